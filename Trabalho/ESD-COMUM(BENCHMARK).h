@@ -0,0 +1,546 @@
+// Código comum aos cinco programas (ESD-TRABALHO(*).cpp): timer de alta precisão, harness de
+// benchmark (aquecimento, repetições, percentis e contadores de hardware por cenário) e registros
+// estruturados dos benchmarks (CSV/JSON, comparação com baseline). Cada programa o inclui uma vez,
+// logo depois de MachineData e antes dos outros ESD-COMUM(*).h, cujos benchmarks o usam; o arquivo
+// traz definições e usa os includes do programa.
+#ifndef ESD_COMUM_BENCHMARK_H
+#define ESD_COMUM_BENCHMARK_H
+
+// Timer de alta precisão
+typedef struct {
+    long long start;
+    long long end;
+} HighPrecisionTimer;
+
+void start_timer(HighPrecisionTimer* timer) {
+    timer->start = timerTicks();
+}
+
+double stop_timer(HighPrecisionTimer* timer) {
+    timer->end = timerTicks();
+    return (double)(timer->end - timer->start) * 1000.0 / timerFrequency();
+}
+
+// --- HARNESS DE BENCHMARK: AQUECIMENTO, REPETIÇÕES E PERCENTIS ---
+// Um cenário é uma operação op(ctx, i) repetida opsPerRun vezes por rodada. setup e teardown
+// (opcionais) correm antes e depois de cada rodada, fora da medição; servem, por exemplo, para
+// montar uma estrutura nova. runBenchScenario faz BENCH_WARMUP_RUNS rodadas de aquecimento (caches,
+// preditor, páginas do heap), que ficam fora dos números, e depois BENCH_RUNS rodadas medidas.
+// Cada operação é cronometrada com timerTicks(), descontado o custo de ler o relógio, e cai num
+// histograma log-linear no estilo HDR. Até HDR_SUB ns os valores são exatos; acima disso há
+// HDR_SUB/2 faixas por oitava, e o erro de um percentil fica abaixo de 2/HDR_SUB. op devolve a
+// classe da operação (inserção, busca...), e cada classe tem o próprio histograma. A vazão de
+// cada rodada (operações / tempo da rodada) dá a média e o intervalo de confiança de 95% (t de
+// Student com BENCH_RUNS - 1 graus de liberdade).
+#define BENCH_WARMUP_RUNS 2
+#define BENCH_RUNS 10
+#define BENCH_MAX_CLASSES 6
+#define HDR_SUB_BITS 7                  // 128 faixas na primeira oitava, 64 nas seguintes
+#define HDR_SUB (1 << HDR_SUB_BITS)
+#define HDR_MAX_SHIFT 40                // Até ~2^47 ns; acima disso satura
+#define HDR_BUCKETS ((HDR_MAX_SHIFT + 2) * (HDR_SUB / 2))
+
+typedef struct {
+    long long counts[HDR_BUCKETS];
+    long long total;
+    long long min, max;                 // ns, exatos
+    double sum;
+} LatencyHistogram;
+
+typedef struct {
+    const char* name;
+    int opsPerRun;
+    void* ctx;
+    void (*setup)(void* ctx);           // Antes de cada rodada (opcional)
+    int (*op)(void* ctx, int i);        // Uma operação; devolve a classe (0 .. classes - 1)
+    void (*teardown)(void* ctx);        // Depois de cada rodada (opcional)
+    int classes;
+    const char* classNames[BENCH_MAX_CLASSES];
+} BenchScenario;
+
+typedef struct {
+    long long count;
+    double mean, min, p50, p99, p999, max; // ns
+} BenchLatency;
+
+typedef struct {
+    int runs;
+    double throughput, throughputCi;    // ops/s e meia largura do IC de 95%
+    BenchLatency all;
+    BenchLatency cls[BENCH_MAX_CLASSES];
+} BenchResult;
+
+int hdrIndex(long long v) {
+    if (v < HDR_SUB) return v < 0 ? 0 : (int)v;
+    int shift = 63 - bitCountLeadingZeros64((unsigned long long)v) - HDR_SUB_BITS + 1;
+    if (shift > HDR_MAX_SHIFT) return HDR_BUCKETS - 1;
+    return shift * (HDR_SUB / 2) + (int)(v >> shift);
+}
+
+// Ponto médio da faixa
+double hdrValue(int index) {
+    if (index < HDR_SUB) return index;
+    int shift = index / (HDR_SUB / 2) - 1;
+    long long low = (long long)(index - shift * (HDR_SUB / 2)) << shift;
+    return low + ((1LL << shift) - 1) / 2.0;
+}
+
+void latencyReset(LatencyHistogram* h) {
+    memset(h, 0, sizeof(LatencyHistogram));
+    h->min = LLONG_MAX;
+}
+
+void latencyRecord(LatencyHistogram* h, long long ns) {
+    h->counts[hdrIndex(ns)]++;
+    h->total++;
+    h->sum += ns;
+    if (ns < h->min) h->min = ns;
+    if (ns > h->max) h->max = ns;
+}
+
+double latencyPercentile(const LatencyHistogram* h, double q) {
+    long long rank = (long long)ceil(q * h->total), seen = 0;
+    if (rank < 1) rank = 1;
+    for (int i = 0; i < HDR_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            double v = hdrValue(i); // O ponto médio pode passar dos extremos exatos
+            return v < h->min ? h->min : v > h->max ? h->max : v;
+        }
+    }
+    return (double)h->max;
+}
+
+void latencySummary(const LatencyHistogram* h, BenchLatency* out) {
+    memset(out, 0, sizeof(BenchLatency));
+    out->count = h->total;
+    if (h->total == 0) return;
+    out->mean = h->sum / h->total;
+    out->min = (double)h->min;
+    out->p50 = latencyPercentile(h, 0.50);
+    out->p99 = latencyPercentile(h, 0.99);
+    out->p999 = latencyPercentile(h, 0.999);
+    out->max = (double)h->max;
+}
+
+// t de Student bilateral de 95%
+double studentT95(int df) {
+    static const double t[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                 2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                 2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    return df < 1 ? 0.0 : df <= 30 ? t[df - 1] : 1.96;
+}
+
+// Menor intervalo entre duas leituras seguidas do relógio, em ticks
+long long timerOverheadTicks(void) {
+    long long best = LLONG_MAX;
+    for (int i = 0; i < 1000; i++) {
+        long long a = timerTicks();
+        long long b = timerTicks();
+        if (b - a < best) best = b - a;
+    }
+    return best;
+}
+
+void runBenchScenario(const BenchScenario* s, BenchResult* result) {
+    int classes = s->classes > 0 ? s->classes : 1;
+    LatencyHistogram* hist = (LatencyHistogram*)malloc(sizeof(LatencyHistogram) * (classes + 1));
+    if (hist == NULL) {
+        perror("Erro ao alocar memória para os histogramas do benchmark");
+        exit(EXIT_FAILURE);
+    }
+    for (int c = 0; c <= classes; c++) latencyReset(&hist[c]);
+    double nsPerTick = 1e9 / timerFrequency();
+    long long overhead = timerOverheadTicks();
+    double throughput[BENCH_RUNS];
+
+    for (int run = 0; run < BENCH_WARMUP_RUNS + BENCH_RUNS; run++) {
+        bool measured = run >= BENCH_WARMUP_RUNS;
+        if (s->setup) s->setup(s->ctx);
+        long long runTicks = 0;
+        for (int i = 0; i < s->opsPerRun; i++) {
+            long long a = timerTicks();
+            int c = s->op(s->ctx, i);
+            long long ticks = timerTicks() - a - overhead;
+            if (ticks < 0) ticks = 0;
+            runTicks += ticks;
+            if (!measured) continue;
+            long long ns = (long long)(ticks * nsPerTick);
+            latencyRecord(&hist[classes], ns);
+            if (classes > 1 && c >= 0 && c < classes) latencyRecord(&hist[c], ns);
+        }
+        if (s->teardown) s->teardown(s->ctx);
+        if (measured)
+            throughput[run - BENCH_WARMUP_RUNS] = runTicks > 0 ? s->opsPerRun / (runTicks * nsPerTick * 1e-9) : 0.0;
+    }
+
+    memset(result, 0, sizeof(BenchResult));
+    result->runs = BENCH_RUNS;
+    double mean = 0.0, var = 0.0;
+    for (int r = 0; r < BENCH_RUNS; r++) mean += throughput[r];
+    mean /= BENCH_RUNS;
+    for (int r = 0; r < BENCH_RUNS; r++) var += (throughput[r] - mean) * (throughput[r] - mean);
+    var = BENCH_RUNS > 1 ? var / (BENCH_RUNS - 1) : 0.0;
+    result->throughput = mean;
+    result->throughputCi = studentT95(BENCH_RUNS - 1) * sqrt(var / BENCH_RUNS);
+    latencySummary(&hist[classes], &result->all);
+    if (classes > 1)
+        for (int c = 0; c < classes; c++) latencySummary(&hist[c], &result->cls[c]);
+    free(hist);
+}
+
+void printBenchHeader(void) {
+    printf("%-24s %10s %14s %9s %9s %9s %9s %9s %10s\n", "Cenario (us/op)", "ops", "ops/s", "IC95", "min",
+           "p50", "p99", "p99.9", "max");
+}
+
+void printBenchLatencyRow(const char* label, const BenchLatency* l, double throughput, double ci) {
+    if (throughput > 0)
+        printf("%-24s %10lld %14.0f %8.1f%% %9.3f %9.3f %9.3f %9.3f %10.3f\n", label, l->count, throughput,
+               100.0 * ci / throughput, l->min / 1e3, l->p50 / 1e3, l->p99 / 1e3, l->p999 / 1e3, l->max / 1e3);
+    else
+        printf("%-24s %10lld %14s %9s %9.3f %9.3f %9.3f %9.3f %10.3f\n", label, l->count, "", "", l->min / 1e3,
+               l->p50 / 1e3, l->p99 / 1e3, l->p999 / 1e3, l->max / 1e3);
+}
+
+// Linha do cenário e, se houver mais de uma classe, uma linha por classe
+void printBenchResult(const BenchScenario* s, const BenchResult* r) {
+    printBenchLatencyRow(s->name, &r->all, r->throughput, r->throughputCi);
+    if (s->classes > 1) {
+        for (int c = 0; c < s->classes; c++) {
+            char label[40];
+            snprintf(label, sizeof(label), "  %s", s->classNames[c]);
+            printBenchLatencyRow(label, &r->cls[c], 0.0, 0.0);
+        }
+    }
+}
+
+// Com --perf: uma rodada extra do cenário, sem relógio nem histogramas, dentro dos contadores de
+// hardware, para as contagens por operação não incluírem o custo do próprio arcabouço
+void benchScenarioCounters(const BenchScenario* s) {
+    if (!useHardwareCounters) return;
+    HwCounters c;
+    if (s->setup) s->setup(s->ctx);
+    hwCountersStart(&c);
+    for (int i = 0; i < s->opsPerRun; i++) s->op(s->ctx, i);
+    hwCountersStop(&c);
+    if (s->teardown) s->teardown(s->ctx);
+    printHwCounters(&c, s->opsPerRun);
+}
+
+// --- REGISTROS ESTRUTURADOS DOS BENCHMARKS ---
+// Além do texto, cada medição dos benchmarks vira um BenchRecord (seção, cenário, n, operações,
+// ns/op, percentis, bytes) num log em memória. Depois de run_all_benchmarks ou
+// run_restricted_benchmarks o log é gravado em CSV e JSON. Um CSV guardado serve de baseline:
+// compareBenchRecords casa os cenários pela chave (estrutura, seção, cenário, n; repetições da
+// mesma chave casam pela ordem) e aponta como regressão um ns/op ou um uso de memória acima do
+// baseline por mais que o limiar. Quando as duas medidas têm intervalo de confiança, a diferença
+// também precisa passar da soma dos dois para não acusar ruído.
+#define BENCH_DEFAULT_OUTPUT "MachineFailure.bench"             // .csv e .json
+#define BENCH_RESTRICTED_OUTPUT "MachineFailure.bench-restricted"
+#define BENCH_REGRESSION_THRESHOLD 10.0                         // % acima do baseline
+#define BENCH_MIN_BYTES_DELTA 65536                             // Variações de memória menores são do alocador
+
+typedef struct {
+    char backend[32];
+    char section[128];
+    char scenario[64];
+    long long n;           // Registros envolvidos (0 = não se aplica)
+    long long ops;         // Operações medidas (0 = só memória)
+    double nsPerOp;
+    double ci95;           // Meia largura do IC de 95% em % (0 = medida única)
+    double p50, p99, p999; // ns (0 = não medido)
+    long long bytes;       // Memória medida (-1 = não medida)
+} BenchRecord;
+
+typedef struct {
+    BenchRecord* items;
+    int count, capacity;
+    char section[128];
+} BenchRecordLog;
+
+BenchRecordLog benchLog = {NULL, 0, 0, ""};
+
+// Esvazia o log; section é a seção dos registros até o próximo benchSection
+void benchLogReset(const char* section) {
+    benchLog.count = 0;
+    snprintf(benchLog.section, sizeof(benchLog.section), "%s", section);
+}
+
+// Tira vírgulas e aspas, que separariam campos no CSV
+void benchSanitize(char* s) {
+    for (; *s; s++) if (*s == ',' || *s == '"') *s = ';';
+}
+
+// Imprime s numa coluna de width caracteres (não bytes, por causa dos acentos): corta ou completa
+void printUTF8Column(const char* s, int width) {
+    int chars = 0;
+    const char* end = s;
+    while (*end && chars < width) {
+        end++;
+        while (((unsigned char)*end & 0xC0) == 0x80) end++;
+        chars++;
+    }
+    printf("%.*s%*s", (int)(end - s), s, width - chars, "");
+}
+
+// Imprime o título da seção ("3. Tempo de Busca") e o guarda sem o número nos registros seguintes,
+// para a chave não mudar quando as seções forem renumeradas
+void benchSection(const char* title) {
+    printf("\n%s:\n", title);
+    const char* name = title;
+    while (isdigit((unsigned char)*name)) name++;
+    if (name != title && *name == '.') name++;
+    while (*name == ' ') name++;
+    snprintf(benchLog.section, sizeof(benchLog.section), "%s", name);
+    benchSanitize(benchLog.section);
+}
+
+BenchRecord* benchRecordAppend(long long n, long long ops, double ms, const char* fmt, va_list args) {
+    if (benchLog.count == benchLog.capacity) {
+        int capacity = benchLog.capacity ? benchLog.capacity * 2 : 128;
+        BenchRecord* grown = (BenchRecord*)realloc(benchLog.items, sizeof(BenchRecord) * capacity);
+        if (grown == NULL) {
+            perror("Erro ao alocar memória para os registros dos benchmarks");
+            exit(EXIT_FAILURE);
+        }
+        benchLog.items = grown;
+        benchLog.capacity = capacity;
+    }
+    BenchRecord* r = &benchLog.items[benchLog.count++];
+    memset(r, 0, sizeof(BenchRecord));
+    snprintf(r->backend, sizeof(r->backend), "%s", STRUCTURE_NAME);
+    snprintf(r->section, sizeof(r->section), "%s", benchLog.section);
+    vsnprintf(r->scenario, sizeof(r->scenario), fmt, args);
+    benchSanitize(r->scenario);
+    r->n = n;
+    r->ops = ops;
+    r->nsPerOp = ops > 0 ? ms * 1e6 / ops : 0.0;
+    r->bytes = -1;
+    return r;
+}
+
+// Uma medição de ms milissegundos para ops operações; o nome do cenário é formatado como no printf
+BenchRecord* benchRecord(long long n, long long ops, double ms, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    BenchRecord* r = benchRecordAppend(n, ops, ms, fmt, args);
+    va_end(args);
+    return r;
+}
+
+// Um cenário do runBenchScenario: a linha geral (com IC e percentis) e uma por classe
+void benchRecordResult(const BenchScenario* s, const BenchResult* r, long long n) {
+    BenchRecord* rec = benchRecord(n, r->all.count, r->all.mean * r->all.count / 1e6, "%s", s->name);
+    rec->ci95 = r->throughput > 0 ? 100.0 * r->throughputCi / r->throughput : 0.0;
+    rec->p50 = r->all.p50;
+    rec->p99 = r->all.p99;
+    rec->p999 = r->all.p999;
+    if (s->classes <= 1) return;
+    for (int c = 0; c < s->classes; c++) {
+        const BenchLatency* l = &r->cls[c];
+        rec = benchRecord(n, l->count, l->mean * l->count / 1e6, "%s: %s", s->name, s->classNames[c]);
+        rec->p50 = l->p50;
+        rec->p99 = l->p99;
+        rec->p999 = l->p999;
+    }
+}
+
+// Bytes entre duas fotos: o heap quando medido, senão o residente (-1 = nenhum dos dois)
+long long memoryDeltaBytes(const MemorySnapshot* before, const MemorySnapshot* after) {
+    if (after->heapBytes >= 0 && before->heapBytes >= 0) return after->heapBytes - before->heapBytes;
+    if (after->rssBytes >= 0 && before->rssBytes >= 0) return after->rssBytes - before->rssBytes;
+    return -1;
+}
+
+void benchRecordBytes(long long n, long long bytes, const char* scenario) {
+    benchRecord(n, 0, 0.0, "%s", scenario)->bytes = bytes;
+}
+
+// Fecha a seção: imprime a variação de memória e a registra
+void benchMemoryDelta(const MemorySnapshot* before) {
+    MemorySnapshot after;
+    memorySnapshot(&after);
+    printMemoryDelta("Memória", before);
+    benchRecordBytes(0, memoryDeltaBytes(before, &after), "Memoria da secao");
+}
+
+int writeBenchRecordsCSV(const char* path, const BenchRecord* records, int count) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        perror("Erro ao gravar o CSV dos benchmarks");
+        return -1;
+    }
+    fprintf(file, "backend,section,scenario,n,ops,ns_per_op,ci95_pct,p50_ns,p99_ns,p999_ns,bytes\n");
+    for (int i = 0; i < count; i++) {
+        const BenchRecord* r = &records[i];
+        fprintf(file, "%s,%s,%s,%lld,%lld,%.3f,%.2f,%.1f,%.1f,%.1f,%lld\n", r->backend, r->section, r->scenario, r->n,
+                r->ops, r->nsPerOp, r->ci95, r->p50, r->p99, r->p999, r->bytes);
+    }
+    fclose(file);
+    return 0;
+}
+
+void writeJSONString(FILE* file, const char* s) {
+    fputc('"', file);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', file);
+        fputc(*s, file);
+    }
+    fputc('"', file);
+}
+
+int writeBenchRecordsJSON(const char* path, const BenchRecord* records, int count) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        perror("Erro ao gravar o JSON dos benchmarks");
+        return -1;
+    }
+    fprintf(file, "{\n  \"backend\": \"%s\",\n  \"clock\": \"%s\",\n  \"memory\": \"%s\",\n  \"records\": [\n",
+            STRUCTURE_NAME, timerSourceName(), memoryHeapSource());
+    for (int i = 0; i < count; i++) {
+        const BenchRecord* r = &records[i];
+        fprintf(file, "    {\"section\": ");
+        writeJSONString(file, r->section);
+        fprintf(file, ", \"scenario\": ");
+        writeJSONString(file, r->scenario);
+        fprintf(file, ", \"n\": %lld, \"ops\": %lld, \"ns_per_op\": %.3f, \"ci95_pct\": %.2f, \"p50_ns\": %.1f, "
+                      "\"p99_ns\": %.1f, \"p999_ns\": %.1f, \"bytes\": %lld}%s\n",
+                r->n, r->ops, r->nsPerOp, r->ci95, r->p50, r->p99, r->p999, r->bytes, i + 1 < count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return 0;
+}
+
+// Grava o log em <prefixo>.csv e <prefixo>.json
+int saveBenchRecords(const char* prefix) {
+    char csvPath[512], jsonPath[512];
+    snprintf(csvPath, sizeof(csvPath), "%s.csv", prefix);
+    snprintf(jsonPath, sizeof(jsonPath), "%s.json", prefix);
+    if (writeBenchRecordsCSV(csvPath, benchLog.items, benchLog.count) < 0 ||
+        writeBenchRecordsJSON(jsonPath, benchLog.items, benchLog.count) < 0)
+        return -1;
+    printf("\n%d medições gravadas em %s e %s\n", benchLog.count, csvPath, jsonPath);
+    return 0;
+}
+
+int loadBenchRecords(const char* path, BenchRecord** records) {
+    *records = NULL;
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        perror("Erro ao abrir o CSV dos benchmarks");
+        return -1;
+    }
+    int count = 0, capacity = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        BenchRecord r;
+        memset(&r, 0, sizeof(r));
+        if (sscanf(line, "%31[^,],%127[^,],%63[^,],%lld,%lld,%lf,%lf,%lf,%lf,%lf,%lld", r.backend, r.section,
+                   r.scenario, &r.n, &r.ops, &r.nsPerOp, &r.ci95, &r.p50, &r.p99, &r.p999, &r.bytes) != 11)
+            continue; // Cabeçalho ou linha inválida
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 128;
+            BenchRecord* grown = (BenchRecord*)realloc(*records, sizeof(BenchRecord) * capacity);
+            if (grown == NULL) {
+                perror("Erro ao alocar memória para os registros dos benchmarks");
+                exit(EXIT_FAILURE);
+            }
+            *records = grown;
+        }
+        (*records)[count++] = r;
+    }
+    fclose(file);
+    return count;
+}
+
+bool benchSameKey(const BenchRecord* a, const BenchRecord* b) {
+    return a->n == b->n && strcmp(a->backend, b->backend) == 0 && strcmp(a->section, b->section) == 0 &&
+           strcmp(a->scenario, b->scenario) == 0;
+}
+
+// k-ésima ocorrência (a partir de 0) da chave de key em records
+const BenchRecord* findBenchRecord(const BenchRecord* records, int count, const BenchRecord* key, int k) {
+    for (int i = 0; i < count; i++) {
+        if (benchSameKey(&records[i], key) && k-- == 0) return &records[i];
+    }
+    return NULL;
+}
+
+// Uma linha por métrica comparada; devolve quantas regressões passaram do limiar (em %)
+int compareBenchRecords(const BenchRecord* baseline, int baseCount, const BenchRecord* current, int count,
+                        double threshold) {
+    int regressions = 0, improvements = 0, compared = 0, missing = 0;
+    printf("\n=== COMPARAÇÃO COM O BASELINE (limiar %.1f%%) ===\n", threshold);
+    printf("%-28s %-36s %8s %13s %13s %9s  %s\n", "Secao", "Cenario", "n", "Baseline", "Atual", "Dif.", "Situacao");
+    for (int i = 0; i < count; i++) {
+        const BenchRecord* cur = &current[i];
+        int k = 0;
+        for (int j = 0; j < i; j++) k += benchSameKey(&current[j], cur);
+        const BenchRecord* base = findBenchRecord(baseline, baseCount, cur, k);
+        if (base == NULL) {
+            missing++;
+            continue;
+        }
+        for (int metric = 0; metric < 2; metric++) {
+            double before = metric == 0 ? base->nsPerOp : (double)base->bytes;
+            double after = metric == 0 ? cur->nsPerOp : (double)cur->bytes;
+            bool measured = metric == 0 ? base->ops > 0 && cur->ops > 0 : base->bytes > 0 && cur->bytes >= 0;
+            if (!measured || before <= 0) continue;
+            compared++;
+            double diff = 100.0 * (after - before) / before;
+            double noise = base->ci95 > 0 && cur->ci95 > 0 ? base->ci95 + cur->ci95 : 0.0;
+            const char* verdict = "ok";
+            if (metric == 1 && fabs(after - before) < BENCH_MIN_BYTES_DELTA) noise = INFINITY;
+            if (diff > threshold && diff > noise) {
+                verdict = "REGRESSAO";
+                regressions++;
+            } else if (diff < -threshold && -diff > noise) {
+                verdict = "melhora";
+                improvements++;
+            }
+            if (strcmp(verdict, "ok") == 0) continue; // Só as mudanças entram na tabela
+            printUTF8Column(cur->section, 28);
+            putchar(' ');
+            printUTF8Column(cur->scenario, 36);
+            if (metric == 0)
+                printf(" %8lld %10.1f ns %10.1f ns %+8.1f%%  %s\n", cur->n, before, after, diff, verdict);
+            else
+                printf(" %8lld %10.1f KB %10.1f KB %+8.1f%%  %s\n", cur->n, before / 1024.0, after / 1024.0, diff,
+                       verdict);
+        }
+    }
+    printf("%d métricas comparadas: %d regressão(ões), %d melhora(s), %d sem mudança além do limiar; "
+           "%d medição(ões) sem par no baseline\n",
+           compared, regressions, improvements, compared - regressions - improvements, missing);
+    return regressions;
+}
+
+int compareBenchFiles(const char* currentPath, const char* baselinePath, double threshold) {
+    BenchRecord *current, *baseline;
+    int count = loadBenchRecords(currentPath, &current);
+    if (count < 0) return -1;
+    int baseCount = loadBenchRecords(baselinePath, &baseline);
+    if (baseCount < 0) {
+        free(current);
+        return -1;
+    }
+    int regressions = compareBenchRecords(baseline, baseCount, current, count, threshold);
+    free(current);
+    free(baseline);
+    return regressions;
+}
+
+// Modo batch: "--compare-benchmarks atual.csv baseline.csv [limiar%]"; sai com 1 se houver regressão
+int batchCompareBenchmarks(int argc, char* argv[]) {
+    if (argc < 4) {
+        printf("Uso: %s --compare-benchmarks atual.csv baseline.csv [limiar%%]\n", argv[0]);
+        return 2;
+    }
+    double threshold = argc > 4 && atof(argv[4]) > 0 ? atof(argv[4]) : BENCH_REGRESSION_THRESHOLD;
+    int regressions = compareBenchFiles(argv[2], argv[3], threshold);
+    return regressions < 0 ? 2 : regressions > 0 ? 1 : 0;
+}
+
+#endif // ESD_COMUM_BENCHMARK_H
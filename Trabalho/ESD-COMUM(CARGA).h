@@ -0,0 +1,426 @@
+// Código comum aos cinco programas (ESD-TRABALHO(*).cpp): traço de carga de trabalho
+// determinístico e o modo "--workload" que o executa sobre a estrutura do programa. Cada programa o
+// inclui uma vez, depois da sua adaptação ao código comum (WorkloadBackend e funções workload*); o
+// arquivo traz definições e usa os includes do programa.
+#ifndef ESD_COMUM_CARGA_H
+#define ESD_COMUM_CARGA_H
+
+// --- CARGA DE TRABALHO COMUM PARA COMPARAR AS ESTRUTURAS ---
+// Os cinco programas geram, a partir da mesma semente, o mesmo traço: WORKLOAD_DEFAULT_PRELOAD
+// registros iniciais e uma sequência de inserções, buscas por UDI, buscas por ProductID,
+// contagens de um intervalo de UDIs, remoções por UDI e estatísticas. O gerador é próprio
+// (splitmix64) para o traço não depender do rand() da libc. Cada programa reproduz o traço na
+// sua estrutura pelas funções workload* (definidas antes desta seção, uma por operação), com o
+// runBenchScenario, e acrescenta as suas linhas a um CSV comum; a tabela e o JSON são refeitos
+// a partir de todas as estruturas do CSV medidas com a mesma semente e o mesmo traço. As
+// respostas das operações são dobradas num checksum, que tem de ser igual entre as estruturas.
+#define WORKLOAD_OPS 6
+#define WORKLOAD_DEFAULT_OPS 20000
+#define WORKLOAD_DEFAULT_PRELOAD 5000
+#define WORKLOAD_DEFAULT_SEED 1u
+#define WORKLOAD_DEFAULT_FILE "MachineFailure.workload.csv"
+#define WORKLOAD_FIRST_UDI 100000        // Acima dos UDIs do CSV e do generateRandomData
+#define WORKLOAD_RANGE_WIDTH 64          // UDIs por consulta de intervalo
+#define WORKLOAD_MAX_BACKENDS 16
+
+enum { WORKLOAD_INSERT, WORKLOAD_FIND_UDI, WORKLOAD_FIND_PID, WORKLOAD_RANGE, WORKLOAD_DELETE, WORKLOAD_STATS };
+
+const char* workloadOpNames[WORKLOAD_OPS] = {"insert", "search_udi", "search_pid", "range", "delete", "stats"};
+const int workloadMix[WORKLOAD_OPS] = {30, 25, 15, 10, 18, 2}; // % do traço
+
+typedef struct {
+    int op;
+    int udi;          // Chave (limite inferior no intervalo)
+    int hi;           // Intervalo: limite superior
+    MachineData data; // Inserção: o registro; busca por ProductID: data.ProductID
+} WorkloadOp;
+
+typedef struct {
+    unsigned int seed;
+    int preload, ops;
+    MachineData* initial;
+    WorkloadOp* trace;
+} WorkloadTrace;
+
+typedef struct {
+    char backend[32];
+    unsigned int seed;
+    int preload, ops;
+    char op[16];
+    long long count;
+    double throughput, ci;                 // ops/s; só na linha "all"
+    double mean, p50, p99, p999, max;      // ns
+    unsigned long long checksum;
+} WorkloadRow;
+
+unsigned long long workloadNext(unsigned long long* state) {
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int workloadUniform(unsigned long long* state, int n) {
+    return (int)(workloadNext(state) % (unsigned long long)n);
+}
+
+// ProductID único por UDI, para que a busca por ProductID tenha uma resposta só
+void workloadProductID(int udi, char* pid, size_t size) {
+    snprintf(pid, size, "W%07d", udi);
+}
+
+// Faixas de valores do conjunto AI4I (temperaturas em K) e ~3,4% de falhas, com um modo cada
+void workloadRecord(unsigned long long* state, int udi, MachineData* d) {
+    memset(d, 0, sizeof(MachineData));
+    d->UDI = udi;
+    workloadProductID(udi, d->ProductID, sizeof(d->ProductID));
+    d->Type = "LLLLLMMMHH"[workloadUniform(state, 10)];
+    d->AirTemp = 295.0f + workloadUniform(state, 100) / 10.0f;
+    d->ProcessTemp = d->AirTemp + 8.0f + workloadUniform(state, 40) / 10.0f;
+    d->RotationalSpeed = 1170 + workloadUniform(state, 1720);
+    d->Torque = 3.8f + workloadUniform(state, 728) / 10.0f;
+    d->ToolWear = workloadUniform(state, 254);
+    if (workloadUniform(state, 1000) < 34) {
+        d->MachineFailure = true;
+        switch (workloadUniform(state, 5)) {
+            case 0: d->TWF = true; break;
+            case 1: d->HDF = true; break;
+            case 2: d->PWF = true; break;
+            case 3: d->OSF = true; break;
+            default: d->RNF = true; break;
+        }
+    }
+}
+
+// Sorteia o traço acompanhando os UDIs vivos: buscas e remoções acertam um registro existente em
+// 80%/90% das vezes e no resto usam uma chave qualquer já emitida (viva, removida ou nunca usada).
+void generateWorkloadTrace(WorkloadTrace* w, unsigned int seed, int preload, int ops) {
+    w->seed = seed;
+    w->preload = preload;
+    w->ops = ops;
+    w->initial = (MachineData*)malloc(sizeof(MachineData) * (preload > 0 ? preload : 1));
+    w->trace = (WorkloadOp*)malloc(sizeof(WorkloadOp) * (ops > 0 ? ops : 1));
+    int* alive = (int*)malloc(sizeof(int) * (preload + ops + 1));
+    if (w->initial == NULL || w->trace == NULL || alive == NULL) {
+        perror("Erro ao alocar memória para o traço da carga de trabalho");
+        exit(EXIT_FAILURE);
+    }
+    unsigned long long state = seed;
+    int nextUDI = WORKLOAD_FIRST_UDI, aliveCount = 0;
+    for (int i = 0; i < preload; i++) {
+        workloadRecord(&state, nextUDI, &w->initial[i]);
+        alive[aliveCount++] = nextUDI++;
+    }
+
+    for (int i = 0; i < ops; i++) {
+        WorkloadOp* op = &w->trace[i];
+        memset(op, 0, sizeof(WorkloadOp));
+        int pick = workloadUniform(&state, 100);
+        op->op = 0;
+        while (op->op < WORKLOAD_OPS - 1 && pick >= workloadMix[op->op]) pick -= workloadMix[op->op++];
+        if (aliveCount == 0 && op->op != WORKLOAD_STATS) op->op = WORKLOAD_INSERT;
+
+        int span = nextUDI - WORKLOAD_FIRST_UDI + 1; // Chaves já emitidas e a próxima
+        switch (op->op) {
+            case WORKLOAD_INSERT:
+                workloadRecord(&state, nextUDI, &op->data);
+                op->udi = nextUDI;
+                alive[aliveCount++] = nextUDI++;
+                break;
+            case WORKLOAD_FIND_UDI:
+            case WORKLOAD_FIND_PID:
+                op->udi = workloadUniform(&state, 100) < 80 ? alive[workloadUniform(&state, aliveCount)]
+                                                             : WORKLOAD_FIRST_UDI + workloadUniform(&state, span);
+                workloadProductID(op->udi, op->data.ProductID, sizeof(op->data.ProductID));
+                break;
+            case WORKLOAD_RANGE:
+                op->udi = WORKLOAD_FIRST_UDI + workloadUniform(&state, span);
+                op->hi = op->udi + WORKLOAD_RANGE_WIDTH - 1;
+                break;
+            case WORKLOAD_DELETE:
+                if (workloadUniform(&state, 100) < 90) {
+                    int k = workloadUniform(&state, aliveCount);
+                    op->udi = alive[k];
+                    alive[k] = alive[--aliveCount];
+                } else {
+                    op->udi = WORKLOAD_FIRST_UDI + workloadUniform(&state, span);
+                    for (int k = 0; k < aliveCount; k++) {
+                        if (alive[k] == op->udi) {
+                            alive[k] = alive[--aliveCount];
+                            break;
+                        }
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    free(alive);
+}
+
+void freeWorkloadTrace(WorkloadTrace* w) {
+    free(w->initial);
+    free(w->trace);
+    w->initial = NULL;
+    w->trace = NULL;
+}
+
+// Executa uma operação do traço; a resposta (achou, removeu, quantos no intervalo, n das
+// estatísticas) entra no checksum
+long long workloadExecute(WorkloadBackend* b, const WorkloadOp* op) {
+    switch (op->op) {
+        case WORKLOAD_INSERT: workloadInsert(b, &op->data); return 1;
+        case WORKLOAD_FIND_UDI: return workloadFindUDI(b, op->udi);
+        case WORKLOAD_FIND_PID: return workloadFindProductID(b, op->data.ProductID);
+        case WORKLOAD_RANGE: return workloadRangeCount(b, op->udi, op->hi);
+        case WORKLOAD_DELETE: return workloadDeleteUDI(b, op->udi);
+        default: return workloadStats(b);
+    }
+}
+
+typedef struct {
+    WorkloadBackend backend;
+    const WorkloadTrace* trace;
+    unsigned long long checksum;
+} WorkloadBench;
+
+void workloadBenchSetup(void* ctx) {
+    WorkloadBench* w = (WorkloadBench*)ctx;
+    workloadInit(&w->backend, w->trace->preload + w->trace->ops);
+    for (int i = 0; i < w->trace->preload; i++) workloadInsert(&w->backend, &w->trace->initial[i]);
+    w->checksum = 1469598103934665603ULL;
+}
+
+int workloadBenchOp(void* ctx, int i) {
+    WorkloadBench* w = (WorkloadBench*)ctx;
+    const WorkloadOp* op = &w->trace->trace[i];
+    long long answer = workloadExecute(&w->backend, op);
+    w->checksum = (w->checksum ^ (unsigned long long)answer) * 1099511628211ULL;
+    return op->op;
+}
+
+void workloadBenchTeardown(void* ctx) {
+    workloadFree(&((WorkloadBench*)ctx)->backend);
+}
+
+void workloadRowFromLatency(WorkloadRow* row, const WorkloadTrace* w, unsigned long long checksum, const char* op,
+                            const BenchLatency* l) {
+    memset(row, 0, sizeof(WorkloadRow));
+    snprintf(row->backend, sizeof(row->backend), "%s", STRUCTURE_NAME);
+    row->seed = w->seed;
+    row->preload = w->preload;
+    row->ops = w->ops;
+    snprintf(row->op, sizeof(row->op), "%s", op);
+    row->count = l->count;
+    row->mean = l->mean;
+    row->p50 = l->p50;
+    row->p99 = l->p99;
+    row->p999 = l->p999;
+    row->max = l->max;
+    row->checksum = checksum;
+}
+
+bool workloadSameTrace(const WorkloadRow* a, const WorkloadRow* b) {
+    return a->seed == b->seed && a->preload == b->preload && a->ops == b->ops;
+}
+
+// Lê as linhas de um CSV da carga de trabalho (ausente = nenhuma linha)
+int loadWorkloadRows(const char* path, WorkloadRow** rows) {
+    *rows = NULL;
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return 0;
+    int count = 0, capacity = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        WorkloadRow r;
+        memset(&r, 0, sizeof(r));
+        if (sscanf(line, "%31[^,],%u,%d,%d,%15[^,],%lld,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%llx", r.backend, &r.seed,
+                   &r.preload, &r.ops, r.op, &r.count, &r.throughput, &r.ci, &r.mean, &r.p50, &r.p99, &r.p999,
+                   &r.max, &r.checksum) != 14)
+            continue; // Cabeçalho ou linha inválida
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            WorkloadRow* grown = (WorkloadRow*)realloc(*rows, sizeof(WorkloadRow) * capacity);
+            if (grown == NULL) {
+                perror("Erro ao alocar memória para as linhas da carga de trabalho");
+                exit(EXIT_FAILURE);
+            }
+            *rows = grown;
+        }
+        (*rows)[count++] = r;
+    }
+    fclose(file);
+    return count;
+}
+
+int writeWorkloadRows(const char* path, const WorkloadRow* rows, int count) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        perror("Erro ao gravar o CSV da carga de trabalho");
+        return -1;
+    }
+    fprintf(file, "backend,seed,preload,ops,op,count,ops_per_s,ci95_ops_per_s,mean_ns,p50_ns,p99_ns,p999_ns,"
+                  "max_ns,checksum\n");
+    for (int i = 0; i < count; i++) {
+        const WorkloadRow* r = &rows[i];
+        fprintf(file, "%s,%u,%d,%d,%s,%lld,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%016llx\n", r->backend, r->seed,
+                r->preload, r->ops, r->op, r->count, r->throughput, r->ci, r->mean, r->p50, r->p99, r->p999, r->max,
+                r->checksum);
+    }
+    fclose(file);
+    return 0;
+}
+
+// Estruturas do CSV medidas com o traço de key, na ordem em que aparecem
+int workloadBackends(const WorkloadRow* rows, int count, const WorkloadRow* key, const char* names[]) {
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        if (!workloadSameTrace(&rows[i], key)) continue;
+        bool seen = false;
+        for (int b = 0; b < n && !seen; b++) seen = strcmp(names[b], rows[i].backend) == 0;
+        if (!seen && n < WORKLOAD_MAX_BACKENDS) names[n++] = rows[i].backend;
+    }
+    return n;
+}
+
+const WorkloadRow* findWorkloadRow(const WorkloadRow* rows, int count, const WorkloadRow* key, const char* backend,
+                                   const char* op) {
+    for (int i = 0; i < count; i++) {
+        if (workloadSameTrace(&rows[i], key) && strcmp(rows[i].backend, backend) == 0 && strcmp(rows[i].op, op) == 0)
+            return &rows[i];
+    }
+    return NULL;
+}
+
+int writeWorkloadJSON(const char* path, const WorkloadRow* rows, int count, const WorkloadRow* key) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        perror("Erro ao gravar o JSON da carga de trabalho");
+        return -1;
+    }
+    const char* names[WORKLOAD_MAX_BACKENDS];
+    int n = workloadBackends(rows, count, key, names);
+    fprintf(file, "{\n  \"seed\": %u,\n  \"preload\": %d,\n  \"ops\": %d,\n  \"backends\": [\n", key->seed, key->preload,
+            key->ops);
+    for (int b = 0; b < n; b++) {
+        const WorkloadRow* all = findWorkloadRow(rows, count, key, names[b], "all");
+        fprintf(file, "    {\n      \"backend\": \"%s\",\n", names[b]);
+        if (all != NULL)
+            fprintf(file, "      \"checksum\": \"%016llx\",\n      \"ops_per_s\": %.1f,\n      \"ci95_ops_per_s\": %.1f,\n",
+                    all->checksum, all->throughput, all->ci);
+        fprintf(file, "      \"operations\": {");
+        bool first = true;
+        for (int o = -1; o < WORKLOAD_OPS; o++) {
+            const WorkloadRow* r = findWorkloadRow(rows, count, key, names[b], o < 0 ? "all" : workloadOpNames[o]);
+            if (r == NULL) continue;
+            fprintf(file, "%s\n        \"%s\": {\"count\": %lld, \"mean_ns\": %.1f, \"p50_ns\": %.1f, \"p99_ns\": %.1f, "
+                          "\"p999_ns\": %.1f, \"max_ns\": %.1f}",
+                    first ? "" : ",", r->op, r->count, r->mean, r->p50, r->p99, r->p999, r->max);
+            first = false;
+        }
+        fprintf(file, "\n      }\n    }%s\n", b + 1 < n ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return 0;
+}
+
+// Uma linha por estrutura: vazão do traço inteiro e latência média de cada operação
+void displayWorkloadComparison(const WorkloadRow* rows, int count, const WorkloadRow* key) {
+    const char* names[WORKLOAD_MAX_BACKENDS];
+    int n = workloadBackends(rows, count, key, names);
+    printf("\n=== COMPARAÇÃO DAS ESTRUTURAS (semente %u, %d registros iniciais, %d operações) ===\n", key->seed,
+           key->preload, key->ops);
+    printf("%-18s %12s %7s", "Estrutura", "ops/s", "IC95");
+    for (int o = 0; o < WORKLOAD_OPS; o++) printf(" %11s", workloadOpNames[o]);
+    printf("  %s\n", "checksum");
+    printf("%-18s %12s %7s", "", "", "");
+    for (int o = 0; o < WORKLOAD_OPS; o++) printf(" %11s", "media us");
+    printf("\n");
+
+    unsigned long long reference = 0;
+    bool mismatch = false;
+    for (int b = 0; b < n; b++) {
+        const WorkloadRow* all = findWorkloadRow(rows, count, key, names[b], "all");
+        if (all == NULL) continue;
+        printf("%-18s %12.0f %6.1f%%", names[b], all->throughput,
+               all->throughput > 0 ? 100.0 * all->ci / all->throughput : 0.0);
+        for (int o = 0; o < WORKLOAD_OPS; o++) {
+            const WorkloadRow* r = findWorkloadRow(rows, count, key, names[b], workloadOpNames[o]);
+            if (r != NULL && r->count > 0) printf(" %11.3f", r->mean / 1e3);
+            else printf(" %11s", "-");
+        }
+        printf("  %016llx\n", all->checksum);
+        if (b == 0) reference = all->checksum;
+        else mismatch |= all->checksum != reference;
+    }
+    if (mismatch) printf("ATENÇÃO: checksums diferentes; as estruturas não deram as mesmas respostas ao traço.\n");
+}
+
+// Modo batch: "--workload [operações] [semente] [arquivo.csv]" mede esta estrutura no traço comum,
+// substitui as linhas dela no CSV e refaz a tabela comparativa e o JSON (mesmo nome, .json)
+int batchWorkload(int argc, char* argv[]) {
+    int ops = argc > 2 && atoi(argv[2]) > 0 ? atoi(argv[2]) : WORKLOAD_DEFAULT_OPS;
+    unsigned int seed = argc > 3 ? (unsigned int)strtoul(argv[3], NULL, 10) : WORKLOAD_DEFAULT_SEED;
+    const char* path = argc > 4 ? argv[4] : WORKLOAD_DEFAULT_FILE;
+
+    WorkloadTrace trace;
+    generateWorkloadTrace(&trace, seed, WORKLOAD_DEFAULT_PRELOAD, ops);
+    int mix[WORKLOAD_OPS] = {0};
+    for (int i = 0; i < ops; i++) mix[trace.trace[i].op]++;
+    printf("Traço: semente %u, %d registros iniciais, %d operações (", seed, trace.preload, ops);
+    for (int o = 0; o < WORKLOAD_OPS; o++) printf("%s%s=%d", o ? ", " : "", workloadOpNames[o], mix[o]);
+    printf(")\n");
+
+    WorkloadBench bench;
+    bench.trace = &trace;
+    bench.checksum = 0;
+    BenchScenario s = {STRUCTURE_NAME, ops, &bench, workloadBenchSetup, workloadBenchOp, workloadBenchTeardown,
+                       WORKLOAD_OPS, {NULL}};
+    for (int o = 0; o < WORKLOAD_OPS; o++) s.classNames[o] = workloadOpNames[o];
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printBenchHeader();
+    printBenchResult(&s, &r);
+
+    WorkloadRow own[WORKLOAD_OPS + 1];
+    workloadRowFromLatency(&own[0], &trace, bench.checksum, "all", &r.all);
+    own[0].throughput = r.throughput;
+    own[0].ci = r.throughputCi;
+    for (int o = 0; o < WORKLOAD_OPS; o++)
+        workloadRowFromLatency(&own[o + 1], &trace, bench.checksum, workloadOpNames[o], &r.cls[o]);
+    freeWorkloadTrace(&trace);
+
+    // Linhas antigas desta estrutura com o mesmo traço saem; as outras ficam
+    WorkloadRow* rows;
+    int count = loadWorkloadRows(path, &rows), kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (!(workloadSameTrace(&rows[i], &own[0]) && strcmp(rows[i].backend, own[0].backend) == 0))
+            rows[kept++] = rows[i];
+    }
+    WorkloadRow* merged = (WorkloadRow*)realloc(rows, sizeof(WorkloadRow) * (kept + WORKLOAD_OPS + 1));
+    if (merged == NULL) {
+        perror("Erro ao alocar memória para as linhas da carga de trabalho");
+        free(rows);
+        return 1;
+    }
+    memcpy(merged + kept, own, sizeof(own));
+    count = kept + WORKLOAD_OPS + 1;
+
+    char jsonPath[512];
+    snprintf(jsonPath, sizeof(jsonPath), "%s", path);
+    char* dot = strrchr(jsonPath, '.');
+    if (dot != NULL && strchr(dot, '/') == NULL) *dot = '\0';
+    strncat(jsonPath, ".json", sizeof(jsonPath) - strlen(jsonPath) - 1);
+
+    int status = writeWorkloadRows(path, merged, count) == 0 && writeWorkloadJSON(jsonPath, merged, count, &own[0]) == 0
+                     ? 0
+                     : 1;
+    displayWorkloadComparison(merged, count, &own[0]);
+    if (status == 0) printf("Linhas em %s; comparação em %s\n", path, jsonPath);
+    free(merged);
+    return status;
+}
+
+#endif // ESD_COMUM_CARGA_H
@@ -0,0 +1,822 @@
+// Código comum aos cinco programas (ESD-TRABALHO(*).cpp): estatísticas em uma passada (Welford/Chan,
+// com redução paralela) e o motor de histogramas e matrizes de covariância/correlação, cada um com
+// o seu benchmark sobre registros sintéticos. Cada programa o inclui uma vez, antes das suas funções
+// de estatística; o arquivo traz definições e usa os includes do programa.
+#ifndef ESD_COMUM_ESTATISTICAS_H
+#define ESD_COMUM_ESTATISTICAS_H
+
+// --- ESTATÍSTICAS EM UMA PASSADA (WELFORD / CHAN) ---
+// Média e soma dos quadrados dos desvios (m2) atualizadas a cada registro, em double.
+// Dois acumuladores parciais se fundem pela fórmula de Chan, então as linhas podem ser
+// divididas em blocos, acumuladas em paralelo e reduzidas no fim.
+#define STAT_METRICS 4              // ToolWear, Torque, RotationalSpeed, diferença de temperatura
+#define STATS_MAX_THREADS 64
+#define STATS_PARALLEL_MIN_ROWS 200000 // Abaixo disso criar threads custa mais que a passada
+
+const char* statMetricTitles[STAT_METRICS] = {
+    "Desgaste da Ferramenta (ToolWear)",
+    "Torque (Nm)",
+    "Velocidade Rotacional (RPM)",
+    "Diferença de Temperatura (ProcessTemp - AirTemp)"
+};
+
+typedef struct {
+    long long n;
+    double mean[STAT_METRICS];
+    double m2[STAT_METRICS];
+    double min[STAT_METRICS];
+    double max[STAT_METRICS];
+} RunningStats;
+
+void runningStatsInit(RunningStats* rs) {
+    rs->n = 0;
+    for (int m = 0; m < STAT_METRICS; m++) {
+        rs->mean[m] = 0;
+        rs->m2[m] = 0;
+        rs->min[m] = INFINITY;
+        rs->max[m] = -INFINITY;
+    }
+}
+
+// Valor da métrica m de um registro (mesma ordem de statMetricTitles)
+double statMetric(const MachineData* d, int m) {
+    switch (m) {
+        case 0: return d->ToolWear;
+        case 1: return d->Torque;
+        case 2: return d->RotationalSpeed;
+        default: return (double)(d->ProcessTemp - d->AirTemp);
+    }
+}
+
+void runningStatsAdd(RunningStats* rs, const MachineData* d) {
+    double x[STAT_METRICS] = {(double)d->ToolWear, (double)d->Torque, (double)d->RotationalSpeed,
+                              (double)(d->ProcessTemp - d->AirTemp)};
+    double inv = 1.0 / (double)++rs->n;
+    for (int m = 0; m < STAT_METRICS; m++) {
+        double delta = x[m] - rs->mean[m];
+        rs->mean[m] += delta * inv;
+        rs->m2[m] += delta * (x[m] - rs->mean[m]);
+        if (x[m] < rs->min[m]) rs->min[m] = x[m];
+        if (x[m] > rs->max[m]) rs->max[m] = x[m];
+    }
+}
+
+// Chan et al.: funde 'part' em 'into' sem rever as linhas
+void runningStatsMerge(RunningStats* into, const RunningStats* part) {
+    if (part->n == 0) return;
+    if (into->n == 0) {
+        *into = *part;
+        return;
+    }
+    double na = (double)into->n, nb = (double)part->n, n = na + nb;
+    for (int m = 0; m < STAT_METRICS; m++) {
+        double delta = part->mean[m] - into->mean[m];
+        into->mean[m] += delta * nb / n;
+        into->m2[m] += part->m2[m] + delta * delta * na * nb / n;
+        if (part->min[m] < into->min[m]) into->min[m] = part->min[m];
+        if (part->max[m] > into->max[m]) into->max[m] = part->max[m];
+    }
+    into->n += part->n;
+}
+
+// Desvio padrão populacional, como o cálculo original
+double runningStatsStdDev(const RunningStats* rs, int m) {
+    return rs->n > 0 && rs->m2[m] > 0 ? sqrt(rs->m2[m] / rs->n) : 0;
+}
+
+typedef struct {
+    const MachineData* const* rows;
+    int begin, end;
+    RunningStats partial;
+} StatsChunk;
+
+#ifdef _WIN32
+DWORD WINAPI statsChunkWorker(LPVOID arg) {
+#else
+void* statsChunkWorker(void* arg) {
+#endif
+    StatsChunk* chunk = (StatsChunk*)arg;
+    runningStatsInit(&chunk->partial);
+    for (int i = chunk->begin; i < chunk->end; i++) runningStatsAdd(&chunk->partial, chunk->rows[i]);
+    return 0;
+}
+
+int availableCores() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+#endif
+}
+
+// Divide as n linhas em 'threads' blocos contíguos, acumula cada bloco numa thread
+// (o primeiro na thread atual) e reduz os parciais na ordem dos blocos
+void runningStatsParallel(const MachineData* const* rows, int n, int threads, RunningStats* out) {
+    if (threads > STATS_MAX_THREADS) threads = STATS_MAX_THREADS;
+    if (threads > n) threads = n;
+    if (threads < 1) threads = 1;
+    StatsChunk chunks[STATS_MAX_THREADS];
+    bool started[STATS_MAX_THREADS] = {false};
+#ifdef _WIN32
+    HANDLE handles[STATS_MAX_THREADS];
+#else
+    pthread_t handles[STATS_MAX_THREADS];
+#endif
+    for (int t = 0; t < threads; t++) {
+        chunks[t].rows = rows;
+        chunks[t].begin = (int)((long long)n * t / threads);
+        chunks[t].end = (int)((long long)n * (t + 1) / threads);
+    }
+    for (int t = 1; t < threads; t++) {
+#ifdef _WIN32
+        handles[t] = CreateThread(NULL, 0, statsChunkWorker, &chunks[t], 0, NULL);
+        started[t] = handles[t] != NULL;
+#else
+        started[t] = pthread_create(&handles[t], NULL, statsChunkWorker, &chunks[t]) == 0;
+#endif
+        if (!started[t]) statsChunkWorker(&chunks[t]); // Sem thread: o bloco roda aqui mesmo
+    }
+    statsChunkWorker(&chunks[0]);
+    runningStatsInit(out);
+    for (int t = 0; t < threads; t++) {
+        if (started[t]) {
+#ifdef _WIN32
+            WaitForSingleObject(handles[t], INFINITE);
+            CloseHandle(handles[t]);
+#else
+            pthread_join(handles[t], NULL);
+#endif
+        }
+        runningStatsMerge(out, &chunks[t].partial);
+    }
+}
+
+#define STATS_SYNTH_PASSES 50 // Passadas sobre o bloco sintético: 50M linhas
+
+double statsRelativeError(double x, long double ref) {
+    return ref != 0 ? (double)fabsl(((long double)x - ref) / ref) : fabs(x);
+}
+
+// Maior erro relativo (média e desvio, nas 4 métricas) contra a referência
+double statsMaxError(const double mean[STAT_METRICS], const double stdDev[STAT_METRICS],
+                     const long double refMean[STAT_METRICS], const long double refStd[STAT_METRICS]) {
+    double worst = 0;
+    for (int m = 0; m < STAT_METRICS; m++) {
+        double e = statsRelativeError(mean[m], refMean[m]);
+        if (e > worst) worst = e;
+        e = statsRelativeError(stdDev[m], refStd[m]);
+        if (e > worst) worst = e;
+    }
+    return worst;
+}
+
+// Duas passadas em float (método anterior) x Welford em uma passada x redução paralela de Chan
+void benchmark_parallel_stats() {
+    MachineData* recs = (MachineData*)malloc(sizeof(MachineData) * SYNTH_ROWS);
+    const MachineData** rows = (const MachineData**)malloc(sizeof(MachineData*) * SYNTH_ROWS);
+    if (recs == NULL || rows == NULL) {
+        perror("Erro ao alocar memória para o benchmark das estatísticas");
+        free(recs);
+        free(rows);
+        return;
+    }
+    fillSyntheticRecords(recs, SYNTH_ROWS, 35);
+    for (int i = 0; i < SYNTH_ROWS; i++) rows[i] = &recs[i];
+    long long total = (long long)SYNTH_ROWS * STATS_SYNTH_PASSES;
+
+    // Referência em long double, duas passadas. Todas as passadas repetem o mesmo bloco,
+    // então média e desvio das 50M linhas são os do bloco
+    long double refMean[STAT_METRICS] = {0}, refStd[STAT_METRICS] = {0};
+    for (int i = 0; i < SYNTH_ROWS; i++)
+        for (int m = 0; m < STAT_METRICS; m++) refMean[m] += statMetric(rows[i], m);
+    for (int m = 0; m < STAT_METRICS; m++) refMean[m] /= SYNTH_ROWS;
+    for (int i = 0; i < SYNTH_ROWS; i++)
+        for (int m = 0; m < STAT_METRICS; m++) {
+            long double dev = statMetric(rows[i], m) - refMean[m];
+            refStd[m] += dev * dev;
+        }
+    for (int m = 0; m < STAT_METRICS; m++) refStd[m] = sqrtl(refStd[m] / SYNTH_ROWS);
+
+    HighPrecisionTimer t;
+    double mean[STAT_METRICS], stdDev[STAT_METRICS];
+    printf("%lld linhas (%d x %d registros), %d núcleo(s) disponível(is)\n", total, STATS_SYNTH_PASSES,
+           SYNTH_ROWS, availableCores());
+    printf("%-30s %12s %9s %14s\n", "Metodo", "Tempo(ms)", "Speedup", "Erro relativo");
+    printf("(speedup em relação ao Welford de uma thread; erro contra referência em long double)\n");
+
+    // Método anterior: somas em float e segunda passada com pow
+    start_timer(&t);
+    float sum[STAT_METRICS] = {0}, sq[STAT_METRICS] = {0};
+    for (int pass = 0; pass < STATS_SYNTH_PASSES; pass++)
+        for (int i = 0; i < SYNTH_ROWS; i++)
+            for (int m = 0; m < STAT_METRICS; m++) sum[m] += (float)statMetric(rows[i], m);
+    for (int m = 0; m < STAT_METRICS; m++) mean[m] = sum[m] / total;
+    for (int pass = 0; pass < STATS_SYNTH_PASSES; pass++)
+        for (int i = 0; i < SYNTH_ROWS; i++)
+            for (int m = 0; m < STAT_METRICS; m++) sq[m] += pow((float)statMetric(rows[i], m) - (float)mean[m], 2);
+    for (int m = 0; m < STAT_METRICS; m++) stdDev[m] = sqrt(sq[m] / total);
+    double legacy_ms = stop_timer(&t);
+    double legacy_error = statsMaxError(mean, stdDev, refMean, refStd);
+
+    // Welford, uma thread
+    start_timer(&t);
+    RunningStats rs;
+    runningStatsInit(&rs);
+    for (int pass = 0; pass < STATS_SYNTH_PASSES; pass++)
+        for (int i = 0; i < SYNTH_ROWS; i++) runningStatsAdd(&rs, rows[i]);
+    double welford_ms = stop_timer(&t);
+    for (int m = 0; m < STAT_METRICS; m++) {
+        mean[m] = rs.mean[m];
+        stdDev[m] = runningStatsStdDev(&rs, m);
+    }
+    printf("%-30s %12.2f %8.2fx %14.2e\n", "Duas passadas (float)", legacy_ms, welford_ms / legacy_ms, legacy_error);
+    printf("%-30s %12.2f %8.2fx %14.2e\n", "Welford (1 thread)", welford_ms, 1.0,
+           statsMaxError(mean, stdDev, refMean, refStd));
+    benchRecord(SYNTH_ROWS, total, legacy_ms, "Duas passadas (float)");
+    benchRecord(SYNTH_ROWS, total, welford_ms, "Welford (1 thread)");
+
+    // Blocos em paralelo + redução de Chan, dobrando as threads até o número de núcleos
+    int cores = availableCores();
+    for (int threads = 1; ; threads *= 2) {
+        if (threads > cores) threads = cores;
+        start_timer(&t);
+        RunningStats all, part;
+        runningStatsInit(&all);
+        for (int pass = 0; pass < STATS_SYNTH_PASSES; pass++) {
+            runningStatsParallel(rows, SYNTH_ROWS, threads, &part);
+            runningStatsMerge(&all, &part);
+        }
+        double parallel_ms = stop_timer(&t);
+        for (int m = 0; m < STAT_METRICS; m++) {
+            mean[m] = all.mean[m];
+            stdDev[m] = runningStatsStdDev(&all, m);
+        }
+        char label[40];
+        snprintf(label, sizeof(label), "Welford/Chan (%d thread%s)", threads, threads > 1 ? "s" : "");
+        printf("%-30s %12.2f %8.2fx %14.2e\n", label, parallel_ms, welford_ms / parallel_ms,
+               statsMaxError(mean, stdDev, refMean, refStd));
+        benchRecord(SYNTH_ROWS, total, parallel_ms, "%s", label);
+        if (threads >= cores || threads >= STATS_MAX_THREADS) break;
+    }
+    free(recs);
+    free(rows);
+}
+
+// --- HISTOGRAMAS E MATRIZES DE COVARIÂNCIA/CORRELAÇÃO ---
+// Uma passada preenche, para cada grupo (todos, sem/com falha e cada modo), os histogramas
+// das 5 colunas e as somas Σ(x-K) e Σ(x-K)(y-K), com K = valores do primeiro registro
+// (dados deslocados: a covariância final não sofre cancelamento). Somas só se adicionam,
+// então blocos de threads diferentes se fundem somando e "sem falha" sai de "todos" menos
+// "com falha". O grupo "todos" roda em lotes colunares com SSE2; os grupos de falha, raros,
+// são acumulados linha a linha a partir do mesmo lote.
+#define ANALYTICS_COLS 5
+#define ANALYTICS_GROUPS 8
+#define ANALYTICS_BLOCK 64     // Linhas somadas em float antes de passar para double
+#define ANALYTICS_BATCH 1024
+#define HIST_MAX_BINS 200      // Índice da faixa cabe em unsigned char (0..HIST_MAX_BINS+1)
+#define HIST_DEFAULT_BINS 20
+#define ANALYTICS_DEFAULT_PREFIX "MachineFailure" // Prefixo dos CSVs do modo batch
+
+#ifdef FILTER_SSE2
+#define ANALYTICS_SIMD_NAME "SSE2"
+#else
+#define ANALYTICS_SIMD_NAME "escalar"
+#endif
+
+enum { GROUP_ALL, GROUP_OK, GROUP_FAIL, GROUP_TWF, GROUP_HDF, GROUP_PWF, GROUP_OSF, GROUP_RNF };
+
+const char* analyticsColumnNames[ANALYTICS_COLS] = {"AirTemp", "ProcessTemp", "RPM", "Torque", "ToolWear"};
+const char* analyticsGroupNames[ANALYTICS_GROUPS] = {"Todos", "Sem falha", "Com falha", "TWF", "HDF", "PWF", "OSF", "RNF"};
+
+typedef struct {
+    int bins;
+    double lo[ANALYTICS_COLS]; // Faixa [lo, hi) de cada coluna
+    double hi[ANALYTICS_COLS];
+} AnalyticsConfig;
+
+typedef struct {
+    long long n;
+    double s1[ANALYTICS_COLS];                 // Σ(x - K)
+    double s2[ANALYTICS_COLS][ANALYTICS_COLS]; // Σ(x - K)(y - K), só o triângulo superior
+} CovarianceSums;
+
+typedef struct {
+    AnalyticsConfig cfg;
+    double shift[ANALYTICS_COLS]; // K
+    CovarianceSums sums[ANALYTICS_GROUPS];
+    long long hist[ANALYTICS_GROUPS][ANALYTICS_COLS][HIST_MAX_BINS + 2]; // [0] abaixo de lo, [bins + 1] a partir de hi
+} SensorAnalytics;
+
+typedef struct {
+    float cols[ANALYTICS_COLS][ANALYTICS_BATCH]; // x - K
+    unsigned char bin[ANALYTICS_COLS][ANALYTICS_BATCH];
+    unsigned int groups[ANALYTICS_BATCH];        // Bits GROUP_FAIL..GROUP_RNF
+} AnalyticsBatch;
+
+// Faixas cobrindo o conjunto AI4I; o que ficar fora vai para as caixas de excesso
+void analyticsDefaultConfig(AnalyticsConfig* cfg, int bins) {
+    static const double lo[ANALYTICS_COLS] = {295, 305, 1100, 0, 0};
+    static const double hi[ANALYTICS_COLS] = {305, 315, 2900, 80, 260};
+    cfg->bins = bins < 1 ? 1 : bins > HIST_MAX_BINS ? HIST_MAX_BINS : bins;
+    for (int c = 0; c < ANALYTICS_COLS; c++) {
+        cfg->lo[c] = lo[c];
+        cfg->hi[c] = hi[c];
+    }
+}
+
+// Valor da coluna c (mesma ordem de analyticsColumnNames)
+double analyticsValue(const MachineData* d, int c) {
+    switch (c) {
+        case 0: return d->AirTemp;
+        case 1: return d->ProcessTemp;
+        case 2: return d->RotationalSpeed;
+        case 3: return d->Torque;
+        default: return d->ToolWear;
+    }
+}
+
+unsigned int analyticsFailureGroups(const MachineData* d) {
+    return ((unsigned int)d->MachineFailure << GROUP_FAIL) | ((unsigned int)d->TWF << GROUP_TWF) |
+           ((unsigned int)d->HDF << GROUP_HDF) | ((unsigned int)d->PWF << GROUP_PWF) |
+           ((unsigned int)d->OSF << GROUP_OSF) | ((unsigned int)d->RNF << GROUP_RNF);
+}
+
+void sensorAnalyticsInit(SensorAnalytics* a, const AnalyticsConfig* cfg, const MachineData* first) {
+    memset(a, 0, sizeof(SensorAnalytics));
+    a->cfg = *cfg;
+    for (int c = 0; c < ANALYTICS_COLS; c++) {
+        a->shift[c] = first ? analyticsValue(first, c) : (cfg->lo[c] + cfg->hi[c]) / 2;
+    }
+}
+
+// Faixa de um valor deslocado xs; as mesmas operações em float da versão SSE2,
+// então as duas caem sempre na mesma faixa
+int analyticsBin(float xs, float offset, float scale, float top) {
+    float t = (xs + offset) * scale + 1.0f;
+    t = t > 0.0f ? t : 0.0f;
+    t = t < top ? t : top;
+    return (int)t;
+}
+
+// Transpõe n registros para o lote (zeros até o múltiplo de ANALYTICS_BLOCK)
+void analyticsGather(const SensorAnalytics* a, const MachineData* const* rows, int n, AnalyticsBatch* b) {
+    int padded = (n + ANALYTICS_BLOCK - 1) / ANALYTICS_BLOCK * ANALYTICS_BLOCK;
+    for (int i = 0; i < n; i++) {
+        const MachineData* d = rows[i];
+        b->cols[0][i] = (float)(d->AirTemp - a->shift[0]);
+        b->cols[1][i] = (float)(d->ProcessTemp - a->shift[1]);
+        b->cols[2][i] = (float)(d->RotationalSpeed - a->shift[2]);
+        b->cols[3][i] = (float)(d->Torque - a->shift[3]);
+        b->cols[4][i] = (float)(d->ToolWear - a->shift[4]);
+        b->groups[i] = analyticsFailureGroups(d);
+    }
+    for (int i = n; i < padded; i++) {
+        for (int c = 0; c < ANALYTICS_COLS; c++) b->cols[c][i] = 0.0f;
+        b->groups[i] = 0;
+    }
+}
+
+#ifdef FILTER_SSE2
+float analyticsHorizontalSum(__m128 v) {
+    float lanes[4];
+    _mm_storeu_ps(lanes, v);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+#endif
+
+void analyticsAccumulateBatch(SensorAnalytics* a, AnalyticsBatch* b, int n) {
+    int padded = (n + ANALYTICS_BLOCK - 1) / ANALYTICS_BLOCK * ANALYTICS_BLOCK;
+    int bins = a->cfg.bins;
+    float top = (float)(bins + 1);
+
+    // Faixas de todas as linhas (reaproveitadas pelos grupos de falha)
+    for (int c = 0; c < ANALYTICS_COLS; c++) {
+        float offset = (float)(a->shift[c] - a->cfg.lo[c]);
+        float scale = (float)(bins / (a->cfg.hi[c] - a->cfg.lo[c]));
+        const float* col = b->cols[c];
+        unsigned char* bin = b->bin[c];
+#ifdef FILTER_SSE2
+        __m128 voff = _mm_set1_ps(offset), vscale = _mm_set1_ps(scale);
+        __m128 vone = _mm_set1_ps(1.0f), vzero = _mm_setzero_ps(), vtop = _mm_set1_ps(top);
+        for (int i = 0; i < padded; i += 4) {
+            __m128 t = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(col + i), voff), vscale), vone);
+            t = _mm_min_ps(_mm_max_ps(t, vzero), vtop);
+            int idx[4];
+            _mm_storeu_si128((__m128i*)idx, _mm_cvttps_epi32(t));
+            bin[i] = (unsigned char)idx[0];
+            bin[i + 1] = (unsigned char)idx[1];
+            bin[i + 2] = (unsigned char)idx[2];
+            bin[i + 3] = (unsigned char)idx[3];
+        }
+#else
+        for (int i = 0; i < padded; i++) bin[i] = (unsigned char)analyticsBin(col[i], offset, scale, top);
+#endif
+        long long* hist = a->hist[GROUP_ALL][c];
+        for (int i = 0; i < n; i++) hist[bin[i]]++;
+    }
+
+    // Grupo "todos": as linhas de enchimento são zero e não alteram as somas
+    CovarianceSums* all = &a->sums[GROUP_ALL];
+    all->n += n;
+#ifdef FILTER_SSE2
+    for (int base = 0; base < padded; base += ANALYTICS_BLOCK) {
+        __m128 s1[ANALYTICS_COLS], s2[ANALYTICS_COLS][ANALYTICS_COLS];
+        for (int c = 0; c < ANALYTICS_COLS; c++) {
+            s1[c] = _mm_setzero_ps();
+            for (int d = c; d < ANALYTICS_COLS; d++) s2[c][d] = _mm_setzero_ps();
+        }
+        for (int i = base; i < base + ANALYTICS_BLOCK; i += 4) {
+            __m128 v[ANALYTICS_COLS];
+            for (int c = 0; c < ANALYTICS_COLS; c++) {
+                v[c] = _mm_loadu_ps(b->cols[c] + i);
+                s1[c] = _mm_add_ps(s1[c], v[c]);
+            }
+            for (int c = 0; c < ANALYTICS_COLS; c++) {
+                for (int d = c; d < ANALYTICS_COLS; d++) s2[c][d] = _mm_add_ps(s2[c][d], _mm_mul_ps(v[c], v[d]));
+            }
+        }
+        for (int c = 0; c < ANALYTICS_COLS; c++) {
+            all->s1[c] += analyticsHorizontalSum(s1[c]);
+            for (int d = c; d < ANALYTICS_COLS; d++) all->s2[c][d] += analyticsHorizontalSum(s2[c][d]);
+        }
+    }
+#else
+    for (int i = 0; i < n; i++) {
+        for (int c = 0; c < ANALYTICS_COLS; c++) {
+            double x = b->cols[c][i];
+            all->s1[c] += x;
+            for (int d = c; d < ANALYTICS_COLS; d++) all->s2[c][d] += x * b->cols[d][i];
+        }
+    }
+#endif
+
+    // Grupos de falha: poucas linhas, somadas direto em double
+    for (int i = 0; i < n; i++) {
+        unsigned int g = b->groups[i];
+        if (g == 0) continue;
+        double v[ANALYTICS_COLS];
+        for (int c = 0; c < ANALYTICS_COLS; c++) v[c] = b->cols[c][i];
+        while (g) {
+            int k = bitCountTrailingZeros64(g);
+            g &= g - 1;
+            CovarianceSums* s = &a->sums[k];
+            s->n++;
+            for (int c = 0; c < ANALYTICS_COLS; c++) {
+                s->s1[c] += v[c];
+                for (int d = c; d < ANALYTICS_COLS; d++) s->s2[c][d] += v[c] * v[d];
+                a->hist[k][c][b->bin[c][i]]++;
+            }
+        }
+    }
+}
+
+void sensorAnalyticsMerge(SensorAnalytics* into, const SensorAnalytics* part) {
+    for (int g = 0; g < ANALYTICS_GROUPS; g++) {
+        CovarianceSums* s = &into->sums[g];
+        const CovarianceSums* p = &part->sums[g];
+        s->n += p->n;
+        for (int c = 0; c < ANALYTICS_COLS; c++) {
+            s->s1[c] += p->s1[c];
+            for (int d = c; d < ANALYTICS_COLS; d++) s->s2[c][d] += p->s2[c][d];
+            for (int k = 0; k < into->cfg.bins + 2; k++) into->hist[g][c][k] += part->hist[g][c][k];
+        }
+    }
+}
+
+// "Sem falha" = "todos" - "com falha"
+void sensorAnalyticsFinish(SensorAnalytics* a) {
+    CovarianceSums* ok = &a->sums[GROUP_OK];
+    const CovarianceSums* all = &a->sums[GROUP_ALL];
+    const CovarianceSums* fail = &a->sums[GROUP_FAIL];
+    ok->n = all->n - fail->n;
+    for (int c = 0; c < ANALYTICS_COLS; c++) {
+        ok->s1[c] = all->s1[c] - fail->s1[c];
+        for (int d = c; d < ANALYTICS_COLS; d++) ok->s2[c][d] = all->s2[c][d] - fail->s2[c][d];
+        for (int k = 0; k < a->cfg.bins + 2; k++) {
+            a->hist[GROUP_OK][c][k] = a->hist[GROUP_ALL][c][k] - a->hist[GROUP_FAIL][c][k];
+        }
+    }
+}
+
+double analyticsMean(const SensorAnalytics* a, int g, int c) {
+    const CovarianceSums* s = &a->sums[g];
+    return s->n > 0 ? a->shift[c] + s->s1[c] / s->n : 0;
+}
+
+// Covariância populacional (mesma convenção do desvio padrão de calculateStatistics)
+double analyticsCovariance(const SensorAnalytics* a, int g, int c, int d) {
+    const CovarianceSums* s = &a->sums[g];
+    if (s->n == 0) return 0;
+    if (c > d) {
+        int swap = c; c = d; d = swap;
+    }
+    return (s->s2[c][d] - s->s1[c] * s->s1[d] / s->n) / s->n;
+}
+
+double analyticsCorrelation(const SensorAnalytics* a, int g, int c, int d) {
+    double vc = analyticsCovariance(a, g, c, c), vd = analyticsCovariance(a, g, d, d);
+    if (vc <= 0 || vd <= 0) return 0;
+    return analyticsCovariance(a, g, c, d) / sqrt(vc * vd);
+}
+
+typedef struct {
+    const MachineData* const* rows;
+    int begin, end;
+    SensorAnalytics* partial;
+} AnalyticsChunk;
+
+#ifdef _WIN32
+DWORD WINAPI analyticsChunkWorker(LPVOID arg) {
+#else
+void* analyticsChunkWorker(void* arg) {
+#endif
+    AnalyticsChunk* chunk = (AnalyticsChunk*)arg;
+    AnalyticsBatch* b = (AnalyticsBatch*)malloc(sizeof(AnalyticsBatch));
+    if (b == NULL) {
+        perror("Erro ao alocar memória para a análise dos sensores");
+        exit(EXIT_FAILURE);
+    }
+    for (int start = chunk->begin; start < chunk->end; start += ANALYTICS_BATCH) {
+        int len = chunk->end - start < ANALYTICS_BATCH ? chunk->end - start : ANALYTICS_BATCH;
+        analyticsGather(chunk->partial, chunk->rows + start, len, b);
+        analyticsAccumulateBatch(chunk->partial, b, len);
+    }
+    free(b);
+    return 0;
+}
+
+// Mesma divisão de runningStatsParallel: blocos contíguos, o primeiro na thread atual,
+// parciais somados na ordem dos blocos
+void runSensorAnalytics(const MachineData* const* rows, int n, const AnalyticsConfig* cfg, int threads,
+                        SensorAnalytics* out) {
+    sensorAnalyticsInit(out, cfg, n > 0 ? rows[0] : NULL);
+    if (threads > STATS_MAX_THREADS) threads = STATS_MAX_THREADS;
+    if (threads > n) threads = n;
+    if (threads < 1) threads = 1;
+    AnalyticsChunk chunks[STATS_MAX_THREADS];
+    bool started[STATS_MAX_THREADS] = {false};
+#ifdef _WIN32
+    HANDLE handles[STATS_MAX_THREADS];
+#else
+    pthread_t handles[STATS_MAX_THREADS];
+#endif
+    for (int t = 0; t < threads; t++) {
+        chunks[t].rows = rows;
+        chunks[t].begin = (int)((long long)n * t / threads);
+        chunks[t].end = (int)((long long)n * (t + 1) / threads);
+        if (t == 0) {
+            chunks[t].partial = out;
+            continue;
+        }
+        chunks[t].partial = (SensorAnalytics*)malloc(sizeof(SensorAnalytics));
+        if (chunks[t].partial == NULL) {
+            perror("Erro ao alocar memória para a análise dos sensores");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(chunks[t].partial, out, sizeof(SensorAnalytics)); // Mesma configuração e K, somas zeradas
+    }
+    for (int t = 1; t < threads; t++) {
+#ifdef _WIN32
+        handles[t] = CreateThread(NULL, 0, analyticsChunkWorker, &chunks[t], 0, NULL);
+        started[t] = handles[t] != NULL;
+#else
+        started[t] = pthread_create(&handles[t], NULL, analyticsChunkWorker, &chunks[t]) == 0;
+#endif
+        if (!started[t]) analyticsChunkWorker(&chunks[t]);
+    }
+    analyticsChunkWorker(&chunks[0]);
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) {
+#ifdef _WIN32
+            WaitForSingleObject(handles[t], INFINITE);
+            CloseHandle(handles[t]);
+#else
+            pthread_join(handles[t], NULL);
+#endif
+        }
+        sensorAnalyticsMerge(out, chunks[t].partial);
+        free(chunks[t].partial);
+    }
+    sensorAnalyticsFinish(out);
+}
+
+// Referência linha a linha em double, sem lotes nem SIMD (usada no benchmark)
+void sensorAnalyticsRowwise(const MachineData* const* rows, int n, const AnalyticsConfig* cfg, SensorAnalytics* out) {
+    sensorAnalyticsInit(out, cfg, n > 0 ? rows[0] : NULL);
+    float top = (float)(cfg->bins + 1);
+    float offset[ANALYTICS_COLS], scale[ANALYTICS_COLS];
+    for (int c = 0; c < ANALYTICS_COLS; c++) {
+        offset[c] = (float)(out->shift[c] - cfg->lo[c]);
+        scale[c] = (float)(cfg->bins / (cfg->hi[c] - cfg->lo[c]));
+    }
+    for (int i = 0; i < n; i++) {
+        unsigned int g = analyticsFailureGroups(rows[i]) | (1u << GROUP_ALL);
+        if (!rows[i]->MachineFailure) g |= 1u << GROUP_OK;
+        float v[ANALYTICS_COLS];
+        for (int c = 0; c < ANALYTICS_COLS; c++) v[c] = (float)(analyticsValue(rows[i], c) - out->shift[c]);
+        for (int k = 0; k < ANALYTICS_GROUPS; k++) {
+            if (!(g & (1u << k))) continue;
+            CovarianceSums* s = &out->sums[k];
+            s->n++;
+            for (int c = 0; c < ANALYTICS_COLS; c++) {
+                s->s1[c] += v[c];
+                for (int d = c; d < ANALYTICS_COLS; d++) s->s2[c][d] += (double)v[c] * v[d];
+                out->hist[k][c][analyticsBin(v[c], offset[c], scale[c], top)]++;
+            }
+        }
+    }
+}
+
+void displaySensorAnalytics(const SensorAnalytics* a) {
+    static const char bar[] = "########################################"; // 40 colunas
+    const AnalyticsConfig* cfg = &a->cfg;
+    printf("\n=== HISTOGRAMAS (%lld registros, %d faixas por sensor) ===\n", a->sums[GROUP_ALL].n, cfg->bins);
+    for (int c = 0; c < ANALYTICS_COLS; c++) {
+        const long long* h = a->hist[GROUP_ALL][c];
+        long long peak = 1;
+        for (int k = 1; k <= cfg->bins; k++) {
+            if (h[k] > peak) peak = h[k];
+        }
+        double width = (cfg->hi[c] - cfg->lo[c]) / cfg->bins;
+        printf("\n%s [%.2f, %.2f): abaixo %lld | acima %lld\n", analyticsColumnNames[c], cfg->lo[c], cfg->hi[c],
+               h[0], h[cfg->bins + 1]);
+        for (int k = 1; k <= cfg->bins; k++) {
+            int len = (int)(h[k] * 40 / peak);
+            printf("  %10.2f - %-10.2f %8lld | %.*s\n", cfg->lo[c] + (k - 1) * width, cfg->lo[c] + k * width, h[k],
+                   len, bar);
+        }
+    }
+
+    printf("\n=== CORRELAÇÕES POR MODO DE FALHA ===\n");
+    for (int g = 0; g < ANALYTICS_GROUPS; g++) {
+        long long n = a->sums[g].n;
+        if (n < 2) {
+            printf("\n--- %s: %lld registro(s), insuficiente para correlação ---\n", analyticsGroupNames[g], n);
+            continue;
+        }
+        printf("\n--- %s: %lld registros ---\n", analyticsGroupNames[g], n);
+        printf("%-12s", "");
+        for (int d = 0; d < ANALYTICS_COLS; d++) printf("%12s", analyticsColumnNames[d]);
+        printf("\n%-12s", "Média");
+        for (int d = 0; d < ANALYTICS_COLS; d++) printf("%12.2f", analyticsMean(a, g, d));
+        printf("\n%-12s", "Desvio");
+        for (int d = 0; d < ANALYTICS_COLS; d++) printf("%12.2f", sqrt(analyticsCovariance(a, g, d, d)));
+        printf("\n");
+        for (int c = 0; c < ANALYTICS_COLS; c++) {
+            printf("%-12s", analyticsColumnNames[c]);
+            for (int d = 0; d < ANALYTICS_COLS; d++) printf("%12.3f", analyticsCorrelation(a, g, c, d));
+            printf("\n");
+        }
+    }
+}
+
+// Grava <prefixo>_histogramas.csv e <prefixo>_correlacoes.csv (todos os grupos); 0 = sucesso
+int writeSensorAnalyticsCSV(const SensorAnalytics* a, const char* prefix) {
+    char path[512];
+    const AnalyticsConfig* cfg = &a->cfg;
+
+    snprintf(path, sizeof(path), "%s_histogramas.csv", prefix);
+    FILE* f = fopen(path, "w");
+    if (f == NULL) {
+        perror("Erro ao criar o arquivo de histogramas");
+        return 1;
+    }
+    fprintf(f, "grupo,coluna,faixa,inferior,superior,contagem\n");
+    for (int g = 0; g < ANALYTICS_GROUPS; g++) {
+        for (int c = 0; c < ANALYTICS_COLS; c++) {
+            double width = (cfg->hi[c] - cfg->lo[c]) / cfg->bins;
+            const long long* h = a->hist[g][c];
+            fprintf(f, "%s,%s,abaixo,,%.6g,%lld\n", analyticsGroupNames[g], analyticsColumnNames[c], cfg->lo[c], h[0]);
+            for (int k = 1; k <= cfg->bins; k++) {
+                fprintf(f, "%s,%s,%d,%.6g,%.6g,%lld\n", analyticsGroupNames[g], analyticsColumnNames[c], k,
+                        cfg->lo[c] + (k - 1) * width, cfg->lo[c] + k * width, h[k]);
+            }
+            fprintf(f, "%s,%s,acima,%.6g,,%lld\n", analyticsGroupNames[g], analyticsColumnNames[c], cfg->hi[c],
+                    h[cfg->bins + 1]);
+        }
+    }
+    fclose(f);
+    printf("Histogramas gravados em %s\n", path);
+
+    snprintf(path, sizeof(path), "%s_correlacoes.csv", prefix);
+    f = fopen(path, "w");
+    if (f == NULL) {
+        perror("Erro ao criar o arquivo de correlações");
+        return 1;
+    }
+    fprintf(f, "grupo,n,coluna_a,coluna_b,media_a,media_b,covariancia,correlacao\n");
+    for (int g = 0; g < ANALYTICS_GROUPS; g++) {
+        for (int c = 0; c < ANALYTICS_COLS; c++) {
+            for (int d = 0; d < ANALYTICS_COLS; d++) {
+                fprintf(f, "%s,%lld,%s,%s,%.6f,%.6f,%.6f,%.6f\n", analyticsGroupNames[g], a->sums[g].n,
+                        analyticsColumnNames[c], analyticsColumnNames[d], analyticsMean(a, g, c), analyticsMean(a, g, d),
+                        analyticsCovariance(a, g, c, d), analyticsCorrelation(a, g, c, d));
+            }
+        }
+    }
+    fclose(f);
+    printf("Matrizes de covariância/correlação gravadas em %s\n", path);
+    return 0;
+}
+
+// Pergunta o número de faixas e, se o usuário quiser, a faixa [min, max) de cada coluna
+void readAnalyticsConfig(AnalyticsConfig* cfg) {
+    char input[128];
+    int bins = HIST_DEFAULT_BINS;
+    printf("Número de faixas por histograma (1-%d, Enter = %d): ", HIST_MAX_BINS, HIST_DEFAULT_BINS);
+    if (fgets(input, sizeof(input), stdin) && atoi(input) > 0) bins = atoi(input);
+    analyticsDefaultConfig(cfg, bins);
+
+    printf("Usar as faixas padrão dos sensores? (s/n): ");
+    if (!fgets(input, sizeof(input), stdin) || toupper((unsigned char)input[0]) != 'N') return;
+    for (int c = 0; c < ANALYTICS_COLS; c++) {
+        printf("%s: mínimo e máximo (Enter = %.1f %.1f): ", analyticsColumnNames[c], cfg->lo[c], cfg->hi[c]);
+        double lo, hi;
+        if (fgets(input, sizeof(input), stdin) && sscanf(input, "%lf %lf", &lo, &hi) == 2) {
+            if (hi > lo) {
+                cfg->lo[c] = lo;
+                cfg->hi[c] = hi;
+            } else {
+                printf("Faixa inválida, mantendo a padrão.\n");
+            }
+        }
+    }
+}
+
+// Histogramas + covariâncias: referência linha a linha x lotes colunares, dobrando as threads
+void benchmark_sensor_analytics() {
+    static const double lo[ANALYTICS_COLS] = {20, 20, 1200, 30, 0}; // Faixas dos dados sintéticos
+    static const double hi[ANALYTICS_COLS] = {35, 45, 3200, 50, 250};
+    MachineData* recs = (MachineData*)malloc(sizeof(MachineData) * SYNTH_ROWS);
+    const MachineData** rows = (const MachineData**)malloc(sizeof(MachineData*) * SYNTH_ROWS);
+    SensorAnalytics* ref = (SensorAnalytics*)malloc(sizeof(SensorAnalytics));
+    SensorAnalytics* res = (SensorAnalytics*)malloc(sizeof(SensorAnalytics));
+    if (recs == NULL || rows == NULL || ref == NULL || res == NULL) {
+        perror("Erro ao alocar memória para o benchmark da análise");
+        free(recs);
+        free(rows);
+        free(ref);
+        free(res);
+        return;
+    }
+    fillSyntheticRecords(recs, SYNTH_ROWS, 38);
+    for (int i = 0; i < SYNTH_ROWS; i++) {
+        MachineData* d = &recs[i];
+        d->MachineFailure = i % 29 == 0; // ~3,4% de falhas, como no CSV
+        d->TWF = d->MachineFailure && i % 3 == 0;
+        d->HDF = d->MachineFailure && i % 3 == 1;
+        d->PWF = d->MachineFailure && i % 3 == 2;
+        d->OSF = d->MachineFailure && i % 2 == 0;
+        d->RNF = i % 1000 == 0;
+        rows[i] = d;
+    }
+    AnalyticsConfig cfg;
+    analyticsDefaultConfig(&cfg, HIST_DEFAULT_BINS);
+    for (int c = 0; c < ANALYTICS_COLS; c++) {
+        cfg.lo[c] = lo[c];
+        cfg.hi[c] = hi[c];
+    }
+
+    HighPrecisionTimer t;
+    start_timer(&t);
+    sensorAnalyticsRowwise(rows, SYNTH_ROWS, &cfg, ref);
+    double rowwise_ms = stop_timer(&t);
+
+    int cores = availableCores();
+    printf("%d registros, %d faixas, %d grupos x %d colunas, %d núcleo(s) disponível(is)\n", SYNTH_ROWS, cfg.bins,
+           ANALYTICS_GROUPS, ANALYTICS_COLS, cores);
+    printf("%-30s %12s %9s %18s\n", "Metodo", "Tempo(ms)", "Speedup", "Maior dif. corr.");
+    printf("%-30s %12.2f %8.2fx %18.2e\n", "Linha a linha (double)", rowwise_ms, 1.0, 0.0);
+    benchRecord(SYNTH_ROWS, SYNTH_ROWS, rowwise_ms, "Linha a linha (double)");
+    for (int threads = 1; ; threads *= 2) {
+        if (threads > cores) threads = cores;
+        start_timer(&t);
+        runSensorAnalytics(rows, SYNTH_ROWS, &cfg, threads, res);
+        double ms = stop_timer(&t);
+        double worst = 0;
+        for (int g = 0; g < ANALYTICS_GROUPS; g++) {
+            for (int c = 0; c < ANALYTICS_COLS; c++) {
+                for (int d = 0; d < ANALYTICS_COLS; d++) {
+                    double diff = fabs(analyticsCorrelation(res, g, c, d) - analyticsCorrelation(ref, g, c, d));
+                    if (diff > worst) worst = diff;
+                }
+            }
+        }
+        if (memcmp(res->hist, ref->hist, sizeof(res->hist)) != 0)
+            printf("AVISO: histogramas divergem da referência!\n");
+        char label[40];
+        snprintf(label, sizeof(label), "Lotes %s (%d thread%s)", ANALYTICS_SIMD_NAME, threads, threads > 1 ? "s" : "");
+        printf("%-30s %12.2f %8.2fx %18.2e\n", label, ms, rowwise_ms / ms, worst);
+        benchRecord(SYNTH_ROWS, SYNTH_ROWS, ms, "%s", label);
+        if (threads >= cores || threads >= STATS_MAX_THREADS) break;
+    }
+    free(recs);
+    free(rows);
+    free(ref);
+    free(res);
+}
+
+#endif // ESD_COMUM_ESTATISTICAS_H
@@ -0,0 +1,686 @@
+// Código comum aos cinco programas (ESD-TRABALHO(*).cpp): simulação de frota em paralelo e
+// gravação/reprodução do fluxo da simulação, sobre a estrutura do programa via WorkloadBackend.
+// Cada programa o inclui uma vez, logo depois da sua adaptação ao código comum; o arquivo traz
+// definições e usa os includes do programa.
+#ifndef ESD_COMUM_FROTA_H
+#define ESD_COMUM_FROTA_H
+
+// --- SIMULAÇÃO DE FROTA EM PARALELO ---
+// M fresadoras virtuais divididas entre as threads em blocos contíguos (como em
+// runningStatsParallel, o primeiro bloco na thread atual). Cada máquina tem o próprio gerador
+// (xorshift64*, semeado pelo número da máquina: a frota gera os mesmos dados com qualquer número
+// de threads, e nenhuma thread toca no rand() global) e o próprio desvio: o desgaste da ferramenta
+// sobe 2/3/5 min por ciclo (L/M/H) até a troca, o ar esquenta ou esfria devagar entre 296 e 304 K
+// (deriva térmica) e o processo o acompanha 10 K acima. As falhas não são sorteadas: saem das
+// regras do conjunto AI4I sobre o estado da máquina (TWF na troca da ferramenta, HDF com menos de
+// 8,6 K de diferença abaixo de 1380 rpm, PWF fora de 3500-9000 W, OSF com desgaste x torque acima
+// de 11000/12000/13000 min·Nm, RNF em 0,1% dos ciclos). Cada thread junta as amostras num buffer
+// de FLEET_BUFFER, pontua o buffer cheio com checkForFailurePatternBatch e o mescla de uma vez na
+// estrutura, sob um mutex. A latência de um alerta vai da geração da amostra até a pontuação.
+#define FLEET_BUFFER 256                // Amostras por buffer de thread (múltiplo de 64)
+#define FLEET_MAX_MACHINES 100000
+#define FLEET_BENCH_SAMPLES 262144      // Amostras por configuração no benchmark
+
+typedef struct {
+    unsigned long long rng;             // xorshift64*
+    char productID[10];
+    char type;
+    float airTemp;                      // K, com deriva térmica
+    float creep;                        // K por ciclo; troca de sinal nos limites
+    int toolWear, toolLife;             // min; a ferramenta é trocada ao chegar em toolLife
+} FleetMachine;
+
+#ifdef _WIN32
+typedef CRITICAL_SECTION FleetLock;
+#else
+typedef pthread_mutex_t FleetLock;
+#endif
+
+void fleetLockInit(FleetLock* lock) {
+#ifdef _WIN32
+    InitializeCriticalSection(lock);
+#else
+    pthread_mutex_init(lock, NULL);
+#endif
+}
+
+void fleetLockEnter(FleetLock* lock) {
+#ifdef _WIN32
+    EnterCriticalSection(lock);
+#else
+    pthread_mutex_lock(lock);
+#endif
+}
+
+void fleetLockLeave(FleetLock* lock) {
+#ifdef _WIN32
+    LeaveCriticalSection(lock);
+#else
+    pthread_mutex_unlock(lock);
+#endif
+}
+
+void fleetLockDestroy(FleetLock* lock) {
+#ifdef _WIN32
+    DeleteCriticalSection(lock);
+#else
+    pthread_mutex_destroy(lock);
+#endif
+}
+
+typedef struct {
+    WorkloadBackend* store;
+    FleetLock lock;
+    int nextUDI;
+    double mergeMs;                     // Tempo dentro da seção crítica, somado entre as threads
+} FleetStore;
+
+typedef struct {
+    FleetMachine* machines;
+    int begin, end, steps;
+    FailurePatternList* patterns;       // Só leitura: o índice é construído antes das threads
+    FleetStore* shared;
+    long long samples;
+    DetectionCounts hits;               // Alertas x MachineFailure
+    float* latency;                     // µs da geração ao alerta, um por alerta
+    int latencyCount, latencyCap;
+} FleetWorker;
+
+typedef struct {
+    int machines, threads;
+    long long samples;
+    DetectionCounts hits;
+    double ms, mergeMs;
+    float latencyP50, latencyP99, latencyMax; // µs
+} FleetReport;
+
+unsigned long long fleetNext(unsigned long long* state) {
+    unsigned long long x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+float fleetUniform(unsigned long long* state) {
+    return (float)(fleetNext(state) >> 40) * (1.0f / 16777216.0f);
+}
+
+// Aproximadamente N(0, 1): soma de quatro uniformes de 16 bits do mesmo sorteio
+float fleetGauss(unsigned long long* state) {
+    unsigned long long r = fleetNext(state);
+    float sum = (float)(r & 0xffff) + (float)(r >> 16 & 0xffff) + (float)(r >> 32 & 0xffff) + (float)(r >> 48);
+    return (sum * (1.0f / 65536.0f) - 2.0f) * 1.7320508f;
+}
+
+void initFleetMachine(FleetMachine* m, int id, unsigned long long seed) {
+    unsigned long long z = seed + 0x9E3779B97F4A7C15ULL * (unsigned long long)(id + 1); // splitmix64
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    m->rng = (z ^ (z >> 31)) | 1;
+    float u = fleetUniform(&m->rng);
+    m->type = u < 0.6f ? 'L' : u < 0.9f ? 'M' : 'H'; // Proporções do conjunto original
+    snprintf(m->productID, sizeof(m->productID), "%c%05d", m->type, id % 100000);
+    m->airTemp = 300.0f + 2.0f * fleetGauss(&m->rng);
+    m->creep = (0.0005f + 0.001f * fleetUniform(&m->rng)) * (fleetUniform(&m->rng) < 0.5f ? -1.0f : 1.0f);
+    m->toolLife = 200 + (int)(40.0f * fleetUniform(&m->rng));
+    m->toolWear = (int)(m->toolLife * fleetUniform(&m->rng)); // Frota com ferramentas em idades diferentes
+}
+
+// Um ciclo da máquina: avança o desvio e gera a amostra (UDI fica para a mescla)
+void fleetStep(FleetMachine* m, MachineData* d) {
+    m->airTemp += m->creep + 0.02f * fleetGauss(&m->rng);
+    if (m->airTemp > 304.0f) m->creep = -fabsf(m->creep);
+    if (m->airTemp < 296.0f) m->creep = fabsf(m->creep);
+    m->toolWear += m->type == 'H' ? 5 : m->type == 'M' ? 3 : 2;
+
+    d->UDI = 0;
+    memcpy(d->ProductID, m->productID, sizeof(d->ProductID));
+    d->Type = m->type;
+    d->AirTemp = m->airTemp;
+    d->ProcessTemp = m->airTemp + 10.0f + fleetGauss(&m->rng);
+    d->RotationalSpeed = (int)(1538.0f + 180.0f * fleetGauss(&m->rng));
+    float torque = 40.0f - 0.04f * (float)(d->RotationalSpeed - 1538) + 5.0f * fleetGauss(&m->rng);
+    d->Torque = torque < 3.0f ? 3.0f : torque;
+    d->ToolWear = m->toolWear;
+
+    float power = d->Torque * (float)d->RotationalSpeed * (2.0f * 3.14159265f / 60.0f);
+    float strainLimit = m->type == 'H' ? 13000.0f : m->type == 'M' ? 12000.0f : 11000.0f;
+    d->TWF = false;
+    if (m->toolWear >= m->toolLife) { // Troca da ferramenta; metade das trocas chega como falha
+        d->TWF = fleetUniform(&m->rng) < 0.5f;
+        m->toolWear = 0;
+        m->toolLife = 200 + (int)(40.0f * fleetUniform(&m->rng));
+    }
+    d->HDF = d->ProcessTemp - d->AirTemp < 8.6f && d->RotationalSpeed < 1380;
+    d->PWF = power < 3500.0f || power > 9000.0f;
+    d->OSF = (float)d->ToolWear * d->Torque > strainLimit;
+    d->RNF = fleetUniform(&m->rng) < 0.001f;
+    d->MachineFailure = d->TWF || d->HDF || d->PWF || d->OSF || d->RNF;
+}
+
+// Pontua o buffer, registra a latência dos alertas e o mescla na estrutura de uma vez
+void fleetFlush(FleetWorker* w, MachineData* buffer, const long long* born, int len) {
+    unsigned long long alerts[FLEET_BUFFER / 64];
+    checkForFailurePatternBatch(buffer, len, w->patterns, alerts);
+    long long now = timerTicks();
+    double usPerTick = 1e6 / timerFrequency();
+    for (int i = 0; i < len; i++) {
+        bool alert = (alerts[i / 64] >> (i % 64)) & 1;
+        countDetection(&w->hits, alert, buffer[i].MachineFailure);
+        if (!alert) continue;
+        if (w->latencyCount == w->latencyCap) {
+            w->latencyCap = w->latencyCap ? w->latencyCap * 2 : 1024;
+            w->latency = (float*)realloc(w->latency, sizeof(float) * w->latencyCap);
+            if (w->latency == NULL) {
+                perror("Erro ao alocar memória para as latências da frota");
+                exit(EXIT_FAILURE);
+            }
+        }
+        w->latency[w->latencyCount++] = (float)((double)(now - born[i]) * usPerTick);
+    }
+    w->samples += len;
+
+    FleetStore* shared = w->shared;
+    fleetLockEnter(&shared->lock);
+    HighPrecisionTimer t;
+    start_timer(&t);
+    for (int i = 0; i < len; i++) {
+        buffer[i].UDI = shared->nextUDI++;
+        workloadInsert(shared->store, &buffer[i]);
+    }
+    shared->mergeMs += stop_timer(&t);
+    fleetLockLeave(&shared->lock);
+}
+
+#ifdef _WIN32
+DWORD WINAPI fleetWorker(LPVOID arg) {
+#else
+void* fleetWorker(void* arg) {
+#endif
+    FleetWorker* w = (FleetWorker*)arg;
+    MachineData buffer[FLEET_BUFFER];
+    long long born[FLEET_BUFFER];
+    int len = 0;
+    for (int s = 0; s < w->steps; s++) {
+        for (int m = w->begin; m < w->end; m++) {
+            fleetStep(&w->machines[m], &buffer[len]);
+            born[len] = timerTicks();
+            if (++len == FLEET_BUFFER) {
+                fleetFlush(w, buffer, born, len);
+                len = 0;
+            }
+        }
+    }
+    if (len > 0) fleetFlush(w, buffer, born, len);
+    return 0;
+}
+
+// Roda 'machines' máquinas por 'steps' ciclos em 'threads' threads, mesclando as amostras em store
+void runFleetSimulation(WorkloadBackend* store, FailurePatternList* patterns, int machines, int steps, int threads,
+                        unsigned long long seed, FleetReport* report) {
+    if (threads > STATS_MAX_THREADS) threads = STATS_MAX_THREADS;
+    if (threads > machines) threads = machines;
+    if (threads < 1) threads = 1;
+    memset(report, 0, sizeof(FleetReport));
+    report->machines = machines;
+    report->threads = threads;
+    FleetMachine* fleet = (FleetMachine*)malloc(sizeof(FleetMachine) * machines);
+    if (fleet == NULL) {
+        perror("Erro ao alocar memória para a frota");
+        return;
+    }
+    for (int m = 0; m < machines; m++) initFleetMachine(&fleet[m], m, seed);
+    ensureFailurePatternIndex(patterns); // As threads só leem o índice
+
+    FleetStore shared;
+    shared.store = store;
+    shared.nextUDI = nextSimulatedUDI(store);
+    shared.mergeMs = 0.0;
+    fleetLockInit(&shared.lock);
+    FleetWorker workers[STATS_MAX_THREADS];
+    bool started[STATS_MAX_THREADS] = {false};
+#ifdef _WIN32
+    HANDLE handles[STATS_MAX_THREADS];
+#else
+    pthread_t handles[STATS_MAX_THREADS];
+#endif
+    for (int t = 0; t < threads; t++) {
+        memset(&workers[t], 0, sizeof(FleetWorker));
+        workers[t].machines = fleet;
+        workers[t].begin = (int)((long long)machines * t / threads);
+        workers[t].end = (int)((long long)machines * (t + 1) / threads);
+        workers[t].steps = steps;
+        workers[t].patterns = patterns;
+        workers[t].shared = &shared;
+    }
+
+    HighPrecisionTimer timer;
+    start_timer(&timer);
+    for (int t = 1; t < threads; t++) {
+#ifdef _WIN32
+        handles[t] = CreateThread(NULL, 0, fleetWorker, &workers[t], 0, NULL);
+        started[t] = handles[t] != NULL;
+#else
+        started[t] = pthread_create(&handles[t], NULL, fleetWorker, &workers[t]) == 0;
+#endif
+        if (!started[t]) fleetWorker(&workers[t]);
+    }
+    fleetWorker(&workers[0]);
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) {
+#ifdef _WIN32
+            WaitForSingleObject(handles[t], INFINITE);
+            CloseHandle(handles[t]);
+#else
+            pthread_join(handles[t], NULL);
+#endif
+        }
+    }
+    report->ms = stop_timer(&timer);
+    report->mergeMs = shared.mergeMs;
+    fleetLockDestroy(&shared.lock);
+
+    // Soma os contadores e tira os percentis das latências de todas as threads
+    int latencyCount = 0;
+    for (int t = 0; t < threads; t++) latencyCount += workers[t].latencyCount;
+    float* latency = (float*)malloc(sizeof(float) * (latencyCount + 1));
+    if (latency == NULL) {
+        perror("Erro ao alocar memória para as latências da frota");
+        exit(EXIT_FAILURE);
+    }
+    int filled = 0;
+    for (int t = 0; t < threads; t++) {
+        FleetWorker* w = &workers[t];
+        report->samples += w->samples;
+        report->hits.tp += w->hits.tp;
+        report->hits.fp += w->hits.fp;
+        report->hits.fn += w->hits.fn;
+        report->hits.tn += w->hits.tn;
+        if (w->latencyCount) memcpy(latency + filled, w->latency, sizeof(float) * w->latencyCount);
+        filled += w->latencyCount;
+        free(w->latency);
+    }
+    if (latencyCount > 0) {
+        qsort(latency, latencyCount, sizeof(float), kllCompareFloats);
+        report->latencyP50 = latency[(latencyCount - 1) / 2];
+        report->latencyP99 = latency[(int)((latencyCount - 1) * 0.99)];
+        report->latencyMax = latency[latencyCount - 1];
+    }
+    free(latency);
+    free(fleet);
+}
+
+void displayFleetReport(const FleetReport* r) {
+    printf("Frota: %d máquinas, %d thread(s), %lld amostras em %.2f ms (%.2f M amostras/s, mescla %.2f ms)\n",
+           r->machines, r->threads, r->samples, r->ms, r->ms > 0 ? r->samples / (r->ms * 1e3) : 0.0, r->mergeMs);
+    printf("Alertas: %d | falhas: %d | precisão %.1f%% | recall %.1f%%\n", r->hits.tp + r->hits.fp,
+           r->hits.tp + r->hits.fn, detectionPrecision(&r->hits), detectionRecall(&r->hits));
+    printf("Latência dos alertas (geração -> pontuação): p50 %.1f us | p99 %.1f us | máx %.1f us\n", r->latencyP50,
+           r->latencyP99, r->latencyMax);
+}
+
+// Modo batch: "--fleet [máquinas] [ciclos por máquina] [threads]" aprende os padrões e roda a frota
+int batchFleetSimulation(WorkloadBackend* store, int argc, char* argv[]) {
+    int machines = argc > 2 && atoi(argv[2]) > 0 ? atoi(argv[2]) : 64;
+    int steps = argc > 3 && atoi(argv[3]) > 0 ? atoi(argv[3]) : 1000;
+    int threads = argc > 4 && atoi(argv[4]) > 0 ? atoi(argv[4]) : availableCores();
+    if (machines > FLEET_MAX_MACHINES) machines = FLEET_MAX_MACHINES;
+    FailurePatternList patterns;
+    initFailurePatternList(&patterns);
+    learnFailurePatterns(store, &patterns);
+    memcpy(patterns.tolerance, patternSuggestedTolerance, sizeof(patterns.tolerance));
+    if (patterns.count == 0) {
+        printf("Nenhum padrão de falha aprendido; a frota não será simulada.\n");
+        freeFailurePatternList(&patterns);
+        return 1;
+    }
+    FleetReport report;
+    runFleetSimulation(store, &patterns, machines, steps, threads, (unsigned long long)time(NULL), &report);
+    displayFleetReport(&report);
+    freeFailurePatternList(&patterns);
+    return 0;
+}
+
+// --- GRAVAÇÃO E REPRODUÇÃO DO FLUXO DA SIMULAÇÃO ---
+// Com a mesma semente o simulador gera o mesmo fluxo, mas só na mesma biblioteca C (rand() muda
+// entre MSVCRT e glibc) e com os mesmos padrões aprendidos. O fluxo gravado fixa tudo: um
+// cabeçalho de STREAM_HEADER_SIZE bytes (assinatura, versão, semente, número e hash dos padrões,
+// tolerância e total de amostras) e um registro de STREAM_RECORD_SIZE bytes por amostra, com os
+// campos de MachineData (sem o preenchimento do struct) e o índice do padrão injetado (-1 =
+// operação normal). Os campos são gravados um a um em little-endian, e o arquivo vale entre
+// compiladores. A reprodução carrega o fluxo na memória e o entrega à estrutura na velocidade
+// máxima ou a uma taxa fixa (amostras/s). Cada amostra tem um horário de chegada; a detecção
+// (checkForFailurePattern) e a inserção correm em seguida, e a latência vai da chegada à decisão.
+// Se a estrutura não acompanha a taxa, as amostras seguintes chegam vencidas e o atraso acumulado
+// aparece na latência.
+#define STREAM_MAGIC 0x53445345u          // "ESDS"
+#define STREAM_VERSION 1
+#define STREAM_HEADER_SIZE 48
+#define STREAM_RECORD_SIZE 34
+#define STREAM_CHUNK 4096                 // Registros por fwrite/fread
+#define STREAM_MAX_PATTERNS 32767         // O índice do padrão é gravado em 16 bits
+#define STREAM_DEFAULT_FILE "MachineFailure.stream"
+#define STREAM_DEFAULT_SAMPLES 100000
+#define STREAM_DEFAULT_SEED 1u
+
+typedef struct {
+    unsigned int seed;
+    int patternCount;
+    unsigned int patternHash;
+    float tolerance[PATTERN_DIMS];
+    int count;
+    MachineData* samples;
+    short* injected;                      // Padrão injetado em cada amostra (-1 = normal)
+} SimulationStream;
+
+typedef struct {
+    int samples;
+    double rate;                          // Amostras/s pedidas (0 = velocidade máxima)
+    double ms;
+    DetectionCounts hits;
+    int late;                             // Amostras tratadas mais de um período depois da chegada
+    float latencyP50, latencyP99, latencyMax; // us
+} ReplayReport;
+
+void streamPut16(unsigned char* p, unsigned int v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+void streamPut32(unsigned char* p, unsigned int v) {
+    streamPut16(p, v & 0xFFFFu);
+    streamPut16(p + 2, v >> 16);
+}
+
+void streamPutFloat(unsigned char* p, float f) {
+    unsigned int v;
+    memcpy(&v, &f, sizeof(v));
+    streamPut32(p, v);
+}
+
+unsigned int streamGet16(const unsigned char* p) {
+    return p[0] | (unsigned int)p[1] << 8;
+}
+
+unsigned int streamGet32(const unsigned char* p) {
+    return streamGet16(p) | streamGet16(p + 2) << 16;
+}
+
+float streamGetFloat(const unsigned char* p) {
+    unsigned int v = streamGet32(p);
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+// FNV-1a sobre as caixas e os modos dos padrões: a reprodução confere que aprendeu os mesmos
+unsigned int patternListHash(const FailurePatternList* patterns) {
+    unsigned int h = 2166136261u;
+    for (int i = 0; i < patterns->count; i++) {
+        const FailurePattern* p = &patterns->patterns[i];
+        unsigned char b[41];
+        streamPutFloat(b, p->minAirTemp);
+        streamPutFloat(b + 4, p->maxAirTemp);
+        streamPutFloat(b + 8, p->minProcessTemp);
+        streamPutFloat(b + 12, p->maxProcessTemp);
+        streamPut32(b + 16, (unsigned int)p->minRotationalSpeed);
+        streamPut32(b + 20, (unsigned int)p->maxRotationalSpeed);
+        streamPutFloat(b + 24, p->minTorque);
+        streamPutFloat(b + 28, p->maxTorque);
+        streamPut32(b + 32, (unsigned int)p->minToolWear);
+        streamPut32(b + 36, (unsigned int)p->maxToolWear);
+        b[40] = (unsigned char)((p->hadTWF ? 1 : 0) | (p->hadHDF ? 2 : 0) | (p->hadPWF ? 4 : 0) |
+                                (p->hadOSF ? 8 : 0) | (p->hadRNF ? 16 : 0));
+        for (int k = 0; k < 41; k++) h = (h ^ b[k]) * 16777619u;
+    }
+    return h;
+}
+
+// Registro: UDI(4) ProductID(10) Type(1) flags(1) AirTemp(4) ProcessTemp(4) Torque(4) RPM(2) ToolWear(2) padrão(2)
+void encodeStreamRecord(unsigned char* r, const MachineData* d, int pattern) {
+    streamPut32(r, (unsigned int)d->UDI);
+    memset(r + 4, 0, 10);
+    for (int k = 0; k < 10 && d->ProductID[k]; k++) r[4 + k] = (unsigned char)d->ProductID[k];
+    r[14] = (unsigned char)d->Type;
+    r[15] = (unsigned char)((d->MachineFailure ? 1 : 0) | (d->TWF ? 2 : 0) | (d->HDF ? 4 : 0) |
+                            (d->PWF ? 8 : 0) | (d->OSF ? 16 : 0) | (d->RNF ? 32 : 0));
+    streamPutFloat(r + 16, d->AirTemp);
+    streamPutFloat(r + 20, d->ProcessTemp);
+    streamPutFloat(r + 24, d->Torque);
+    streamPut16(r + 28, (unsigned int)d->RotationalSpeed);
+    streamPut16(r + 30, (unsigned int)d->ToolWear);
+    streamPut16(r + 32, (unsigned int)pattern & 0xFFFFu);
+}
+
+void decodeStreamRecord(const unsigned char* r, MachineData* d, short* pattern) {
+    memset(d, 0, sizeof(MachineData));
+    d->UDI = (int)streamGet32(r);
+    memcpy(d->ProductID, r + 4, 10);
+    d->ProductID[sizeof(d->ProductID) - 1] = '\0';
+    d->Type = (char)r[14];
+    d->MachineFailure = r[15] & 1;
+    d->TWF = (r[15] >> 1) & 1;
+    d->HDF = (r[15] >> 2) & 1;
+    d->PWF = (r[15] >> 3) & 1;
+    d->OSF = (r[15] >> 4) & 1;
+    d->RNF = (r[15] >> 5) & 1;
+    d->AirTemp = streamGetFloat(r + 16);
+    d->ProcessTemp = streamGetFloat(r + 20);
+    d->Torque = streamGetFloat(r + 24);
+    d->RotationalSpeed = (int)streamGet16(r + 28);
+    d->ToolWear = (int)streamGet16(r + 30);
+    *pattern = (short)streamGet16(r + 32);
+}
+
+// Gera n amostras com a semente, pelo mesmo caminho de simulateMillingMachine, e grava o fluxo.
+// Retorna 0, ou -1 em caso de erro.
+int recordSimulationStream(const char* path, FailurePatternList* patterns, int n, unsigned int seed, int firstUDI) {
+    if (patterns->count > STREAM_MAX_PATTERNS) {
+        printf("Padrões demais para o formato do fluxo (%d, máximo %d).\n", patterns->count, STREAM_MAX_PATTERNS);
+        return -1;
+    }
+    unsigned char* chunk = (unsigned char*)malloc((size_t)STREAM_RECORD_SIZE * STREAM_CHUNK);
+    if (chunk == NULL) {
+        perror("Erro ao alocar memória para a gravação do fluxo");
+        exit(EXIT_FAILURE);
+    }
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        perror("Erro ao criar o arquivo do fluxo");
+        free(chunk);
+        return -1;
+    }
+
+    unsigned char header[STREAM_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    streamPut32(header, STREAM_MAGIC);
+    streamPut16(header + 4, STREAM_VERSION);
+    streamPut16(header + 6, STREAM_RECORD_SIZE);
+    streamPut32(header + 8, seed);
+    streamPut32(header + 12, (unsigned int)patterns->count);
+    streamPut32(header + 16, patternListHash(patterns));
+    for (int k = 0; k < PATTERN_DIMS; k++) streamPutFloat(header + 20 + 4 * k, patterns->tolerance[k]);
+    streamPut32(header + 40, (unsigned int)n);
+    bool ok = fwrite(header, sizeof(header), 1, file) == 1;
+
+    srand(seed);
+    int injected = 0;
+    for (int i = 0; i < n && ok; i += STREAM_CHUNK) {
+        int len = n - i < STREAM_CHUNK ? n - i : STREAM_CHUNK;
+        for (int j = 0; j < len; j++) {
+            MachineData d;
+            int pattern = generateSimulatedSample(&d, patterns, firstUDI + i + j);
+            if (pattern >= 0) injected++;
+            encodeStreamRecord(chunk + (size_t)j * STREAM_RECORD_SIZE, &d, pattern);
+        }
+        ok = fwrite(chunk, STREAM_RECORD_SIZE, len, file) == (size_t)len;
+    }
+    if (fclose(file) != 0) ok = false;
+    free(chunk);
+    if (!ok) {
+        perror("Erro ao gravar o fluxo");
+        return -1;
+    }
+    printf("Fluxo gravado em %s: %d amostras (%d falhas injetadas), semente %u, %.1f KB\n", path, n, injected, seed,
+           (STREAM_HEADER_SIZE + (double)STREAM_RECORD_SIZE * n) / 1024.0);
+    return 0;
+}
+
+void freeSimulationStream(SimulationStream* s) {
+    free(s->samples);
+    free(s->injected);
+    s->samples = NULL;
+    s->injected = NULL;
+    s->count = 0;
+}
+
+// Carrega o fluxo inteiro na memória (a leitura do disco fica fora da medição).
+// Retorna 0, ou -1 se o arquivo não abre, não é um fluxo desta versão ou está truncado.
+int loadSimulationStream(const char* path, SimulationStream* s) {
+    memset(s, 0, sizeof(SimulationStream));
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        perror("Erro ao abrir o arquivo do fluxo");
+        return -1;
+    }
+    unsigned char header[STREAM_HEADER_SIZE];
+    if (fread(header, sizeof(header), 1, file) != 1 || streamGet32(header) != STREAM_MAGIC ||
+        streamGet16(header + 4) != STREAM_VERSION || streamGet16(header + 6) != STREAM_RECORD_SIZE ||
+        (int)streamGet32(header + 40) < 0) {
+        printf("%s não é um fluxo de simulação válido (versão %d).\n", path, STREAM_VERSION);
+        fclose(file);
+        return -1;
+    }
+    s->seed = streamGet32(header + 8);
+    s->patternCount = (int)streamGet32(header + 12);
+    s->patternHash = streamGet32(header + 16);
+    for (int k = 0; k < PATTERN_DIMS; k++) s->tolerance[k] = streamGetFloat(header + 20 + 4 * k);
+    s->count = (int)streamGet32(header + 40);
+
+    s->samples = (MachineData*)malloc(sizeof(MachineData) * ((size_t)s->count + 1));
+    s->injected = (short*)malloc(sizeof(short) * ((size_t)s->count + 1));
+    unsigned char* chunk = (unsigned char*)malloc((size_t)STREAM_RECORD_SIZE * STREAM_CHUNK);
+    if (s->samples == NULL || s->injected == NULL || chunk == NULL) {
+        perror("Erro ao alocar memória para o fluxo");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < s->count; i += STREAM_CHUNK) {
+        int len = s->count - i < STREAM_CHUNK ? s->count - i : STREAM_CHUNK;
+        if (fread(chunk, STREAM_RECORD_SIZE, len, file) != (size_t)len) {
+            printf("Fluxo %s truncado: %d de %d amostras.\n", path, i, s->count);
+            free(chunk);
+            fclose(file);
+            freeSimulationStream(s);
+            return -1;
+        }
+        for (int j = 0; j < len; j++)
+            decodeStreamRecord(chunk + (size_t)j * STREAM_RECORD_SIZE, &s->samples[i + j], &s->injected[i + j]);
+    }
+    free(chunk);
+    fclose(file);
+    return 0;
+}
+
+// Entrega o fluxo à estrutura: rate = 0 na velocidade máxima, senão rate amostras/s
+void replaySimulationStream(WorkloadBackend* store, FailurePatternList* patterns, const SimulationStream* s, double rate,
+                            ReplayReport* report) {
+    memset(report, 0, sizeof(ReplayReport));
+    report->samples = s->count;
+    report->rate = rate;
+    float* latency = (float*)malloc(sizeof(float) * ((size_t)s->count + 1));
+    if (latency == NULL) {
+        perror("Erro ao alocar memória para as latências da reprodução");
+        exit(EXIT_FAILURE);
+    }
+    ensureFailurePatternIndex(patterns); // O índice é montado fora da medição
+
+    double frequency = timerFrequency();
+    double period = rate > 0 ? frequency / rate : 0.0; // Ticks entre chegadas
+    long long start = timerTicks();
+    for (int i = 0; i < s->count; i++) {
+        long long arrival, now = timerTicks();
+        if (rate > 0) {
+            arrival = start + (long long)(period * i);
+            if (now - arrival > period) report->late++;
+            while (now < arrival) now = timerTicks(); // Espera ativa: o sono não tem resolução de us
+        } else {
+            arrival = now;
+        }
+        bool alert = checkForFailurePattern(s->samples[i], patterns);
+        now = timerTicks();
+        latency[i] = (float)((now - arrival) * 1e6 / frequency);
+        countDetection(&report->hits, alert, s->injected[i] >= 0);
+        workloadInsert(store, &s->samples[i]);
+    }
+    report->ms = (timerTicks() - start) * 1000.0 / frequency;
+
+    if (s->count > 0) {
+        qsort(latency, s->count, sizeof(float), kllCompareFloats);
+        report->latencyP50 = latency[(s->count - 1) / 2];
+        report->latencyP99 = latency[(int)((s->count - 1) * 0.99)];
+        report->latencyMax = latency[s->count - 1];
+    }
+    free(latency);
+}
+
+void displayReplayReport(const ReplayReport* r) {
+    if (r->rate > 0)
+        printf("Reprodução: %d amostras em %.2f ms (%.2f M amostras/s; taxa pedida %.0f/s, %d atrasadas)\n",
+               r->samples, r->ms, r->ms > 0 ? r->samples / (r->ms * 1e3) : 0.0, r->rate, r->late);
+    else
+        printf("Reprodução: %d amostras em %.2f ms (%.2f M amostras/s; velocidade máxima)\n", r->samples, r->ms,
+               r->ms > 0 ? r->samples / (r->ms * 1e3) : 0.0);
+    printf("Alertas: %d | falhas injetadas: %d | precisão %.1f%% | recall %.1f%%\n", r->hits.tp + r->hits.fp,
+           r->hits.tp + r->hits.fn, detectionPrecision(&r->hits), detectionRecall(&r->hits));
+    printf("Latência (chegada -> decisão): p50 %.2f us | p99 %.2f us | máx %.1f us\n", r->latencyP50, r->latencyP99,
+           r->latencyMax);
+}
+
+// Modo batch: "--record [arquivo] [amostras] [semente]" aprende os padrões e grava o fluxo
+int batchRecordStream(WorkloadBackend* store, int argc, char* argv[]) {
+    const char* path = argc > 2 ? argv[2] : STREAM_DEFAULT_FILE;
+    int n = argc > 3 && atoi(argv[3]) > 0 ? atoi(argv[3]) : STREAM_DEFAULT_SAMPLES;
+    unsigned int seed = argc > 4 ? (unsigned int)strtoul(argv[4], NULL, 10) : STREAM_DEFAULT_SEED;
+    FailurePatternList patterns;
+    initFailurePatternList(&patterns);
+    learnFailurePatterns(store, &patterns);
+    memcpy(patterns.tolerance, patternSuggestedTolerance, sizeof(patterns.tolerance));
+    if (patterns.count == 0) {
+        printf("Nenhum padrão de falha aprendido; o fluxo não será gravado.\n");
+        freeFailurePatternList(&patterns);
+        return 1;
+    }
+    int status = recordSimulationStream(path, &patterns, n, seed, nextSimulatedUDI(store)) == 0 ? 0 : 1;
+    freeFailurePatternList(&patterns);
+    return status;
+}
+
+// Modo batch: "--replay [arquivo] [amostras/s]" reproduz o fluxo nesta estrutura (0 = velocidade máxima)
+int batchReplayStream(WorkloadBackend* store, int argc, char* argv[]) {
+    const char* path = argc > 2 ? argv[2] : STREAM_DEFAULT_FILE;
+    double rate = argc > 3 && atof(argv[3]) > 0 ? atof(argv[3]) : 0.0;
+    SimulationStream stream;
+    if (loadSimulationStream(path, &stream) < 0) return 1;
+    FailurePatternList patterns;
+    initFailurePatternList(&patterns);
+    learnFailurePatterns(store, &patterns);
+    if (patterns.count != stream.patternCount || patternListHash(&patterns) != stream.patternHash) {
+        printf("Os padrões aprendidos (%d) não são os da gravação (%d); use o mesmo CSV.\n", patterns.count,
+               stream.patternCount);
+        freeFailurePatternList(&patterns);
+        freeSimulationStream(&stream);
+        return 1;
+    }
+    memcpy(patterns.tolerance, stream.tolerance, sizeof(patterns.tolerance));
+    printf("Fluxo %s: %d amostras, semente %u\n", path, stream.count, stream.seed);
+    ReplayReport report;
+    replaySimulationStream(store, &patterns, &stream, rate, &report);
+    displayReplayReport(&report);
+    freeFailurePatternList(&patterns);
+    freeSimulationStream(&stream);
+    return 0;
+}
+
+#endif // ESD_COMUM_FROTA_H
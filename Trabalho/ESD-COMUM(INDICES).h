@@ -0,0 +1,1496 @@
+// Código comum aos cinco programas (ESD-TRABALHO(*).cpp): índice hash por ProductID, bitmaps de
+// Type/falhas, cubo de agregados, motor de filtro e sketches KLL, com os benchmarks dos kernels de
+// filtro e dos sketches e a conferência dos sketches depois de remoções (--check-quantiles). Cada
+// programa o inclui uma vez, logo depois de ESD-COMUM(BENCHMARK).h; o arquivo traz definições e usa
+// os includes do programa.
+#ifndef ESD_COMUM_INDICES_H
+#define ESD_COMUM_INDICES_H
+
+// --- ÍNDICE HASH POR ProductID ---
+// Tabela de endereçamento aberto (sondagem linear) que leva um ProductID à lista de
+// referências dos registros com esse ProductID. O significado da referência depende da
+// estrutura (UDI, posição no array ou endereço do nó). Busca e remoção por ProductID
+// passam a ser O(1) em média em vez de uma varredura completa.
+#define PRODUCT_INDEX_INITIAL_CAPACITY 1024 // Potência de 2
+
+typedef struct {
+    bool occupied;   // Slot com chave (mesmo que count == 0, até o próximo rehash)
+    char key[10];    // ProductID
+    int count;       // Referências ativas
+    int capacity;
+    long long* refs;
+} ProductIndexEntry;
+
+typedef struct {
+    ProductIndexEntry* slots;
+    int capacity;    // Potência de 2
+    int used;        // Slots ocupados
+} ProductIndex;
+
+// Índice ligado nas estruturas criadas a partir daqui (desligado só para comparação nos benchmarks)
+bool useProductIndex = true;
+
+// FNV-1a
+unsigned int hashProductID(const char* pid) {
+    unsigned int h = 2166136261u;
+    for (int i = 0; i < 9 && pid[i]; i++) {
+        h ^= (unsigned char)pid[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+ProductIndex* createProductIndex(int capacity) {
+    ProductIndex* idx = (ProductIndex*)malloc(sizeof(ProductIndex));
+    int cap = PRODUCT_INDEX_INITIAL_CAPACITY;
+    while (cap < capacity) cap <<= 1;
+    if (idx) idx->slots = (ProductIndexEntry*)calloc(cap, sizeof(ProductIndexEntry));
+    if (idx == NULL || idx->slots == NULL) {
+        perror("Erro ao alocar memória para o índice de ProductID");
+        exit(EXIT_FAILURE);
+    }
+    idx->capacity = cap;
+    idx->used = 0;
+    return idx;
+}
+
+void freeProductIndex(ProductIndex* idx) {
+    if (idx == NULL) return;
+    for (int i = 0; i < idx->capacity; i++) free(idx->slots[i].refs);
+    free(idx->slots);
+    free(idx);
+}
+
+// Slot da chave pid, ou o slot livre onde ela seria inserida
+ProductIndexEntry* productIndexSlot(ProductIndex* idx, const char* pid) {
+    unsigned int mask = (unsigned int)idx->capacity - 1;
+    unsigned int i = hashProductID(pid) & mask;
+    while (idx->slots[i].occupied && strncmp(idx->slots[i].key, pid, 10) != 0) {
+        i = (i + 1) & mask;
+    }
+    return &idx->slots[i];
+}
+
+// Entrada com pelo menos uma referência, ou NULL
+ProductIndexEntry* productIndexFind(ProductIndex* idx, const char* pid) {
+    ProductIndexEntry* e = productIndexSlot(idx, pid);
+    return (e->occupied && e->count > 0) ? e : NULL;
+}
+
+// Dobra a tabela (ou só a limpa, se muitas chaves ficaram sem referências)
+void productIndexRehash(ProductIndex* idx) {
+    ProductIndexEntry* old = idx->slots;
+    int oldCapacity = idx->capacity;
+    int live = 0;
+    for (int i = 0; i < oldCapacity; i++) {
+        if (old[i].occupied && old[i].count > 0) live++;
+    }
+    int cap = oldCapacity;
+    while ((live + 1) * 10 > cap * 5) cap <<= 1; // Carga <= 50% após o rehash
+    idx->slots = (ProductIndexEntry*)calloc(cap, sizeof(ProductIndexEntry));
+    if (idx->slots == NULL) {
+        perror("Erro ao realocar o índice de ProductID");
+        exit(EXIT_FAILURE);
+    }
+    idx->capacity = cap;
+    idx->used = 0;
+    for (int i = 0; i < oldCapacity; i++) {
+        if (old[i].occupied && old[i].count > 0) {
+            *productIndexSlot(idx, old[i].key) = old[i]; // Move o array de referências
+            idx->used++;
+        } else {
+            free(old[i].refs);
+        }
+    }
+    free(old);
+}
+
+void productIndexAdd(ProductIndex* idx, const char* pid, long long ref) {
+    if ((idx->used + 1) * 10 > idx->capacity * 7) productIndexRehash(idx); // Carga máxima 70%
+    ProductIndexEntry* e = productIndexSlot(idx, pid);
+    if (!e->occupied) {
+        e->occupied = true;
+        strncpy(e->key, pid, 9);
+        e->key[9] = '\0';
+        idx->used++;
+    }
+    if (e->count == e->capacity) {
+        e->capacity = e->capacity ? e->capacity * 2 : 2;
+        e->refs = (long long*)realloc(e->refs, sizeof(long long) * e->capacity);
+        if (e->refs == NULL) {
+            perror("Erro ao alocar referências do índice de ProductID");
+            exit(EXIT_FAILURE);
+        }
+    }
+    e->refs[e->count++] = ref;
+}
+
+// Remove uma referência mantendo a ordem de inserção das demais
+bool productIndexRemove(ProductIndex* idx, const char* pid, long long ref) {
+    ProductIndexEntry* e = productIndexFind(idx, pid);
+    if (e == NULL) return false;
+    for (int i = 0; i < e->count; i++) {
+        if (e->refs[i] == ref) {
+            memmove(&e->refs[i], &e->refs[i + 1], sizeof(long long) * (e->count - i - 1));
+            e->count--;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Copia as referências de pid (a estrutura pode alterar o índice enquanto as usa)
+int productIndexCopyRefs(ProductIndex* idx, const char* pid, long long** out) {
+    ProductIndexEntry* e = productIndexFind(idx, pid);
+    *out = NULL;
+    if (e == NULL) return 0;
+    *out = (long long*)malloc(sizeof(long long) * e->count);
+    if (*out == NULL) {
+        perror("Erro de alocação de memória");
+        return 0;
+    }
+    memcpy(*out, e->refs, sizeof(long long) * e->count);
+    return e->count;
+}
+
+size_t productIndexMemory(ProductIndex* idx) {
+    if (idx == NULL) return 0;
+    size_t total = sizeof(ProductIndex) + sizeof(ProductIndexEntry) * idx->capacity;
+    for (int i = 0; i < idx->capacity; i++) total += sizeof(long long) * idx->slots[i].capacity;
+    return total;
+}
+
+// --- ÍNDICES DE BITMAP (ESTILO ROARING) ---
+// Cada bitmap guarda identificadores de linha de 32 bits divididos em contêineres pelos
+// 16 bits altos. Um contêiner com até ROARING_ARRAY_MAX valores é um array ordenado de
+// 16 bits; acima disso vira um bitmap de 65536 bits. Consultas por Type e modos de falha
+// viram AND/OR/ANDNOT entre bitmaps e contagens viram popcount.
+#define ROARING_ARRAY_MAX 4096
+#define ROARING_WORDS 1024 // 65536 bits
+
+// Bitmaps ligados nas estruturas criadas a partir daqui
+bool useBitmapIndex = true;
+
+typedef struct {
+    unsigned short key;         // 16 bits altos
+    int cardinality;
+    int capacity;               // Capacidade de values
+    unsigned short* values;     // Contêiner array (ordenado), NULL se for bitmap
+    unsigned long long* words;  // Contêiner bitmap, NULL se for array
+} RoaringContainer;
+
+typedef struct {
+    RoaringContainer* containers; // Ordenados por key
+    int count;
+    int capacity;
+} RoaringBitmap;
+
+// Um bitmap por Type, MachineFailure, modo de falha e o conjunto de todas as linhas vivas
+enum {
+    BM_TYPE_L, BM_TYPE_M, BM_TYPE_H, BM_FAILURE,
+    BM_TWF, BM_HDF, BM_PWF, BM_OSF, BM_RNF, BM_ALL, BM_COUNT
+};
+
+typedef struct {
+    RoaringBitmap bm[BM_COUNT];
+} BitmapIndex;
+
+void roaringInit(RoaringBitmap* rb) {
+    rb->containers = NULL;
+    rb->count = 0;
+    rb->capacity = 0;
+}
+
+void roaringFree(RoaringBitmap* rb) {
+    for (int i = 0; i < rb->count; i++) {
+        free(rb->containers[i].values);
+        free(rb->containers[i].words);
+    }
+    free(rb->containers);
+    roaringInit(rb);
+}
+
+void* roaringAlloc(size_t bytes) {
+    void* p = malloc(bytes);
+    if (p == NULL) {
+        perror("Erro ao alocar memória para o índice de bitmap");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// Índice do contêiner com a chave, ou -(posição de inserção + 1)
+int roaringFindContainer(const RoaringBitmap* rb, unsigned short key) {
+    int lo = 0, hi = rb->count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (rb->containers[mid].key == key) return mid;
+        if (rb->containers[mid].key < key) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -(lo + 1);
+}
+
+// Posição de v no array do contêiner, ou -(posição de inserção + 1)
+int containerArrayFind(const RoaringContainer* c, unsigned short v) {
+    int lo = 0, hi = c->cardinality - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (c->values[mid] == v) return mid;
+        if (c->values[mid] < v) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -(lo + 1);
+}
+
+// Expande o contêiner para 1024 palavras (words deve ter ROARING_WORDS posições)
+void containerToWords(const RoaringContainer* c, unsigned long long* words) {
+    if (c->words) {
+        memcpy(words, c->words, sizeof(unsigned long long) * ROARING_WORDS);
+        return;
+    }
+    memset(words, 0, sizeof(unsigned long long) * ROARING_WORDS);
+    for (int i = 0; i < c->cardinality; i++) {
+        words[c->values[i] >> 6] |= 1ULL << (c->values[i] & 63);
+    }
+}
+
+// Monta um contêiner a partir de 1024 palavras, escolhendo a representação pela cardinalidade
+void containerFromWords(RoaringContainer* c, unsigned short key, const unsigned long long* words, int cardinality) {
+    c->key = key;
+    c->cardinality = cardinality;
+    if (cardinality > ROARING_ARRAY_MAX) {
+        c->values = NULL;
+        c->capacity = 0;
+        c->words = (unsigned long long*)roaringAlloc(sizeof(unsigned long long) * ROARING_WORDS);
+        memcpy(c->words, words, sizeof(unsigned long long) * ROARING_WORDS);
+        return;
+    }
+    c->words = NULL;
+    c->capacity = cardinality > 0 ? cardinality : 1;
+    c->values = (unsigned short*)roaringAlloc(sizeof(unsigned short) * c->capacity);
+    int n = 0;
+    for (int w = 0; w < ROARING_WORDS; w++) {
+        unsigned long long bits = words[w];
+        while (bits) {
+            c->values[n++] = (unsigned short)((w << 6) + bitCountTrailingZeros64(bits));
+            bits &= bits - 1;
+        }
+    }
+}
+
+void roaringAppendContainer(RoaringBitmap* rb, RoaringContainer c) {
+    if (rb->count == rb->capacity) {
+        rb->capacity = rb->capacity ? rb->capacity * 2 : 4;
+        rb->containers = (RoaringContainer*)realloc(rb->containers, sizeof(RoaringContainer) * rb->capacity);
+        if (rb->containers == NULL) {
+            perror("Erro ao alocar memória para o índice de bitmap");
+            exit(EXIT_FAILURE);
+        }
+    }
+    rb->containers[rb->count++] = c;
+}
+
+void roaringAdd(RoaringBitmap* rb, unsigned int x) {
+    unsigned short key = (unsigned short)(x >> 16), low = (unsigned short)(x & 0xFFFF);
+    int ci = roaringFindContainer(rb, key);
+    if (ci < 0) {
+        RoaringContainer c = {key, 0, 4, (unsigned short*)roaringAlloc(sizeof(unsigned short) * 4), NULL};
+        roaringAppendContainer(rb, c); // Garante espaço; depois move para a posição certa
+        ci = -ci - 1;
+        memmove(&rb->containers[ci + 1], &rb->containers[ci], sizeof(RoaringContainer) * (rb->count - 1 - ci));
+        rb->containers[ci] = c;
+    }
+    RoaringContainer* c = &rb->containers[ci];
+    if (c->words) {
+        unsigned long long bit = 1ULL << (low & 63);
+        if (!(c->words[low >> 6] & bit)) {
+            c->words[low >> 6] |= bit;
+            c->cardinality++;
+        }
+        return;
+    }
+    int pos = containerArrayFind(c, low);
+    if (pos >= 0) return;
+    pos = -pos - 1;
+    if (c->cardinality == ROARING_ARRAY_MAX) { // Array cheio: converte para bitmap
+        unsigned long long* words = (unsigned long long*)roaringAlloc(sizeof(unsigned long long) * ROARING_WORDS);
+        containerToWords(c, words);
+        words[low >> 6] |= 1ULL << (low & 63);
+        free(c->values);
+        c->values = NULL;
+        c->capacity = 0;
+        c->words = words;
+        c->cardinality++;
+        return;
+    }
+    if (c->cardinality == c->capacity) {
+        c->capacity *= 2;
+        c->values = (unsigned short*)realloc(c->values, sizeof(unsigned short) * c->capacity);
+        if (c->values == NULL) {
+            perror("Erro ao alocar memória para o índice de bitmap");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memmove(&c->values[pos + 1], &c->values[pos], sizeof(unsigned short) * (c->cardinality - pos));
+    c->values[pos] = low;
+    c->cardinality++;
+}
+
+void roaringRemove(RoaringBitmap* rb, unsigned int x) {
+    unsigned short key = (unsigned short)(x >> 16), low = (unsigned short)(x & 0xFFFF);
+    int ci = roaringFindContainer(rb, key);
+    if (ci < 0) return;
+    RoaringContainer* c = &rb->containers[ci];
+    if (c->words) {
+        unsigned long long bit = 1ULL << (low & 63);
+        if (!(c->words[low >> 6] & bit)) return;
+        c->words[low >> 6] &= ~bit;
+        c->cardinality--;
+        if (c->cardinality == ROARING_ARRAY_MAX) { // Volta a ser array
+            RoaringContainer small;
+            containerFromWords(&small, key, c->words, c->cardinality);
+            free(c->words);
+            *c = small;
+        }
+        return;
+    }
+    int pos = containerArrayFind(c, low);
+    if (pos < 0) return;
+    memmove(&c->values[pos], &c->values[pos + 1], sizeof(unsigned short) * (c->cardinality - pos - 1));
+    c->cardinality--;
+    if (c->cardinality == 0) { // Remove o contêiner vazio
+        free(c->values);
+        memmove(&rb->containers[ci], &rb->containers[ci + 1], sizeof(RoaringContainer) * (rb->count - ci - 1));
+        rb->count--;
+    }
+}
+
+bool roaringContains(const RoaringBitmap* rb, unsigned int x) {
+    unsigned short low = (unsigned short)(x & 0xFFFF);
+    int ci = roaringFindContainer(rb, (unsigned short)(x >> 16));
+    if (ci < 0) return false;
+    const RoaringContainer* c = &rb->containers[ci];
+    if (c->words) return (c->words[low >> 6] >> (low & 63)) & 1;
+    return containerArrayFind(c, low) >= 0;
+}
+
+int roaringCardinality(const RoaringBitmap* rb) {
+    int total = 0;
+    for (int i = 0; i < rb->count; i++) total += rb->containers[i].cardinality;
+    return total;
+}
+
+// |a AND b| sem materializar o resultado
+int roaringAndCardinality(const RoaringBitmap* a, const RoaringBitmap* b) {
+    int total = 0;
+    int i = 0, j = 0;
+    while (i < a->count && j < b->count) {
+        const RoaringContainer* ca = &a->containers[i];
+        const RoaringContainer* cb = &b->containers[j];
+        if (ca->key < cb->key) { i++; continue; }
+        if (cb->key < ca->key) { j++; continue; }
+        if (ca->words && cb->words) {
+            for (int w = 0; w < ROARING_WORDS; w++) total += bitPopCount64(ca->words[w] & cb->words[w]);
+        } else if (ca->words || cb->words) {
+            const RoaringContainer* arr = ca->words ? cb : ca;
+            const RoaringContainer* bits = ca->words ? ca : cb;
+            for (int k = 0; k < arr->cardinality; k++) {
+                unsigned short v = arr->values[k];
+                total += (bits->words[v >> 6] >> (v & 63)) & 1;
+            }
+        } else {
+            const RoaringContainer* small = ca->cardinality <= cb->cardinality ? ca : cb;
+            const RoaringContainer* large = small == ca ? cb : ca;
+            if (small->cardinality * 16 < large->cardinality) { // Tamanhos desiguais: busca binária
+                for (int k = 0; k < small->cardinality; k++) {
+                    total += containerArrayFind(large, small->values[k]) >= 0;
+                }
+            } else {
+                int p = 0, q = 0;
+                while (p < ca->cardinality && q < cb->cardinality) {
+                    if (ca->values[p] < cb->values[q]) p++;
+                    else if (cb->values[q] < ca->values[p]) q++;
+                    else { total++; p++; q++; }
+                }
+            }
+        }
+        i++;
+        j++;
+    }
+    return total;
+}
+
+enum { ROARING_AND, ROARING_OR, ROARING_ANDNOT };
+
+// out = a op b (out é reinicializado; não pode ser a nem b)
+void roaringCombine(const RoaringBitmap* a, const RoaringBitmap* b, RoaringBitmap* out, int op) {
+    unsigned long long wa[ROARING_WORDS], wb[ROARING_WORDS];
+    roaringFree(out);
+    int i = 0, j = 0;
+    while (i < a->count || j < b->count) {
+        const RoaringContainer* ca = i < a->count ? &a->containers[i] : NULL;
+        const RoaringContainer* cb = j < b->count ? &b->containers[j] : NULL;
+        unsigned short key;
+        if (cb == NULL || (ca != NULL && ca->key < cb->key)) { // Só em a
+            key = ca->key;
+            i++;
+            if (op == ROARING_AND) continue;
+            containerToWords(ca, wa);
+            memset(wb, 0, sizeof(wb));
+        } else if (ca == NULL || cb->key < ca->key) { // Só em b
+            key = cb->key;
+            j++;
+            if (op != ROARING_OR) continue;
+            memset(wa, 0, sizeof(wa));
+            containerToWords(cb, wb);
+        } else {
+            key = ca->key;
+            i++;
+            j++;
+            containerToWords(ca, wa);
+            containerToWords(cb, wb);
+        }
+        int cardinality = 0;
+        for (int w = 0; w < ROARING_WORDS; w++) {
+            unsigned long long r = op == ROARING_AND ? (wa[w] & wb[w]) :
+                                   op == ROARING_OR  ? (wa[w] | wb[w]) : (wa[w] & ~wb[w]);
+            wa[w] = r;
+            cardinality += bitPopCount64(r);
+        }
+        if (cardinality == 0) continue;
+        RoaringContainer c;
+        containerFromWords(&c, key, wa, cardinality);
+        roaringAppendContainer(out, c);
+    }
+}
+
+// Copia os valores em ordem crescente para out (com roaringCardinality posições)
+int roaringToArray(const RoaringBitmap* rb, unsigned int* out) {
+    int n = 0;
+    for (int i = 0; i < rb->count; i++) {
+        const RoaringContainer* c = &rb->containers[i];
+        unsigned int high = (unsigned int)c->key << 16;
+        if (c->words) {
+            for (int w = 0; w < ROARING_WORDS; w++) {
+                unsigned long long bits = c->words[w];
+                while (bits) {
+                    out[n++] = high | (unsigned int)((w << 6) + bitCountTrailingZeros64(bits));
+                    bits &= bits - 1;
+                }
+            }
+        } else {
+            for (int k = 0; k < c->cardinality; k++) out[n++] = high | c->values[k];
+        }
+    }
+    return n;
+}
+
+size_t roaringMemory(const RoaringBitmap* rb) {
+    size_t total = sizeof(RoaringBitmap) + sizeof(RoaringContainer) * rb->capacity;
+    for (int i = 0; i < rb->count; i++) {
+        const RoaringContainer* c = &rb->containers[i];
+        total += c->words ? sizeof(unsigned long long) * ROARING_WORDS : sizeof(unsigned short) * c->capacity;
+    }
+    return total;
+}
+
+BitmapIndex* createBitmapIndex() {
+    BitmapIndex* bi = (BitmapIndex*)roaringAlloc(sizeof(BitmapIndex));
+    for (int b = 0; b < BM_COUNT; b++) roaringInit(&bi->bm[b]);
+    return bi;
+}
+
+void freeBitmapIndex(BitmapIndex* bi) {
+    if (bi == NULL) return;
+    for (int b = 0; b < BM_COUNT; b++) roaringFree(&bi->bm[b]);
+    free(bi);
+}
+
+// Bitmaps em que o registro aparece
+void bitmapIndexUpdate(BitmapIndex* bi, const MachineData* d, unsigned int row, bool add) {
+    int members[BM_COUNT];
+    int n = 0;
+    switch (toupper(d->Type)) {
+        case 'L': members[n++] = BM_TYPE_L; break;
+        case 'M': members[n++] = BM_TYPE_M; break;
+        case 'H': members[n++] = BM_TYPE_H; break;
+    }
+    if (d->MachineFailure) members[n++] = BM_FAILURE;
+    if (d->TWF) members[n++] = BM_TWF;
+    if (d->HDF) members[n++] = BM_HDF;
+    if (d->PWF) members[n++] = BM_PWF;
+    if (d->OSF) members[n++] = BM_OSF;
+    if (d->RNF) members[n++] = BM_RNF;
+    members[n++] = BM_ALL;
+    for (int i = 0; i < n; i++) {
+        if (add) roaringAdd(&bi->bm[members[i]], row);
+        else roaringRemove(&bi->bm[members[i]], row);
+    }
+}
+
+void bitmapIndexAdd(BitmapIndex* bi, const MachineData* d, unsigned int row) {
+    bitmapIndexUpdate(bi, d, row, true);
+}
+
+void bitmapIndexRemove(BitmapIndex* bi, const MachineData* d, unsigned int row) {
+    bitmapIndexUpdate(bi, d, row, false);
+}
+
+size_t bitmapIndexMemory(const BitmapIndex* bi) {
+    if (bi == NULL) return 0;
+    size_t total = 0;
+    for (int b = 0; b < BM_COUNT; b++) total += roaringMemory(&bi->bm[b]);
+    return total;
+}
+
+// Contagens de classifyFailures só com popcounts: counts[tipo][0] = total do tipo,
+// counts[tipo][1..5] = TWF, HDF, PWF, OSF, RNF daquele tipo
+void bitmapClassifyCounts(const BitmapIndex* bi, int counts[3][6]) {
+    for (int t = 0; t < 3; t++) {
+        counts[t][0] = roaringCardinality(&bi->bm[BM_TYPE_L + t]);
+        for (int m = 0; m < 5; m++) {
+            counts[t][m + 1] = roaringAndCardinality(&bi->bm[BM_TYPE_L + t], &bi->bm[BM_TWF + m]);
+        }
+    }
+}
+
+// Linhas do Type (ou todas, se type == 0) com pelo menos um dos modos de falha em modeMask
+// (bit 0 = TWF ... bit 4 = RNF; 0 = sem restrição de modo)
+void bitmapTypeWithModes(const BitmapIndex* bi, char type, int modeMask, RoaringBitmap* out) {
+    RoaringBitmap modes, tmp, empty;
+    roaringInit(&modes);
+    roaringInit(&tmp);
+    roaringInit(&empty);
+    const RoaringBitmap* base = &bi->bm[BM_ALL];
+    switch (toupper(type)) {
+        case 'L': base = &bi->bm[BM_TYPE_L]; break;
+        case 'M': base = &bi->bm[BM_TYPE_M]; break;
+        case 'H': base = &bi->bm[BM_TYPE_H]; break;
+        case 0: break;
+        default: base = &empty; break; // Tipo inválido: conjunto vazio
+    }
+    if (modeMask == 0) {
+        roaringCombine(base, &empty, out, ROARING_OR); // Cópia de base
+    } else {
+        for (int m = 0; m < 5; m++) {
+            if (!(modeMask & (1 << m))) continue;
+            roaringCombine(&modes, &bi->bm[BM_TWF + m], &tmp, ROARING_OR);
+            RoaringBitmap swap = modes; modes = tmp; tmp = swap;
+        }
+        roaringCombine(base, &modes, out, ROARING_AND);
+    }
+    roaringFree(&modes);
+    roaringFree(&tmp);
+}
+
+// Lê modos de falha de um texto como "HDF,OSF" (bit 0 = TWF ... bit 4 = RNF)
+int parseFailureModes(const char* text) {
+    static const char* names[5] = {"TWF", "HDF", "PWF", "OSF", "RNF"};
+    char upper[64];
+    int n = 0;
+    for (; text[n] && n < (int)sizeof(upper) - 1; n++) upper[n] = toupper((unsigned char)text[n]);
+    upper[n] = '\0';
+    int mask = 0;
+    for (int m = 0; m < 5; m++) {
+        if (strstr(upper, names[m])) mask |= 1 << m;
+    }
+    return mask;
+}
+
+// Mesmo critério de bitmapTypeWithModes, registro a registro (varredura sem índice)
+bool recordMatchesTypeModes(const MachineData* d, char type, int modeMask) {
+    if (type && toupper(d->Type) != toupper(type)) return false;
+    if (modeMask == 0) return true;
+    bool modes[5] = {d->TWF, d->HDF, d->PWF, d->OSF, d->RNF};
+    for (int m = 0; m < 5; m++) {
+        if ((modeMask & (1 << m)) && modes[m]) return true;
+    }
+    return false;
+}
+
+// Acumula um registro nas contagens de classifyFailures (varredura sem índice)
+void classifyRecord(const MachineData* d, int counts[3][6]) {
+    int t;
+    switch (toupper(d->Type)) {
+        case 'L': t = 0; break;
+        case 'M': t = 1; break;
+        case 'H': t = 2; break;
+        default: return;
+    }
+    counts[t][0]++;
+    counts[t][1] += d->TWF;
+    counts[t][2] += d->HDF;
+    counts[t][3] += d->PWF;
+    counts[t][4] += d->OSF;
+    counts[t][5] += d->RNF;
+}
+
+// --- CUBO DE AGREGADOS TYPE x MODO DE FALHA ---
+// Contagens e somas dos sensores por Type (L/M/H) e modo de falha, mantidas a cada inserção
+// e remoção. cell[tipo][0] cobre todos os registros do tipo; cell[tipo][1..5] os que têm
+// TWF, HDF, PWF, OSF, RNF (um registro com vários modos entra em várias células).
+// Os relatórios leem o cubo em O(1), sem percorrer a estrutura.
+#define CUBE_TYPES 3
+#define CUBE_SLOTS 6
+
+typedef struct {
+    int count;
+    long long toolWear;  // Inteiros: somas exatas mesmo após remoções
+    long long rpm;
+    double torque;
+    double airTemp;
+    double processTemp;
+} CubeCell;
+
+typedef struct {
+    CubeCell cell[CUBE_TYPES][CUBE_SLOTS];
+} FailureCube;
+
+void failureCubeInit(FailureCube* cube) {
+    memset(cube, 0, sizeof(FailureCube));
+}
+
+// Índice do Type no cubo (-1 para tipos fora de L/M/H, que classifyFailures também ignora)
+int failureCubeType(char type) {
+    switch (toupper(type)) {
+        case 'L': return 0;
+        case 'M': return 1;
+        case 'H': return 2;
+        default: return -1;
+    }
+}
+
+// sign = +1 na inserção, -1 na remoção
+void failureCubeUpdate(FailureCube* cube, const MachineData* d, int sign) {
+    int t = failureCubeType(d->Type);
+    if (t < 0) return;
+    bool modes[CUBE_SLOTS] = {true, d->TWF, d->HDF, d->PWF, d->OSF, d->RNF};
+    for (int s = 0; s < CUBE_SLOTS; s++) {
+        if (!modes[s]) continue;
+        CubeCell* c = &cube->cell[t][s];
+        c->count += sign;
+        c->toolWear += sign * d->ToolWear;
+        c->rpm += sign * d->RotationalSpeed;
+        c->torque += sign * d->Torque;
+        c->airTemp += sign * d->AirTemp;
+        c->processTemp += sign * d->ProcessTemp;
+    }
+}
+
+void failureCubeAdd(FailureCube* cube, const MachineData* d) {
+    failureCubeUpdate(cube, d, 1);
+}
+
+void failureCubeRemove(FailureCube* cube, const MachineData* d) {
+    failureCubeUpdate(cube, d, -1);
+}
+
+// Mesmo formato de bitmapClassifyCounts/classifyRecord: counts[tipo][0] = total do tipo
+void failureCubeCounts(const FailureCube* cube, int counts[3][6]) {
+    for (int t = 0; t < CUBE_TYPES; t++) {
+        for (int s = 0; s < CUBE_SLOTS; s++) counts[t][s] = cube->cell[t][s].count;
+    }
+}
+
+// Médias dos sensores por modo de falha (todos os tipos somados), direto das somas do cubo
+void displayFailureCubeAverages(const FailureCube* cube) {
+    static const char* slotNames[CUBE_SLOTS] = {"Todos", "TWF", "HDF", "PWF", "OSF", "RNF"};
+    printf("\n=== MÉDIAS DOS SENSORES POR MODO DE FALHA ===\n");
+    printf("%-10s %-10s %-12s %-12s %-12s %-12s %-12s\n",
+           "Modo", "Registros", "ToolWear", "Torque", "RPM", "AirTemp", "ProcTemp");
+    for (int s = 0; s < CUBE_SLOTS; s++) {
+        CubeCell sum;
+        memset(&sum, 0, sizeof(sum));
+        for (int t = 0; t < CUBE_TYPES; t++) {
+            const CubeCell* c = &cube->cell[t][s];
+            sum.count += c->count;
+            sum.toolWear += c->toolWear;
+            sum.rpm += c->rpm;
+            sum.torque += c->torque;
+            sum.airTemp += c->airTemp;
+            sum.processTemp += c->processTemp;
+        }
+        if (sum.count == 0) {
+            printf("%-10s %-10d %-12s %-12s %-12s %-12s %-12s\n", slotNames[s], 0, "N/A", "N/A", "N/A", "N/A", "N/A");
+            continue;
+        }
+        printf("%-10s %-10d %-12.2f %-12.2f %-12.2f %-12.2f %-12.2f\n", slotNames[s], sum.count,
+               (double)sum.toolWear / sum.count, sum.torque / sum.count, (double)sum.rpm / sum.count,
+               sum.airTemp / sum.count, sum.processTemp / sum.count);
+    }
+}
+
+// Os bitmaps só cobrem L/M/H; outros tipos (ex.: 'X' dos dados anômalos) ficam com a varredura
+bool bitmapCoversType(char type) {
+    type = toupper(type);
+    return type == 0 || type == 'L' || type == 'M' || type == 'H';
+}
+
+// Candidatos do filtro avançado: type (0 = qualquer) e failure (-1 = qualquer, 0 ou 1)
+void bitmapFilterCandidates(const BitmapIndex* bi, char type, int failure, RoaringBitmap* out) {
+    RoaringBitmap typed;
+    roaringInit(&typed);
+    bitmapTypeWithModes(bi, type, 0, &typed);
+    if (failure < 0) {
+        roaringFree(out);
+        *out = typed;
+        return;
+    }
+    roaringCombine(&typed, &bi->bm[BM_FAILURE], out, failure ? ROARING_AND : ROARING_ANDNOT);
+    roaringFree(&typed);
+}
+
+// --- MOTOR DE FILTRO VETORIZADO ---
+// Os critérios do filtro avançado viram um plano: intervalos [min, max] sobre colunas
+// numéricas e igualdades sobre Type/MachineFailure. Os registros são transpostos em lotes
+// colunares de FILTER_BATCH linhas e os predicados percorrem as colunas com SSE2
+// (4 floats ou 16 bytes por instrução), 64 linhas por palavra da máscara de bits. Os bits
+// que sobram formam o vetor de seleção; a formatação vem depois, num buffer só.
+#define FILTER_BATCH 1024
+#define FILTER_WORDS (FILTER_BATCH / 64)
+#define FILTER_LINE_MAX 512 // Folga por linha formatada (a maior fica bem abaixo disso)
+
+// Colunas na mesma ordem dos critérios 1-4 do menu
+enum { FILTER_COL_TOOLWEAR, FILTER_COL_TORQUE, FILTER_COL_RPM, FILTER_COL_TEMPDIFF, FILTER_COLS };
+
+typedef struct {
+    int rangeCount;
+    int rangeCol[FILTER_COLS];
+    float rangeMin[FILTER_COLS];
+    float rangeMax[FILTER_COLS];
+    bool byType;
+    unsigned char type;     // Em maiúscula
+    bool byFailure;
+    unsigned char failure;
+} FilterPlan;
+
+typedef struct {
+    float cols[FILTER_COLS][FILTER_BATCH];
+    unsigned char type[FILTER_BATCH];
+    unsigned char failure[FILTER_BATCH];
+} FilterBatch;
+
+FilterPlan buildFilterPlan(const int criteria[6], const float minVal[4], const float maxVal[4],
+                           char typeFilter, bool failureFilter) {
+    FilterPlan plan;
+    memset(&plan, 0, sizeof(plan));
+    for (int c = 0; c < FILTER_COLS; c++) {
+        if (!criteria[c]) continue;
+        plan.rangeCol[plan.rangeCount] = c;
+        plan.rangeMin[plan.rangeCount] = minVal[c];
+        plan.rangeMax[plan.rangeCount] = maxVal[c];
+        plan.rangeCount++;
+    }
+    plan.byType = criteria[4] != 0;
+    plan.type = (unsigned char)toupper(typeFilter);
+    plan.byFailure = criteria[5] != 0;
+    plan.failure = failureFilter;
+    return plan;
+}
+
+// Transpõe só as colunas que o plano usa, numa passada pelos registros;
+// as posições até o múltiplo de 64 são zeradas
+void filterGather(const FilterPlan* plan, const MachineData* const* rows, int n, FilterBatch* b) {
+    int padded = (n + 63) & ~63;
+    bool use[FILTER_COLS] = {false, false, false, false};
+    for (int r = 0; r < plan->rangeCount; r++) use[plan->rangeCol[r]] = true;
+    for (int i = 0; i < n; i++) {
+        const MachineData* d = rows[i];
+        if (use[FILTER_COL_TOOLWEAR]) b->cols[FILTER_COL_TOOLWEAR][i] = (float)d->ToolWear;
+        if (use[FILTER_COL_TORQUE]) b->cols[FILTER_COL_TORQUE][i] = d->Torque;
+        if (use[FILTER_COL_RPM]) b->cols[FILTER_COL_RPM][i] = (float)d->RotationalSpeed;
+        if (use[FILTER_COL_TEMPDIFF]) b->cols[FILTER_COL_TEMPDIFF][i] = d->ProcessTemp - d->AirTemp;
+        if (plan->byType) b->type[i] = (unsigned char)toupper(d->Type);
+        if (plan->byFailure) b->failure[i] = d->MachineFailure;
+    }
+    for (int i = n; i < padded; i++) {
+        for (int c = 0; c < FILTER_COLS; c++) b->cols[c][i] = 0.0f;
+        b->type[i] = 0;
+        b->failure[i] = 0;
+    }
+}
+
+// Avalia o plano sobre as n linhas do lote, 64 linhas (uma palavra da máscara) por vez.
+// Mesmo critério do laço escalar: a linha sai quando x < min ou x > max (por isso NLT/NGT)
+void filterEvaluate(const FilterPlan* plan, const FilterBatch* b, int n, unsigned long long sel[FILTER_WORDS]) {
+    const unsigned char* bytes[2] = {plan->byType ? b->type : NULL, plan->byFailure ? b->failure : NULL};
+    unsigned char wanted[2] = {plan->type, plan->failure};
+    int words = (n + 63) / 64;
+
+    for (int w = 0; w < words; w++) {
+        int base = w * 64;
+        unsigned long long keep = (n - base >= 64) ? ~0ULL : (1ULL << (n - base)) - 1;
+
+        for (int r = 0; r < plan->rangeCount && keep; r++) {
+            const float* col = b->cols[plan->rangeCol[r]] + base;
+            float lo = plan->rangeMin[r], hi = plan->rangeMax[r];
+            unsigned long long bits = 0;
+#ifdef FILTER_SSE2
+            __m128 vlo = _mm_set1_ps(lo), vhi = _mm_set1_ps(hi);
+            for (int i = 0; i < 64; i += 4) {
+                __m128 v = _mm_loadu_ps(col + i);
+                __m128 in = _mm_and_ps(_mm_cmpnlt_ps(v, vlo), _mm_cmpngt_ps(v, vhi));
+                bits |= (unsigned long long)_mm_movemask_ps(in) << i;
+            }
+#else
+            for (int i = 0; i < 64; i++) bits |= (unsigned long long)(!(col[i] < lo) & !(col[i] > hi)) << i;
+#endif
+            keep &= bits;
+        }
+
+        for (int p = 0; p < 2 && keep; p++) {
+            if (bytes[p] == NULL) continue;
+            const unsigned char* col = bytes[p] + base;
+            unsigned long long bits = 0;
+#ifdef FILTER_SSE2
+            __m128i vw = _mm_set1_epi8((char)wanted[p]);
+            for (int i = 0; i < 64; i += 16) {
+                __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(col + i)), vw);
+                bits |= (unsigned long long)(unsigned int)_mm_movemask_epi8(eq) << i;
+            }
+#else
+            for (int i = 0; i < 64; i++) bits |= (unsigned long long)(col[i] == wanted[p]) << i;
+#endif
+            keep &= bits;
+        }
+        sel[w] = keep;
+    }
+}
+
+// Executa o plano sobre n registros e grava os aprovados em 'selected', na ordem de entrada.
+// 'selected' pode ser o próprio 'rows' (a escrita nunca passa à frente da leitura).
+int runFilterPlan(const FilterPlan* plan, const MachineData** rows, int n, const MachineData** selected) {
+    FilterBatch* b = (FilterBatch*)malloc(sizeof(FilterBatch));
+    if (b == NULL) {
+        perror("Erro ao alocar memória para o filtro");
+        exit(EXIT_FAILURE);
+    }
+    unsigned long long sel[FILTER_WORDS];
+    int count = 0;
+    for (int start = 0; start < n; start += FILTER_BATCH) {
+        int len = n - start < FILTER_BATCH ? n - start : FILTER_BATCH;
+        filterGather(plan, rows + start, len, b);
+        filterEvaluate(plan, b, len, sel);
+        for (int w = 0; w < (len + 63) / 64; w++) {
+            unsigned long long bits = sel[w];
+            while (bits) {
+                selected[count++] = rows[start + w * 64 + bitCountTrailingZeros64(bits)];
+                bits &= bits - 1;
+            }
+        }
+    }
+    free(b);
+    return count;
+}
+
+// Formata as linhas selecionadas num único buffer e escreve tudo com um fwrite
+void writeFilterMatches(const MachineData* const* selected, int count, const int criteria[6]) {
+    size_t capacity = (size_t)(count + 1) * 128;
+    size_t len = 0;
+    char* text = (char*)malloc(capacity);
+    if (text == NULL) {
+        perror("Erro ao alocar memória para a saída do filtro");
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        if (capacity - len < FILTER_LINE_MAX) {
+            capacity *= 2;
+            char* grown = (char*)realloc(text, capacity);
+            if (grown == NULL) {
+                perror("Erro ao alocar memória para a saída do filtro");
+                break;
+            }
+            text = grown;
+        }
+        const MachineData* d = selected[i];
+        len += snprintf(text + len, capacity - len, "UDI: %d | ProductID: %s | Type: %c | ",
+                        d->UDI, d->ProductID, d->Type);
+        if (criteria[0])
+            len += snprintf(text + len, capacity - len, "ToolWear: %d | ", d->ToolWear);
+        if (criteria[1])
+            len += snprintf(text + len, capacity - len, "Torque: %.1f | ", d->Torque);
+        if (criteria[2])
+            len += snprintf(text + len, capacity - len, "RPM: %d | ", d->RotationalSpeed);
+        if (criteria[3])
+            len += snprintf(text + len, capacity - len, "TempDiff: %.1f | ", d->ProcessTemp - d->AirTemp);
+        if (criteria[5])
+            len += snprintf(text + len, capacity - len, "Failure: %d | ", d->MachineFailure);
+        text[len++] = '\n';
+    }
+    fwrite(text, 1, len, stdout);
+    free(text);
+}
+
+// Critérios do filtro avançado aplicados a um registro (referência escalar do motor vetorizado)
+bool filterMatchesRecord(const MachineData* d, const int criteria[6], const float minVal[4], const float maxVal[4],
+                         char typeFilter, bool failureFilter) {
+    if (criteria[0] && (d->ToolWear < minVal[0] || d->ToolWear > maxVal[0])) return false;
+    if (criteria[1] && (d->Torque < minVal[1] || d->Torque > maxVal[1])) return false;
+    if (criteria[2] && (d->RotationalSpeed < minVal[2] || d->RotationalSpeed > maxVal[2])) return false;
+    if (criteria[3]) {
+        float tempDiff = d->ProcessTemp - d->AirTemp;
+        if (tempDiff < minVal[3] || tempDiff > maxVal[3]) return false;
+    }
+    if (criteria[4] && toupper(d->Type) != typeFilter) return false;
+    if (criteria[5] && d->MachineFailure != failureFilter) return false;
+    return true;
+}
+
+// --- KERNELS DE FILTRO ESPECIALIZADOS ---
+// Cada combinação dos 6 critérios (bit c = criteria[c]) vira uma instância de filterKernel<MASK>:
+// os testes dos critérios desligados somem na compilação e o laço não consulta criteria[]
+// por registro. O kernel é escolhido uma vez por consulta, pela tabela filterKernels.
+#define FILTER_PLAN_MIN_PREDICATES 4 // Daqui para cima o plano em colunas empata ou vence os kernels
+
+#if __cplusplus >= 201703L
+#define FILTER_IF_CONSTEXPR if constexpr
+#else
+#define FILTER_IF_CONSTEXPR if // C++14 (padrão do TDM-GCC 9.2): MASK é constante, o ramo morto sai igual
+#endif
+
+typedef int (*FilterKernel)(const MachineData* const* rows, int n, const float minVal[4], const float maxVal[4],
+                            char typeFilter, bool failureFilter, const MachineData** selected);
+
+// Sem desvio por registro: a linha é sempre escrita e o contador só anda se passou.
+// 'selected' pode ser o próprio 'rows'
+template <int MASK>
+int filterKernel(const MachineData* const* rows, int n, const float minVal[4], const float maxVal[4],
+                 char typeFilter, bool failureFilter, const MachineData** selected) {
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        const MachineData* d = rows[i];
+        bool keep = true;
+        FILTER_IF_CONSTEXPR (MASK & 1) keep &= !(d->ToolWear < minVal[0]) & !(d->ToolWear > maxVal[0]);
+        FILTER_IF_CONSTEXPR (MASK & 2) keep &= !(d->Torque < minVal[1]) & !(d->Torque > maxVal[1]);
+        FILTER_IF_CONSTEXPR (MASK & 4) keep &= !(d->RotationalSpeed < minVal[2]) & !(d->RotationalSpeed > maxVal[2]);
+        FILTER_IF_CONSTEXPR (MASK & 8) {
+            float tempDiff = d->ProcessTemp - d->AirTemp;
+            keep &= !(tempDiff < minVal[3]) & !(tempDiff > maxVal[3]);
+        }
+        FILTER_IF_CONSTEXPR (MASK & 16) keep &= toupper(d->Type) == typeFilter;
+        FILTER_IF_CONSTEXPR (MASK & 32) keep &= d->MachineFailure == failureFilter;
+        selected[count] = d;
+        count += keep;
+    }
+    return count;
+}
+
+#define FILTER_K4(m) filterKernel<(m)>, filterKernel<(m) + 1>, filterKernel<(m) + 2>, filterKernel<(m) + 3>
+#define FILTER_K16(m) FILTER_K4(m), FILTER_K4((m) + 4), FILTER_K4((m) + 8), FILTER_K4((m) + 12)
+static const FilterKernel filterKernels[64] = {FILTER_K16(0), FILTER_K16(16), FILTER_K16(32), FILTER_K16(48)};
+
+int filterCriteriaMask(const int criteria[6]) {
+    int mask = 0;
+    for (int c = 0; c < 6; c++)
+        if (criteria[c]) mask |= 1 << c;
+    return mask;
+}
+
+FilterKernel selectFilterKernel(const int criteria[6]) {
+    return filterKernels[filterCriteriaMask(criteria)];
+}
+
+#define SYNTH_ROWS 1000000        // Registros sintéticos em memória nos benchmarks de milhões de linhas
+#define SYNTH_FILTER_PASSES 10    // Passadas por consulta: 10M linhas avaliadas
+
+// Registros com as mesmas distribuições de generateRandomData, fora de qualquer estrutura
+void fillSyntheticRecords(MachineData* recs, int n, unsigned int seed) {
+    srand(seed);
+    for (int i = 0; i < n; i++) {
+        MachineData d = {0};
+        d.UDI = i + 1;
+        snprintf(d.ProductID, sizeof(d.ProductID), "M%07d", rand() % 1000000);
+        d.Type = "LMH"[rand() % 3];
+        d.AirTemp = 20.0f + (rand() % 150) / 10.0f;
+        d.ProcessTemp = d.AirTemp + (rand() % 100) / 10.0f;
+        d.RotationalSpeed = 1200 + rand() % 2000;
+        d.Torque = 30.0f + (rand() % 200) / 10.0f;
+        d.ToolWear = rand() % 250;
+        d.MachineFailure = rand() % 2;
+        recs[i] = d;
+    }
+}
+
+// Kernels especializados x laço genérico (criteria[] testado em cada registro) x plano vetorizado
+void benchmark_filter_kernels() {
+    MachineData* recs = (MachineData*)malloc(sizeof(MachineData) * SYNTH_ROWS);
+    const MachineData** rows = (const MachineData**)malloc(sizeof(MachineData*) * SYNTH_ROWS);
+    const MachineData** selected = (const MachineData**)malloc(sizeof(MachineData*) * SYNTH_ROWS);
+    if (recs == NULL || rows == NULL || selected == NULL) {
+        perror("Erro ao alocar memória para o benchmark dos kernels");
+        free(recs);
+        free(rows);
+        free(selected);
+        return;
+    }
+    fillSyntheticRecords(recs, SYNTH_ROWS, 34);
+    for (int i = 0; i < SYNTH_ROWS; i++) rows[i] = &recs[i];
+
+    struct {
+        const char* name;
+        int criteria[6];
+    } queries[] = {
+        {"ToolWear", {1, 0, 0, 0, 0, 0}},
+        {"Torque + RPM", {0, 1, 1, 0, 0, 0}},
+        {"Type + Falha", {0, 0, 0, 0, 1, 1}},
+        {"4 intervalos + Falha", {1, 1, 1, 1, 0, 1}},
+        {"Todos os 6", {1, 1, 1, 1, 1, 1}},
+    };
+    const float minVal[4] = {0, 30, 1200, 0};
+    const float maxVal[4] = {125, 40, 2200, 5};
+    const char typeFilter = 'M';
+    const bool failureFilter = true;
+    HighPrecisionTimer t;
+
+    printf("%d linhas por consulta (%d x %d registros)\n", SYNTH_ROWS * SYNTH_FILTER_PASSES,
+           SYNTH_FILTER_PASSES, SYNTH_ROWS);
+    printf("%-22s %10s %13s %11s %10s %8s\n", "Consulta", "Aprovados", "Generico(ms)", "Kernel(ms)", "Plano(ms)", "Speedup");
+    for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++) {
+        const int* criteria = queries[q].criteria;
+        int generic_matches = 0, kernel_matches = 0, plan_matches = 0;
+
+        start_timer(&t);
+        for (int pass = 0; pass < SYNTH_FILTER_PASSES; pass++) {
+            generic_matches = 0;
+            for (int i = 0; i < SYNTH_ROWS; i++) {
+                if (filterMatchesRecord(rows[i], criteria, minVal, maxVal, typeFilter, failureFilter))
+                    selected[generic_matches++] = rows[i];
+            }
+        }
+        double generic_ms = stop_timer(&t);
+
+        start_timer(&t);
+        FilterKernel kernel = selectFilterKernel(criteria);
+        for (int pass = 0; pass < SYNTH_FILTER_PASSES; pass++)
+            kernel_matches = kernel(rows, SYNTH_ROWS, minVal, maxVal, typeFilter, failureFilter, selected);
+        double kernel_ms = stop_timer(&t);
+
+        FilterPlan plan = buildFilterPlan(criteria, minVal, maxVal, typeFilter, failureFilter);
+        start_timer(&t);
+        for (int pass = 0; pass < SYNTH_FILTER_PASSES; pass++)
+            plan_matches = runFilterPlan(&plan, rows, SYNTH_ROWS, selected);
+        double plan_ms = stop_timer(&t);
+
+        printf("%-22s %10d %13.2f %11.2f %10.2f %7.1fx\n", queries[q].name, kernel_matches,
+               generic_ms, kernel_ms, plan_ms, generic_ms / kernel_ms);
+        long long rows_seen = (long long)SYNTH_ROWS * SYNTH_FILTER_PASSES;
+        benchRecord(SYNTH_ROWS, rows_seen, generic_ms, "%s: generico", queries[q].name);
+        benchRecord(SYNTH_ROWS, rows_seen, kernel_ms, "%s: kernel", queries[q].name);
+        benchRecord(SYNTH_ROWS, rows_seen, plan_ms, "%s: plano", queries[q].name);
+        if (generic_matches != kernel_matches || generic_matches != plan_matches)
+            printf("AVISO: contagens divergentes (genérico %d, kernel %d, plano %d)!\n",
+                   generic_matches, kernel_matches, plan_matches);
+    }
+    free(recs);
+    free(rows);
+    free(selected);
+}
+
+// --- SKETCHES DE QUANTIS (KLL) ---
+// Resumo de tamanho limitado de um fluxo de floats. O nível h guarda itens que valem 2^h
+// amostras; quando o total passa da capacidade, o nível mais baixo cheio é ordenado e metade
+// dos itens (os de posição par ou ímpar, por sorteio) sobe um nível com o dobro do peso.
+// O nível do topo comporta KLL_K itens e cada nível abaixo 2/3 do de cima, então o sketch
+// guarda no máximo ~3*KLL_K itens para qualquer n. Com KLL_K = 200 o erro de rank fica em
+// torno de 1,65% (99% de confiança): o p95 devolvido está entre o p93,35 e o p96,65 reais.
+// Dois sketches se fundem concatenando os níveis e compactando de novo.
+#define KLL_K 200
+#define KLL_RANK_ERROR 0.0165 // Erro de rank citado acima, usado como limite nas conferências
+#define KLL_MAX_LEVELS 48
+#define KLL_MIN_WIDTH 8 // Capacidade mínima de um nível: evita compactar a cada 2 amostras
+#define QUANTILE_METRICS 4 // ToolWear, Torque, RotationalSpeed, diferença de temperatura
+
+typedef struct {
+    float value;
+    long long rank; // Peso acumulado até este item, inclusive
+} KllItem;
+
+typedef struct {
+    float* items[KLL_MAX_LEVELS];
+    int size[KLL_MAX_LEVELS];
+    int alloc[KLL_MAX_LEVELS];
+    int levelCapacity[KLL_MAX_LEVELS];
+    int levels;
+    int capacity;    // Soma das capacidades dos níveis em uso
+    int retained;    // Itens guardados em todos os níveis
+    long long n;     // Amostras vistas
+    unsigned int rng; // Xorshift própria: não altera a sequência do rand() das simulações
+    KllItem* sorted;  // Resumo ordenado, refeito na primeira consulta depois de uma mudança
+    int sortedAlloc;
+    bool sortedValid;
+} KllSketch;
+
+void kllUpdateCapacities(KllSketch* s) {
+    double cap = KLL_K;
+    s->capacity = 0;
+    for (int h = s->levels - 1; h >= 0; h--) {
+        int c = (int)ceil(cap);
+        s->levelCapacity[h] = c < KLL_MIN_WIDTH ? KLL_MIN_WIDTH : c;
+        s->capacity += s->levelCapacity[h];
+        cap *= 2.0 / 3.0;
+    }
+}
+
+void kllInit(KllSketch* s) {
+    memset(s, 0, sizeof(KllSketch));
+    s->levels = 1;
+    s->rng = 0x9E3779B9u;
+    kllUpdateCapacities(s);
+}
+
+// Esvazia o sketch mantendo os buffers
+void kllClear(KllSketch* s) {
+    for (int h = 0; h < s->levels; h++) s->size[h] = 0;
+    s->levels = 1;
+    s->retained = 0;
+    s->n = 0;
+    s->sortedValid = false;
+    kllUpdateCapacities(s);
+}
+
+// Libera os buffers; o sketch volta a ficar vazio e utilizável
+void kllFree(KllSketch* s) {
+    for (int h = 0; h < KLL_MAX_LEVELS; h++) free(s->items[h]);
+    free(s->sorted);
+    kllInit(s);
+}
+
+void kllPush(KllSketch* s, int h, float x) {
+    if (s->size[h] == s->alloc[h]) {
+        int alloc = s->alloc[h] ? s->alloc[h] * 2 : 16;
+        float* grown = (float*)realloc(s->items[h], sizeof(float) * alloc);
+        if (grown == NULL) {
+            perror("Erro ao alocar memória para o sketch de quantis");
+            exit(EXIT_FAILURE);
+        }
+        s->items[h] = grown;
+        s->alloc[h] = alloc;
+    }
+    s->items[h][s->size[h]++] = x;
+    s->retained++;
+}
+
+int kllCompareFloats(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+// Sobe metade do nível h para h + 1. Com quantidade ímpar, o menor item fica em h
+void kllCompactLevel(KllSketch* s, int h) {
+    if (h + 1 == s->levels && s->levels < KLL_MAX_LEVELS) {
+        s->levels++;
+        kllUpdateCapacities(s);
+    }
+    float* items = s->items[h];
+    int count = s->size[h];
+    if (count <= 32) { // Níveis baixos são curtos: inserção direta evita o custo do qsort
+        for (int i = 1; i < count; i++) {
+            float x = items[i];
+            int j = i - 1;
+            while (j >= 0 && items[j] > x) {
+                items[j + 1] = items[j];
+                j--;
+            }
+            items[j + 1] = x;
+        }
+    } else {
+        qsort(items, count, sizeof(float), kllCompareFloats);
+    }
+    int keep = count & 1;
+    s->rng ^= s->rng << 13;
+    s->rng ^= s->rng >> 17;
+    s->rng ^= s->rng << 5;
+    for (int i = keep + (int)(s->rng & 1); i < count; i += 2) kllPush(s, h + 1, items[i]);
+    s->retained -= count - keep;
+    s->size[h] = keep;
+}
+
+void kllCompress(KllSketch* s) {
+    while (s->retained >= s->capacity) {
+        int h = 0;
+        while (h < s->levels - 1 && s->size[h] < s->levelCapacity[h]) h++;
+        if (h == KLL_MAX_LEVELS - 1) break; // Inalcançável na prática (n > 2^47 amostras)
+        kllCompactLevel(s, h);
+    }
+}
+
+void kllAdd(KllSketch* s, float x) {
+    kllPush(s, 0, x);
+    s->n++;
+    s->sortedValid = false;
+    if (s->retained >= s->capacity) kllCompress(s);
+}
+
+void kllMerge(KllSketch* into, const KllSketch* from) {
+    if (from->n == 0) return;
+    if (from->levels > into->levels) {
+        into->levels = from->levels;
+        kllUpdateCapacities(into);
+    }
+    for (int h = 0; h < from->levels; h++)
+        for (int i = 0; i < from->size[h]; i++) kllPush(into, h, from->items[h][i]);
+    into->n += from->n;
+    into->sortedValid = false;
+    kllCompress(into);
+}
+
+int kllCompareItems(const void* a, const void* b) {
+    return kllCompareFloats(&((const KllItem*)a)->value, &((const KllItem*)b)->value);
+}
+
+void kllBuildSorted(KllSketch* s) {
+    if (s->retained > s->sortedAlloc) {
+        KllItem* grown = (KllItem*)realloc(s->sorted, sizeof(KllItem) * s->retained);
+        if (grown == NULL) {
+            perror("Erro ao alocar memória para o sketch de quantis");
+            exit(EXIT_FAILURE);
+        }
+        s->sorted = grown;
+        s->sortedAlloc = s->retained;
+    }
+    int k = 0;
+    for (int h = 0; h < s->levels; h++)
+        for (int i = 0; i < s->size[h]; i++) {
+            s->sorted[k].value = s->items[h][i];
+            s->sorted[k++].rank = 1LL << h; // Peso por enquanto; acumulado abaixo
+        }
+    qsort(s->sorted, k, sizeof(KllItem), kllCompareItems);
+    for (int i = 1; i < k; i++) s->sorted[i].rank += s->sorted[i - 1].rank;
+    s->sortedValid = true;
+}
+
+// Quantil q (0..1). O(log KLL_K) com o resumo em cache: não depende de n
+float kllQuantile(KllSketch* s, double q) {
+    if (s->n == 0) return 0;
+    if (!s->sortedValid) kllBuildSorted(s);
+    long long target = (long long)ceil(q * s->n);
+    if (target < 1) target = 1;
+    int lo = 0, hi = s->retained - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (s->sorted[mid].rank >= target) hi = mid;
+        else lo = mid + 1;
+    }
+    return s->sorted[lo].value;
+}
+
+size_t kllMemory(const KllSketch* s) {
+    size_t bytes = sizeof(KllSketch) + sizeof(KllItem) * s->sortedAlloc;
+    for (int h = 0; h < KLL_MAX_LEVELS; h++) bytes += sizeof(float) * s->alloc[h];
+    return bytes;
+}
+
+// Um sketch por métrica, na ordem de QUANTILE_METRICS. Um KLL não desconta uma amostra já
+// inserida: a remoção só marca os sketches como desatualizados, e a próxima consulta os refaz
+// a partir dos registros vivos (uma passada O(n), paga uma vez por lote de remoções)
+typedef struct {
+    KllSketch metric[QUANTILE_METRICS];
+    bool stale; // Houve remoção desde a última reconstrução
+} QuantileSketches;
+
+const double quantileLevels[3] = {0.50, 0.95, 0.99};
+
+void initQuantileSketches(QuantileSketches* qs) {
+    for (int m = 0; m < QUANTILE_METRICS; m++) kllInit(&qs->metric[m]);
+    qs->stale = false;
+}
+
+void freeQuantileSketches(QuantileSketches* qs) {
+    for (int m = 0; m < QUANTILE_METRICS; m++) kllFree(&qs->metric[m]);
+}
+
+void clearQuantileSketches(QuantileSketches* qs) {
+    for (int m = 0; m < QUANTILE_METRICS; m++) kllClear(&qs->metric[m]);
+    qs->stale = false;
+}
+
+// Valor da métrica m de um registro, na ordem de QUANTILE_METRICS
+float quantileMetricValue(const MachineData* d, int m) {
+    switch (m) {
+        case 0: return (float)d->ToolWear;
+        case 1: return d->Torque;
+        case 2: return (float)d->RotationalSpeed;
+        default: return d->ProcessTemp - d->AirTemp;
+    }
+}
+
+void quantileSketchesAdd(QuantileSketches* qs, const MachineData* d) {
+    for (int m = 0; m < QUANTILE_METRICS; m++) kllAdd(&qs->metric[m], quantileMetricValue(d, m));
+}
+
+// Chamada a cada remoção; o custo fica para a próxima consulta
+void quantileSketchesInvalidate(QuantileSketches* qs) {
+    qs->stale = true;
+}
+
+// Refaz os sketches a partir dos registros vivos
+void rebuildQuantileSketches(QuantileSketches* qs, const MachineData* const* rows, int n) {
+    clearQuantileSketches(qs);
+    for (int i = 0; i < n; i++) quantileSketchesAdd(qs, rows[i]);
+}
+
+void mergeQuantileSketches(QuantileSketches* into, const QuantileSketches* from) {
+    for (int m = 0; m < QUANTILE_METRICS; m++) kllMerge(&into->metric[m], &from->metric[m]);
+}
+
+size_t quantileSketchesMemory(const QuantileSketches* qs) {
+    size_t bytes = 0;
+    for (int m = 0; m < QUANTILE_METRICS; m++) bytes += kllMemory(&qs->metric[m]);
+    return bytes;
+}
+
+void displayQuantiles(QuantileSketches* qs, const char* const titles[QUANTILE_METRICS]) {
+    for (int m = 0; m < QUANTILE_METRICS; m++) {
+        printf("%s: p50=%.2f | p95=%.2f | p99=%.2f\n", titles[m], kllQuantile(&qs->metric[m], quantileLevels[0]),
+               kllQuantile(&qs->metric[m], quantileLevels[1]), kllQuantile(&qs->metric[m], quantileLevels[2]));
+    }
+}
+
+// Distância entre q e o intervalo de ranks [abaixo de x, até x] nos dados ordenados, em fração de n
+double quantileRankError(const float* sorted, int n, float x, double q) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (sorted[mid] < x) lo = mid + 1;
+        else hi = mid;
+    }
+    int below = lo;
+    hi = n;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (sorted[mid] <= x) lo = mid + 1;
+        else hi = mid;
+    }
+    double target = q * n;
+    if (target < below) return (below - target) / n;
+    if (target > lo) return (target - lo) / n;
+    return 0;
+}
+
+// Percentis por ordenação (O(n log n) a cada pedido) x sketches KLL, em 1M registros sintéticos
+void benchmark_quantile_sketches() {
+    MachineData* recs = (MachineData*)malloc(sizeof(MachineData) * SYNTH_ROWS);
+    float* column = (float*)malloc(sizeof(float) * SYNTH_ROWS);
+    if (recs == NULL || column == NULL) {
+        perror("Erro ao alocar memória para o benchmark dos quantis");
+        free(recs);
+        free(column);
+        return;
+    }
+    fillSyntheticRecords(recs, SYNTH_ROWS, 36);
+    HighPrecisionTimer t;
+    QuantileSketches whole, half[2];
+    initQuantileSketches(&whole);
+    initQuantileSketches(&half[0]);
+    initQuantileSketches(&half[1]);
+
+    start_timer(&t);
+    for (int i = 0; i < SYNTH_ROWS; i++) quantileSketchesAdd(&whole, &recs[i]);
+    double insert_ms = stop_timer(&t);
+    for (int i = 0; i < SYNTH_ROWS; i++) quantileSketchesAdd(&half[i < SYNTH_ROWS / 2 ? 0 : 1], &recs[i]);
+    mergeQuantileSketches(&half[0], &half[1]);
+
+    float sketch[QUANTILE_METRICS][3], merged[QUANTILE_METRICS][3];
+    start_timer(&t);
+    for (int m = 0; m < QUANTILE_METRICS; m++)
+        for (int q = 0; q < 3; q++) sketch[m][q] = kllQuantile(&whole.metric[m], quantileLevels[q]);
+    double first_ms = stop_timer(&t);
+    start_timer(&t);
+    for (int m = 0; m < QUANTILE_METRICS; m++)
+        for (int q = 0; q < 3; q++) sketch[m][q] = kllQuantile(&whole.metric[m], quantileLevels[q]);
+    double cached_ms = stop_timer(&t);
+    for (int m = 0; m < QUANTILE_METRICS; m++)
+        for (int q = 0; q < 3; q++) merged[m][q] = kllQuantile(&half[0].metric[m], quantileLevels[q]);
+
+    // Referência exata: copia cada coluna e ordena
+    double exact_ms = 0, worst = 0, worstMerged = 0;
+    for (int m = 0; m < QUANTILE_METRICS; m++) {
+        start_timer(&t);
+        for (int i = 0; i < SYNTH_ROWS; i++) column[i] = quantileMetricValue(&recs[i], m);
+        qsort(column, SYNTH_ROWS, sizeof(float), kllCompareFloats);
+        exact_ms += stop_timer(&t);
+        for (int q = 0; q < 3; q++) {
+            double e = quantileRankError(column, SYNTH_ROWS, sketch[m][q], quantileLevels[q]);
+            if (e > worst) worst = e;
+            e = quantileRankError(column, SYNTH_ROWS, merged[m][q], quantileLevels[q]);
+            if (e > worstMerged) worstMerged = e;
+        }
+    }
+
+    printf("%d registros sintéticos, 4 métricas, p50/p95/p99\n", SYNTH_ROWS);
+    printf("Inserção nos sketches: %.1f ns/registro | Memória: %.1f KB (colunas brutas: %.1f KB)\n",
+           insert_ms * 1e6 / SYNTH_ROWS, quantileSketchesMemory(&whole) / 1024.0,
+           sizeof(float) * QUANTILE_METRICS * (double)SYNTH_ROWS / 1024.0);
+    printf("Exato (cópia + ordenação): %.2f ms | Sketch, 1a consulta: %.3f ms | Sketch, em cache: %.2f us\n",
+           exact_ms, first_ms, cached_ms * 1000.0);
+    benchRecord(SYNTH_ROWS, SYNTH_ROWS, insert_ms, "Insercao nos sketches KLL")->bytes = (long long)quantileSketchesMemory(&whole);
+    benchRecord(SYNTH_ROWS, 1, exact_ms, "Percentis exatos (copia + ordenacao)");
+    benchRecord(SYNTH_ROWS, 1, first_ms, "Percentis do sketch (1a consulta)");
+    benchRecord(SYNTH_ROWS, 1, cached_ms, "Percentis do sketch (em cache)");
+    printf("Maior erro de rank: sketch %.3f%% | duas metades fundidas %.3f%% (limite documentado ~1,65%%)\n",
+           worst * 100.0, worstMerged * 100.0);
+    freeQuantileSketches(&whole);
+    freeQuantileSketches(&half[0]);
+    freeQuantileSketches(&half[1]);
+    free(recs);
+    free(column);
+}
+
+// Escolhe os ProductIDs que "--check-quantiles" remove: o dado na linha de comando ou, sem ele,
+// os de todos os registros com ToolWear acima da mediana, o que desloca bem os percentis.
+// Devolve cópias dos registros escolhidos (os ponteiros de rows não sobrevivem às remoções).
+MachineData* selectQuantileCheckVictims(const MachineData* const* rows, int n, const char* pid, int* victims) {
+    *victims = 0;
+    MachineData* out = (MachineData*)malloc(sizeof(MachineData) * (n > 0 ? n : 1));
+    float* column = (float*)malloc(sizeof(float) * (n > 0 ? n : 1));
+    if (out == NULL || column == NULL) {
+        perror("Erro ao alocar memória para a conferência dos quantis");
+        free(out);
+        free(column);
+        return NULL;
+    }
+    for (int i = 0; i < n; i++) column[i] = quantileMetricValue(rows[i], 0);
+    qsort(column, n, sizeof(float), kllCompareFloats);
+    float median = n > 0 ? column[n / 2] : 0;
+    for (int i = 0; i < n; i++) {
+        bool chosen = pid != NULL ? strcmp(rows[i]->ProductID, pid) == 0 : quantileMetricValue(rows[i], 0) > median;
+        if (chosen) out[(*victims)++] = *rows[i];
+    }
+    free(column);
+    return out;
+}
+
+// Confere os sketches com os percentis exatos dos registros vivos: cada sketch deve ter visto
+// exatamente n amostras e o erro de rank de p50/p95/p99 ficar dentro de KLL_RANK_ERROR.
+// Devolve quantas métricas não conferem.
+int checkQuantileSketches(QuantileSketches* qs, const MachineData* const* rows, int n,
+                          const char* const titles[QUANTILE_METRICS]) {
+    if (n == 0) {
+        printf("Nenhum registro restante para conferir.\n");
+        return QUANTILE_METRICS;
+    }
+    float* column = (float*)malloc(sizeof(float) * n);
+    if (column == NULL) {
+        perror("Erro ao alocar memória para a conferência dos quantis");
+        return QUANTILE_METRICS;
+    }
+    int failures = 0;
+    for (int m = 0; m < QUANTILE_METRICS; m++) {
+        for (int i = 0; i < n; i++) column[i] = quantileMetricValue(rows[i], m);
+        qsort(column, n, sizeof(float), kllCompareFloats);
+        double worst = 0;
+        for (int q = 0; q < 3; q++) {
+            double e = quantileRankError(column, n, kllQuantile(&qs->metric[m], quantileLevels[q]), quantileLevels[q]);
+            if (e > worst) worst = e;
+        }
+        bool ok = qs->metric[m].n == n && worst <= KLL_RANK_ERROR;
+        printf("%s: %lld amostras no sketch, %d vivas | maior erro de rank %.3f%% ... %s\n", titles[m],
+               qs->metric[m].n, n, worst * 100.0, ok ? "ok" : "FALHOU");
+        if (!ok) failures++;
+    }
+    free(column);
+    return failures;
+}
+
+#endif // ESD_COMUM_INDICES_H
@@ -0,0 +1,385 @@
+// Código comum aos cinco programas (ESD-TRABALHO(*).cpp): operações de bits portáveis, relógio e
+// memória das medições e contadores de hardware (perf_event_open). Cada programa o inclui uma vez,
+// logo depois dos includes do sistema, que também escolhem os caminhos (TIMER_RDTSC,
+// MEMORY_MALLINFO2, PERF_COUNTERS); o arquivo traz definições.
+#ifndef ESD_COMUM_INSTRUMENTACAO_H
+#define ESD_COMUM_INSTRUMENTACAO_H
+
+// --- OPERAÇÕES DE BITS PORTÁVEIS ---
+// Contagem de bits e de zeros à direita/esquerda usada pelos bitmaps, pelo filtro, pelos grupos
+// de falha e pelo histograma HDR. GCC/Clang usam os builtins; o MSVC, _BitScanForward64/
+// _BitScanReverse64 (x64 e ARM64) e uma contagem SWAR no lugar de __popcnt64, que exige a
+// instrução POPCNT; outros compiladores caem nos laços. x deve ser != 0 em ctz e clz.
+int bitPopCount64(unsigned long long x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+int bitCountTrailingZeros64(unsigned long long x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (int)index;
+#else
+    int n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+int bitCountLeadingZeros64(unsigned long long x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return 63 - (int)index;
+#else
+    int n = 0;
+    while (!(x & (1ULL << 63))) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// --- INSTRUMENTAÇÃO PORTÁVEL: TEMPO E MEMÓRIA ---
+// timerTicks() é o relógio de todas as medições. Em x86 com TSC invariante (frequência constante,
+// igual em todos os núcleos) ele lê o contador de ciclos (rdtsc); fora disso usa
+// std::chrono::steady_clock. A frequência do TSC é calibrada uma vez contra o steady_clock
+// (timerInit, ~10 ms, chamada no início de main). rdtsc custa poucos ns, contra ~20 ns do
+// clock_gettime, e isso pesa nos carimbos por amostra da frota e da reprodução.
+// A memória é medida, não estimada: o residente vem de /proc/self/statm (Linux) ou do working set
+// (Windows), e o pico do processo vem de getrusage ou de PeakWorkingSetSize. Os bytes vivos no heap
+// vêm, em ordem de preferência, do alocador contador (compilar com -DMEMORY_COUNTING, que troca
+// malloc/calloc/realloc/free do arquivo e conta também o pico e as alocações) ou do mallinfo2 da
+// glibc. Sem nenhum dos dois o heap aparece como indisponível.
+int timerSource = -1;  // -1 não iniciado, 0 steady_clock, 1 TSC
+double timerHz = 1.0;  // Ticks por segundo
+
+#ifdef TIMER_RDTSC
+bool timerTscInvariant(void) {
+#ifdef _MSC_VER
+    int r[4];
+    __cpuid(r, 0x80000000);
+    if ((unsigned int)r[0] < 0x80000007u) return false;
+    __cpuid(r, 0x80000007);
+    return (r[3] >> 8) & 1;
+#else
+    unsigned int a, b, c, d;
+    if (!__get_cpuid(0x80000007, &a, &b, &c, &d)) return false;
+    return (d >> 8) & 1;
+#endif
+}
+#endif
+
+void timerInit(void) {
+    if (timerSource >= 0) return;
+    typedef std::chrono::steady_clock Clock;
+#ifdef TIMER_RDTSC
+    if (timerTscInvariant()) {
+        Clock::time_point t0 = Clock::now();
+        unsigned long long c0 = __rdtsc();
+        Clock::time_point t1 = t0;
+        while (t1 - t0 < std::chrono::milliseconds(10)) t1 = Clock::now();
+        unsigned long long c1 = __rdtsc();
+        timerHz = (double)(c1 - c0) / std::chrono::duration<double>(t1 - t0).count();
+        timerSource = 1;
+        return;
+    }
+#endif
+    timerHz = (double)Clock::period::den / Clock::period::num;
+    timerSource = 0;
+}
+
+long long timerTicks(void) {
+    if (timerSource < 0) timerInit();
+#ifdef TIMER_RDTSC
+    if (timerSource == 1) return (long long)__rdtsc();
+#endif
+    return (long long)std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+double timerFrequency(void) {
+    if (timerSource < 0) timerInit();
+    return timerHz;
+}
+
+const char* timerSourceName(void) {
+    if (timerSource < 0) timerInit();
+    return timerSource == 1 ? "rdtsc" : "steady_clock";
+}
+
+void sleepMilliseconds(int ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    struct timespec ts = {ms / 1000, (long)(ms % 1000) * 1000000L};
+    while (nanosleep(&ts, &ts) != 0) {} // Retoma se interrompido por sinal
+#endif
+}
+
+#ifdef MEMORY_COUNTING
+// Cada bloco leva 16 bytes à frente com o tamanho pedido (mantém o alinhamento do malloc)
+#define COUNTING_HEADER 16
+std::atomic<long long> countedHeapBytes(0), countedHeapPeak(0), countedAllocations(0);
+
+void countingAdd(long long delta) {
+    long long now = countedHeapBytes += delta;
+    long long peak = countedHeapPeak.load(std::memory_order_relaxed);
+    while (now > peak && !countedHeapPeak.compare_exchange_weak(peak, now)) {}
+}
+
+void* countingMalloc(size_t n) {
+    char* p = (char*)malloc(n + COUNTING_HEADER);
+    if (p == NULL) return NULL;
+    *(size_t*)p = n;
+    countingAdd((long long)n);
+    countedAllocations++;
+    return p + COUNTING_HEADER;
+}
+
+void* countingCalloc(size_t count, size_t size) {
+    if (size != 0 && count > ((size_t)-1 - COUNTING_HEADER) / size) return NULL;
+    void* p = countingMalloc(count * size);
+    if (p != NULL) memset(p, 0, count * size);
+    return p;
+}
+
+void* countingRealloc(void* p, size_t n) {
+    if (p == NULL) return countingMalloc(n);
+    char* base = (char*)p - COUNTING_HEADER;
+    size_t old = *(size_t*)base;
+    char* q = (char*)realloc(base, n + COUNTING_HEADER);
+    if (q == NULL) return NULL;
+    *(size_t*)q = n;
+    countingAdd((long long)n - (long long)old);
+    return q + COUNTING_HEADER;
+}
+
+void countingFree(void* p) {
+    if (p == NULL) return;
+    char* base = (char*)p - COUNTING_HEADER;
+    countingAdd(-(long long)*(size_t*)base);
+    free(base);
+}
+
+#define malloc(n) countingMalloc(n)
+#define calloc(c, n) countingCalloc(c, n)
+#define realloc(p, n) countingRealloc(p, n)
+#define free(p) countingFree(p)
+#endif
+
+typedef struct {
+    long long heapBytes;     // Bytes vivos no heap (-1 = indisponível)
+    long long heapPeak;      // Pico desde o último memoryResetPeak (só com o alocador contador)
+    long long allocations;   // Alocações feitas até aqui (só com o alocador contador)
+    long long rssBytes;      // Residente atual (-1 = indisponível)
+    long long peakRssBytes;  // Pico do residente desde o início do processo (-1 = indisponível)
+} MemorySnapshot;
+
+const char* memoryHeapSource(void) {
+#if defined(MEMORY_COUNTING)
+    return "alocador contador";
+#elif defined(MEMORY_MALLINFO2)
+    return "mallinfo2";
+#else
+    return "heap indisponível";
+#endif
+}
+
+// O pico do heap passa a valer a partir daqui
+void memoryResetPeak(void) {
+#ifdef MEMORY_COUNTING
+    countedHeapPeak = countedHeapBytes.load();
+#endif
+}
+
+void memorySnapshot(MemorySnapshot* m) {
+    m->heapBytes = m->heapPeak = m->allocations = -1;
+    m->rssBytes = m->peakRssBytes = -1;
+#if defined(MEMORY_COUNTING)
+    m->heapBytes = countedHeapBytes.load();
+    m->heapPeak = countedHeapPeak.load();
+    m->allocations = countedAllocations.load();
+#elif defined(MEMORY_MALLINFO2)
+    struct mallinfo2 mi = mallinfo2();
+    m->heapBytes = (long long)(mi.uordblks + mi.hblkhd); // Blocos em uso + blocos mapeados à parte
+#endif
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        m->rssBytes = (long long)pmc.WorkingSetSize;
+        m->peakRssBytes = (long long)pmc.PeakWorkingSetSize;
+    }
+#else
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm != NULL) {
+        long long size, resident;
+        if (fscanf(statm, "%lld %lld", &size, &resident) == 2) m->rssBytes = resident * sysconf(_SC_PAGESIZE);
+        fclose(statm);
+    }
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        m->peakRssBytes = (long long)usage.ru_maxrss;        // bytes no macOS
+#else
+        m->peakRssBytes = (long long)usage.ru_maxrss * 1024; // KB no Linux
+#endif
+    }
+#endif
+}
+
+// Uma linha com o que mudou desde 'before': heap, pico do heap, alocações e residente
+void printMemoryDelta(const char* label, const MemorySnapshot* before) {
+    MemorySnapshot after;
+    memorySnapshot(&after);
+    printf("%s:", label);
+    if (after.heapBytes >= 0) {
+        printf(" heap %+.1f KB", (after.heapBytes - before->heapBytes) / 1024.0);
+        if (after.heapPeak >= 0)
+            printf(" (pico +%.1f KB, %lld alocações)", (after.heapPeak - before->heapBytes) / 1024.0,
+                   after.allocations - before->allocations);
+    } else {
+        printf(" heap n/d");
+    }
+    if (after.rssBytes >= 0) printf(" | residente %+.1f KB (%.1f MB)", (after.rssBytes - before->rssBytes) / 1024.0,
+                                    after.rssBytes / 1048576.0);
+    if (after.peakRssBytes >= 0) printf(" | pico do processo %.1f MB", after.peakRssBytes / 1048576.0);
+    printf("\n");
+}
+
+// Início de uma medição: zera o pico do heap e tira a foto inicial
+void memoryProbeStart(MemorySnapshot* m) {
+    memoryResetPeak();
+    memorySnapshot(m);
+}
+
+// --- CONTADORES DE HARDWARE (perf_event_open) ---
+// Modo opcional, só no Linux: com --perf antes dos outros argumentos, benchmark_search,
+// benchmark_random_access e benchmark_insertion leem também os contadores da CPU e imprimem, abaixo
+// dos tempos, IPC e eventos por operação (ciclos, instruções, faltas na L1d, na LLC e no dTLB,
+// desvios mal previstos). Cada evento é aberto à parte, só para esta thread e só em modo usuário
+// (exclude_kernel, que funciona com perf_event_paranoid = 2). Quando há mais eventos que registradores
+// o kernel os reveza, e a contagem é escalada por tempo habilitado / tempo contando, como no perf
+// stat; essas aparecem com "*". Um evento que a CPU não tem sai como n/d. Sem o de ciclos (máquina
+// virtual sem PMU, paranoid alto) o modo não liga.
+#define HW_EVENTS 6
+
+enum { HW_CYCLES, HW_INSTRUCTIONS, HW_L1D_MISSES, HW_LLC_MISSES, HW_BRANCH_MISSES, HW_DTLB_MISSES };
+
+const char* hwEventNames[HW_EVENTS] = {"ciclos", "instr", "L1d", "LLC", "desvios", "dTLB"};
+
+typedef struct {
+    int fd[HW_EVENTS];
+    double value[HW_EVENTS]; // Contagem (escalada se o evento foi revezado); -1 = indisponível
+    bool scaled[HW_EVENTS];
+} HwCounters;
+
+bool useHardwareCounters = false;
+
+#ifdef PERF_COUNTERS
+#define HW_CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+const unsigned int hwEventTypes[HW_EVENTS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                              PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+const unsigned long long hwEventConfigs[HW_EVENTS] = {
+    PERF_COUNT_HW_CPU_CYCLES,           PERF_COUNT_HW_INSTRUCTIONS,  HW_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D),
+    PERF_COUNT_HW_CACHE_MISSES,         PERF_COUNT_HW_BRANCH_MISSES, HW_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB)};
+
+// Abre o evento desligado, para esta thread em qualquer CPU
+int hwEventOpen(int event) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = hwEventTypes[event];
+    attr.config = hwEventConfigs[event];
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+// Liga o modo --perf se o kernel abrir o contador de ciclos
+void enableHardwareCounters(void) {
+#ifdef PERF_COUNTERS
+    int fd = hwEventOpen(HW_CYCLES);
+    if (fd < 0) {
+        perror("Contadores de hardware indisponíveis (perf_event_open); --perf ignorado");
+        printf("(máquina virtual sem PMU ou /proc/sys/kernel/perf_event_paranoid acima de 2)\n");
+        return;
+    }
+    close(fd);
+    useHardwareCounters = true;
+#else
+    printf("Contadores de hardware só existem no Linux (perf_event_open); --perf ignorado\n");
+#endif
+}
+
+// Abre e zera os eventos logo antes do trecho medido (sem efeito fora do modo --perf)
+void hwCountersStart(HwCounters* c) {
+    for (int e = 0; e < HW_EVENTS; e++) {
+        c->fd[e] = -1;
+        c->value[e] = -1.0;
+        c->scaled[e] = false;
+    }
+#ifdef PERF_COUNTERS
+    if (!useHardwareCounters) return;
+    for (int e = 0; e < HW_EVENTS; e++) c->fd[e] = hwEventOpen(e);
+    for (int e = 0; e < HW_EVENTS; e++) {
+        if (c->fd[e] < 0) continue;
+        ioctl(c->fd[e], PERF_EVENT_IOC_RESET, 0);
+        ioctl(c->fd[e], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+// Para, lê e fecha os eventos; desligar todos antes de ler deixa a leitura fora das contagens
+void hwCountersStop(HwCounters* c) {
+#ifdef PERF_COUNTERS
+    for (int e = 0; e < HW_EVENTS; e++)
+        if (c->fd[e] >= 0) ioctl(c->fd[e], PERF_EVENT_IOC_DISABLE, 0);
+    for (int e = 0; e < HW_EVENTS; e++) {
+        if (c->fd[e] < 0) continue;
+        unsigned long long v[3]; // Valor, tempo habilitado, tempo contando
+        if (read(c->fd[e], v, sizeof(v)) == (ssize_t)sizeof(v) && v[2] > 0) {
+            c->value[e] = v[2] < v[1] ? (double)v[0] * v[1] / v[2] : (double)v[0];
+            c->scaled[e] = v[2] < v[1];
+        }
+        close(c->fd[e]);
+        c->fd[e] = -1;
+    }
+#endif
+}
+
+// Uma linha com o IPC e cada evento por operação, abaixo dos tempos do benchmark
+void printHwCounters(const HwCounters* c, long long ops) {
+    if (!useHardwareCounters || ops <= 0) return;
+    printf("Contadores por op:");
+    if (c->value[HW_CYCLES] > 0 && c->value[HW_INSTRUCTIONS] >= 0)
+        printf(" IPC %.2f", c->value[HW_INSTRUCTIONS] / c->value[HW_CYCLES]);
+    else
+        printf(" IPC n/d");
+    for (int e = 0; e < HW_EVENTS; e++) {
+        if (c->value[e] < 0) printf(" | %s n/d", hwEventNames[e]);
+        else printf(" | %s %.2f%s", hwEventNames[e], c->value[e] / ops, c->scaled[e] ? "*" : "");
+    }
+    printf("\n");
+}
+
+#endif // ESD_COMUM_INSTRUMENTACAO_H
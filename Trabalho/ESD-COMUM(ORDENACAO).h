@@ -0,0 +1,49 @@
+// Código comum à fila circular e à segment tree (ESD-TRABALHO(FILA CIRCULAR).cpp e
+// ESD-TRABALHO(SEGMENT TREE-MODERNA).cpp), que ordenam um array de MachineData por UDI nos
+// benchmarks com restrições. Cada um o inclui uma vez, antes da função que ordena a sua estrutura;
+// o arquivo traz definições e usa os includes do programa.
+#ifndef ESD_COMUM_ORDENACAO_H
+#define ESD_COMUM_ORDENACAO_H
+
+// --- RADIX SORT POR UDI ---
+// Radix sort LSD (4 passadas de 8 bits) pela chave UDI. Ordena pares (chave, índice)
+// de 8 bytes e move cada registro uma única vez no final. Estável, O(n).
+void radixSortByUDI(MachineData* arr, int n) {
+    if (n < 2) return;
+    unsigned int* keyBuf = (unsigned int*)malloc(sizeof(unsigned int) * n * 2);
+    int* idxBuf = (int*)malloc(sizeof(int) * n * 2);
+    MachineData* sorted = (MachineData*)malloc(sizeof(MachineData) * n);
+    if (keyBuf == NULL || idxBuf == NULL || sorted == NULL) {
+        perror("Erro ao alocar memória para ordenação");
+        free(keyBuf); free(idxBuf); free(sorted);
+        return;
+    }
+    unsigned int* keys = keyBuf;     // Alterna com keyTmp a cada passada
+    unsigned int* keyTmp = keyBuf + n;
+    int* idx = idxBuf;
+    int* idxTmp = idxBuf + n;
+    for (int i = 0; i < n; i++) {
+        keys[i] = (unsigned int)arr[i].UDI ^ 0x80000000u; // UDIs negativos (anomalias) vêm primeiro
+        idx[i] = i;
+    }
+    for (int shift = 0; shift < 32; shift += 8) {
+        int count[257] = {0};
+        for (int i = 0; i < n; i++) count[((keys[i] >> shift) & 0xFF) + 1]++;
+        if (count[((keys[0] >> shift) & 0xFF) + 1] == n) continue; // Dígito igual em todos: pula a passada
+        for (int d = 0; d < 256; d++) count[d + 1] += count[d];
+        for (int i = 0; i < n; i++) {
+            int pos = count[(keys[i] >> shift) & 0xFF]++;
+            keyTmp[pos] = keys[i];
+            idxTmp[pos] = idx[i];
+        }
+        unsigned int* k = keys; keys = keyTmp; keyTmp = k;
+        int* t = idx; idx = idxTmp; idxTmp = t;
+    }
+    for (int i = 0; i < n; i++) sorted[i] = arr[idx[i]];
+    memcpy(arr, sorted, sizeof(MachineData) * n);
+    free(keyBuf);
+    free(idxBuf);
+    free(sorted);
+}
+
+#endif // ESD_COMUM_ORDENACAO_H
@@ -0,0 +1,1173 @@
+// Código comum aos cinco programas (ESD-TRABALHO(*).cpp): tipos dos padrões de falha, funções da
+// lista dinâmica de padrões, o índice R-tree das regiões de falha, a cópia das caixas em colunas, o
+// pré-filtro de Bloom, a aprendizagem das regiões, as árvores de decisão dos modos de falha, a
+// detecção (uma amostra ou um lote) e o gerador de amostras simuladas. Cada programa o inclui uma
+// vez, antes das suas funções de aprendizagem e detecção; o arquivo traz definições e usa os
+// includes do programa.
+#ifndef ESD_COMUM_PADROES_H
+#define ESD_COMUM_PADROES_H
+
+// --- PADRÕES DE FALHA ---
+// Um padrão é uma caixa [min, max] por sensor com os flags TWF..RNF. A lista guarda, além dos
+// padrões, o índice, as colunas, o pré-filtro e o modelo construídos sobre eles.
+typedef struct {
+    float minAirTemp, maxAirTemp;
+    float minProcessTemp, maxProcessTemp;
+    int minRotationalSpeed, maxRotationalSpeed;
+    float minTorque, maxTorque;
+    int minToolWear, maxToolWear;
+    bool hadTWF, hadHDF, hadPWF, hadOSF, hadRNF;
+} FailurePattern;
+
+// Índice R-tree sobre as caixas dos padrões (ver buildFailurePatternIndex)
+#define PATTERN_DIMS 5      // AirTemp, ProcessTemp, RPM, Torque, ToolWear
+#define PATTERN_MASKS 32    // Combinações de TWF, HDF, PWF, OSF, RNF
+
+typedef struct {
+    float lo[PATTERN_DIMS], hi[PATTERN_DIMS];           // Caixa do padrão
+    float boundLo[PATTERN_DIMS], boundHi[PATTERN_DIMS]; // Caixa que envolve a subárvore
+    int pattern;            // Índice em FailurePatternList.patterns
+} PatternRTreeNode;
+
+// Pré-filtro de Bloom sobre a grade de células (ver buildPatternPrefilter)
+#define PREFILTER_CELLS 32              // Células por dimensão (engrossada até caber em PREFILTER_MAX_KEYS)
+#define PREFILTER_MAX_KEYS (1 << 16)    // Células inseridas no máximo (filtro cabe na cache)
+#define PREFILTER_FP_RATE 0.01          // Taxa de falso-positivo alvo padrão
+#define PREFILTER_MAX_HASHES 8          // Bits por chave; 6 bits do hash para cada um
+
+typedef struct {
+    unsigned long long* words;          // Uma palavra de 64 bits por bloco
+    unsigned long long wordMask;        // Palavras - 1 (potência de 2)
+    int hashes;                         // k bits ligados por chave, todos na mesma palavra
+    long long keys;                     // Células inseridas
+    int cells;                          // Células por dimensão efetivas
+    float origin[PATTERN_DIMS], invWidth[PATTERN_DIMS];
+    float tolerance[PATTERN_DIMS];      // Tolerância com que as células foram cobertas
+    double fpRate;                      // Alvo do dimensionamento
+    bool enabled;
+} PatternPrefilter;
+
+// Árvores de decisão achatadas (ver trainFailureModel)
+#define TREE_DEPTH 6
+#define TREE_INNER ((1 << TREE_DEPTH) - 1)
+#define TREE_LEAVES (1 << TREE_DEPTH)
+#define TREE_FEATURES 9     // 5 sensores, Type, TempDiff, Power, Strain
+#define TREE_TARGETS 6      // MachineFailure, TWF, HDF, PWF, OSF, RNF
+#define TREE_BINS 128       // Faixas por feature no treino
+#define TREE_MIN_LEAF 5     // Linhas mínimas de cada lado de um corte
+#define TREE_BLOCK 64       // Amostras por bloco na inferência
+
+typedef struct {
+    unsigned char feature[TREE_INNER];
+    float threshold[TREE_INNER];    // Vai à direita quando x > threshold
+    float leaf[TREE_LEAVES];        // P(alvo) em cada folha
+} FlatTree;
+
+typedef struct {
+    FlatTree trees[TREE_TARGETS];
+    bool trained;
+} FailureModel;
+
+// NOVA ESTRUTURA: Lista dinâmica para armazenar múltiplos padrões de falha
+typedef struct {
+    FailurePattern* patterns;
+    int count;
+    int capacity;
+    float tolerance[PATTERN_DIMS];      // Tolerância por dimensão, em unidades do sensor (0 = exata)
+    PatternRTreeNode* rtNodes;          // R-trees implícitas, uma por combinação de flags
+    int rtStart[PATTERN_MASKS + 1];     // Grupo m ocupa rtNodes[rtStart[m], rtStart[m + 1])
+    int rtCount;                        // Padrões cobertos pelo índice (-1 = ainda não construído)
+    float* soa;                         // Caixas em colunas para a pontuação em lote (ver buildPatternColumns)
+    int soaStart[PATTERN_MASKS + 1];    // Grupo m ocupa as posições [soaStart[m], soaStart[m + 1]) das colunas
+    int soaStride;                      // Posições por coluna (grupos completados até múltiplo de 4)
+    PatternPrefilter prefilter;         // Descarta amostras longe de todo padrão antes do casamento
+    FailureModel model;                 // Árvores de decisão treinadas junto com as regiões
+} FailurePatternList;
+
+// --- FUNÇÕES AUXILIARES PARA A LISTA DE PADRÕES DE FALHA ---
+
+// Inicializa a lista de padrões de falha
+void initFailurePatternList(FailurePatternList* list) {
+    list->patterns = NULL;
+    list->count = 0;
+    list->capacity = 0;
+    memset(list->tolerance, 0, sizeof(list->tolerance));
+    list->rtNodes = NULL;
+    memset(list->rtStart, 0, sizeof(list->rtStart));
+    list->rtCount = -1;
+    list->soa = NULL;
+    memset(list->soaStart, 0, sizeof(list->soaStart));
+    list->soaStride = 0;
+    memset(&list->prefilter, 0, sizeof(list->prefilter));
+    list->prefilter.fpRate = PREFILTER_FP_RATE;
+    list->prefilter.enabled = true;
+    list->model.trained = false;
+}
+
+// Adiciona um padrão de falha à lista dinâmica
+void addFailurePattern(FailurePatternList* list, FailurePattern pattern) {
+    if (list->count == list->capacity) {
+        list->capacity = (list->capacity == 0) ? 1 : list->capacity * 2;
+        list->patterns = (FailurePattern*)realloc(list->patterns, list->capacity * sizeof(FailurePattern));
+        if (list->patterns == NULL) {
+            perror("Falha ao realocar memória para os padrões de falha");
+            exit(EXIT_FAILURE);
+        }
+    }
+    list->patterns[list->count++] = pattern;
+}
+
+// Libera a memória alocada para a lista de padrões de falha
+void freeFailurePatternList(FailurePatternList* list) {
+    free(list->patterns);
+    free(list->rtNodes);
+    free(list->soa);
+    free(list->prefilter.words);
+    list->patterns = NULL;
+    list->rtNodes = NULL;
+    list->soa = NULL;
+    list->prefilter.words = NULL;
+    list->prefilter.keys = 0;
+    list->count = 0;
+    list->capacity = 0;
+    list->rtCount = -1;
+}
+
+// --- ÍNDICE R-TREE DAS REGIÕES DE FALHA ---
+// Cada padrão é uma caixa [min, max] no espaço 5-D dos sensores (ar, processo, rpm, torque,
+// desgaste); um padrão tirado de uma única linha é a caixa degenerada min == max. Os flags
+// TWF..RNF precisam bater exatamente, então as caixas são agrupadas pela combinação de flags e
+// cada grupo vira uma R-tree binária carregada em bloco no mesmo vetor: o nó do meio de cada
+// intervalo é a mediana dos centros na dimensão de maior espalhamento normalizado (dividido pela
+// faixa global, para que rpm não domine as temperaturas) e guarda a caixa que envolve a própria
+// subárvore. A consulta procura uma caixa que cruze [x - ε, x + ε] e descarta toda subárvore
+// cuja caixa envolvente não cruza.
+const char* patternDimNames[PATTERN_DIMS] = {"AirTemp", "ProcessTemp", "RPM", "Torque", "ToolWear"};
+const float patternSuggestedTolerance[PATTERN_DIMS] = {0.5f, 0.5f, 25.0f, 1.0f, 5.0f};
+
+void patternBox(const FailurePattern* fp, float lo[PATTERN_DIMS], float hi[PATTERN_DIMS]) {
+    lo[0] = fp->minAirTemp;
+    hi[0] = fp->maxAirTemp;
+    lo[1] = fp->minProcessTemp;
+    hi[1] = fp->maxProcessTemp;
+    lo[2] = (float)fp->minRotationalSpeed;
+    hi[2] = (float)fp->maxRotationalSpeed;
+    lo[3] = fp->minTorque;
+    hi[3] = fp->maxTorque;
+    lo[4] = (float)fp->minToolWear;
+    hi[4] = (float)fp->maxToolWear;
+}
+
+void samplePoint(const MachineData* d, float p[PATTERN_DIMS]) {
+    p[0] = d->AirTemp;
+    p[1] = d->ProcessTemp;
+    p[2] = (float)d->RotationalSpeed;
+    p[3] = d->Torque;
+    p[4] = (float)d->ToolWear;
+}
+
+// Caixa de consulta da amostra: [x - ε, x + ε]. Com ε = 0 é o próprio ponto (correspondência exata)
+void sampleQueryBox(const MachineData* d, const float eps[PATTERN_DIMS], float qlo[PATTERN_DIMS], float qhi[PATTERN_DIMS]) {
+    samplePoint(d, qlo);
+    for (int k = 0; k < PATTERN_DIMS; k++) {
+        qhi[k] = qlo[k] + eps[k];
+        qlo[k] -= eps[k];
+    }
+}
+
+int patternFlagMask(bool twf, bool hdf, bool pwf, bool osf, bool rnf) {
+    return (twf ? 1 : 0) | (hdf ? 2 : 0) | (pwf ? 4 : 0) | (osf ? 8 : 0) | (rnf ? 16 : 0);
+}
+
+bool boxOverlap(const float lo[PATTERN_DIMS], const float hi[PATTERN_DIMS], const float qlo[PATTERN_DIMS], const float qhi[PATTERN_DIMS]) {
+    for (int k = 0; k < PATTERN_DIMS; k++) {
+        if (lo[k] > qhi[k] || hi[k] < qlo[k]) return false;
+    }
+    return true;
+}
+
+// Quickselect pelo centro da caixa (lo + hi, sem dividir por 2) na dimensão dim: deixa em
+// nodes[k] o k-ésimo menor de nodes[lo, hi), menores ou iguais à esquerda e maiores ou iguais à direita
+void rtreeSelect(PatternRTreeNode* nodes, int lo, int hi, int k, int dim) {
+    hi--;
+    while (lo < hi) {
+        const PatternRTreeNode* p = &nodes[lo + (hi - lo) / 2];
+        float pivot = p->lo[dim] + p->hi[dim];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (nodes[i].lo[dim] + nodes[i].hi[dim] < pivot) i++;
+            while (nodes[j].lo[dim] + nodes[j].hi[dim] > pivot) j--;
+            if (i <= j) {
+                PatternRTreeNode tmp = nodes[i];
+                nodes[i++] = nodes[j];
+                nodes[j--] = tmp;
+            }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else break;
+    }
+}
+
+void rtreeExtend(PatternRTreeNode* n, const PatternRTreeNode* child) {
+    for (int k = 0; k < PATTERN_DIMS; k++) {
+        if (child->boundLo[k] < n->boundLo[k]) n->boundLo[k] = child->boundLo[k];
+        if (child->boundHi[k] > n->boundHi[k]) n->boundHi[k] = child->boundHi[k];
+    }
+}
+
+// Organiza nodes[lo, hi) (caixas já preenchidas) como R-tree implícita. O(n log n).
+void rtreeBuild(PatternRTreeNode* nodes, int lo, int hi, const float invRange[PATTERN_DIMS]) {
+    if (hi <= lo) return;
+    int mid = lo + (hi - lo) / 2;
+    if (hi - lo > 1) {
+        float mn[PATTERN_DIMS], mx[PATTERN_DIMS];
+        for (int k = 0; k < PATTERN_DIMS; k++) mn[k] = mx[k] = nodes[lo].lo[k] + nodes[lo].hi[k];
+        for (int i = lo + 1; i < hi; i++) {
+            for (int k = 0; k < PATTERN_DIMS; k++) {
+                float c = nodes[i].lo[k] + nodes[i].hi[k];
+                if (c < mn[k]) mn[k] = c;
+                if (c > mx[k]) mx[k] = c;
+            }
+        }
+        int dim = 0;
+        for (int k = 1; k < PATTERN_DIMS; k++) {
+            if ((mx[k] - mn[k]) * invRange[k] > (mx[dim] - mn[dim]) * invRange[dim]) dim = k;
+        }
+        rtreeSelect(nodes, lo, hi, mid, dim);
+        rtreeBuild(nodes, lo, mid, invRange);
+        rtreeBuild(nodes, mid + 1, hi, invRange);
+    }
+    PatternRTreeNode* n = &nodes[mid];
+    memcpy(n->boundLo, n->lo, sizeof(n->lo));
+    memcpy(n->boundHi, n->hi, sizeof(n->hi));
+    if (mid > lo) rtreeExtend(n, &nodes[lo + (mid - lo) / 2]);
+    if (hi > mid + 1) rtreeExtend(n, &nodes[mid + 1 + (hi - mid - 1) / 2]);
+}
+
+// Alguma caixa de nodes[lo, hi) cruza [qlo, qhi]? Para na primeira encontrada.
+bool rtreeAny(const PatternRTreeNode* nodes, int lo, int hi, const float qlo[PATTERN_DIMS], const float qhi[PATTERN_DIMS]) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        const PatternRTreeNode* n = &nodes[mid];
+        if (!boxOverlap(n->boundLo, n->boundHi, qlo, qhi)) return false;
+        if (boxOverlap(n->lo, n->hi, qlo, qhi)) return true;
+        if (rtreeAny(nodes, lo, mid, qlo, qhi)) return true;
+        lo = mid + 1;
+    }
+    return false;
+}
+
+// 1 / faixa dos centros em cada dimensão (1 quando a faixa é nula)
+void rtreeInvRange(const PatternRTreeNode* nodes, int n, float invRange[PATTERN_DIMS]) {
+    for (int k = 0; k < PATTERN_DIMS; k++) {
+        float mn = 0, mx = 0;
+        for (int i = 0; i < n; i++) {
+            float c = nodes[i].lo[k] + nodes[i].hi[k];
+            if (i == 0 || c < mn) mn = c;
+            if (i == 0 || c > mx) mx = c;
+        }
+        invRange[k] = mx > mn ? 1.0f / (mx - mn) : 1.0f;
+    }
+}
+
+// --- PADRÕES EM COLUNAS PARA A PONTUAÇÃO EM LOTE ---
+// Cópia das caixas em struct-of-arrays: lo e hi de cada dimensão em colunas contíguas, agrupadas
+// pela combinação de flags como na R-tree. Cada grupo é completado até múltiplo de PATTERN_LANES
+// com caixas vazias (lo = +inf, hi = -inf), que nunca cruzam uma consulta, e o laço SSE2 compara
+// sempre PATTERN_LANES padrões inteiros, sem cauda.
+#define PATTERN_LANES 4
+
+const float* patternColumn(const FailurePatternList* list, int dim, bool high) {
+    return list->soa + (size_t)(2 * dim + (high ? 1 : 0)) * list->soaStride;
+}
+
+void buildPatternColumns(FailurePatternList* list) {
+    free(list->soa);
+    list->soa = NULL;
+    int sizes[PATTERN_MASKS] = {0};
+    for (int i = 0; i < list->count; i++) {
+        const FailurePattern* fp = &list->patterns[i];
+        sizes[patternFlagMask(fp->hadTWF, fp->hadHDF, fp->hadPWF, fp->hadOSF, fp->hadRNF)]++;
+    }
+    list->soaStart[0] = 0;
+    for (int m = 0; m < PATTERN_MASKS; m++)
+        list->soaStart[m + 1] = list->soaStart[m] + (sizes[m] + PATTERN_LANES - 1) / PATTERN_LANES * PATTERN_LANES;
+    list->soaStride = list->soaStart[PATTERN_MASKS];
+    if (list->soaStride == 0) return;
+
+    list->soa = (float*)malloc(sizeof(float) * 2 * PATTERN_DIMS * list->soaStride);
+    if (list->soa == NULL) {
+        perror("Erro ao alocar memória para as colunas de padrões");
+        exit(EXIT_FAILURE);
+    }
+    for (int k = 0; k < PATTERN_DIMS; k++) {
+        float* lo = list->soa + (size_t)(2 * k) * list->soaStride;
+        float* hi = lo + list->soaStride;
+        for (int p = 0; p < list->soaStride; p++) {
+            lo[p] = INFINITY;
+            hi[p] = -INFINITY;
+        }
+    }
+    int fill[PATTERN_MASKS];
+    memcpy(fill, list->soaStart, sizeof(fill));
+    for (int i = 0; i < list->count; i++) {
+        const FailurePattern* fp = &list->patterns[i];
+        int p = fill[patternFlagMask(fp->hadTWF, fp->hadHDF, fp->hadPWF, fp->hadOSF, fp->hadRNF)]++;
+        float lo[PATTERN_DIMS], hi[PATTERN_DIMS];
+        patternBox(fp, lo, hi);
+        for (int k = 0; k < PATTERN_DIMS; k++) {
+            list->soa[(size_t)(2 * k) * list->soaStride + p] = lo[k];
+            list->soa[(size_t)(2 * k + 1) * list->soaStride + p] = hi[k];
+        }
+    }
+}
+
+// --- PRÉ-FILTRO DE BLOOM DOS PADRÕES ---
+// Quase toda amostra do simulador é normal e não cruza padrão nenhum. O espaço dos sensores é
+// dividido numa grade de `cells` células por dimensão (sobre a extensão das caixas alargadas pela
+// tolerância) e cada padrão insere no filtro a chave (flags, célula) de toda célula que a sua caixa
+// alargada toca. Uma amostra que cruza um padrão cai numa dessas células (o arredondamento para a
+// célula é monótono), então o filtro nunca descarta um acerto. O filtro é de Bloom em blocos de
+// uma palavra: o hash escolhe a palavra e os k bits dentro dela, e a consulta é um hash, uma
+// leitura e uma comparação. A grade é engrossada até as células inseridas caberem em
+// PREFILTER_MAX_KEYS; as palavras e k são os menores que dão a taxa alvo. Como as células
+// dependem da tolerância, o filtro é refeito quando ela muda (ensureFailurePatternIndex).
+int prefilterCell(const PatternPrefilter* f, float v, int dim) {
+    float c = (v - f->origin[dim]) * f->invWidth[dim];
+    if (!(c >= 0.0f)) return 0; // Também NaN
+    return c >= (float)(f->cells - 1) ? f->cells - 1 : (int)c;
+}
+
+// Chave (flags, célula) espalhada (finalizador do MurmurHash3)
+unsigned long long prefilterHash(int mask, const int cell[PATTERN_DIMS]) {
+    unsigned long long h = (unsigned long long)mask;
+    for (int k = 0; k < PATTERN_DIMS; k++) h = (h << 8) | (unsigned long long)cell[k];
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Os k bits da chave: 6 bits do hash para cada, a partir do bit 16 (os de baixo escolhem a palavra)
+unsigned long long prefilterBits(unsigned long long h, int hashes) {
+    unsigned long long bits = 0;
+    for (int i = 0; i < hashes; i++) bits |= 1ULL << ((h >> (16 + 6 * i)) & 63);
+    return bits;
+}
+
+// A amostra pode cruzar algum padrão? false é definitivo
+bool prefilterMayMatch(const PatternPrefilter* f, const MachineData* d) {
+    if (f->keys == 0) return false;
+    float p[PATTERN_DIMS];
+    int cell[PATTERN_DIMS];
+    samplePoint(d, p);
+    for (int k = 0; k < PATTERN_DIMS; k++) cell[k] = prefilterCell(f, p[k], k);
+    unsigned long long h = prefilterHash(patternFlagMask(d->TWF, d->HDF, d->PWF, d->OSF, d->RNF), cell);
+    unsigned long long bits = prefilterBits(h, f->hashes);
+    return (f->words[h & f->wordMask] & bits) == bits;
+}
+
+// Células que a caixa alargada do padrão toca em cada dimensão
+void prefilterCellRange(const PatternPrefilter* f, const FailurePattern* fp, int clo[PATTERN_DIMS], int chi[PATTERN_DIMS]) {
+    float lo[PATTERN_DIMS], hi[PATTERN_DIMS];
+    patternBox(fp, lo, hi);
+    for (int k = 0; k < PATTERN_DIMS; k++) {
+        clo[k] = prefilterCell(f, lo[k] - f->tolerance[k], k);
+        chi[k] = prefilterCell(f, hi[k] + f->tolerance[k], k);
+    }
+}
+
+// Falso-positivo esperado com n chaves em w palavras e k bits: a carga de cada palavra é ~Poisson(n/w)
+// e uma palavra com j chaves responde "talvez" com probabilidade (1 - (63/64)^(jk))^k
+double prefilterFpFor(double keys, double words, int hashes) {
+    double lambda = keys / words, spread = 10.0 * sqrt(lambda) + 10.0, fp = 0.0;
+    int first = lambda > spread ? (int)(lambda - spread) : 0;
+    for (int j = first; j <= (int)(lambda + spread); j++) {
+        double pj = exp(j * log(lambda) - lambda - lgamma(j + 1.0)); // Poisson em log para não estourar
+        fp += pj * pow(1.0 - pow(63.0 / 64.0, (double)j * hashes), hashes);
+    }
+    return fp;
+}
+
+double prefilterExpectedFpRate(const PatternPrefilter* f) {
+    return f->keys ? prefilterFpFor((double)f->keys, (double)(f->wordMask + 1), f->hashes) : 0.0;
+}
+
+void buildPatternPrefilter(FailurePatternList* list) {
+    PatternPrefilter* f = &list->prefilter;
+    free(f->words);
+    f->words = NULL;
+    f->keys = 0;
+    memcpy(f->tolerance, list->tolerance, sizeof(f->tolerance));
+    if (list->count == 0) return;
+
+    float mn[PATTERN_DIMS], mx[PATTERN_DIMS], lo[PATTERN_DIMS], hi[PATTERN_DIMS];
+    for (int i = 0; i < list->count; i++) {
+        patternBox(&list->patterns[i], lo, hi);
+        for (int k = 0; k < PATTERN_DIMS; k++) {
+            if (i == 0 || lo[k] - f->tolerance[k] < mn[k]) mn[k] = lo[k] - f->tolerance[k];
+            if (i == 0 || hi[k] + f->tolerance[k] > mx[k]) mx[k] = hi[k] + f->tolerance[k];
+        }
+    }
+
+    // Engrossa a grade até as células tocadas caberem no orçamento
+    int clo[PATTERN_DIMS], chi[PATTERN_DIMS];
+    for (f->cells = PREFILTER_CELLS;; f->cells /= 2) {
+        for (int k = 0; k < PATTERN_DIMS; k++) {
+            f->origin[k] = mn[k];
+            f->invWidth[k] = mx[k] > mn[k] ? (float)f->cells / (mx[k] - mn[k]) : 0.0f;
+        }
+        f->keys = 0;
+        for (int i = 0; i < list->count && f->keys <= PREFILTER_MAX_KEYS; i++) {
+            prefilterCellRange(f, &list->patterns[i], clo, chi);
+            long long cellsInBox = 1;
+            for (int k = 0; k < PATTERN_DIMS; k++) cellsInBox *= chi[k] - clo[k] + 1;
+            f->keys += cellsInBox;
+        }
+        if (f->keys <= PREFILTER_MAX_KEYS || f->cells == 1) break;
+    }
+
+    // Menor potência de 2 de palavras (e o melhor k para ela) que atinge a taxa alvo
+    unsigned long long words = 1;
+    while ((long long)words * 64 < f->keys) words <<= 1; // Menos que isso passa de uma chave por bit
+    for (;; words <<= 1) {
+        int best = 1;
+        for (int k = 2; k <= PREFILTER_MAX_HASHES; k++) {
+            if (prefilterFpFor((double)f->keys, (double)words, k) < prefilterFpFor((double)f->keys, (double)words, best))
+                best = k;
+        }
+        f->hashes = best;
+        if (prefilterFpFor((double)f->keys, (double)words, best) <= f->fpRate || words >= (1ULL << 26)) break;
+    }
+    f->wordMask = words - 1;
+    f->words = (unsigned long long*)calloc(words, sizeof(unsigned long long));
+    if (f->words == NULL) {
+        perror("Erro ao alocar memória para o pré-filtro de padrões");
+        exit(EXIT_FAILURE);
+    }
+
+    // Percorre as células de cada caixa como um odômetro
+    for (int i = 0; i < list->count; i++) {
+        const FailurePattern* fp = &list->patterns[i];
+        int mask = patternFlagMask(fp->hadTWF, fp->hadHDF, fp->hadPWF, fp->hadOSF, fp->hadRNF);
+        prefilterCellRange(f, fp, clo, chi);
+        int cell[PATTERN_DIMS];
+        memcpy(cell, clo, sizeof(cell));
+        for (;;) {
+            unsigned long long h = prefilterHash(mask, cell);
+            f->words[h & f->wordMask] |= prefilterBits(h, f->hashes);
+            int k = 0;
+            while (k < PATTERN_DIMS && cell[k] == chi[k]) cell[k] = clo[k], k++;
+            if (k == PATTERN_DIMS) break;
+            cell[k]++;
+        }
+    }
+}
+
+// Falso-positivo medido: chaves sorteadas com flags >= PATTERN_MASKS, que nunca são inseridas
+double prefilterMeasuredFpRate(const PatternPrefilter* f, int probes) {
+    if (f->keys == 0) return 0.0;
+    int hits = 0, cell[PATTERN_DIMS];
+    for (int i = 0; i < probes; i++) {
+        for (int k = 0; k < PATTERN_DIMS; k++) cell[k] = rand() % f->cells;
+        unsigned long long h = prefilterHash(PATTERN_MASKS + rand() % PATTERN_MASKS, cell);
+        unsigned long long bits = prefilterBits(h, f->hashes);
+        hits += (f->words[h & f->wordMask] & bits) == bits;
+    }
+    return (double)hits / probes;
+}
+
+void displayPatternPrefilter(const PatternPrefilter* f) {
+    if (f->keys == 0) return;
+    printf("Pré-filtro de Bloom: %lld células (grade %d/dim), %.1f KB (%.1f bits/célula), %d bits por chave, "
+           "falso-positivo esperado %.2f%%\n",
+           f->keys, f->cells, (f->wordMask + 1) / 128.0, 64.0 * (f->wordMask + 1) / f->keys, f->hashes,
+           100.0 * prefilterExpectedFpRate(f));
+}
+
+// (Re)constrói o índice, as colunas e o pré-filtro a partir de patterns[0, count). O(n log n).
+void buildFailurePatternIndex(FailurePatternList* list) {
+    free(list->rtNodes);
+    list->rtNodes = NULL;
+    memset(list->rtStart, 0, sizeof(list->rtStart));
+    list->rtCount = list->count;
+    buildPatternColumns(list);
+    buildPatternPrefilter(list);
+    if (list->count == 0) return;
+
+    list->rtNodes = (PatternRTreeNode*)malloc(sizeof(PatternRTreeNode) * list->count);
+    if (list->rtNodes == NULL) {
+        perror("Erro ao alocar memória para o índice de padrões");
+        exit(EXIT_FAILURE);
+    }
+
+    // Counting sort pela combinação de flags: rtStart[m] .. rtStart[m + 1] é o grupo m
+    int fill[PATTERN_MASKS];
+    for (int i = 0; i < list->count; i++) {
+        const FailurePattern* fp = &list->patterns[i];
+        list->rtStart[patternFlagMask(fp->hadTWF, fp->hadHDF, fp->hadPWF, fp->hadOSF, fp->hadRNF) + 1]++;
+    }
+    for (int m = 0; m < PATTERN_MASKS; m++) {
+        list->rtStart[m + 1] += list->rtStart[m];
+        fill[m] = list->rtStart[m];
+    }
+    for (int i = 0; i < list->count; i++) {
+        const FailurePattern* fp = &list->patterns[i];
+        PatternRTreeNode* n = &list->rtNodes[fill[patternFlagMask(fp->hadTWF, fp->hadHDF, fp->hadPWF, fp->hadOSF, fp->hadRNF)]++];
+        patternBox(fp, n->lo, n->hi);
+        n->pattern = i;
+    }
+
+    float invRange[PATTERN_DIMS];
+    rtreeInvRange(list->rtNodes, list->count, invRange);
+    for (int m = 0; m < PATTERN_MASKS; m++) rtreeBuild(list->rtNodes, list->rtStart[m], list->rtStart[m + 1], invRange);
+}
+
+// Refaz o que ficou velho: tudo se padrões foram adicionados, só o pré-filtro se a tolerância mudou
+void ensureFailurePatternIndex(FailurePatternList* list) {
+    if (list->rtCount != list->count) buildFailurePatternIndex(list);
+    else if (memcmp(list->prefilter.tolerance, list->tolerance, sizeof(list->tolerance)) != 0) buildPatternPrefilter(list);
+}
+
+// --- APRENDIZAGEM DE REGIÕES DE FALHA ---
+// Em vez de um padrão por linha com falha, as falhas de cada combinação de flags são fundidas
+// gulosamente em caixas. A cada rodada os pares de caixas são ordenados pela soma das larguras
+// normalizadas da caixa fundida e fundidos do mais barato em diante (cada caixa no máximo uma vez
+// por rodada), desde que nenhuma largura passe de REGION_MAX_SPAN da faixa do sensor e a caixa
+// fundida não contenha nenhuma linha sem falha (consulta a uma R-tree das linhas normais).
+// Para quando uma rodada não funde nada. Grupos grandes são fatiados em blocos de REGION_CHUNK
+// caixas vizinhas para limitar os pares a O(REGION_CHUNK²).
+#define REGION_MAX_SPAN 0.5f
+#define REGION_CHUNK 512
+
+typedef struct {
+    float lo[PATTERN_DIMS], hi[PATTERN_DIMS];
+    float key;              // Ar + desgaste normalizados, para fatiar grupos grandes
+    int mask;
+    bool alive;
+} RegionBox;
+
+typedef struct {
+    float cost;
+    int a, b;
+} RegionMerge;
+
+int compareRegionMerge(const void* a, const void* b) {
+    float x = ((const RegionMerge*)a)->cost, y = ((const RegionMerge*)b)->cost;
+    return (x > y) - (x < y);
+}
+
+// Ordena por combinação de flags e, dentro dela, pela chave (vizinhos caem no mesmo bloco)
+int compareRegionBox(const void* a, const void* b) {
+    const RegionBox* x = (const RegionBox*)a;
+    const RegionBox* y = (const RegionBox*)b;
+    if (x->mask != y->mask) return x->mask - y->mask;
+    return (x->key > y->key) - (x->key < y->key);
+}
+
+void addRegionPattern(FailurePatternList* list, const float lo[PATTERN_DIMS], const float hi[PATTERN_DIMS], int mask) {
+    FailurePattern fp;
+    fp.minAirTemp = lo[0];
+    fp.maxAirTemp = hi[0];
+    fp.minProcessTemp = lo[1];
+    fp.maxProcessTemp = hi[1];
+    fp.minRotationalSpeed = (int)lo[2];
+    fp.maxRotationalSpeed = (int)hi[2];
+    fp.minTorque = lo[3];
+    fp.maxTorque = hi[3];
+    fp.minToolWear = (int)lo[4];
+    fp.maxToolWear = (int)hi[4];
+    fp.hadTWF = (mask & 1) != 0;
+    fp.hadHDF = (mask & 2) != 0;
+    fp.hadPWF = (mask & 4) != 0;
+    fp.hadOSF = (mask & 8) != 0;
+    fp.hadRNF = (mask & 16) != 0;
+    addFailurePattern(list, fp);
+}
+
+// Reinicia a lista mantendo a tolerância escolhida
+void resetFailurePatternList(FailurePatternList* patterns) {
+    float tolerance[PATTERN_DIMS];
+    memcpy(tolerance, patterns->tolerance, sizeof(tolerance));
+    double fpRate = patterns->prefilter.fpRate;
+    bool prefilterOn = patterns->prefilter.enabled;
+    freeFailurePatternList(patterns);
+    initFailurePatternList(patterns);
+    memcpy(patterns->tolerance, tolerance, sizeof(tolerance));
+    patterns->prefilter.fpRate = fpRate;
+    patterns->prefilter.enabled = prefilterOn;
+}
+
+// Um padrão por linha com falha (o aprendizado original). Devolve o número de falhas.
+int learnPointPatterns(const MachineData** rows, int n, FailurePatternList* patterns) {
+    resetFailurePatternList(patterns);
+    float p[PATTERN_DIMS];
+    for (int i = 0; i < n; i++) {
+        const MachineData* d = rows[i];
+        if (!d->MachineFailure) continue;
+        samplePoint(d, p);
+        addRegionPattern(patterns, p, p, patternFlagMask(d->TWF, d->HDF, d->PWF, d->OSF, d->RNF));
+    }
+    buildFailurePatternIndex(patterns);
+    return patterns->count;
+}
+
+// Funde as caixas de boxes[s, e) (mesma combinação de flags); normals é a R-tree das linhas sem falha
+void mergeRegionChunk(RegionBox* boxes, int s, int e, const PatternRTreeNode* normals, int normalCount,
+                      const float invRange[PATTERN_DIMS], RegionMerge* merges, bool* touched) {
+    for (;;) {
+        int pairs = 0;
+        for (int a = s; a < e; a++) {
+            if (!boxes[a].alive) continue;
+            for (int b = a + 1; b < e; b++) {
+                if (!boxes[b].alive) continue;
+                float cost = 0;
+                bool fits = true;
+                for (int k = 0; k < PATTERN_DIMS && fits; k++) {
+                    float lo = boxes[a].lo[k] < boxes[b].lo[k] ? boxes[a].lo[k] : boxes[b].lo[k];
+                    float hi = boxes[a].hi[k] > boxes[b].hi[k] ? boxes[a].hi[k] : boxes[b].hi[k];
+                    float span = (hi - lo) * invRange[k];
+                    fits = span <= REGION_MAX_SPAN;
+                    cost += span;
+                }
+                if (!fits) continue;
+                merges[pairs].cost = cost;
+                merges[pairs].a = a;
+                merges[pairs].b = b;
+                pairs++;
+            }
+        }
+        qsort(merges, pairs, sizeof(RegionMerge), compareRegionMerge);
+
+        int merged = 0;
+        memset(touched + s, 0, sizeof(bool) * (e - s));
+        for (int i = 0; i < pairs; i++) {
+            RegionBox* x = &boxes[merges[i].a];
+            RegionBox* y = &boxes[merges[i].b];
+            if (touched[merges[i].a] || touched[merges[i].b]) continue;
+            float lo[PATTERN_DIMS], hi[PATTERN_DIMS];
+            for (int k = 0; k < PATTERN_DIMS; k++) {
+                lo[k] = x->lo[k] < y->lo[k] ? x->lo[k] : y->lo[k];
+                hi[k] = x->hi[k] > y->hi[k] ? x->hi[k] : y->hi[k];
+            }
+            if (rtreeAny(normals, 0, normalCount, lo, hi)) continue; // Cobriria uma linha normal
+            memcpy(x->lo, lo, sizeof(lo));
+            memcpy(x->hi, hi, sizeof(hi));
+            y->alive = false;
+            touched[merges[i].a] = touched[merges[i].b] = true;
+            merged++;
+        }
+        if (merged == 0) return;
+    }
+}
+
+// Aprende regiões (caixas) de falha a partir das linhas. Devolve o número de falhas usadas.
+int learnFailureRegions(const MachineData** rows, int n, FailurePatternList* patterns) {
+    resetFailurePatternList(patterns);
+    int failures = 0;
+    for (int i = 0; i < n; i++) failures += rows[i]->MachineFailure ? 1 : 0;
+    int normalCount = n - failures;
+    if (failures == 0) {
+        buildFailurePatternIndex(patterns);
+        return 0;
+    }
+
+    RegionBox* boxes = (RegionBox*)malloc(sizeof(RegionBox) * failures);
+    PatternRTreeNode* normals = (PatternRTreeNode*)malloc(sizeof(PatternRTreeNode) * (normalCount > 0 ? normalCount : 1));
+    int chunk = failures < REGION_CHUNK ? failures : REGION_CHUNK;
+    RegionMerge* merges = (RegionMerge*)malloc(sizeof(RegionMerge) * ((size_t)chunk * (chunk - 1) / 2 + 1));
+    bool* touched = (bool*)malloc(sizeof(bool) * failures);
+    if (boxes == NULL || normals == NULL || merges == NULL || touched == NULL) {
+        perror("Erro ao alocar memória para o aprendizado de regiões");
+        exit(EXIT_FAILURE);
+    }
+
+    int f = 0, g = 0;
+    for (int i = 0; i < n; i++) {
+        const MachineData* d = rows[i];
+        if (d->MachineFailure) {
+            samplePoint(d, boxes[f].lo);
+            memcpy(boxes[f].hi, boxes[f].lo, sizeof(boxes[f].lo));
+            boxes[f].mask = patternFlagMask(d->TWF, d->HDF, d->PWF, d->OSF, d->RNF);
+            boxes[f].alive = true;
+            f++;
+        } else {
+            samplePoint(d, normals[g].lo);
+            memcpy(normals[g].hi, normals[g].lo, sizeof(normals[g].lo));
+            normals[g].pattern = i;
+            g++;
+        }
+    }
+
+    // Larguras normalizadas pela faixa de cada sensor em todas as linhas
+    float invRange[PATTERN_DIMS];
+    for (int k = 0; k < PATTERN_DIMS; k++) {
+        float mn = boxes[0].lo[k], mx = boxes[0].lo[k], p[PATTERN_DIMS];
+        for (int i = 0; i < n; i++) {
+            samplePoint(rows[i], p);
+            if (p[k] < mn) mn = p[k];
+            if (p[k] > mx) mx = p[k];
+        }
+        invRange[k] = mx > mn ? 1.0f / (mx - mn) : 1.0f;
+    }
+    for (int i = 0; i < failures; i++) boxes[i].key = boxes[i].lo[0] * invRange[0] + boxes[i].lo[4] * invRange[4];
+    rtreeBuild(normals, 0, normalCount, invRange);
+
+    qsort(boxes, failures, sizeof(RegionBox), compareRegionBox);
+    for (int s = 0; s < failures; ) {
+        int e = s;
+        while (e < failures && boxes[e].mask == boxes[s].mask && e - s < REGION_CHUNK) e++;
+        mergeRegionChunk(boxes, s, e, normals, normalCount, invRange, merges, touched);
+        s = e;
+    }
+    for (int i = 0; i < failures; i++) {
+        if (boxes[i].alive) addRegionPattern(patterns, boxes[i].lo, boxes[i].hi, boxes[i].mask);
+    }
+
+    free(boxes);
+    free(normals);
+    free(merges);
+    free(touched);
+    buildFailurePatternIndex(patterns);
+    return failures;
+}
+
+// --- ÁRVORES DE DECISÃO PARA OS MODOS DE FALHA ---
+// Uma árvore CART rasa por alvo (MachineFailure e cada modo TWF..RNF), treinada sobre os cinco
+// sensores, o Type e três combinações físicas deles (diferença de temperatura, potência e
+// desgaste x torque), que são as grandezas em que os modos HDF, PWF e OSF se definem. O treino
+// usa histogramas: cada feature é quantizada em até TREE_BINS faixas por quantis, e o melhor
+// corte de um nó (índice de Gini) sai de uma passada pelas linhas do nó. A árvore é guardada
+// completa, em ordem de níveis (filhos de i em 2i+1 e 2i+2); um nó que não divide recebe corte
+// +inf e repassa tudo à esquerda. Assim a inferência não tem desvios: idx = 2*idx + 1 + (x > corte)
+// por TREE_DEPTH níveis, num bloco de TREE_BLOCK amostras com as features em colunas. O bloco
+// evita os erros de previsão quando os caminhos variam; se os caminhos se repetem, como no fluxo do
+// simulador, a descida com if/else é prevista e fica à frente (benchmark_failure_model mede os dois).
+const char* treeFeatureNames[TREE_FEATURES] = {"AirTemp", "ProcessTemp", "RPM", "Torque", "ToolWear",
+                                               "Type", "TempDiff", "Power", "Strain"};
+const char* treeTargetNames[TREE_TARGETS] = {"Falha", "TWF", "HDF", "PWF", "OSF", "RNF"};
+
+void treeFeatures(const MachineData* d, float x[TREE_FEATURES]) {
+    x[0] = d->AirTemp;
+    x[1] = d->ProcessTemp;
+    x[2] = (float)d->RotationalSpeed;
+    x[3] = d->Torque;
+    x[4] = (float)d->ToolWear;
+    x[5] = d->Type == 'H' ? 2.0f : d->Type == 'M' ? 1.0f : 0.0f;
+    x[6] = d->ProcessTemp - d->AirTemp;
+    x[7] = d->Torque * (float)d->RotationalSpeed * (2.0f * 3.14159265f / 60.0f); // W
+    x[8] = d->Torque * (float)d->ToolWear;                                      // min·Nm
+}
+
+unsigned char treeLabels(const MachineData* d) {
+    return (unsigned char)((d->MachineFailure ? 1 : 0) | (d->TWF ? 2 : 0) | (d->HDF ? 4 : 0) |
+                           (d->PWF ? 8 : 0) | (d->OSF ? 16 : 0) | (d->RNF ? 32 : 0));
+}
+
+typedef struct {
+    int n;
+    unsigned char* bins;                        // bins[f * n + linha]
+    float cuts[TREE_FEATURES][TREE_BINS - 1];   // Faixa b de f: cuts[f][b - 1] < x <= cuts[f][b]
+    int cutCount[TREE_FEATURES];
+    unsigned char* labels;                      // Bits dos alvos (treeLabels)
+    int* order;                                 // Linhas, particionadas pelos nós
+} TreeTrainSet;
+
+// Gini ponderado pelo tamanho: n * (1 - p² - q²)
+double treeGini(int pos, int n) {
+    if (n == 0) return 0.0;
+    double neg = n - pos;
+    return n - ((double)pos * pos + neg * neg) / n;
+}
+
+void treeGrow(TreeTrainSet* set, int target, FlatTree* tree, int node, int depth, int lo, int hi, float inherited) {
+    int count = hi - lo, pos = 0;
+    for (int r = lo; r < hi; r++) pos += (set->labels[set->order[r]] >> target) & 1;
+    float prob = count > 0 ? (float)pos / count : inherited;
+    if (depth == TREE_DEPTH) {
+        tree->leaf[node - TREE_INNER] = prob;
+        return;
+    }
+
+    int bestF = -1, bestB = 0;
+    double bestGain = 1e-9;
+    if (pos > 0 && pos < count && count >= 2 * TREE_MIN_LEAF) {
+        double parent = treeGini(pos, count);
+        int hc[TREE_BINS], hp[TREE_BINS];
+        for (int f = 0; f < TREE_FEATURES; f++) {
+            const unsigned char* bins = set->bins + (size_t)f * set->n;
+            memset(hc, 0, sizeof(hc));
+            memset(hp, 0, sizeof(hp));
+            for (int r = lo; r < hi; r++) {
+                int row = set->order[r];
+                hc[bins[row]]++;
+                hp[bins[row]] += (set->labels[row] >> target) & 1;
+            }
+            int lc = 0, lp = 0;
+            for (int b = 0; b < set->cutCount[f]; b++) {
+                lc += hc[b];
+                lp += hp[b];
+                if (lc < TREE_MIN_LEAF || count - lc < TREE_MIN_LEAF) continue;
+                double gain = parent - treeGini(lp, lc) - treeGini(pos - lp, count - lc);
+                if (gain > bestGain) {
+                    bestGain = gain;
+                    bestF = f;
+                    bestB = b;
+                }
+            }
+        }
+    }
+
+    if (bestF < 0) { // Folha antecipada: corte +inf leva tudo à esquerda até o último nível
+        tree->feature[node] = 0;
+        tree->threshold[node] = INFINITY;
+        treeGrow(set, target, tree, 2 * node + 1, depth + 1, lo, hi, prob);
+        treeGrow(set, target, tree, 2 * node + 2, depth + 1, hi, hi, prob);
+        return;
+    }
+
+    tree->feature[node] = (unsigned char)bestF;
+    tree->threshold[node] = set->cuts[bestF][bestB];
+    const unsigned char* bins = set->bins + (size_t)bestF * set->n;
+    int mid = lo;
+    for (int r = lo; r < hi; r++) {
+        if (bins[set->order[r]] <= bestB) {
+            int tmp = set->order[mid];
+            set->order[mid++] = set->order[r];
+            set->order[r] = tmp;
+        }
+    }
+    treeGrow(set, target, tree, 2 * node + 1, depth + 1, lo, mid, prob);
+    treeGrow(set, target, tree, 2 * node + 2, depth + 1, mid, hi, prob);
+}
+
+// Treina as TREE_TARGETS árvores sobre as linhas
+void trainFailureModel(const MachineData** rows, int n, FailureModel* model) {
+    model->trained = false;
+    if (n == 0) return;
+    TreeTrainSet set;
+    set.n = n;
+    set.bins = (unsigned char*)malloc((size_t)n * TREE_FEATURES);
+    set.labels = (unsigned char*)malloc(n);
+    set.order = (int*)malloc(sizeof(int) * n);
+    float* x = (float*)malloc(sizeof(float) * (size_t)n * TREE_FEATURES);
+    float* column = (float*)malloc(sizeof(float) * n);
+    if (set.bins == NULL || set.labels == NULL || set.order == NULL || x == NULL || column == NULL) {
+        perror("Erro ao alocar memória para o treino das árvores");
+        exit(EXIT_FAILURE);
+    }
+    for (int r = 0; r < n; r++) {
+        treeFeatures(rows[r], x + (size_t)r * TREE_FEATURES);
+        set.labels[r] = treeLabels(rows[r]);
+    }
+
+    // Cortes nos quantis de cada feature (repetidos descartados) e a faixa de cada linha
+    for (int f = 0; f < TREE_FEATURES; f++) {
+        for (int r = 0; r < n; r++) column[r] = x[(size_t)r * TREE_FEATURES + f];
+        qsort(column, n, sizeof(float), kllCompareFloats);
+        int m = 0;
+        for (int k = 1; k < TREE_BINS; k++) {
+            float v = column[(long long)k * n / TREE_BINS];
+            if (v < column[n - 1] && (m == 0 || v > set.cuts[f][m - 1])) set.cuts[f][m++] = v;
+        }
+        set.cutCount[f] = m;
+        for (int r = 0; r < n; r++) {
+            float v = x[(size_t)r * TREE_FEATURES + f];
+            int a = 0, b = m; // Quantos cortes ficam abaixo de v
+            while (a < b) {
+                int c = (a + b) / 2;
+                if (set.cuts[f][c] < v) a = c + 1;
+                else b = c;
+            }
+            set.bins[(size_t)f * n + r] = (unsigned char)a;
+        }
+    }
+
+    for (int t = 0; t < TREE_TARGETS; t++) {
+        for (int r = 0; r < n; r++) set.order[r] = r;
+        treeGrow(&set, t, &model->trees[t], 0, 0, 0, n, 0.0f);
+    }
+    model->trained = true;
+    free(set.bins);
+    free(set.labels);
+    free(set.order);
+    free(x);
+    free(column);
+}
+
+// Inferência em bloco e sem desvios; predicted[i] recebe os bits dos alvos previstos (P >= 0,5)
+void predictFailureModes(const FailureModel* model, const MachineData** rows, int n, unsigned char* predicted) {
+    float x[TREE_FEATURES][TREE_BLOCK];
+    int idx[TREE_BLOCK];
+    for (int start = 0; start < n; start += TREE_BLOCK) {
+        int len = n - start < TREE_BLOCK ? n - start : TREE_BLOCK;
+        for (int i = 0; i < len; i++) {
+            float f[TREE_FEATURES];
+            treeFeatures(rows[start + i], f);
+            for (int k = 0; k < TREE_FEATURES; k++) x[k][i] = f[k];
+            predicted[start + i] = 0;
+        }
+        for (int t = 0; t < TREE_TARGETS; t++) {
+            const FlatTree* tree = &model->trees[t];
+            for (int i = 0; i < len; i++) idx[i] = 0;
+            for (int level = 0; level < TREE_DEPTH; level++) {
+                for (int i = 0; i < len; i++) {
+                    int node = idx[i];
+                    idx[i] = 2 * node + 1 + (x[tree->feature[node]][i] > tree->threshold[node]);
+                }
+            }
+            for (int i = 0; i < len; i++)
+                predicted[start + i] |= (unsigned char)((tree->leaf[idx[i] - TREE_INNER] >= 0.5f) << t);
+        }
+    }
+}
+
+// Referência: uma amostra por vez, descendo cada árvore com if/else
+unsigned char predictFailureModesScalar(const FailureModel* model, const MachineData* d) {
+    float x[TREE_FEATURES];
+    treeFeatures(d, x);
+    unsigned char out = 0;
+    for (int t = 0; t < TREE_TARGETS; t++) {
+        const FlatTree* tree = &model->trees[t];
+        int node = 0;
+        while (node < TREE_INNER) {
+            if (x[tree->feature[node]] > tree->threshold[node]) node = 2 * node + 2;
+            else node = 2 * node + 1;
+        }
+        if (tree->leaf[node - TREE_INNER] >= 0.5f) out |= (unsigned char)(1 << t);
+    }
+    return out;
+}
+
+typedef struct {
+    int tp, fp, fn, tn;
+} DetectionCounts;
+
+void countDetection(DetectionCounts* c, bool predicted, bool actual) {
+    if (actual) predicted ? c->tp++ : c->fn++;
+    else predicted ? c->fp++ : c->tn++;
+}
+
+double detectionPrecision(const DetectionCounts* c) {
+    return c->tp + c->fp ? 100.0 * c->tp / (c->tp + c->fp) : 0.0;
+}
+
+double detectionRecall(const DetectionCounts* c) {
+    return c->tp + c->fn ? 100.0 * c->tp / (c->tp + c->fn) : 0.0;
+}
+
+// Precisão/recall de cada alvo sobre as linhas
+void evaluateFailureModel(const FailureModel* model, const MachineData** rows, int n, DetectionCounts counts[TREE_TARGETS]) {
+    memset(counts, 0, sizeof(DetectionCounts) * TREE_TARGETS);
+    unsigned char predicted[TREE_BLOCK];
+    for (int start = 0; start < n; start += TREE_BLOCK) {
+        int len = n - start < TREE_BLOCK ? n - start : TREE_BLOCK;
+        predictFailureModes(model, rows + start, len, predicted);
+        for (int i = 0; i < len; i++) {
+            unsigned char actual = treeLabels(rows[start + i]);
+            for (int t = 0; t < TREE_TARGETS; t++)
+                countDetection(&counts[t], (predicted[i] >> t) & 1, (actual >> t) & 1);
+        }
+    }
+}
+
+void displayFailureModelEvaluation(const DetectionCounts counts[TREE_TARGETS]) {
+    printf("%-8s %10s %10s %10s %9s\n", "Alvo", "Positivos", "Previstos", "Precisao", "Recall");
+    for (int t = 0; t < TREE_TARGETS; t++) {
+        const DetectionCounts* c = &counts[t];
+        printf("%-8s %10d %10d %9.1f%% %8.1f%%\n", treeTargetNames[t], c->tp + c->fn, c->tp + c->fp,
+               detectionPrecision(c), detectionRecall(c));
+    }
+}
+
+void displayPatternTolerance(const FailurePatternList* patterns) {
+    bool exact = true;
+    for (int d = 0; d < PATTERN_DIMS; d++) exact = exact && patterns->tolerance[d] == 0.0f;
+    if (exact) {
+        printf("Correspondência exata com os padrões aprendidos.\n");
+        return;
+    }
+    printf("Tolerância:");
+    for (int d = 0; d < PATTERN_DIMS; d++) printf(" %s ±%g", patternDimNames[d], patterns->tolerance[d]);
+    printf("\n");
+}
+
+// Lê a tolerância por dimensão usada pela detecção (Enter mantém a atual)
+void readPatternTolerance(FailurePatternList* patterns) {
+    char input[128];
+    float* eps = patterns->tolerance;
+    printf("Tolerância por dimensão (ar K, processo K, rpm, torque Nm, desgaste min)\n");
+    printf("Enter = manter %.2f %.2f %.0f %.2f %.0f | 's' = sugerida %.1f %.1f %.0f %.1f %.0f | ou 5 valores: ",
+           eps[0], eps[1], eps[2], eps[3], eps[4], patternSuggestedTolerance[0], patternSuggestedTolerance[1],
+           patternSuggestedTolerance[2], patternSuggestedTolerance[3], patternSuggestedTolerance[4]);
+    if (!fgets(input, sizeof(input), stdin)) return;
+    if (toupper((unsigned char)input[0]) == 'S') {
+        memcpy(eps, patternSuggestedTolerance, sizeof(patterns->tolerance));
+        return;
+    }
+    float v[PATTERN_DIMS];
+    int read = sscanf(input, "%f %f %f %f %f", &v[0], &v[1], &v[2], &v[3], &v[4]);
+    if (read == PATTERN_DIMS && v[0] >= 0 && v[1] >= 0 && v[2] >= 0 && v[3] >= 0 && v[4] >= 0) {
+        memcpy(eps, v, sizeof(v));
+    } else if (read > 0) {
+        printf("Tolerância inválida, mantendo a atual.\n");
+    }
+}
+
+// --- DETECÇÃO DE PADRÕES E AMOSTRAS SIMULADAS ---
+// Consulta de uma amostra contra a lista (varredura de referência e R-tree), o lote pelas colunas
+// (SSE2) e o gerador de amostras da fresadora, que injeta pontos das regiões aprendidas.
+
+// VERIFICA SE OS DADOS ATUAIS CORRESPONDEM A UM PADRÃO DE FALHA APRENDIDO
+// Varredura linear de referência: mesmo critério do índice, um padrão por vez.
+bool checkForFailurePatternLinear(MachineData data, FailurePatternList* patterns) {
+    float qlo[PATTERN_DIMS], qhi[PATTERN_DIMS], lo[PATTERN_DIMS], hi[PATTERN_DIMS];
+    sampleQueryBox(&data, patterns->tolerance, qlo, qhi);
+    int mask = patternFlagMask(data.TWF, data.HDF, data.PWF, data.OSF, data.RNF);
+    for (int i = 0; i < patterns->count; i++) {
+        FailurePattern* fp = &patterns->patterns[i];
+        if (patternFlagMask(fp->hadTWF, fp->hadHDF, fp->hadPWF, fp->hadOSF, fp->hadRNF) != mask) continue;
+        patternBox(fp, lo, hi);
+        if (boxOverlap(lo, hi, qlo, qhi)) {
+            return true; // Padrão detectado!
+        }
+    }
+    return false; // Nenhum padrão correspondente encontrado
+}
+
+// Mesma resposta pela R-tree: só o grupo com os flags da amostra é consultado.
+// O índice é refeito se padrões foram adicionados depois da última construção.
+bool checkForFailurePattern(MachineData data, FailurePatternList* patterns) {
+    ensureFailurePatternIndex(patterns);
+    if (patterns->prefilter.enabled && !prefilterMayMatch(&patterns->prefilter, &data)) return false;
+    float qlo[PATTERN_DIMS], qhi[PATTERN_DIMS];
+    sampleQueryBox(&data, patterns->tolerance, qlo, qhi);
+    int mask = patternFlagMask(data.TWF, data.HDF, data.PWF, data.OSF, data.RNF);
+    return rtreeAny(patterns->rtNodes, patterns->rtStart[mask], patterns->rtStart[mask + 1], qlo, qhi);
+}
+
+// Mesma resposta para samples[0, n) de uma vez, pelas colunas: o bit i % 64 de matches[i / 64]
+// liga quando a amostra i cruza algum padrão do seu grupo de flags. Cada passo testa PATTERN_LANES
+// padrões nas cinco dimensões (10 comparações SSE2 reduzidas por um movemask) e a amostra para no
+// primeiro passo com acerto.
+void checkForFailurePatternBatch(const MachineData* samples, int n, FailurePatternList* patterns, unsigned long long* matches) {
+    ensureFailurePatternIndex(patterns);
+    int words = (n + 63) / 64;
+    if (patterns->soa == NULL) {
+        memset(matches, 0, sizeof(unsigned long long) * words);
+        return;
+    }
+    const float* lo[PATTERN_DIMS];
+    const float* hi[PATTERN_DIMS];
+    for (int k = 0; k < PATTERN_DIMS; k++) {
+        lo[k] = patternColumn(patterns, k, false);
+        hi[k] = patternColumn(patterns, k, true);
+    }
+
+    for (int w = 0; w < words; w++) {
+        int base = w * 64;
+        int len = n - base < 64 ? n - base : 64;
+        unsigned long long bits = 0;
+        for (int i = 0; i < len; i++) {
+            const MachineData* d = &samples[base + i];
+            if (patterns->prefilter.enabled && !prefilterMayMatch(&patterns->prefilter, d)) continue;
+            float qlo[PATTERN_DIMS], qhi[PATTERN_DIMS];
+            sampleQueryBox(d, patterns->tolerance, qlo, qhi);
+            int mask = patternFlagMask(d->TWF, d->HDF, d->PWF, d->OSF, d->RNF);
+            int end = patterns->soaStart[mask + 1];
+            bool hit = false;
+#ifdef FILTER_SSE2
+            __m128 vqlo[PATTERN_DIMS], vqhi[PATTERN_DIMS];
+            for (int k = 0; k < PATTERN_DIMS; k++) {
+                vqlo[k] = _mm_set1_ps(qlo[k]);
+                vqhi[k] = _mm_set1_ps(qhi[k]);
+            }
+            for (int p = patterns->soaStart[mask]; p < end && !hit; p += PATTERN_LANES) {
+                __m128 in = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(lo[0] + p), vqhi[0]),
+                                       _mm_cmpge_ps(_mm_loadu_ps(hi[0] + p), vqlo[0]));
+                for (int k = 1; k < PATTERN_DIMS; k++) {
+                    in = _mm_and_ps(in, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(lo[k] + p), vqhi[k]),
+                                                   _mm_cmpge_ps(_mm_loadu_ps(hi[k] + p), vqlo[k])));
+                }
+                hit = _mm_movemask_ps(in) != 0;
+            }
+#else
+            for (int p = patterns->soaStart[mask]; p < end && !hit; p++) {
+                bool in = true;
+                for (int k = 0; k < PATTERN_DIMS; k++) in = in & (lo[k][p] <= qhi[k]) & (hi[k][p] >= qlo[k]);
+                hit = in;
+            }
+#endif
+            bits |= (unsigned long long)hit << i;
+        }
+        matches[w] = bits;
+    }
+}
+
+// Sorteia um valor dentro de [lo, hi]; sem sorteio quando a região é um ponto
+float regionSampleFloat(float lo, float hi) {
+    if (hi <= lo) return lo;
+    float v = lo + (hi - lo) * ((float)rand() / (float)RAND_MAX);
+    return v > hi ? hi : v;
+}
+
+int regionSampleInt(int lo, int hi) {
+    return hi > lo ? lo + rand() % (hi - lo + 1) : lo;
+}
+
+// GERA UMA AMOSTRA SIMULADA DA FRESADORA
+// Operação normal com pequenas variações; em 5% das amostras injeta um ponto de uma região aprendida.
+// Devolve o índice do padrão injetado, ou -1.
+int generateSimulatedSample(MachineData* simulatedData, FailurePatternList* patterns, int udi) {
+    simulatedData->UDI = udi;
+
+    // Gera ProductID e Tipo (pode ser aleatório ou seguir uma sequência)
+    snprintf(simulatedData->ProductID, sizeof(simulatedData->ProductID), "SIM%06u", (unsigned)rand() % 1000000u); // 0..999999: cabe nos 10 bytes
+    simulatedData->Type = "LMH"[rand() % 3];
+
+    // Introduz variações em torno de valores típicos (menos de falha)
+    // Defina faixas razoáveis para a sua simulação de "operação normal"
+    simulatedData->AirTemp = 298.0f + (float)(rand() % 200) / 100.0f - 1.0f; // Ex: 297.0 a 299.0 K
+    simulatedData->ProcessTemp = simulatedData->AirTemp + 10.0f + (float)(rand() % 100) / 100.0f; // Ex: Processo geralmente mais alto
+    simulatedData->RotationalSpeed = 1400 + rand() % 200 - 100; // Ex: 1300 a 1500 rpm
+    simulatedData->Torque = 30.0f + (float)(rand() % 200) / 100.0f - 1.0f; // Ex: 29.0 a 31.0 Nm
+    simulatedData->ToolWear = 30 + rand() % 30 - 15; // Ex: 15 a 45 min
+
+    // Assume que não há falha inicialmente para dados simulados, a menos que um padrão seja injetado
+    simulatedData->MachineFailure = false;
+    simulatedData->TWF = false;
+    simulatedData->HDF = false;
+    simulatedData->PWF = false;
+    simulatedData->OSF = false;
+    simulatedData->RNF = false;
+
+    // Introduz um padrão de falha periodicamente ou aleatoriamente
+    // Aqui, há uma chance de 5% de injetar um padrão de falha aprendido
+    if (patterns->count > 0 && rand() % 20 == 0) {
+        // Seleciona um padrão aprendido aleatório para injetar
+        int pattern_idx = rand() % patterns->count;
+        FailurePattern injected_pattern = patterns->patterns[pattern_idx];
+
+        // Sobrescreve os dados simulados com um ponto sorteado dentro da região do padrão
+        simulatedData->AirTemp = regionSampleFloat(injected_pattern.minAirTemp, injected_pattern.maxAirTemp);
+        simulatedData->ProcessTemp = regionSampleFloat(injected_pattern.minProcessTemp, injected_pattern.maxProcessTemp);
+        simulatedData->RotationalSpeed = regionSampleInt(injected_pattern.minRotationalSpeed, injected_pattern.maxRotationalSpeed);
+        simulatedData->Torque = regionSampleFloat(injected_pattern.minTorque, injected_pattern.maxTorque);
+        simulatedData->ToolWear = regionSampleInt(injected_pattern.minToolWear, injected_pattern.maxToolWear);
+
+        // Define os flags de falha de acordo com o padrão
+        simulatedData->MachineFailure = true; // Isso é crucial para a detecção
+        simulatedData->TWF = injected_pattern.hadTWF;
+        simulatedData->HDF = injected_pattern.hadHDF;
+        simulatedData->PWF = injected_pattern.hadPWF;
+        simulatedData->OSF = injected_pattern.hadOSF;
+        simulatedData->RNF = injected_pattern.hadRNF;
+        return pattern_idx;
+    }
+    return -1;
+}
+
+#endif // ESD_COMUM_PADROES_H
@@ -0,0 +1,396 @@
+// Código comum aos cinco programas (ESD-TRABALHO(*).cpp): benchmarks do índice de padrões, das
+// regiões de falha e das árvores de decisão. Cada programa o inclui uma vez, antes do benchmark
+// da frota; o arquivo traz definições e usa os includes do programa.
+#ifndef ESD_COMUM_PADROES_BENCHMARK_H
+#define ESD_COMUM_PADROES_BENCHMARK_H
+
+// --- BENCHMARK DO ÍNDICE DE PADRÕES ---
+// Mesmo fluxo de amostras de simulateMillingMachine (gerador e injeção de 5%, semente fixa),
+// sem a impressão dos alertas nem a inserção na estrutura: só a detecção é cronometrada.
+#define PATTERN_BENCH_SAMPLES 1000000
+#define PATTERN_SCALE_SAMPLES 100000
+#define PATTERN_LINEAR_BUDGET 1000000000LL // Comparações máximas para a varredura linear
+
+enum { MATCH_LINEAR, MATCH_RTREE, MATCH_BATCH };
+
+// Cronometra a detecção sobre as amostras pela varredura, pelo índice ou em lote pelas colunas;
+// devolve os alertas
+int timePatternMatching(const MachineData* samples, int n, FailurePatternList* patterns, int method, double* ms) {
+    HighPrecisionTimer t;
+    int alerts = 0;
+    if (method == MATCH_BATCH) {
+        int words = (n + 63) / 64;
+        unsigned long long* matches = (unsigned long long*)malloc(sizeof(unsigned long long) * words);
+        if (matches == NULL) {
+            perror("Erro ao alocar memória para o bitmap de alertas");
+            exit(EXIT_FAILURE);
+        }
+        start_timer(&t);
+        checkForFailurePatternBatch(samples, n, patterns, matches);
+        *ms = stop_timer(&t);
+        for (int w = 0; w < words; w++) alerts += bitPopCount64(matches[w]);
+        free(matches);
+        return alerts;
+    }
+    start_timer(&t);
+    for (int i = 0; i < n; i++) {
+        if (method == MATCH_RTREE ? checkForFailurePattern(samples[i], patterns)
+                                  : checkForFailurePatternLinear(samples[i], patterns))
+            alerts++;
+    }
+    *ms = stop_timer(&t);
+    return alerts;
+}
+
+void printPatternMatchRow(const char* label, int n, double ms, double base_ms, int alerts) {
+    printf("%-30s %12.2f %12.1f %8.2fx %10d\n", label, ms, ms * 1e6 / n, base_ms / ms, alerts);
+    benchRecord(n, n, ms, "%s", label);
+}
+
+void benchmark_pattern_index(WorkloadBackend* store) {
+    FailurePatternList patterns;
+    initFailurePatternList(&patterns);
+    learnFailurePatterns(store, &patterns);
+    MachineData* samples = (MachineData*)malloc(sizeof(MachineData) * PATTERN_BENCH_SAMPLES);
+    if (samples == NULL) {
+        perror("Erro ao alocar memória para o benchmark de padrões");
+        freeFailurePatternList(&patterns);
+        return;
+    }
+    if (patterns.count > 0) {
+        srand(39);
+        for (int i = 0; i < PATTERN_BENCH_SAMPLES; i++) generateSimulatedSample(&samples[i], &patterns, i + 1);
+
+        HighPrecisionTimer t;
+        start_timer(&t);
+        buildFailurePatternIndex(&patterns);
+        double build_ms = stop_timer(&t);
+        printf("%d padrões, %d amostras simuladas, índice construído em %.3f ms\n", patterns.count,
+               PATTERN_BENCH_SAMPLES, build_ms);
+        benchRecord(patterns.count, patterns.count, build_ms, "Construcao do indice");
+        printf("%-30s %12s %12s %9s %10s\n", "Metodo", "Tempo(ms)", "ns/amostra", "Speedup", "Alertas");
+        patterns.prefilter.enabled = false;
+        double plain_index_ms = 0, plain_batch_ms = 0;
+        int plain_alerts = 0;
+        for (int mode = 0; mode < 2; mode++) {
+            if (mode == 0) memset(patterns.tolerance, 0, sizeof(patterns.tolerance));
+            else memcpy(patterns.tolerance, patternSuggestedTolerance, sizeof(patterns.tolerance));
+            double linear_ms, index_ms, batch_ms;
+            int linear = timePatternMatching(samples, PATTERN_BENCH_SAMPLES, &patterns, MATCH_LINEAR, &linear_ms);
+            int indexed = timePatternMatching(samples, PATTERN_BENCH_SAMPLES, &patterns, MATCH_RTREE, &index_ms);
+            int batch = timePatternMatching(samples, PATTERN_BENCH_SAMPLES, &patterns, MATCH_BATCH, &batch_ms);
+            printPatternMatchRow(mode == 0 ? "Linear (exata)" : "Linear (tolerancia sugerida)", PATTERN_BENCH_SAMPLES,
+                                 linear_ms, linear_ms, linear);
+            printPatternMatchRow(mode == 0 ? "R-tree (exata)" : "R-tree (tolerancia sugerida)",
+                                 PATTERN_BENCH_SAMPLES, index_ms, linear_ms, indexed);
+            printPatternMatchRow(mode == 0 ? "Lote (exata)" : "Lote (tolerancia sugerida)",
+                                 PATTERN_BENCH_SAMPLES, batch_ms, linear_ms, batch);
+            if (linear != indexed) printf("AVISO: o índice diverge da varredura linear!\n");
+            if (linear != batch) printf("AVISO: o lote diverge da varredura linear!\n");
+            plain_index_ms = index_ms;
+            plain_batch_ms = batch_ms;
+            plain_alerts = linear;
+        }
+
+        // Pré-filtro na frente dos dois casamentos, ainda com a tolerância sugerida. "FP Bloom" é o
+        // falso-positivo do filtro em chaves ausentes; "Passam" é a fração das amostras sem padrão
+        // que chegam ao casamento (inclui as células só em parte cobertas pelas caixas).
+        printf("\nPré-filtro de Bloom (tolerância sugerida, speedup sobre o mesmo método sem filtro):\n");
+        printf("%8s %9s %8s %9s %3s %6s %11s %8s %9s %8s\n", "FP alvo", "FP Bloom", "Passam", "Bits/cel", "k",
+               "Grade", "R-tree(ns)", "Speedup", "Lote(ns)", "Speedup");
+        static const double rates[] = {0.1, 0.01, 0.001};
+        for (int r = 0; r < (int)(sizeof(rates) / sizeof(rates[0])); r++) {
+            PatternPrefilter* pf = &patterns.prefilter;
+            pf->fpRate = rates[r];
+            pf->enabled = true;
+            buildPatternPrefilter(&patterns);
+            double index_ms, batch_ms;
+            int indexed = timePatternMatching(samples, PATTERN_BENCH_SAMPLES, &patterns, MATCH_RTREE, &index_ms);
+            int batch = timePatternMatching(samples, PATTERN_BENCH_SAMPLES, &patterns, MATCH_BATCH, &batch_ms);
+            int passed = 0;
+            for (int i = 0; i < PATTERN_BENCH_SAMPLES; i++) passed += prefilterMayMatch(pf, &samples[i]) ? 1 : 0;
+            int negatives = PATTERN_BENCH_SAMPLES - plain_alerts;
+            printf("%7.1f%% %8.2f%% %7.2f%% %9.1f %3d %6d %11.1f %7.2fx %9.1f %7.2fx\n", 100.0 * rates[r],
+                   100.0 * prefilterMeasuredFpRate(pf, PATTERN_SCALE_SAMPLES),
+                   negatives ? 100.0 * (passed - plain_alerts) / negatives : 0.0,
+                   64.0 * (pf->wordMask + 1) / pf->keys, pf->hashes, pf->cells,
+                   index_ms * 1e6 / PATTERN_BENCH_SAMPLES, plain_index_ms / index_ms,
+                   batch_ms * 1e6 / PATTERN_BENCH_SAMPLES, plain_batch_ms / batch_ms);
+            benchRecord(PATTERN_BENCH_SAMPLES, PATTERN_BENCH_SAMPLES, index_ms, "R-tree + Bloom (FP %.1f%%)", 100.0 * rates[r]);
+            benchRecord(PATTERN_BENCH_SAMPLES, PATTERN_BENCH_SAMPLES, batch_ms, "Lote + Bloom (FP %.1f%%)", 100.0 * rates[r]);
+            if (indexed != plain_alerts || batch != plain_alerts) printf("AVISO: o pré-filtro descartou acertos!\n");
+        }
+    } else {
+        printf("Nenhuma falha nos dados carregados; só a parte sintética será medida.\n");
+    }
+    freeFailurePatternList(&patterns);
+
+    // Crescimento com o histórico: padrões pontuais sintéticos, metade das amostras sobre um padrão
+    printf("\nEscala (%d amostras, tolerância sugerida):\n", PATTERN_SCALE_SAMPLES);
+    printf("%9s %11s %11s %11s %12s %10s %9s %10s\n", "Padroes", "Linear(ns)", "R-tree(ns)", "Lote(ns)",
+           "Lote+BF(ns)", "R-tree x L", "Lote x L", "BF x Lote");
+    static const int sizes[] = {1000, 10000, 100000};
+    for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++) {
+        int n = sizes[s];
+        initFailurePatternList(&patterns);
+        fillSyntheticRecords(samples, n, 390 + s);
+        for (int i = 0; i < n; i++) {
+            FailurePattern fp;
+            fp.minAirTemp = fp.maxAirTemp = samples[i].AirTemp;
+            fp.minProcessTemp = fp.maxProcessTemp = samples[i].ProcessTemp;
+            fp.minRotationalSpeed = fp.maxRotationalSpeed = samples[i].RotationalSpeed;
+            fp.minTorque = fp.maxTorque = samples[i].Torque;
+            fp.minToolWear = fp.maxToolWear = samples[i].ToolWear;
+            fp.hadTWF = i % 5 == 0;
+            fp.hadHDF = i % 5 == 1;
+            fp.hadPWF = i % 5 == 2;
+            fp.hadOSF = i % 5 == 3;
+            fp.hadRNF = false;
+            addFailurePattern(&patterns, fp);
+        }
+        memcpy(patterns.tolerance, patternSuggestedTolerance, sizeof(patterns.tolerance));
+        patterns.prefilter.enabled = false;
+        buildFailurePatternIndex(&patterns);
+        fillSyntheticRecords(samples, PATTERN_SCALE_SAMPLES, 3900 + s);
+        for (int i = 0; i < PATTERN_SCALE_SAMPLES; i++) {
+            MachineData* d = &samples[i];
+            const FailurePattern* fp = &patterns.patterns[rand() % n];
+            d->TWF = fp->hadTWF;
+            d->HDF = fp->hadHDF;
+            d->PWF = fp->hadPWF;
+            d->OSF = fp->hadOSF;
+            d->RNF = false;
+            if (i % 2 == 0) {
+                d->AirTemp = fp->minAirTemp;
+                d->ProcessTemp = fp->minProcessTemp;
+                d->RotationalSpeed = fp->minRotationalSpeed;
+                d->Torque = fp->minTorque;
+                d->ToolWear = fp->minToolWear;
+            }
+        }
+        double index_ms, batch_ms, filtered_ms;
+        int indexed = timePatternMatching(samples, PATTERN_SCALE_SAMPLES, &patterns, MATCH_RTREE, &index_ms);
+        int batch = timePatternMatching(samples, PATTERN_SCALE_SAMPLES, &patterns, MATCH_BATCH, &batch_ms);
+        patterns.prefilter.enabled = true;
+        int filtered = timePatternMatching(samples, PATTERN_SCALE_SAMPLES, &patterns, MATCH_BATCH, &filtered_ms);
+        double scale = 1e6 / PATTERN_SCALE_SAMPLES;
+        if ((long long)n * PATTERN_SCALE_SAMPLES <= PATTERN_LINEAR_BUDGET) {
+            double linear_ms;
+            int linear = timePatternMatching(samples, PATTERN_SCALE_SAMPLES, &patterns, MATCH_LINEAR, &linear_ms);
+            printf("%9d %11.1f %11.1f %11.1f %12.1f %9.2fx %8.2fx %9.2fx\n", n, linear_ms * scale, index_ms * scale,
+                   batch_ms * scale, filtered_ms * scale, linear_ms / index_ms, linear_ms / batch_ms,
+                   batch_ms / filtered_ms);
+            benchRecord(n, PATTERN_SCALE_SAMPLES, linear_ms, "Escala: linear");
+            if (linear != indexed) printf("AVISO: o índice diverge da varredura linear!\n");
+        } else {
+            printf("%9d %11s %11.1f %11.1f %12.1f %10s %9s %9.2fx\n", n, "-", index_ms * scale, batch_ms * scale,
+                   filtered_ms * scale, "-", "-", batch_ms / filtered_ms);
+        }
+        benchRecord(n, PATTERN_SCALE_SAMPLES, index_ms, "Escala: R-tree");
+        benchRecord(n, PATTERN_SCALE_SAMPLES, batch_ms, "Escala: lote");
+        benchRecord(n, PATTERN_SCALE_SAMPLES, filtered_ms, "Escala: lote + Bloom");
+        if (indexed != batch) printf("AVISO: o lote diverge do índice!\n");
+        if (filtered != batch) printf("AVISO: o pré-filtro descartou acertos!\n");
+        freeFailurePatternList(&patterns);
+    }
+    free(samples);
+}
+
+// --- BENCHMARK DAS REGIÕES DE FALHA ---
+// Validação 80/20 sobre os dados carregados: aprende com 4 de cada 5 linhas e verifica, nas
+// restantes, se os sensores caem em alguma região de falha de qualquer combinação de flags (os
+// flags da própria linha entregariam a resposta). Compara um padrão por falha com as regiões.
+#define REGION_EVAL_REPS 200
+
+bool sampleInAnyRegion(const MachineData* d, FailurePatternList* patterns) {
+    if (patterns->rtCount != patterns->count) buildFailurePatternIndex(patterns);
+    float qlo[PATTERN_DIMS], qhi[PATTERN_DIMS];
+    sampleQueryBox(d, patterns->tolerance, qlo, qhi);
+    for (int m = 0; m < PATTERN_MASKS; m++) {
+        if (rtreeAny(patterns->rtNodes, patterns->rtStart[m], patterns->rtStart[m + 1], qlo, qhi)) return true;
+    }
+    return false;
+}
+
+void benchmark_failure_regions(WorkloadBackend* store) {
+    int count;
+    const MachineData** rows = collectFilterRecords(store, NULL, &count);
+    const MachineData** train = (const MachineData**)malloc(sizeof(MachineData*) * (count + 1));
+    const MachineData** test = (const MachineData**)malloc(sizeof(MachineData*) * (count + 1));
+    if (rows == NULL || train == NULL || test == NULL) {
+        perror("Erro ao alocar memória para o benchmark de regiões");
+        free(rows);
+        free(train);
+        free(test);
+        return;
+    }
+    int trainCount = 0, testCount = 0, testFailures = 0;
+    for (int i = 0; i < count; i++) {
+        if (i % 5 == 4) {
+            test[testCount++] = rows[i];
+            testFailures += rows[i]->MachineFailure ? 1 : 0;
+        } else {
+            train[trainCount++] = rows[i];
+        }
+    }
+    printf("%d linhas de treino, %d de teste (%d falhas no teste)\n", trainCount, testCount, testFailures);
+    if (testCount == 0) {
+        free(rows);
+        free(train);
+        free(test);
+        return;
+    }
+    printf("%-30s %8s %13s %9s %8s %9s %11s\n", "Modelo", "Padroes", "Aprender(ms)", "Precisao", "Recall",
+           "Acuracia", "ns/amostra");
+
+    FailurePatternList model;
+    initFailurePatternList(&model);
+    HighPrecisionTimer t;
+    for (int regions = 0; regions < 2; regions++) {
+        for (int mode = 0; mode < 2; mode++) {
+            if (mode == 0) memset(model.tolerance, 0, sizeof(model.tolerance));
+            else memcpy(model.tolerance, patternSuggestedTolerance, sizeof(model.tolerance));
+            start_timer(&t);
+            if (regions) learnFailureRegions(train, trainCount, &model);
+            else learnPointPatterns(train, trainCount, &model);
+            double learn_ms = stop_timer(&t);
+
+            int tp = 0, fp = 0, fn = 0, tn = 0;
+            for (int i = 0; i < testCount; i++) {
+                bool hit = sampleInAnyRegion(test[i], &model);
+                if (test[i]->MachineFailure) hit ? tp++ : fn++;
+                else hit ? fp++ : tn++;
+            }
+            volatile int sink = 0;
+            start_timer(&t);
+            for (int r = 0; r < REGION_EVAL_REPS; r++) {
+                for (int i = 0; i < testCount; i++) sink += sampleInAnyRegion(test[i], &model);
+            }
+            double ms = stop_timer(&t);
+            (void)sink;
+
+            char label[48];
+            snprintf(label, sizeof(label), "%s (%s)", regions ? "Regioes agrupadas" : "Um ponto por falha",
+                     mode ? "tolerancia" : "exata");
+            printf("%-30s %8d %13.2f %8.1f%% %7.1f%% %8.2f%% %11.1f\n", label, model.count, learn_ms,
+                   tp + fp ? 100.0 * tp / (tp + fp) : 0.0, tp + fn ? 100.0 * tp / (tp + fn) : 0.0,
+                   100.0 * (tp + tn) / testCount, ms * 1e6 / ((double)REGION_EVAL_REPS * testCount));
+            benchRecord(trainCount, trainCount, learn_ms, "%s: aprender", label);
+            benchRecord(testCount, (long long)REGION_EVAL_REPS * testCount, ms, "%s: avaliar", label);
+        }
+    }
+    freeFailurePatternList(&model);
+    free(rows);
+    free(train);
+    free(test);
+}
+
+// --- BENCHMARK DAS ÁRVORES DE DECISÃO ---
+// Precisão/recall por alvo numa validação 80/20 dos dados carregados e vazão da inferência
+// (uma por vez com if/else x blocos sem desvios) sobre PATTERN_BENCH_SAMPLES amostras do simulador
+// e sobre linhas do CSV sorteadas com ruído.
+
+// Cronometra as duas inferências sobre as amostras e imprime uma linha para cada
+void timeFailureModel(const FailureModel* model, const MachineData* samples, const MachineData** sampleRows, int n,
+                      const char* label, unsigned char* batch, unsigned char* scalar) {
+    HighPrecisionTimer t;
+    char name[64];
+    start_timer(&t);
+    for (int i = 0; i < n; i++) scalar[i] = predictFailureModesScalar(model, &samples[i]);
+    double scalar_ms = stop_timer(&t);
+    start_timer(&t);
+    predictFailureModes(model, sampleRows, n, batch);
+    double batch_ms = stop_timer(&t);
+
+    int mismatches = 0;
+    for (int i = 0; i < n; i++) mismatches += batch[i] != scalar[i];
+    snprintf(name, sizeof(name), "%s, uma por vez (if/else)", label);
+    printf("%-34s %12.2f %12.1f %14.2f %8.2fx\n", name, scalar_ms, scalar_ms * 1e6 / n, n / (scalar_ms * 1e3), 1.0);
+    snprintf(name, sizeof(name), "%s, blocos sem desvios", label);
+    printf("%-34s %12.2f %12.1f %14.2f %8.2fx\n", name, batch_ms, batch_ms * 1e6 / n, n / (batch_ms * 1e3),
+           scalar_ms / batch_ms);
+    benchRecord(n, n, scalar_ms, "%s: uma por vez", label);
+    benchRecord(n, n, batch_ms, "%s: blocos", label);
+    if (mismatches) printf("AVISO: %d previsões divergem entre os dois caminhos!\n", mismatches);
+}
+
+void benchmark_failure_model(WorkloadBackend* store) {
+    int count;
+    const MachineData** rows = collectFilterRecords(store, NULL, &count);
+    const MachineData** train = (const MachineData**)malloc(sizeof(MachineData*) * (count + 1));
+    const MachineData** test = (const MachineData**)malloc(sizeof(MachineData*) * (count + 1));
+    MachineData* samples = (MachineData*)malloc(sizeof(MachineData) * PATTERN_BENCH_SAMPLES);
+    const MachineData** sampleRows = (const MachineData**)malloc(sizeof(MachineData*) * PATTERN_BENCH_SAMPLES);
+    unsigned char* batch = (unsigned char*)malloc(PATTERN_BENCH_SAMPLES);
+    unsigned char* scalar = (unsigned char*)malloc(PATTERN_BENCH_SAMPLES);
+    if (rows == NULL || train == NULL || test == NULL || samples == NULL || sampleRows == NULL || batch == NULL ||
+        scalar == NULL) {
+        perror("Erro ao alocar memória para o benchmark das árvores");
+        free(rows);
+        free(train);
+        free(test);
+        free(samples);
+        free(sampleRows);
+        free(batch);
+        free(scalar);
+        return;
+    }
+    int trainCount = 0, testCount = 0;
+    for (int i = 0; i < count; i++) {
+        if (i % 5 == 4) test[testCount++] = rows[i];
+        else train[trainCount++] = rows[i];
+    }
+
+    FailureModel model;
+    HighPrecisionTimer t;
+    start_timer(&t);
+    trainFailureModel(train, trainCount, &model);
+    double train_ms = stop_timer(&t);
+    printf("Treino em %d linhas: %.2f ms (profundidade %d, %d features). Validação em %d linhas:\n", trainCount,
+           train_ms, TREE_DEPTH, TREE_FEATURES, testCount);
+    benchRecord(trainCount, trainCount, train_ms, "Treino das arvores");
+    DetectionCounts counts[TREE_TARGETS];
+    evaluateFailureModel(&model, test, testCount, counts);
+    displayFailureModelEvaluation(counts);
+
+    // Vazão no fluxo do simulador, com o modelo treinado em todas as linhas
+    FailurePatternList patterns;
+    initFailurePatternList(&patterns);
+    learnFailureRegions(rows, count, &patterns);
+    trainFailureModel(rows, count, &model);
+    srand(41);
+    for (int i = 0; i < PATTERN_BENCH_SAMPLES; i++) {
+        generateSimulatedSample(&samples[i], &patterns, i + 1);
+        sampleRows[i] = &samples[i];
+    }
+
+    printf("\n%d amostras x %d árvores:\n", PATTERN_BENCH_SAMPLES, TREE_TARGETS);
+    printf("%-34s %12s %12s %14s %9s\n", "Metodo", "Tempo(ms)", "ns/amostra", "Mamostras/s", "Speedup");
+    timeFailureModel(&model, samples, sampleRows, PATTERN_BENCH_SAMPLES, "simulador", batch, scalar);
+    DetectionCounts sim = {0, 0, 0, 0};
+    for (int i = 0; i < PATTERN_BENCH_SAMPLES; i++) countDetection(&sim, batch[i] & 1, samples[i].MachineFailure);
+
+    // Linhas do CSV sorteadas com ruído: os caminhos nas árvores variam de uma amostra para outra
+    for (int i = 0; i < PATTERN_BENCH_SAMPLES; i++) {
+        samples[i] = *rows[rand() % count];
+        samples[i].AirTemp += (float)(rand() % 201 - 100) / 100.0f;
+        samples[i].ProcessTemp += (float)(rand() % 201 - 100) / 100.0f;
+        samples[i].RotationalSpeed += rand() % 101 - 50;
+        samples[i].Torque += (float)(rand() % 201 - 100) / 50.0f;
+        samples[i].ToolWear += rand() % 21 - 10;
+    }
+    timeFailureModel(&model, samples, sampleRows, PATTERN_BENCH_SAMPLES, "CSV sorteado", batch, scalar);
+    printf("Falhas injetadas no simulador: precisão %.1f%% | recall %.1f%%\n", detectionPrecision(&sim),
+           detectionRecall(&sim));
+
+    freeFailurePatternList(&patterns);
+    free(rows);
+    free(train);
+    free(test);
+    free(samples);
+    free(sampleRows);
+    free(batch);
+    free(scalar);
+}
+
+#endif // ESD_COMUM_PADROES_BENCHMARK_H
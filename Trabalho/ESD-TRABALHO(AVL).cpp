@@ -5,11 +5,52 @@
 #include <ctype.h>
 #include <math.h>
 #include <time.h>
+#include <limits.h>
+#include <stdarg.h>
+#ifdef _WIN32
 #include <windows.h>
-#include <profileapi.h>
 #include <psapi.h>
+#endif
+#include <chrono> // steady_clock: relógio portátil das medições
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h> // SSE2 para o filtro vetorizado
+#define FILTER_SSE2
+#endif
+#ifndef _WIN32
+#include <pthread.h> // Redução paralela das estatísticas
+#include <unistd.h>  // sysconf
+#include <sys/resource.h> // getrusage: pico de memória do processo
+#endif
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h> // mallinfo2: bytes em uso no heap
+#define MEMORY_MALLINFO2
+#endif
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>    // __rdtsc, __cpuid
+#else
+#include <x86intrin.h> // __rdtsc
+#include <cpuid.h>     // __get_cpuid
+#endif
+#define TIMER_RDTSC
+#endif
+#if defined(_MSC_VER) && !defined(TIMER_RDTSC)
+#include <intrin.h> // _BitScanForward64 fora de x86 (ARM64)
+#endif
+#ifdef MEMORY_COUNTING
+#include <atomic>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h> // Contadores de hardware do modo --perf
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#define PERF_COUNTERS
+#endif
+
+#include "ESD-COMUM(INSTRUMENTACAO).h"
 
 #define MAX_LINHA 2048
+#define STRUCTURE_NAME "AVL" // Nome da estrutura nos registros dos benchmarks
 
 // Estrutura de dados para MachineData (mantida igual)
 typedef struct {
@@ -29,6 +70,9 @@ typedef struct {
     bool RNF;
 } MachineData;
 
+#include "ESD-COMUM(BENCHMARK).h"
+#include "ESD-COMUM(INDICES).h"
+
 // Estrutura do nó da Árvore AVL
 typedef struct AVLNode {
     MachineData data;
@@ -38,26 +82,14 @@ typedef struct AVLNode {
     int height;             // Altura do nó
 } AVLNode;
 
-typedef struct {
-    float minAirTemp, maxAirTemp;
-    float minProcessTemp, maxProcessTemp;
-    int minRotationalSpeed, maxRotationalSpeed;
-    float minTorque, maxTorque;
-    int minToolWear, maxToolWear;
-    bool hadTWF, hadHDF, hadPWF, hadOSF, hadRNF;
-} FailurePattern;
-
-// NOVA ESTRUTURA: Lista dinâmica para armazenar múltiplos padrões de falha
-typedef struct {
-    FailurePattern* patterns;
-    int count;
-    int capacity;
-} FailurePatternList;
-
 // Estrutura da Árvore AVL
 typedef struct {
     AVLNode* root;
     int size;
+    ProductIndex* pidIndex; // ProductID -> UDIs (NULL = índice desligado)
+    BitmapIndex* bitmaps;   // Type/falhas -> UDIs (NULL = índice desligado)
+    QuantileSketches quantiles; // Percentis dos registros vivos (KLL, refeitos após remoções)
+    FailureCube cube;       // Contagens/somas por Type x modo de falha
 } AVLTree;
 
 // Funções auxiliares para Árvore AVL
@@ -258,16 +290,32 @@ AVLNode* searchAVL(AVLNode* root, int key) {
 void initAVLTree(AVLTree* tree) {
     tree->root = NULL;
     tree->size = 0;
+    tree->pidIndex = useProductIndex ? createProductIndex(0) : NULL;
+    tree->bitmaps = useBitmapIndex ? createBitmapIndex() : NULL;
+    initQuantileSketches(&tree->quantiles);
+    failureCubeInit(&tree->cube);
 }
 
 // Função para inserir na Árvore AVL (wrapper)
+// UDI repetido é ignorado (insertAVL não insere duplicatas), então size só cresce quando há inserção
 void insertAVLTree(AVLTree* tree, int key, MachineData data) {
+    if (searchAVL(tree->root, key) != NULL) return;
     tree->root = insertAVL(tree->root, key, data);
     tree->size++;
+    if (tree->pidIndex) productIndexAdd(tree->pidIndex, data.ProductID, key);
+    if (tree->bitmaps) bitmapIndexAdd(tree->bitmaps, &data, (unsigned int)key);
+    quantileSketchesAdd(&tree->quantiles, &data);
+    failureCubeAdd(&tree->cube, &data);
 }
 
 // Função para remover da Árvore AVL (wrapper)
 void deleteAVLTree(AVLTree* tree, int key) {
+    AVLNode* node = searchAVL(tree->root, key);
+    if (node == NULL) return;
+    if (tree->pidIndex) productIndexRemove(tree->pidIndex, node->data.ProductID, key);
+    if (tree->bitmaps) bitmapIndexRemove(tree->bitmaps, &node->data, (unsigned int)key);
+    failureCubeRemove(&tree->cube, &node->data);
+    quantileSketchesInvalidate(&tree->quantiles);
     tree->root = deleteAVL(tree->root, key);
     tree->size--;
 }
@@ -286,6 +334,55 @@ void freeAVLTree(AVLNode* node) {
     }
 }
 
+// Libera os nós e os índices
+void destroyAVLTree(AVLTree* tree) {
+    freeAVLTree(tree->root);
+    freeProductIndex(tree->pidIndex);
+    freeBitmapIndex(tree->bitmaps);
+    freeQuantileSketches(&tree->quantiles);
+    tree->root = NULL;
+    tree->pidIndex = NULL;
+    tree->bitmaps = NULL;
+    tree->size = 0;
+    failureCubeInit(&tree->cube);
+}
+
+void addToProductIndex(AVLNode* node, ProductIndex* idx) {
+    if (node != NULL) {
+        addToProductIndex(node->left, idx);
+        productIndexAdd(idx, node->data.ProductID, node->key);
+        addToProductIndex(node->right, idx);
+    }
+}
+
+// Liga (reconstruindo a partir da árvore) ou desliga o índice de ProductID
+void setProductIndexEnabled(AVLTree* tree, bool enabled) {
+    freeProductIndex(tree->pidIndex);
+    tree->pidIndex = NULL;
+    if (enabled) {
+        tree->pidIndex = createProductIndex(tree->size * 2);
+        addToProductIndex(tree->root, tree->pidIndex);
+    }
+}
+
+void addToBitmapIndex(AVLNode* node, BitmapIndex* bi) {
+    if (node != NULL) {
+        addToBitmapIndex(node->left, bi);
+        bitmapIndexAdd(bi, &node->data, (unsigned int)node->key);
+        addToBitmapIndex(node->right, bi);
+    }
+}
+
+// Liga (reconstruindo a partir da árvore) ou desliga os bitmaps de Type/falhas
+void setBitmapIndexEnabled(AVLTree* tree, bool enabled) {
+    freeBitmapIndex(tree->bitmaps);
+    tree->bitmaps = NULL;
+    if (enabled) {
+        tree->bitmaps = createBitmapIndex();
+        addToBitmapIndex(tree->root, tree->bitmaps);
+    }
+}
+
 // Funções auxiliares (mantidas iguais)
 void removerAspas(char* str) {
     char *src = str, *dst = str;
@@ -593,9 +690,87 @@ void searchByProductID(AVLNode* node, const char* pid) {
     }
 }
 
-// Wrapper para searchByProductID
+// Wrapper para searchByProductID (usa o índice quando ligado)
 void searchByProductIDTree(AVLTree* tree, const char* pid) {
-    searchByProductID(tree->root, pid);
+    if (tree->pidIndex == NULL) {
+        searchByProductID(tree->root, pid);
+        return;
+    }
+    ProductIndexEntry* e = productIndexFind(tree->pidIndex, pid);
+    if (e == NULL) return;
+    for (int i = 0; i < e->count; i++) {
+        AVLNode* node = searchAVL(tree->root, (int)e->refs[i]);
+        if (node != NULL) displayItem(node->data);
+    }
+}
+
+bool containsProductIDNode(AVLNode* node, const char* pid) {
+    if (node == NULL) return false;
+    if (strcmp(node->data.ProductID, pid) == 0) return true;
+    return containsProductIDNode(node->left, pid) || containsProductIDNode(node->right, pid);
+}
+
+// Existe algum registro com o ProductID? (O(1) com índice, O(n) sem)
+bool containsProductID(AVLTree* tree, const char* pid) {
+    if (tree->pidIndex) return productIndexFind(tree->pidIndex, pid) != NULL;
+    return containsProductIDNode(tree->root, pid);
+}
+
+// Registro de uma linha dos bitmaps (linha = UDI)
+MachineData* recordAtRow(AVLTree* tree, unsigned int row) {
+    AVLNode* node = searchAVL(tree->root, (int)row);
+    return node ? &node->data : NULL;
+}
+
+// Linhas de um bitmap na ordem do percurso em ordem (UDI crescente)
+unsigned int* orderedRows(AVLTree* tree, const RoaringBitmap* rows, int* count) {
+    (void)tree;
+    unsigned int* out = (unsigned int*)roaringAlloc(sizeof(unsigned int) * (roaringCardinality(rows) + 1));
+    *count = roaringToArray(rows, out);
+    return out;
+}
+
+// Exibe os registros das linhas de um bitmap
+int displayRows(AVLTree* tree, const RoaringBitmap* rows) {
+    int count;
+    unsigned int* ids = orderedRows(tree, rows, &count);
+    for (int i = 0; i < count; i++) {
+        MachineData* d = recordAtRow(tree, ids[i]);
+        if (d) displayItem(*d);
+    }
+    free(ids);
+    return count;
+}
+
+void collectRecordsInOrder(AVLNode* node, const MachineData** out, int* count) {
+    if (node != NULL) {
+        collectRecordsInOrder(node->left, out, count);
+        out[(*count)++] = &node->data;
+        collectRecordsInOrder(node->right, out, count);
+    }
+}
+
+// Registros na ordem da estrutura; com candidates, só os das linhas desse bitmap
+const MachineData** collectFilterRecords(AVLTree* tree, const RoaringBitmap* candidates, int* count) {
+    int capacity = candidates ? roaringCardinality(candidates) : tree->size;
+    const MachineData** out = (const MachineData**)malloc(sizeof(MachineData*) * (capacity + 1));
+    if (out == NULL) {
+        perror("Erro ao alocar memória para o filtro");
+        exit(EXIT_FAILURE);
+    }
+    *count = 0;
+    if (candidates == NULL) {
+        collectRecordsInOrder(tree->root, out, count);
+        return out;
+    }
+    int n;
+    unsigned int* ids = orderedRows(tree, candidates, &n);
+    for (int i = 0; i < n; i++) {
+        MachineData* d = recordAtRow(tree, ids[i]);
+        if (d) out[(*count)++] = d;
+    }
+    free(ids);
+    return out;
 }
 
 // Função para buscar por Type (percurso em ordem)
@@ -609,9 +784,17 @@ void searchByType(AVLNode* node, char type) {
     }
 }
 
-// Wrapper para searchByType
+// Wrapper para searchByType (usa os bitmaps quando ligados)
 void searchByTypeTree(AVLTree* tree, char type) {
-    searchByType(tree->root, type);
+    if (tree->bitmaps == NULL || !bitmapCoversType(type)) {
+        searchByType(tree->root, type);
+        return;
+    }
+    RoaringBitmap rows;
+    roaringInit(&rows);
+    bitmapTypeWithModes(tree->bitmaps, type, 0, &rows);
+    displayRows(tree, &rows);
+    roaringFree(&rows);
 }
 
 // Função para buscar por MachineFailure (percurso em ordem)
@@ -625,137 +808,177 @@ void searchByMachineFailure(AVLNode* node, bool f) {
     }
 }
 
-// Wrapper para searchByMachineFailure
+// Wrapper para searchByMachineFailure (com bitmaps: FAILURE ou ALL ANDNOT FAILURE)
 void searchByMachineFailureTree(AVLTree* tree, bool f) {
-    searchByMachineFailure(tree->root, f);
+    if (tree->bitmaps == NULL) {
+        searchByMachineFailure(tree->root, f);
+        return;
+    }
+    RoaringBitmap rows;
+    roaringInit(&rows);
+    bitmapFilterCandidates(tree->bitmaps, 0, f, &rows);
+    displayRows(tree, &rows);
+    roaringFree(&rows);
 }
 
-// Função para remover por ProductID (busca linear)
-bool removeByProductID(AVLTree* tree, const char* pid) {
-    // Implementação simplificada: busca linear para encontrar o UDI correspondente
-    // Pode ser ineficiente para grandes conjuntos de dados
-    
-    bool removed = false;
-    AVLNode* current = tree->root;
-    // Usaremos uma pilha para percurso in-order iterativo
-    AVLNode* stack[1000]; // Tamanho arbitrário grande
-    int top = -1;
-    
-    while (current != NULL || top != -1) {
-        while (current != NULL) {
-            stack[++top] = current;
-            current = current->left;
-        }
-        
-        current = stack[top--];
-        
-        if (strcmp(current->data.ProductID, pid) == 0) {
-            int udi = current->data.UDI;
-            current = current->right; // Avança antes de remover
-            deleteAVLTree(tree, udi);
-            removed = true;
-        } else {
-            current = current->right;
+void searchByTypeAndFailureModesNode(AVLNode* node, char type, int modeMask) {
+    if (node != NULL) {
+        searchByTypeAndFailureModesNode(node->left, type, modeMask);
+        if (recordMatchesTypeModes(&node->data, type, modeMask)) {
+            displayItem(node->data);
         }
+        searchByTypeAndFailureModesNode(node->right, type, modeMask);
     }
-    
-    return removed;
 }
 
-// Funções para estatísticas (adaptadas para AVL)
-void calculateStatistics(AVLTree* tree) {
-    if (tree->size == 0) {
-        printf("Árvore vazia. Nenhum dado para análise.\n");
+// Busca por Type com pelo menos um dos modos de falha (ex.: H com HDF ou OSF)
+void searchByTypeAndFailureModes(AVLTree* tree, char type, int modeMask) {
+    if (tree->bitmaps == NULL || !bitmapCoversType(type)) {
+        searchByTypeAndFailureModesNode(tree->root, type, modeMask);
         return;
     }
+    RoaringBitmap rows;
+    roaringInit(&rows);
+    bitmapTypeWithModes(tree->bitmaps, type, modeMask, &rows);
+    displayRows(tree, &rows);
+    roaringFree(&rows);
+}
 
-    float twSum = 0, twMax = -INFINITY, twMin = INFINITY;
-    float twSqDiffSum = 0;
-
-    float tqSum = 0, tqMax = -INFINITY, tqMin = INFINITY;
-    float tqSqDiffSum = 0;
+// Contagens de classifyFailures por varredura (sem bitmaps)
+void scanClassifyCounts(AVLNode* node, int counts[3][6]) {
+    if (node != NULL) {
+        scanClassifyCounts(node->left, counts);
+        classifyRecord(&node->data, counts);
+        scanClassifyCounts(node->right, counts);
+    }
+}
 
-    int rsSum = 0, rsMax = -INT_MAX, rsMin = INT_MAX;
-    float rsSqDiffSum = 0;
+int countTypeWithModes(AVLNode* node, char type, int modeMask) {
+    if (node == NULL) return 0;
+    return countTypeWithModes(node->left, type, modeMask) +
+           recordMatchesTypeModes(&node->data, type, modeMask) +
+           countTypeWithModes(node->right, type, modeMask);
+}
 
-    float tempDiffSum = 0, tempDiffMax = -INFINITY, tempDiffMin = INFINITY;
-    float tempDiffSqDiffSum = 0;
+void collectUDIsByProductID(AVLNode* node, const char* pid, int** udis, int* count, int* capacity) {
+    if (node == NULL) return;
+    collectUDIsByProductID(node->left, pid, udis, count, capacity);
+    if (strcmp(node->data.ProductID, pid) == 0) {
+        if (*count == *capacity) {
+            *capacity = *capacity ? *capacity * 2 : 16;
+            *udis = (int*)realloc(*udis, sizeof(int) * *capacity);
+            if (*udis == NULL) {
+                perror("Erro de alocação de memória");
+                exit(EXIT_FAILURE);
+            }
+        }
+        (*udis)[(*count)++] = node->key;
+    }
+    collectUDIsByProductID(node->right, pid, udis, count, capacity);
+}
 
-    // Percorre a árvore para calcular estatísticas
-    AVLNode* stack[1000];
-    int top = -1;
-    AVLNode* current = tree->root;
-    
-    while (current != NULL || top != -1) {
-        while (current != NULL) {
-            stack[++top] = current;
-            current = current->left;
+// Função para remover por ProductID
+// Com índice, os UDIs vêm direto da tabela hash; sem índice, são coletados num percurso
+// completo antes de remover (remover durante o percurso invalida a pilha de nós)
+bool removeByProductID(AVLTree* tree, const char* pid) {
+    if (tree->pidIndex) {
+        long long* refs;
+        int count = productIndexCopyRefs(tree->pidIndex, pid, &refs);
+        for (int i = 0; i < count; i++) {
+            deleteAVLTree(tree, (int)refs[i]);
         }
-        
-        current = stack[top--];
-        
-        // Processa o nó atual
-        twSum += current->data.ToolWear;
-        if (current->data.ToolWear > twMax) twMax = current->data.ToolWear;
-        if (current->data.ToolWear < twMin) twMin = current->data.ToolWear;
+        free(refs);
+        return count > 0;
+    }
 
-        tqSum += current->data.Torque;
-        if (current->data.Torque > tqMax) tqMax = current->data.Torque;
-        if (current->data.Torque < tqMin) tqMin = current->data.Torque;
+    int* udis = NULL;
+    int count = 0, capacity = 0;
+    collectUDIsByProductID(tree->root, pid, &udis, &count, &capacity);
+    for (int i = 0; i < count; i++) {
+        deleteAVLTree(tree, udis[i]);
+    }
+    free(udis);
+    return count > 0;
+}
 
-        rsSum += current->data.RotationalSpeed;
-        if (current->data.RotationalSpeed > rsMax) rsMax = current->data.RotationalSpeed;
-        if (current->data.RotationalSpeed < rsMin) rsMin = current->data.RotationalSpeed;
+// Quantos registros têm UDI em [lo, hi]; só desce pelas subárvores que cruzam o intervalo
+int countUDIRangeNode(AVLNode* node, int lo, int hi) {
+    if (node == NULL) return 0;
+    if (node->key < lo) return countUDIRangeNode(node->right, lo, hi);
+    if (node->key > hi) return countUDIRangeNode(node->left, lo, hi);
+    return 1 + countUDIRangeNode(node->left, lo, hi) + countUDIRangeNode(node->right, lo, hi);
+}
 
-        float diff = current->data.ProcessTemp - current->data.AirTemp;
-        tempDiffSum += diff;
-        if (diff > tempDiffMax) tempDiffMax = diff;
-        if (diff < tempDiffMin) tempDiffMin = diff;
+int countUDIRange(AVLTree* tree, int lo, int hi) {
+    return countUDIRangeNode(tree->root, lo, hi);
+}
 
-        current = current->right;
-    }
+#include "ESD-COMUM(ESTATISTICAS).h"
 
-    // Calcula médias
-    float twAvg = twSum / tree->size;
-    float tqAvg = tqSum / tree->size;
-    float rsAvg = (float)rsSum / tree->size;
-    float tempDiffAvg = tempDiffSum / tree->size;
+void accumulateStats(AVLNode* node, RunningStats* rs) {
+    if (node != NULL) {
+        accumulateStats(node->left, rs);
+        runningStatsAdd(rs, &node->data);
+        accumulateStats(node->right, rs);
+    }
+}
 
-    // Segundo percurso para calcular desvios padrão
-    current = tree->root;
-    top = -1;
-    
-    while (current != NULL || top != -1) {
-        while (current != NULL) {
-            stack[++top] = current;
-            current = current->left;
-        }
-        
-        current = stack[top--];
-        
-        twSqDiffSum += pow(current->data.ToolWear - twAvg, 2);
-        tqSqDiffSum += pow(current->data.Torque - tqAvg, 2);
-        rsSqDiffSum += pow(current->data.RotationalSpeed - rsAvg, 2);
-        float diff = current->data.ProcessTemp - current->data.AirTemp;
-        tempDiffSqDiffSum += pow(diff - tempDiffAvg, 2);
+// Sketches em dia com os registros vivos: depois de remoções, refeitos numa passada
+QuantileSketches* liveQuantiles(AVLTree* tree) {
+    if (tree->quantiles.stale) {
+        int count;
+        const MachineData** rows = collectFilterRecords(tree, NULL, &count);
+        rebuildQuantileSketches(&tree->quantiles, rows, count);
+        free(rows);
+    }
+    return &tree->quantiles;
+}
 
-        current = current->right;
+// Funções para estatísticas (adaptadas para AVL)
+void calculateStatistics(AVLTree* tree) {
+    if (tree->size == 0) {
+        printf("Árvore vazia. Nenhum dado para análise.\n");
+        return;
     }
 
-    float twStdDev = sqrt(twSqDiffSum / tree->size);
-    float tqStdDev = sqrt(tqSqDiffSum / tree->size);
-    float rsStdDev = sqrt(rsSqDiffSum / tree->size);
-    float tempDiffStdDev = sqrt(tempDiffSqDiffSum / tree->size);
+    // Uma passada (Welford); com muitos registros, blocos acumulados em paralelo e fundidos
+    RunningStats rs;
+    if (tree->size >= STATS_PARALLEL_MIN_ROWS) {
+        int count;
+        const MachineData** rows = collectFilterRecords(tree, NULL, &count);
+        runningStatsParallel(rows, count, availableCores(), &rs);
+        free(rows);
+    } else {
+        runningStatsInit(&rs);
+        accumulateStats(tree->root, &rs);
+    }
 
     printf("\n=== ESTATÍSTICAS DE OPERAÇÃO ===\n");
-    printf("\nDesgaste da Ferramenta (ToolWear):\nMédia=%.2f | Máximo=%.2f | Mínimo=%.2f | Desvio=%.2f\n",
-           twAvg, twMax, twMin, twStdDev);
-    printf("\nTorque (Nm):\nMédia=%.2f | Máximo=%.2f | Mínimo=%.2f | Desvio=%.2f\n",
-           tqAvg, tqMax, tqMin, tqStdDev);
-    printf("\nVelocidade Rotacional (RPM):\nMédia=%.2f | Máximo=%.2f | Mínimo=%.2f | Desvio=%.2f\n",
-           rsAvg, rsMax, rsMin, rsStdDev);
-    printf("\nDiferença de Temperatura (ProcessTemp - AirTemp):\nMédia=%.2f | Máximo=%.2f | Mínimo=%.2f | Desvio=%.2f\n",
-           tempDiffAvg, tempDiffMax, tempDiffMin, tempDiffStdDev);
+    for (int m = 0; m < STAT_METRICS; m++) {
+        printf("\n%s:\nMédia=%.2f | Máximo=%.2f | Mínimo=%.2f | Desvio=%.2f\n",
+               statMetricTitles[m], rs.mean[m], rs.max[m], rs.min[m], runningStatsStdDev(&rs, m));
+    }
+
+    printf("\nPercentis dos registros (sketches KLL, erro de rank ~1,65%%):\n");
+    displayQuantiles(liveQuantiles(tree), statMetricTitles);
+}
+
+// Modo batch: "--check-quantiles [ProductID]" remove o ProductID dado (sem ele, os de todos os
+// registros com ToolWear acima da mediana) e confere os percentis dos sketches com os exatos
+// dos registros restantes. Sai com 1 se algo não confere.
+int checkQuantilesAfterRemoval(AVLTree* tree, int argc, char* argv[]) {
+    int count, victims;
+    const MachineData** rows = collectFilterRecords(tree, NULL, &count);
+    MachineData* removed = selectQuantileCheckVictims(rows, count, argc > 2 ? argv[2] : NULL, &victims);
+    free(rows);
+    if (removed == NULL) return 1;
+    for (int i = 0; i < victims; i++) removeByProductID(tree, removed[i].ProductID);
+    free(removed);
+    rows = collectFilterRecords(tree, NULL, &count);
+    printf("%d ProductID(s) removido(s), %d registros restantes\n", victims, count);
+    int failures = victims == 0 ? 1 : checkQuantileSketches(liveQuantiles(tree), rows, count, statMetricTitles);
+    free(rows);
+    return failures ? 1 : 0;
 }
 
 // Função para classificar falhas (adaptada para AVL)
@@ -777,52 +1000,18 @@ void classifyFailures(AVLTree* tree) {
     TypeStats stats[3] = {0}; // 0: L, 1: M, 2: H
     int totalFailures[5] = {0}; // TWF, HDF, PWF, OSF, RNF
 
-    // Percorre a árvore para coletar estatísticas
-    AVLNode* stack[1000];
-    int top = -1;
-    AVLNode* current = tree->root;
-    
-    while (current != NULL || top != -1) {
-        while (current != NULL) {
-            stack[++top] = current;
-            current = current->left;
-        }
-        
-        current = stack[top--];
-        
-        int typeIndex = -1;
-        switch (toupper(current->data.Type)) {
-            case 'L': typeIndex = 0; break;
-            case 'M': typeIndex = 1; break;
-            case 'H': typeIndex = 2; break;
-        }
-
-        if (typeIndex != -1) {
-            stats[typeIndex].total++;
-
-            if (current->data.TWF) {
-                stats[typeIndex].twf++;
-                totalFailures[0]++;
-            }
-            if (current->data.HDF) {
-                stats[typeIndex].hdf++;
-                totalFailures[1]++;
-            }
-            if (current->data.PWF) {
-                stats[typeIndex].pwf++;
-                totalFailures[2]++;
-            }
-            if (current->data.OSF) {
-                stats[typeIndex].osf++;
-                totalFailures[3]++;
-            }
-            if (current->data.RNF) {
-                stats[typeIndex].rnf++;
-                totalFailures[4]++;
-            }
-        }
-
-        current = current->right;
+    // Contagens lidas do cubo mantido na inserção/remoção: O(1), sem percorrer a estrutura
+    int counts[3][6];
+    failureCubeCounts(&tree->cube, counts);
+
+    for (int t = 0; t < 3; t++) {
+        stats[t].total = counts[t][0];
+        stats[t].twf = counts[t][1];
+        stats[t].hdf = counts[t][2];
+        stats[t].pwf = counts[t][3];
+        stats[t].osf = counts[t][4];
+        stats[t].rnf = counts[t][5];
+        for (int m = 0; m < 5; m++) totalFailures[m] += counts[t][m + 1];
     }
 
     printf("\n=== CLASSIFICAÇÃO DE FALHAS POR TIPO DE MÁQUINA ===\n");
@@ -867,6 +1056,8 @@ void classifyFailures(AVLTree* tree) {
     printf("PWF: %d ocorrências\n", totalFailures[2]);
     printf("OSF: %d ocorrências\n", totalFailures[3]);
     printf("RNF: %d ocorrências\n", totalFailures[4]);
+
+    displayFailureCubeAverages(&tree->cube);
 }
 
 // Função para filtro avançado (adaptada para AVL)
@@ -908,73 +1099,37 @@ void advancedFilter(AVLTree* tree) {
             criteria[5] = 1;
             hasFailureFilter = true;
             printf("Filtrar por máquinas com falha? (1-Sim, 0-Não): ");
-            scanf("%d", &failureFilter);
+            int failureValue = 0;
+            scanf("%d", &failureValue);
+            failureFilter = failureValue != 0;
         }
     } while (choice != 0);
 
     printf("\nResultados do Filtro:\n");
-    int matches = 0;
-    
-    // Percorre a árvore
-    AVLNode* stack[1000];
-    int top = -1;
-    AVLNode* current = tree->root;
-    
-    while (current != NULL || top != -1) {
-        while (current != NULL) {
-            stack[++top] = current;
-            current = current->left;
-        }
-        
-        current = stack[top--];
-        
-        bool match = true;
-
-        if (criteria[0] && (current->data.ToolWear < minVal[0] || current->data.ToolWear > maxVal[0])) {
-            match = false;
-        }
-        if (match && criteria[1] && (current->data.Torque < minVal[1] || current->data.Torque > maxVal[1])) {
-            match = false;
-        }
-        if (match && criteria[2] && (current->data.RotationalSpeed < minVal[2] || current->data.RotationalSpeed > maxVal[2])) {
-            match = false;
-        }
-        if (match && criteria[3]) {
-            float tempDiff = current->data.ProcessTemp - current->data.AirTemp;
-            if (tempDiff < minVal[3] || tempDiff > maxVal[3]) {
-                match = false;
-            }
-        }
-        if (match && criteria[4] && toupper(current->data.Type) != typeFilter) {
-            match = false;
-        }
-        if (match && criteria[5] && current->data.MachineFailure != failureFilter) {
-            match = false;
-        }
-
-        if (match) {
-            printf("UDI: %d | ProductID: %s | Type: %c | ",
-                   current->data.UDI, current->data.ProductID, current->data.Type);
-
-            if (criteria[0])
-                printf("ToolWear: %d | ", current->data.ToolWear);
-            if (criteria[1])
-                printf("Torque: %.1f | ", current->data.Torque);
-            if (criteria[2])
-                printf("RPM: %d | ", current->data.RotationalSpeed);
-            if (criteria[3]) {
-                float tempDiff = current->data.ProcessTemp - current->data.AirTemp;
-                printf("TempDiff: %.1f | ", tempDiff);
-            }
-            if (criteria[5])
-                printf("Failure: %d | ", current->data.MachineFailure);
 
-            printf("\n");
-            matches++;
-        }
-
-        current = current->right;
+    FilterPlan plan = buildFilterPlan(criteria, minVal, maxVal, typeFilter, failureFilter);
+    RoaringBitmap candidates;
+    roaringInit(&candidates);
+    bool useBitmaps = tree->bitmaps && (plan.byType || plan.byFailure) && (!plan.byType || bitmapCoversType(typeFilter));
+    if (useBitmaps) {
+        // Type e falha saem dos bitmaps; o plano fica só com os intervalos numéricos
+        bitmapFilterCandidates(tree->bitmaps, plan.byType ? typeFilter : 0, plan.byFailure ? failureFilter : -1, &candidates);
+        plan.byType = false;
+        plan.byFailure = false;
     }
+    int count;
+    const MachineData** rows = collectFilterRecords(tree, useBitmaps ? &candidates : NULL, &count);
+    roaringFree(&candidates);
+    int matches;
+    if (plan.rangeCount + plan.byType + plan.byFailure >= FILTER_PLAN_MIN_PREDICATES) {
+        matches = runFilterPlan(&plan, rows, count, rows);
+    } else {
+        // Poucos predicados: o kernel especializado dispensa a transposição em colunas
+        int active[6] = {criteria[0], criteria[1], criteria[2], criteria[3], plan.byType, plan.byFailure};
+        matches = selectFilterKernel(active)(rows, count, minVal, maxVal, typeFilter, failureFilter, rows);
+    }
+    writeFilterMatches(rows, matches, criteria);
+    free(rows);
 
     printf("\nTotal de máquinas que atendem aos critérios: %d\n", matches);
 }
@@ -995,28 +1150,67 @@ void displayMenu() {
     printf("11. Executar Restrições\n");
     printf("12. Aprender Padrões de Falha\n");        // NOVA OPÇÃO
     printf("13. Simular Fresadora e Detectar Falhas\n"); // NOVA OPÇÃO
-    printf("14. Sair\n");                               // Opção de saída atualizada
+    printf("14. Histogramas e Correlações\n");
+    printf("15. Sair\n");                               // Opção de saída atualizada
     printf("Escolha: ");
 }
 
-// Funções de benchmark adaptadas para AVL
-// Timer de alta precisão
-typedef struct {
-    LARGE_INTEGER start;
-    LARGE_INTEGER end;
-    LARGE_INTEGER frequency;
-} HighPrecisionTimer;
-
-// Funções do timer de alta precisão
-void start_timer(HighPrecisionTimer* timer) {
-    QueryPerformanceFrequency(&timer->frequency);
-    QueryPerformanceCounter(&timer->start);
+// Histogramas e correlações por modo de falha numa passada (opção do menu)
+void sensorAnalytics(AVLTree* tree) {
+    if (tree->size == 0) {
+        printf("Árvore vazia. Nenhum dado para análise.\n");
+        return;
+    }
+    AnalyticsConfig cfg;
+    readAnalyticsConfig(&cfg);
+    int count;
+    const MachineData** rows = collectFilterRecords(tree, NULL, &count);
+    SensorAnalytics* a = (SensorAnalytics*)malloc(sizeof(SensorAnalytics));
+    if (a == NULL) {
+        perror("Erro ao alocar memória para a análise dos sensores");
+        free(rows);
+        return;
+    }
+    int threads = count >= STATS_PARALLEL_MIN_ROWS ? availableCores() : 1;
+    HighPrecisionTimer t;
+    start_timer(&t);
+    runSensorAnalytics(rows, count, &cfg, threads, a);
+    double ms = stop_timer(&t);
+    displaySensorAnalytics(a);
+    printf("\nPassada única sobre %d registros: %.3f ms (%d thread(s), %s)\n", count, ms, threads, ANALYTICS_SIMD_NAME);
+
+    char input[16];
+    printf("Gravar também em CSV (%s_*.csv)? (s/n): ", ANALYTICS_DEFAULT_PREFIX);
+    if (fgets(input, sizeof(input), stdin) && toupper((unsigned char)input[0]) == 'S')
+        writeSensorAnalyticsCSV(a, ANALYTICS_DEFAULT_PREFIX);
+    free(a);
+    free(rows);
 }
 
-double stop_timer(HighPrecisionTimer* timer) {
-    QueryPerformanceCounter(&timer->end);
-    double elapsed = (double)(timer->end.QuadPart - timer->start.QuadPart) * 1000.0 / timer->frequency.QuadPart;
-    return elapsed;
+// Modo batch: "--analytics [faixas] [prefixo]" grava os CSVs com as faixas padrão, sem menu
+int batchSensorAnalytics(AVLTree* tree, int argc, char* argv[]) {
+    int bins = argc > 2 && atoi(argv[2]) > 0 ? atoi(argv[2]) : HIST_DEFAULT_BINS;
+    const char* prefix = argc > 3 ? argv[3] : ANALYTICS_DEFAULT_PREFIX;
+    AnalyticsConfig cfg;
+    analyticsDefaultConfig(&cfg, bins);
+    int count;
+    const MachineData** rows = collectFilterRecords(tree, NULL, &count);
+    SensorAnalytics* a = (SensorAnalytics*)malloc(sizeof(SensorAnalytics));
+    if (a == NULL) {
+        perror("Erro ao alocar memória para a análise dos sensores");
+        free(rows);
+        return 1;
+    }
+    int threads = count >= STATS_PARALLEL_MIN_ROWS ? availableCores() : 1;
+    HighPrecisionTimer t;
+    start_timer(&t);
+    runSensorAnalytics(rows, count, &cfg, threads, a);
+    double ms = stop_timer(&t);
+    printf("Análise de %d registros: %.3f ms (%d thread(s), %s)\n", count, ms, threads, ANALYTICS_SIMD_NAME);
+    int status = writeSensorAnalyticsCSV(a, prefix);
+    free(a);
+    free(rows);
+    return status;
 }
 
 void generateRandomData(AVLTree* tree, int count) {
@@ -1043,26 +1237,44 @@ void generateRandomData(AVLTree* tree, int count) {
 
 void benchmark_insertion(AVLTree* tree, int num_elements) {
     HighPrecisionTimer t;
+    HwCounters hw;
+    hwCountersStart(&hw);
     start_timer(&t);
     AVLTree tmp;
     initAVLTree(&tmp);
     generateRandomData(&tmp, num_elements);
     double elapsed = stop_timer(&t);
+    hwCountersStop(&hw);
     printf("\nBenchmark Inserção (%d elementos): %.3f ms (%.1f elem/ms)\n",
            num_elements, elapsed, num_elements / elapsed);
-    freeAVLTree(tmp.root);
+    benchRecord(num_elements, num_elements, elapsed, "Insercao");
+    printHwCounters(&hw, num_elements);
+    destroyAVLTree(&tmp);
 }
 
-void benchmark_search(AVLTree* tree) {
-    if (tree->size == 0) {
-        printf("Árvore vazia para busca\n");
-        return;
-    }
-    HighPrecisionTimer t;
-    const int searches = 10000;
-    int found = 0;
-    
-    // Encontra o menor e maior UDI para o intervalo de busca
+typedef struct {
+    AVLTree* tree;
+    int minUDI, maxUDI;
+    long long hits;    // Encontrados (ou soma dos UDIs): evita que as buscas sejam descartadas
+} SearchBench;
+
+int benchSearchOp(void* ctx, int) {
+    SearchBench* b = (SearchBench*)ctx;
+    int search_udi = b->minUDI + (rand() % (b->maxUDI - b->minUDI + 1));
+    if (searchAVLTree(b->tree, search_udi) != NULL) b->hits++;
+    return 0;
+}
+
+int benchAccessOp(void* ctx, int) {
+    SearchBench* b = (SearchBench*)ctx;
+    int random_udi = b->minUDI + (rand() % (b->maxUDI - b->minUDI + 1));
+    AVLNode* found = searchAVLTree(b->tree, random_udi);
+    if (found != NULL) b->hits += found->data.UDI;
+    return 0;
+}
+
+// Menor e maior UDI da árvore (intervalo das buscas)
+void treeUDIRange(AVLTree* tree, int* minUDI, int* maxUDI) {
     AVLNode* minNode = tree->root;
     while (minNode != NULL && minNode->left != NULL) {
         minNode = minNode->left;
@@ -1071,20 +1283,26 @@ void benchmark_search(AVLTree* tree) {
     while (maxNode != NULL && maxNode->right != NULL) {
         maxNode = maxNode->right;
     }
-    
-    int minUDI = minNode ? minNode->key : 0;
-    int maxUDI = maxNode ? maxNode->key : 0;
-    
-    start_timer(&t);
-    for (int i = 0; i < searches; i++) {
-        int search_udi = minUDI + (rand() % (maxUDI - minUDI + 1));
-        if (searchAVLTree(tree, search_udi) != NULL) {
-            found++;
-        }
+    *minUDI = minNode ? minNode->key : 0;
+    *maxUDI = maxNode ? maxNode->key : 0;
+}
+
+void benchmark_search(AVLTree* tree) {
+    if (tree->size == 0) {
+        printf("Árvore vazia para busca\n");
+        return;
     }
-    double elapsed = stop_timer(&t);
-    printf("\nBenchmark Busca (%d ops): encontrados=%d | tempo=%.3f ms (%.1f ops/ms)\n",
-           searches, found, elapsed, searches / elapsed);
+    SearchBench b = {tree, 0, 0, 0};
+    treeUDIRange(tree, &b.minUDI, &b.maxUDI);
+    BenchScenario s = {"Busca por UDI", 10000, &b, NULL, benchSearchOp, NULL, 1, {NULL}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("\nBenchmark Busca (%d ops x %d rodadas, %d de aquecimento): encontrados=%.1f%%\n", s.opsPerRun,
+           r.runs, BENCH_WARMUP_RUNS, 100.0 * b.hits / ((double)s.opsPerRun * (BENCH_WARMUP_RUNS + BENCH_RUNS)));
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchScenarioCounters(&s);
+    benchRecordResult(&s, &r, tree->size);
 }
 
 void benchmark_removal(AVLTree* tree) {
@@ -1138,7 +1356,8 @@ void benchmark_removal(AVLTree* tree) {
     double elapsed = stop_timer(&t);
     printf("\nBenchmark Remoção (%d ops): %.3f ms (%.1f ops/ms)\n",
            removals, elapsed, removals / elapsed);
-    freeAVLTree(tmp.root);
+    benchRecord(tree->size, removals, elapsed, "Remocao");
+    destroyAVLTree(&tmp);
 }
 
 size_t calculate_node_size() {
@@ -1180,6 +1399,14 @@ void estimate_memory_usage(AVLTree* tree) {
     printf("Número de nós: %d\n", tree->size);
     printf("Memória total estimada: %zu bytes (%.2f KB)\n",
            total_memory, (float)total_memory / 1024);
+    if (tree->pidIndex) {
+        size_t index_memory = productIndexMemory(tree->pidIndex);
+        printf("Índice por ProductID: %zu bytes (%.2f KB)\n", index_memory, (float)index_memory / 1024);
+    }
+    if (tree->bitmaps) {
+        size_t bitmap_memory = bitmapIndexMemory(tree->bitmaps);
+        printf("Bitmaps de Type/falhas: %zu bytes (%.2f KB)\n", bitmap_memory, (float)bitmap_memory / 1024);
+    }
 
     printf("\nComparação com sizeof:\n");
     printf("sizeof(MachineData): %zu bytes\n", sizeof(MachineData));
@@ -1187,41 +1414,42 @@ void estimate_memory_usage(AVLTree* tree) {
     printf("Obs: Pode haver padding/alignment pelo compilador\n");
 }
 
+// Memória medida: monta do zero uma estrutura com o mesmo número de registros (dados aleatórios)
+// e mede o heap e o residente antes e depois; o resultado inclui cabeçalhos e sobras do malloc
+void measure_memory_usage(AVLTree* tree) {
+    int n = tree->size > 0 ? tree->size : 10000;
+    MemorySnapshot before;
+    memoryProbeStart(&before);
+    AVLTree tmp;
+    initAVLTree(&tmp);
+    generateRandomData(&tmp, n);
+    MemorySnapshot built;
+    memorySnapshot(&built);
+    printf("\n=== USO DE MEMÓRIA MEDIDO (%s) ===\n", memoryHeapSource());
+    printf("Registros montados: %d\n", tmp.size);
+    printMemoryDelta("Montagem", &before);
+    benchRecordBytes(n, memoryDeltaBytes(&before, &built), "Memoria medida (montagem)");
+    if (built.heapBytes >= 0 && tmp.size > 0)
+        printf("Heap por registro: %.1f bytes (sizeof(MachineData): %zu)\n",
+               (double)(built.heapBytes - before.heapBytes) / tmp.size, sizeof(MachineData));
+    destroyAVLTree(&tmp);
+}
+
 void benchmark_random_access(AVLTree* tree) {
     if (tree->size == 0) {
         printf("Árvore vazia para teste de acesso aleatório\n");
         return;
     }
-
-    const int accesses = 10000;
-    HighPrecisionTimer t;
-    int sum = 0;
-
-    // Encontra o menor e maior UDI para o intervalo de acesso
-    AVLNode* minNode = tree->root;
-    while (minNode != NULL && minNode->left != NULL) {
-        minNode = minNode->left;
-    }
-    AVLNode* maxNode = tree->root;
-    while (maxNode != NULL && maxNode->right != NULL) {
-        maxNode = maxNode->right;
-    }
-    
-    int minUDI = minNode ? minNode->key : 0;
-    int maxUDI = maxNode ? maxNode->key : 0;
-
-    start_timer(&t);
-    for (int i = 0; i < accesses; i++) {
-        int random_udi = minUDI + (rand() % (maxUDI - minUDI + 1));
-        AVLNode* found = searchAVLTree(tree, random_udi);
-        if (found != NULL) {
-            sum += found->data.UDI;
-        }
-    }
-    double elapsed = stop_timer(&t);
-
-    printf("Benchmark Acesso Aleatório (%d acessos): %.3f ms (%.1f acessos/ms)\n",
-           accesses, elapsed, accesses / elapsed);
+    SearchBench b = {tree, 0, 0, 0};
+    treeUDIRange(tree, &b.minUDI, &b.maxUDI);
+    BenchScenario s = {"Acesso aleatorio", 10000, &b, NULL, benchAccessOp, NULL, 1, {NULL}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("Benchmark Acesso Aleatório (%d acessos x %d rodadas):\n", s.opsPerRun, r.runs);
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchScenarioCounters(&s);
+    benchRecordResult(&s, &r, tree->size);
 }
 
 void benchmark_scalability() {
@@ -1240,79 +1468,376 @@ void benchmark_scalability() {
 
         printf("Tamanho: %6d elementos | Tempo de inserção: %7.3f ms | Tempo por elemento: %.5f ms\n",
                sizes[i], elapsed, elapsed / sizes[i]);
+        benchRecord(sizes[i], sizes[i], elapsed, "Escalabilidade: insercao");
 
-        freeAVLTree(tree.root);
+        destroyAVLTree(&tree);
     }
 }
 
-void benchmark_combined_operations(AVLTree* tree) {
-    const int num_operations = 1000;
-    HighPrecisionTimer t;
-    start_timer(&t);
+// Mistura de operações sobre uma árvore nova de 1000 registros a cada rodada
+typedef struct {
+    AVLTree tree;
+    int minUDI, maxUDI;
+} MixBench;
+
+void benchMixSetup(void* ctx) {
+    MixBench* b = (MixBench*)ctx;
+    initAVLTree(&b->tree);
+    generateRandomData(&b->tree, 1000);
+    treeUDIRange(&b->tree, &b->minUDI, &b->maxUDI);
+}
 
-    // Encontra o menor e maior UDI para o intervalo de operações
-    AVLNode* minNode = tree->root;
-    while (minNode != NULL && minNode->left != NULL) {
-        minNode = minNode->left;
+// 30% inserção; dos 70% restantes, 80% busca e 20% remoção (56% e 14% do total)
+int benchMixOp(void* ctx, int i) {
+    MixBench* b = (MixBench*)ctx;
+    if (rand() % 100 < 30) {
+        // Inserção
+        MachineData d = {0};
+        d.UDI = b->maxUDI + 1 + i; // Novo UDI único
+        snprintf(d.ProductID, sizeof(d.ProductID), "M%07d", rand() % 1000000);
+        insertAVLTree(&b->tree, d.UDI, d);
+        b->maxUDI = d.UDI; // Atualiza o máximo
+        return 0;
+    } else if (rand() % 100 < 80) {
+        // Busca
+        int search_udi = b->minUDI + (rand() % (b->maxUDI - b->minUDI + 1));
+        searchAVLTree(&b->tree, search_udi);
+        return 1;
     }
-    AVLNode* maxNode = tree->root;
-    while (maxNode != NULL && maxNode->right != NULL) {
-        maxNode = maxNode->right;
+    // Remoção (apenas se houver elementos)
+    if (b->tree.size > 0) {
+        int remove_udi = b->minUDI + (rand() % (b->maxUDI - b->minUDI + 1));
+        deleteAVLTree(&b->tree, remove_udi);
     }
-    
-    int minUDI = minNode ? minNode->key : 0;
-    int maxUDI = maxNode ? maxNode->key : 0;
+    return 2;
+}
+
+void benchMixTeardown(void* ctx) {
+    destroyAVLTree(&((MixBench*)ctx)->tree);
+}
 
-    for (int i = 0; i < num_operations; i++) {
-        if (rand() % 100 < 30) {
-            // Inserção
-            MachineData d = {0};
-            d.UDI = maxUDI + 1 + i; // Novo UDI único
-            snprintf(d.ProductID, sizeof(d.ProductID), "M%07d", rand() % 1000000);
-            insertAVLTree(tree, d.UDI, d);
-            maxUDI = d.UDI; // Atualiza o máximo
-        } else if (rand() % 100 < 80) {
-            // Busca
-            int search_udi = minUDI + (rand() % (maxUDI - minUDI + 1));
-            searchAVLTree(tree, search_udi);
+void benchmark_combined_operations() {
+    MixBench b;
+    BenchScenario s = {"Operacoes combinadas", 1000, &b, benchMixSetup, benchMixOp, benchMixTeardown,
+                       3, {"Insercao", "Busca", "Remocao"}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("Benchmark Operações Combinadas (%d ops x %d rodadas, árvore nova de 1000 registros por rodada):\n",
+           s.opsPerRun, r.runs);
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchRecordResult(&s, &r, 1000);
+}
+
+// Coleta até max ProductIDs existentes para montar consultas com acerto
+void collectProductIDs(AVLNode* node, char (*pids)[10], int* count, int max) {
+    if (node == NULL || *count >= max) return;
+    collectProductIDs(node->left, pids, count, max);
+    if (*count < max) {
+        strcpy(pids[(*count)++], node->data.ProductID);
+    }
+    collectProductIDs(node->right, pids, count, max);
+}
+
+// Consultas determinísticas (metade existentes, metade ausentes) para comparar índice ligado x desligado
+char (*buildProductIDQueries(AVLTree* tree, int num_queries))[10] {
+    char (*queries)[10] = (char (*)[10])malloc(sizeof(*queries) * num_queries);
+    char (*existing)[10] = (char (*)[10])malloc(sizeof(*existing) * num_queries);
+    if (queries == NULL || existing == NULL) {
+        perror("Erro de alocação de memória");
+        exit(EXIT_FAILURE);
+    }
+    int n = 0;
+    collectProductIDs(tree->root, existing, &n, num_queries);
+    srand(31);
+    for (int i = 0; i < num_queries; i++) {
+        if (n > 0 && i % 2 == 0) {
+            strcpy(queries[i], existing[rand() % n]);
         } else {
-            // Remoção (apenas se houver elementos)
-            if (tree->size > 0) {
-                int remove_udi = minUDI + (rand() % (maxUDI - minUDI + 1));
-                deleteAVLTree(tree, remove_udi);
-            }
+            snprintf(queries[i], sizeof(queries[i]), "X%07d", rand() % 1000000);
         }
     }
+    free(existing);
+    return queries;
+}
+
+void copyAVLNodes(AVLNode* node, AVLTree* dst) {
+    if (node != NULL) {
+        copyAVLNodes(node->left, dst);
+        insertAVLTree(dst, node->key, node->data);
+        copyAVLNodes(node->right, dst);
+    }
+}
+
+double benchmark_search_product_id(AVLTree* tree) {
+    const int searches = 10000;
+    char (*queries)[10] = buildProductIDQueries(tree, searches);
+    HighPrecisionTimer t;
+    int found = 0;
+
+    start_timer(&t);
+    for (int i = 0; i < searches; i++) {
+        if (containsProductID(tree, queries[i])) found++;
+    }
+    double elapsed = stop_timer(&t);
+    printf("Busca por ProductID (%d ops): encontrados=%d | tempo=%.3f ms (%.1f ops/ms)\n",
+           searches, found, elapsed, searches / elapsed);
+    benchRecord(tree->size, searches, elapsed, "Busca por ProductID (indice %s)", useProductIndex ? "ligado" : "desligado");
+    free(queries);
+    return elapsed;
+}
+
+double benchmark_removal_product_id(AVLTree* tree) {
+    const int removals = 1000;
+    char (*queries)[10] = buildProductIDQueries(tree, removals);
+    AVLTree tmp;
+    initAVLTree(&tmp);
+    copyAVLNodes(tree->root, &tmp);
 
+    HighPrecisionTimer t;
+    int removed = 0;
+    start_timer(&t);
+    for (int i = 0; i < removals; i++) {
+        if (removeByProductID(&tmp, queries[i])) removed++;
+    }
     double elapsed = stop_timer(&t);
-    printf("Benchmark Operações Combinadas (%d ops): %.3f ms | Latência média: %.3f ms/op\n",
-           num_operations, elapsed, elapsed / num_operations);
+    printf("Remoção por ProductID (%d ops): removidos=%d | tempo=%.3f ms (%.1f ops/ms)\n",
+           removals, removed, elapsed, removals / elapsed);
+    benchRecord(tree->size, removals, elapsed, "Remocao por ProductID (indice %s)", useProductIndex ? "ligado" : "desligado");
+    destroyAVLTree(&tmp);
+    free(queries);
+    return elapsed;
+}
+
+// Repete inserção e busca/remoção por ProductID com o índice desligado e ligado
+void benchmark_product_index(AVLTree* tree) {
+    bool saved = useProductIndex;
+    double search_ms[2], removal_ms[2];
+    for (int on = 0; on <= 1; on++) {
+        useProductIndex = on;
+        setProductIndexEnabled(tree, on);
+        printf("\n--- Índice por ProductID %s ---", on ? "LIGADO" : "DESLIGADO");
+        benchmark_insertion(tree, 10000);
+        search_ms[on] = benchmark_search_product_id(tree);
+        removal_ms[on] = benchmark_removal_product_id(tree);
+    }
+    useProductIndex = saved;
+    setProductIndexEnabled(tree, saved);
+    printf("\nSpeedup com índice: busca %.1fx | remoção %.1fx\n",
+           search_ms[0] / search_ms[1], removal_ms[0] / removal_ms[1]);
 }
 
+// classifyFailures e a consulta "Type H com HDF ou OSF": varredura x operações nos bitmaps
+void benchmark_bitmap_index(AVLTree* tree) {
+    if (tree->bitmaps == NULL) setBitmapIndexEnabled(tree, true);
+    const int reps = 100;
+    const int modes = parseFailureModes("HDF,OSF");
+    int scan_counts[3][6], bitmap_counts[3][6];
+    int scan_matches = 0, bitmap_matches = 0;
+    HighPrecisionTimer t;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        memset(scan_counts, 0, sizeof(scan_counts));
+        scanClassifyCounts(tree->root, scan_counts);
+    }
+    double scan_classify = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) bitmapClassifyCounts(tree->bitmaps, bitmap_counts);
+    double bitmap_classify = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) scan_matches = countTypeWithModes(tree->root, 'H', modes);
+    double scan_query = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapTypeWithModes(tree->bitmaps, 'H', modes, &rows);
+        bitmap_matches = roaringCardinality(&rows);
+        roaringFree(&rows);
+    }
+    double bitmap_query = stop_timer(&t) / reps;
+
+    int cube_counts[3][6];
+    const int cube_reps = 100000;
+    volatile int cube_sink = 0;
+    start_timer(&t);
+    for (int r = 0; r < cube_reps; r++) {
+        failureCubeCounts(&tree->cube, cube_counts);
+        cube_sink += cube_counts[r % 3][0];
+    }
+    double cube_classify = stop_timer(&t) / cube_reps;
+
+    if (memcmp(scan_counts, bitmap_counts, sizeof(scan_counts)) != 0 || scan_matches != bitmap_matches)
+        printf("AVISO: bitmaps divergem da varredura!\n");
+    if (memcmp(scan_counts, cube_counts, sizeof(scan_counts)) != 0)
+        printf("AVISO: cubo de agregados diverge da varredura!\n");
+    printf("Classificação de falhas: varredura %.4f ms | popcount %.4f ms | speedup %.1fx\n",
+           scan_classify, bitmap_classify, scan_classify / bitmap_classify);
+    printf("Classificação pelo cubo incremental: %.6f ms | speedup %.0fx sobre a varredura\n",
+           cube_classify, scan_classify / cube_classify);
+    printf("Type H com HDF ou OSF (%d registros): varredura %.4f ms | bitmaps %.4f ms | speedup %.1fx\n",
+           bitmap_matches, scan_query, bitmap_query, scan_query / bitmap_query);
+    size_t bitmap_memory = bitmapIndexMemory(tree->bitmaps);
+    printf("Memória dos bitmaps: %zu bytes (%.2f KB)\n", bitmap_memory, (float)bitmap_memory / 1024);
+    benchRecord(tree->size, reps, scan_classify * reps, "Classificacao: varredura");
+    benchRecord(tree->size, reps, bitmap_classify * reps, "Classificacao: popcount");
+    benchRecord(tree->size, cube_reps, cube_classify * cube_reps, "Classificacao: cubo incremental");
+    benchRecord(tree->size, reps, scan_query * reps, "Type H com HDF ou OSF: varredura");
+    benchRecord(tree->size, reps, bitmap_query * reps, "Type H com HDF ou OSF: bitmaps");
+    benchRecordBytes(tree->size, (long long)bitmap_memory, "Memoria dos bitmaps");
+}
+
+// Filtro avançado sem a saída: laço escalar com um if por critério x plano vetorizado
+void benchmark_filter_engine(AVLTree* tree) {
+    const int criteria[6] = {1, 1, 1, 1, 0, 1};
+    const float minVal[4] = {0, 30, 1400, 8};
+    const float maxVal[4] = {110, 45, 1550, 10.5f};
+    const int reps = 100;
+    int count;
+    const MachineData** rows = collectFilterRecords(tree, NULL, &count);
+    const MachineData** selected = (const MachineData**)malloc(sizeof(MachineData*) * (count + 1));
+    if (selected == NULL) {
+        perror("Erro ao alocar memória para o benchmark do filtro");
+        free(rows);
+        return;
+    }
+    FilterPlan plan = buildFilterPlan(criteria, minVal, maxVal, 0, false);
+    int scalar_matches = 0, engine_matches = 0;
+    HighPrecisionTimer t;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        scalar_matches = 0;
+        for (int i = 0; i < count; i++) {
+            scalar_matches += filterMatchesRecord(rows[i], criteria, minVal, maxVal, 0, false);
+        }
+    }
+    double scalar_ms = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) engine_matches = runFilterPlan(&plan, rows, count, selected);
+    double engine_ms = stop_timer(&t) / reps;
+
+    if (scalar_matches != engine_matches)
+        printf("AVISO: plano vetorizado diverge do laço escalar!\n");
+    printf("5 critérios sobre %d registros (%d aprovados)\n", count, engine_matches);
+    printf("Laço escalar: %.4f ms | Plano vetorizado: %.4f ms | speedup %.1fx\n",
+           scalar_ms, engine_ms, scalar_ms / engine_ms);
+    benchRecord(count, (long long)count * reps, scalar_ms * reps, "Filtro: laco escalar");
+    benchRecord(count, (long long)count * reps, engine_ms * reps, "Filtro: plano vetorizado");
+    free(rows);
+    free(selected);
+}
+
+// Definido junto da simulação da fresadora, depois dos padrões de falha
+void benchmark_pattern_index(AVLTree* tree);
+void benchmark_failure_regions(AVLTree* tree);
+void benchmark_failure_model(AVLTree* tree);
+void benchmark_fleet_simulation(AVLTree* tree);
+
 void run_all_benchmarks(AVLTree* tree) {
     printf("\n=== INICIANDO BENCHMARKS COMPLETOS ===\n");
+    benchLogReset("");
+    printf("Relógio: %s (%.0f MHz) | memória: residente medida, heap por %s\n", timerSourceName(),
+           timerFrequency() / 1e6, memoryHeapSource());
+    MemorySnapshot mem;
 
-    printf("\n1. Tempo de Inserção:\n");
+    benchSection("1. Tempo de Inserção");
+    memoryProbeStart(&mem);
     benchmark_insertion(tree, 1000);
     benchmark_insertion(tree, 10000);
 
-    printf("\n2. Tempo de Remoção:\n");
+    benchMemoryDelta(&mem);
+    benchSection("2. Tempo de Remoção");
+    memoryProbeStart(&mem);
     benchmark_removal(tree);
 
-    printf("\n3. Tempo de Busca:\n");
+    benchMemoryDelta(&mem);
+    benchSection("3. Tempo de Busca");
+    memoryProbeStart(&mem);
     benchmark_search(tree);
 
-    printf("\n4. Uso de Memória:\n");
+    benchMemoryDelta(&mem);
+    benchSection("4. Uso de Memória");
+    memoryProbeStart(&mem);
     estimate_memory_usage(tree);
+    measure_memory_usage(tree);
 
-    printf("\n5. Tempo Médio de Acesso:\n");
+    benchMemoryDelta(&mem);
+    benchSection("5. Tempo Médio de Acesso");
+    memoryProbeStart(&mem);
     benchmark_random_access(tree);
 
-    printf("\n6. Escalabilidade:\n");
+    benchMemoryDelta(&mem);
+    benchSection("6. Escalabilidade");
+    memoryProbeStart(&mem);
     benchmark_scalability();
 
-    printf("\n7. Latência Média (operações combinadas):\n");
-    benchmark_combined_operations(tree);
+    benchMemoryDelta(&mem);
+    benchSection("7. Latência por operação (operações combinadas)");
+    memoryProbeStart(&mem);
+    benchmark_combined_operations();
+
+    benchMemoryDelta(&mem);
+    benchSection("8. Índice Hash por ProductID (desligado x ligado)");
+    memoryProbeStart(&mem);
+    benchmark_product_index(tree);
+
+    benchMemoryDelta(&mem);
+    benchSection("9. Bitmaps de Type/falhas (varredura x popcount)");
+    memoryProbeStart(&mem);
+    benchmark_bitmap_index(tree);
+
+    benchMemoryDelta(&mem);
+    benchSection("10. Filtro avançado (escalar x vetorizado)");
+    memoryProbeStart(&mem);
+    benchmark_filter_engine(tree);
+
+    benchMemoryDelta(&mem);
+    benchSection("11. Kernels de filtro especializados (10M linhas sintéticas)");
+    memoryProbeStart(&mem);
+    benchmark_filter_kernels();
+
+    benchMemoryDelta(&mem);
+    benchSection("12. Estatísticas em uma passada e redução paralela (50M linhas sintéticas)");
+    memoryProbeStart(&mem);
+    benchmark_parallel_stats();
+
+    benchMemoryDelta(&mem);
+    benchSection("13. Percentis: ordenação x sketches KLL");
+    memoryProbeStart(&mem);
+    benchmark_quantile_sketches();
+
+    benchMemoryDelta(&mem);
+    benchSection("14. Histogramas e correlações: linha a linha x lotes colunares");
+    memoryProbeStart(&mem);
+    benchmark_sensor_analytics();
+
+    benchMemoryDelta(&mem);
+    benchSection("15. Padrões de falha: varredura linear x R-tree (1M amostras simuladas)");
+    memoryProbeStart(&mem);
+    benchmark_pattern_index(tree);
+
+    benchMemoryDelta(&mem);
+    benchSection("16. Regiões de falha: um padrão por falha x caixas agrupadas (validação 80/20)");
+    memoryProbeStart(&mem);
+    benchmark_failure_regions(tree);
+
+    benchMemoryDelta(&mem);
+    benchSection("17. Árvores de decisão: treino, validação e inferência em blocos");
+    memoryProbeStart(&mem);
+    benchmark_failure_model(tree);
+
+    benchMemoryDelta(&mem);
+    benchSection("18. Frota em paralelo: amostras/s e latência dos alertas de 1 a 4096 máquinas");
+    memoryProbeStart(&mem);
+    benchmark_fleet_simulation(tree);
+
+    benchMemoryDelta(&mem);
 
     printf("\n=== BENCHMARKS CONCLUÍDOS ===\n");
 }
@@ -1337,7 +1862,7 @@ void generateAnomalousData(AVLTree* tree, int count, int max_size) {
         }
 
         if (i % 100 == 0) {
-            Sleep(1); // R10: Interrupções periódicas
+            sleepMilliseconds(1); // R10: Interrupções periódicas
         }
 
         MachineData d = {0};
@@ -1366,13 +1891,14 @@ void generateAnomalousData(AVLTree* tree, int count, int max_size) {
         insertAVLTree(tree, d.UDI, d); // Insere na Árvore AVL
 
         if (i > 0 && i % 100 == 0) {
-            Sleep(50); // R13: Delay artificial por lote
+            sleepMilliseconds(50); // R13: Delay artificial por lote
         }
     }
 }
 
 void run_restricted_benchmarks() {
     printf("\n=== BENCHMARK COM RESTRIÇÕES ATIVADAS ===\n");
+    benchLogReset("Restricoes ativadas");
 
     AVLTree tree;
     initAVLTree(&tree);
@@ -1386,6 +1912,7 @@ void run_restricted_benchmarks() {
     double elapsed = stop_timer(&t);
 
     printf("\nTempo total (com 4 restrições aplicadas): %.3f ms\n", elapsed);
+    benchRecord(1000, 1000, elapsed, "Geracao com restricoes");
     printf("Elementos finais na árvore (máximo 500): %d\n", tree.size);
 
     // Benchmarks após restrições
@@ -1393,74 +1920,17 @@ void run_restricted_benchmarks() {
     benchmark_removal(&tree);
     benchmark_random_access(&tree);
     estimate_memory_usage(&tree);
+    measure_memory_usage(&tree);
 
-    freeAVLTree(tree.root);
+    destroyAVLTree(&tree);
 
     printf("\n=== FIM DOS TESTES COM RESTRIÇÕES ===\n");
 }
 
-// --- FUNÇÕES AUXILIARES PARA A LISTA DE PADRÕES DE FALHA ---
-
-// Inicializa a lista de padrões de falha
-void initFailurePatternList(FailurePatternList* list) {
-    list->patterns = NULL;
-    list->count = 0;
-    list->capacity = 0;
-}
-
-// Adiciona um padrão de falha à lista dinâmica
-void addFailurePattern(FailurePatternList* list, FailurePattern pattern) {
-    if (list->count == list->capacity) {
-        list->capacity = (list->capacity == 0) ? 1 : list->capacity * 2;
-        list->patterns = (FailurePattern*)realloc(list->patterns, list->capacity * sizeof(FailurePattern));
-        if (list->patterns == NULL) {
-            perror("Falha ao realocar memória para os padrões de falha");
-            exit(EXIT_FAILURE);
-        }
-    }
-    list->patterns[list->count++] = pattern;
-}
-
-// Libera a memória alocada para a lista de padrões de falha
-void freeFailurePatternList(FailurePatternList* list) {
-    free(list->patterns);
-    list->patterns = NULL;
-    list->count = 0;
-    list->capacity = 0;
-}
+#include "ESD-COMUM(PADROES).h"
 
 // --- FUNÇÕES DE APRENDIZAGEM E DETECÇÃO DE PADRÕES DE FALHA ---
 
-// Função auxiliar para percorrer a AVL e aprender padrões
-void learnFailurePatternsRecursive(AVLNode* node, FailurePatternList* patterns) {
-    if (node == NULL) {
-        return;
-    }
-
-    learnFailurePatternsRecursive(node->left, patterns); // Percorre a subárvore esquerda
-
-    if (node->data.MachineFailure) { // Se houver falha na máquina
-        FailurePattern fp;
-        // Para este exemplo, armazena os valores exatos da instância de falha como um padrão.
-        // Um sistema mais robusto poderia calcular faixas, médias, etc.
-        fp.minAirTemp = fp.maxAirTemp = node->data.AirTemp;
-        fp.minProcessTemp = fp.maxProcessTemp = node->data.ProcessTemp;
-        fp.minRotationalSpeed = fp.maxRotationalSpeed = node->data.RotationalSpeed;
-        fp.minTorque = fp.maxTorque = node->data.Torque;
-        fp.minToolWear = fp.maxToolWear = node->data.ToolWear;
-        
-        fp.hadTWF = node->data.TWF;
-        fp.hadHDF = node->data.HDF;
-        fp.hadPWF = node->data.PWF;
-        fp.hadOSF = node->data.OSF;
-        fp.hadRNF = node->data.RNF;
-
-        addFailurePattern(patterns, fp);
-    }
-
-    learnFailurePatternsRecursive(node->right, patterns); // Percorre a subárvore direita
-}
-
 // APRENDE OS PADRÕES DE FALHA A PARTIR DOS DADOS EXISTENTES NA ÁRVORE AVL
 // Opção 12 do menu.
 void learnFailurePatterns(AVLTree* tree, FailurePatternList* patterns) {
@@ -1470,45 +1940,42 @@ void learnFailurePatterns(AVLTree* tree, FailurePatternList* patterns) {
     }
 
     printf("\n=== APRENDENDO PADRÕES DE FALHA ===\n");
-    // Reinicia os padrões antes de aprender novos
-    freeFailurePatternList(patterns);
-    initFailurePatternList(patterns);
-
-    learnFailurePatternsRecursive(tree->root, patterns);
-    printf("Aprendidos %d padrões de falha a partir dos dados existentes.\n", patterns->count);
-}
-
-// VERIFICA SE OS DADOS ATUAIS CORRESPONDEM A UM PADRÃO DE FALHA APRENDIDO
-// Compara os dados da máquina com os padrões armazenados.
-// A correspondência atual é exata. Em um cenário real, você pode usar uma tolerância.
-bool checkForFailurePattern(MachineData data, FailurePatternList* patterns) {
-    for (int i = 0; i < patterns->count; i++) {
-        FailurePattern fp = patterns->patterns[i];
-
-        // Esta é uma correspondência exata. Considere adicionar uma tolerância (e.g., fabs(data.AirTemp - fp.minAirTemp) < epsilon)
-        bool match = true;
-        if (data.AirTemp != fp.minAirTemp ||
-            data.ProcessTemp != fp.minProcessTemp ||
-            data.RotationalSpeed != fp.minRotationalSpeed ||
-            data.Torque != fp.minTorque ||
-            data.ToolWear != fp.minToolWear) {
-            match = false;
-        }
+    int count;
+    const MachineData** rows = collectFilterRecords(tree, NULL, &count);
+    HighPrecisionTimer t;
+    start_timer(&t);
+    int failures = learnFailureRegions(rows, count, patterns);
+    double ms = stop_timer(&t);
+    printf("Aprendidos %d padrões de falha (regiões) a partir de %d falhas dos dados existentes (%.2f ms).\n",
+           patterns->count, failures, ms);
+    displayPatternPrefilter(&patterns->prefilter);
 
-        // Também verifica os flags de falha específicos se eles fazem parte da definição do seu padrão
-        if (match && (data.TWF != fp.hadTWF ||
-                      data.HDF != fp.hadHDF ||
-                      data.PWF != fp.hadPWF ||
-                      data.OSF != fp.hadOSF ||
-                      data.RNF != fp.hadRNF)) {
-            match = false;
-        }
+    start_timer(&t);
+    trainFailureModel(rows, count, &patterns->model);
+    ms = stop_timer(&t);
+    printf("Árvores de decisão treinadas (profundidade %d, %d alvos) em %.2f ms. Ajuste nos dados carregados:\n",
+           TREE_DEPTH, TREE_TARGETS, ms);
+    DetectionCounts counts[TREE_TARGETS];
+    evaluateFailureModel(&patterns->model, rows, count, counts);
+    displayFailureModelEvaluation(counts);
+    free(rows);
+}
 
-        if (match) {
-            return true; // Padrão detectado!
-        }
+// Próximo UDI livre para amostras simuladas: maior UDI atual + 1
+int nextSimulatedUDI(AVLTree* tree) {
+    int next_udi = 0;
+
+    // Encontra o UDI máximo atual para continuar a partir dele
+    // (Reutilizando a lógica de insertManualSample para encontrar o maior UDI)
+    AVLNode* current_max_udi_node = tree->root;
+    while (current_max_udi_node != NULL && current_max_udi_node->right != NULL) {
+        current_max_udi_node = current_max_udi_node->right;
     }
-    return false; // Nenhum padrão correspondente encontrado
+    if (current_max_udi_node != NULL) {
+        next_udi = current_max_udi_node->data.UDI;
+    }
+    next_udi++; // Começa o UDI para novas simulações a partir do próximo número
+    return next_udi;
 }
 
 // --- FUNÇÃO DE SIMULAÇÃO DA FRESADORA ---
@@ -1517,77 +1984,40 @@ bool checkForFailurePattern(MachineData data, FailurePatternList* patterns) {
 // Gera dados de MachineData simulados.
 // Periodicamente, injeta um padrão de falha aprendido para demonstrar a detecção.
 // Opção 13 do menu.
-void simulateMillingMachine(AVLTree* tree, FailurePatternList* patterns, int num_simulations) {
+void simulateMillingMachine(AVLTree* tree, FailurePatternList* patterns, int num_simulations, unsigned int seed) {
     if (patterns->count == 0) {
         printf("Nenhum padrão de falha aprendido. Por favor, aprenda os padrões primeiro (Opção 12).\n");
         return;
     }
 
     printf("\n=== SIMULANDO FRESADORA E DETECTANDO FALHAS ===\n");
-    srand((unsigned)time(NULL)); // Inicializa o gerador de números aleatórios
+    displayPatternTolerance(patterns);
+    printf("Semente: %u\n", seed);
+    srand(seed); // Mesma semente, mesmo fluxo (ver recordSimulationStream)
     int failure_alerts = 0;
-    int next_udi = 0;
-
-    // Encontra o UDI máximo atual para continuar a partir dele
-    // (Reutilizando a lógica de insertManualSample para encontrar o maior UDI)
-    AVLNode* current_max_udi_node = tree->root;
-    while (current_max_udi_node != NULL && current_max_udi_node->right != NULL) {
-        current_max_udi_node = current_max_udi_node->right;
-    }
-    if (current_max_udi_node != NULL) {
-        next_udi = current_max_udi_node->data.UDI;
-    }
-    next_udi++; // Começa o UDI para novas simulações a partir do próximo número
+    int next_udi = nextSimulatedUDI(tree);
 
+    MachineData block[64];
+    unsigned long long blockAlerts = 0;
+    DetectionCounts patternHits = {0, 0, 0, 0}, modelHits = {0, 0, 0, 0};
     for (int i = 0; i < num_simulations; i++) {
-        MachineData simulatedData;
-        simulatedData.UDI = next_udi++;
-
-        // Gera ProductID e Tipo (pode ser aleatório ou seguir uma sequência)
-        snprintf(simulatedData.ProductID, sizeof(simulatedData.ProductID), "SIM%06d", rand() % 1000000);
-        simulatedData.Type = "LMH"[rand() % 3];
-
-        // Introduz variações em torno de valores típicos (menos de falha)
-        // Defina faixas razoáveis para a sua simulação de "operação normal"
-        simulatedData.AirTemp = 298.0f + (float)(rand() % 200) / 100.0f - 1.0f; // Ex: 297.0 a 299.0 K
-        simulatedData.ProcessTemp = simulatedData.AirTemp + 10.0f + (float)(rand() % 100) / 100.0f; // Ex: Processo geralmente mais alto
-        simulatedData.RotationalSpeed = 1400 + rand() % 200 - 100; // Ex: 1300 a 1500 rpm
-        simulatedData.Torque = 30.0f + (float)(rand() % 200) / 100.0f - 1.0f; // Ex: 29.0 a 31.0 Nm
-        simulatedData.ToolWear = 30 + rand() % 30 - 15; // Ex: 15 a 45 min
-
-        // Assume que não há falha inicialmente para dados simulados, a menos que um padrão seja injetado
-        simulatedData.MachineFailure = false;
-        simulatedData.TWF = false;
-        simulatedData.HDF = false;
-        simulatedData.PWF = false;
-        simulatedData.OSF = false;
-        simulatedData.RNF = false;
-
-        // Introduz um padrão de falha periodicamente ou aleatoriamente
-        // Aqui, há uma chance de 5% de injetar um padrão de falha aprendido
-        if (patterns->count > 0 && rand() % 20 == 0) { 
-            // Seleciona um padrão aprendido aleatório para injetar
-            int pattern_idx = rand() % patterns->count;
-            FailurePattern injected_pattern = patterns->patterns[pattern_idx];
-
-            // Sobrescreve os dados simulados com os valores do padrão de falha
-            simulatedData.AirTemp = injected_pattern.minAirTemp;
-            simulatedData.ProcessTemp = injected_pattern.minProcessTemp;
-            simulatedData.RotationalSpeed = injected_pattern.minRotationalSpeed;
-            simulatedData.Torque = injected_pattern.minTorque;
-            simulatedData.ToolWear = injected_pattern.minToolWear;
-            
-            // Define os flags de falha de acordo com o padrão
-            simulatedData.MachineFailure = true; // Isso é crucial para a detecção
-            simulatedData.TWF = injected_pattern.hadTWF;
-            simulatedData.HDF = injected_pattern.hadHDF;
-            simulatedData.PWF = injected_pattern.hadPWF;
-            simulatedData.OSF = injected_pattern.hadOSF;
-            simulatedData.RNF = injected_pattern.hadRNF;
+        // As amostras são geradas e comparadas com os padrões em blocos de 64 (um bit por amostra)
+        int slot = i % 64;
+        if (slot == 0) {
+            int len = num_simulations - i < 64 ? num_simulations - i : 64;
+            for (int j = 0; j < len; j++) generateSimulatedSample(&block[j], patterns, next_udi++);
+            checkForFailurePatternBatch(block, len, patterns, &blockAlerts);
         }
+        MachineData simulatedData = block[slot];
 
         // Verifica se os dados simulados correspondem a algum padrão de falha aprendido
-        if (checkForFailurePattern(simulatedData, patterns)) {
+        bool alert = (blockAlerts >> slot) & 1;
+        countDetection(&patternHits, alert, simulatedData.MachineFailure);
+        // No fluxo do simulador os caminhos se repetem e o if/else é previsto; ver benchmark_failure_model
+        if (patterns->model.trained)
+            countDetection(&modelHits, predictFailureModesScalar(&patterns->model, &simulatedData) & 1,
+                           simulatedData.MachineFailure);
+        if (alert) {
             printf("\n!!! ALERTA DE PADRÃO DE FALHA DETECTADO !!!\n");
             displayItem(simulatedData);
             failure_alerts++;
@@ -1601,13 +2031,174 @@ void simulateMillingMachine(AVLTree* tree, FailurePatternList* patterns, int num
         insertAVLTree(tree, simulatedData.UDI, simulatedData);
     }
     printf("\nSimulação concluída. Total de alertas de falha: %d\n", failure_alerts);
+    printf("Padrões: precisão %.1f%% | recall %.1f%% (falhas injetadas: %d)\n", detectionPrecision(&patternHits),
+           detectionRecall(&patternHits), patternHits.tp + patternHits.fn);
+    if (patterns->model.trained)
+        printf("Árvore de decisão: %d falhas previstas | precisão %.1f%% | recall %.1f%%\n", modelHits.tp + modelHits.fp,
+               detectionPrecision(&modelHits), detectionRecall(&modelHits));
+}
+
+// --- ADAPTAÇÃO DA ÁRVORE AVL AO CÓDIGO COMUM ---
+// As operações sobre esta estrutura de que o código comum precisa: frota, reprodução do fluxo,
+// carga de trabalho e benchmarks de padrões (ESD-COMUM(*).h).
+typedef AVLTree WorkloadBackend;
+
+void workloadInit(AVLTree* tree, int) { // Capacidade ignorada: a árvore cresce sob demanda
+    initAVLTree(tree);
+}
+
+void workloadFree(AVLTree* tree) {
+    destroyAVLTree(tree);
+}
+
+void workloadInsert(AVLTree* tree, const MachineData* d) {
+    insertAVLTree(tree, d->UDI, *d);
+}
+
+bool workloadFindUDI(AVLTree* tree, int udi) {
+    return searchAVLTree(tree, udi) != NULL;
+}
+
+bool workloadFindProductID(AVLTree* tree, const char* pid) {
+    return containsProductID(tree, pid);
+}
+
+int workloadRangeCount(AVLTree* tree, int lo, int hi) {
+    return countUDIRange(tree, lo, hi);
+}
+
+bool workloadDeleteUDI(AVLTree* tree, int udi) {
+    if (searchAVLTree(tree, udi) == NULL) return false;
+    deleteAVLTree(tree, udi);
+    return true;
+}
+
+// O mesmo caminho de calculateStatistics abaixo do limiar paralelo
+long long workloadStats(AVLTree* tree) {
+    RunningStats rs;
+    runningStatsInit(&rs);
+    accumulateStats(tree->root, &rs);
+    return rs.n;
+}
+
+#include "ESD-COMUM(FROTA).h"
+
+#include "ESD-COMUM(CARGA).h"
+
+#include "ESD-COMUM(PADROES-BENCHMARK).h"
+
+// --- BENCHMARK DA FROTA ---
+// FLEET_BENCH_SAMPLES amostras por configuração, divididas entre 1 até milhares de máquinas,
+// com uma thread e com todos os núcleos; cada rodada mescla numa estrutura vazia.
+void benchmark_fleet_simulation(AVLTree* tree) {
+    FailurePatternList patterns;
+    initFailurePatternList(&patterns);
+    learnFailurePatterns(tree, &patterns);
+    memcpy(patterns.tolerance, patternSuggestedTolerance, sizeof(patterns.tolerance));
+    if (patterns.count == 0) {
+        printf("Nenhuma falha nos dados carregados; benchmark da frota ignorado.\n");
+        freeFailurePatternList(&patterns);
+        return;
+    }
+    int cores = availableCores();
+    printf("\n%9s %8s %11s %12s %9s %8s %8s %10s %10s %10s\n", "Maquinas", "Threads", "Tempo(ms)", "Mamostras/s",
+           "Alertas", "Recall", "Mescla", "p50(us)", "p99(us)", "max(us)");
+    static const int fleetSizes[] = {1, 16, 256, 4096};
+    for (int s = 0; s < (int)(sizeof(fleetSizes) / sizeof(fleetSizes[0])); s++) {
+        for (int pass = 0; pass < 2; pass++) {
+            int threads = pass == 0 ? 1 : cores;
+            if (pass == 1 && (cores == 1 || fleetSizes[s] == 1)) continue;
+            AVLTree store;
+            initAVLTree(&store);
+            FleetReport r;
+            runFleetSimulation(&store, &patterns, fleetSizes[s], FLEET_BENCH_SAMPLES / fleetSizes[s], threads, 44, &r);
+            printf("%9d %8d %11.2f %12.2f %9d %7.1f%% %7.1f%% %10.1f %10.1f %10.1f\n", r.machines, r.threads, r.ms,
+                   r.samples / (r.ms * 1e3), r.hits.tp + r.hits.fp, detectionRecall(&r.hits),
+                   r.ms > 0 ? 100.0 * r.mergeMs / r.ms : 0.0, r.latencyP50, r.latencyP99, r.latencyMax);
+            BenchRecord* rec = benchRecord(r.samples, r.samples, r.ms, "Frota: %d maquinas x %d threads", r.machines, r.threads);
+            rec->p50 = r.latencyP50 * 1e3;
+            rec->p99 = r.latencyP99 * 1e3;
+            destroyAVLTree(&store);
+        }
+    }
+    printf("(Mescla = fração do tempo dentro da seção crítica; recall dos alertas sobre as falhas geradas)\n");
+    freeFailurePatternList(&patterns);
+}
+
+// Modo batch: "--benchmarks [prefixo] [baseline.csv] [limiar%]" roda run_all_benchmarks, grava
+// <prefixo>.csv e .json e, com um baseline, sai com 1 se houver regressão
+int batchBenchmarks(AVLTree* tree, int argc, char* argv[]) {
+    const char* prefix = argc > 2 ? argv[2] : BENCH_DEFAULT_OUTPUT;
+    run_all_benchmarks(tree);
+    if (saveBenchRecords(prefix) < 0) return 2;
+    if (argc < 4) return 0;
+    double threshold = argc > 4 && atof(argv[4]) > 0 ? atof(argv[4]) : BENCH_REGRESSION_THRESHOLD;
+    char csvPath[512];
+    snprintf(csvPath, sizeof(csvPath), "%s.csv", prefix);
+    int regressions = compareBenchFiles(csvPath, argv[3], threshold);
+    return regressions < 0 ? 2 : regressions > 0 ? 1 : 0;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    timerInit(); // Calibra o relógio antes de qualquer medição ou thread
+    if (argc > 1 && strcmp(argv[1], "--perf") == 0) { // Contadores de hardware; os outros argumentos seguem
+        enableHardwareCounters();
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+    }
     AVLTree tree;
     initAVLTree(&tree);
     parseCSV(&tree); // Carrega os dados iniciais do CSV
 
+    if (argc > 1 && strcmp(argv[1], "--analytics") == 0) {
+        int status = batchSensorAnalytics(&tree, argc, argv);
+        destroyAVLTree(&tree);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--fleet") == 0) {
+        int status = batchFleetSimulation(&tree, argc, argv);
+        destroyAVLTree(&tree);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--record") == 0) {
+        int status = batchRecordStream(&tree, argc, argv);
+        destroyAVLTree(&tree);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--replay") == 0) {
+        int status = batchReplayStream(&tree, argc, argv);
+        destroyAVLTree(&tree);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--workload") == 0) {
+        int status = batchWorkload(argc, argv);
+        destroyAVLTree(&tree);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--benchmarks") == 0) {
+        int status = batchBenchmarks(&tree, argc, argv);
+        destroyAVLTree(&tree);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--compare-benchmarks") == 0) {
+        int status = batchCompareBenchmarks(argc, argv);
+        destroyAVLTree(&tree);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--check-quantiles") == 0) {
+        int status = checkQuantilesAfterRemoval(&tree, argc, argv);
+        destroyAVLTree(&tree);
+        return status;
+    }
+
     // ADICIONE ESTAS DUAS LINHAS:
     FailurePatternList failurePatterns; // Declara a lista de padrões de falha
     initFailurePatternList(&failurePatterns); // Inicializa a lista
@@ -1639,7 +2230,13 @@ int main() {
             case 3: {
                 printf("Digite o Tipo para buscar (L, M, H): ");
                 if (fgets(input, sizeof(input), stdin)) {
-                    searchByTypeTree(&tree, toupper(input[0])); // Função adaptada para AVL
+                    char type = toupper(input[0]);
+                    printf("Modos de falha (ex.: HDF,OSF; Enter para qualquer): ");
+                    int modes = fgets(input, sizeof(input), stdin) ? parseFailureModes(input) : 0;
+                    if (modes)
+                        searchByTypeAndFailureModes(&tree, type, modes);
+                    else
+                        searchByTypeTree(&tree, type); // Função adaptada para AVL
                 }
                 break;
             }
@@ -1677,9 +2274,11 @@ int main() {
                 break;
             case 10:
                 run_all_benchmarks(&tree); // Função adaptada para AVL
+                saveBenchRecords(BENCH_DEFAULT_OUTPUT);
                 break;
             case 11:
             	run_restricted_benchmarks(); // Função adaptada para AVL
+            	saveBenchRecords(BENCH_RESTRICTED_OUTPUT);
 				break;
             // ADICIONE ESTES NOVOS CASES:
             case 12: // Nova opção: Aprender Padrões de Falha
@@ -1690,7 +2289,8 @@ int main() {
                 int num_sims;
                 if (scanf("%d", &num_sims) == 1) {
                     while (getchar() != '\n'); // Limpa o buffer
-                    simulateMillingMachine(&tree, &failurePatterns, num_sims);
+                    if (failurePatterns.count > 0) readPatternTolerance(&failurePatterns);
+                    simulateMillingMachine(&tree, &failurePatterns, num_sims, (unsigned)time(NULL));
                 } else {
                     printf("Entrada inválida. Por favor, digite um número.\n");
                     while (getchar() != '\n'); // Limpa o buffer
@@ -1699,15 +2299,19 @@ int main() {
             }
             // FIM DOS NOVOS CASES
 
-            case 14: // Opção de saída atualizada
+            case 14:
+                sensorAnalytics(&tree);
+                break;
+
+            case 15: // Opção de saída atualizada
                 printf("Saindo...\n");
                 break;
             default:
                 printf("Opção inválida. Tente novamente.\n");
         }
-    } while (choice != 14); // Condição de saída atualizada
+    } while (choice != 15); // Condição de saída atualizada
 
-    freeAVLTree(tree.root); // Libera a árvore AVL
+    destroyAVLTree(&tree); // Libera a árvore AVL
     // ADICIONE ESTA LINHA:
     freeFailurePatternList(&failurePatterns); // Libera a memória da lista de padrões
     return 0;
@@ -5,12 +5,62 @@
 #include <ctype.h>
 #include <math.h>
 #include <time.h>
-#include <windows.h> // For QueryPerformanceCounter, GetProcessMemoryInfo, Sleep
-#include <profileapi.h> // For QueryPerformanceCounter of high precision
+#include <limits.h>
+#include <stdarg.h>
+#ifdef _WIN32
+#include <windows.h> // For GetProcessMemoryInfo, Sleep, threads and file mapping
 #include <psapi.h> // For GetProcessMemoryInfo
+#endif
+#include <chrono> // steady_clock: relógio portátil das medições
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h> // SSE2 para o filtro vetorizado
+#define FILTER_SSE2
+#endif
+#ifndef _WIN32
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap, msync
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // ftruncate, sysconf
+#include <pthread.h>  // Redução paralela das estatísticas
+#include <sys/resource.h> // getrusage: pico de memória do processo
+#endif
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h> // mallinfo2: bytes em uso no heap
+#define MEMORY_MALLINFO2
+#endif
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>    // __rdtsc, __cpuid
+#else
+#include <x86intrin.h> // __rdtsc
+#include <cpuid.h>     // __get_cpuid
+#endif
+#define TIMER_RDTSC
+#endif
+#if defined(_MSC_VER) && !defined(TIMER_RDTSC)
+#include <intrin.h> // _BitScanForward64 fora de x86 (ARM64)
+#endif
+#ifdef MEMORY_COUNTING
+#include <atomic>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h> // Contadores de hardware do modo --perf
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#define PERF_COUNTERS
+#endif
+
+#include "ESD-COMUM(INSTRUMENTACAO).h"
 
 #define MAX_LINHA 2048
+#define STRUCTURE_NAME "CircularQueue" // Nome da estrutura nos registros dos benchmarks
 #define DEFAULT_QUEUE_CAPACITY 10000 // A suitable default capacity for the circular queue
+#define TOMBSTONE_COMPACT_RATIO 0.25 // Compacta a fila quando mais de 25% dos slots ocupados estão mortos
+#define PERSISTENT_LOG_FILE "MachineFailure.ring" // Arquivo do buffer persistente de amostras
+#define PERSISTENT_SYNC_INTERVAL 64 // Amostras entre dois msync (intervalo de durabilidade)
+#define PERSISTENT_RING_MAGIC 0x52445345u // "ESDR"
+#define PERSISTENT_RING_VERSION 2
+#define PERSISTENT_RING_RESERVE 64 // Slots além da capacidade: escritas até o commit seguinte
 
 // Estruturas de dados
 typedef struct {
@@ -30,6 +80,101 @@ typedef struct {
     bool RNF;
 } MachineData;
 
+#include "ESD-COMUM(BENCHMARK).h"
+#include "ESD-COMUM(INDICES).h"
+
+// Percentis da janela deslizante. As amostras são agrupadas em blocos de blockSize números de
+// sequência, cada bloco com seus sketches, num anel de QUANTILE_WINDOW_BLOCKS blocos; um bloco
+// só é reaproveitado quando todas as suas amostras já saíram da janela. A consulta funde os
+// blocos com amostras vivas, então pode contar até blockSize - 1 amostras já expiradas
+// (1/15 da capacidade) e não desconta as remoções por UDI.
+#define QUANTILE_WINDOW_BLOCKS 16
+
+typedef struct {
+    QuantileSketches block[QUANTILE_WINDOW_BLOCKS];
+    long long blockStart[QUANTILE_WINDOW_BLOCKS]; // Primeiro número de sequência do bloco (-1 = vazio)
+    int blockSize;
+    QuantileSketches merged;                      // Fusão da última consulta
+    long long mergedFront, mergedNext;            // Janela [front, next) que 'merged' representa
+} WindowQuantiles;
+
+void initWindowQuantiles(WindowQuantiles* wq, int capacity) {
+    wq->blockSize = (capacity + QUANTILE_WINDOW_BLOCKS - 2) / (QUANTILE_WINDOW_BLOCKS - 1);
+    if (wq->blockSize < 1) wq->blockSize = 1;
+    for (int b = 0; b < QUANTILE_WINDOW_BLOCKS; b++) {
+        initQuantileSketches(&wq->block[b]);
+        wq->blockStart[b] = -1;
+    }
+    initQuantileSketches(&wq->merged);
+    wq->mergedFront = wq->mergedNext = -1;
+}
+
+void freeWindowQuantiles(WindowQuantiles* wq) {
+    for (int b = 0; b < QUANTILE_WINDOW_BLOCKS; b++) freeQuantileSketches(&wq->block[b]);
+    freeQuantileSketches(&wq->merged);
+}
+
+void windowQuantilesPush(WindowQuantiles* wq, long long seq, const MachineData* d) {
+    long long start = seq - seq % wq->blockSize;
+    int b = (int)((seq / wq->blockSize) % QUANTILE_WINDOW_BLOCKS);
+    if (wq->blockStart[b] != start) { // Bloco antigo, já todo fora da janela
+        clearQuantileSketches(&wq->block[b]);
+        wq->blockStart[b] = start;
+    }
+    quantileSketchesAdd(&wq->block[b], d);
+}
+
+// Sketches das amostras com sequência em [front, next); a fusão só é refeita se a janela mudou
+QuantileSketches* windowQuantiles(WindowQuantiles* wq, long long front, long long next) {
+    if (front != wq->mergedFront || next != wq->mergedNext) {
+        clearQuantileSketches(&wq->merged);
+        for (int b = 0; b < QUANTILE_WINDOW_BLOCKS; b++) {
+            if (wq->blockStart[b] >= 0 && wq->blockStart[b] + wq->blockSize > front && wq->blockStart[b] < next)
+                mergeQuantileSketches(&wq->merged, &wq->block[b]);
+        }
+        wq->mergedFront = front;
+        wq->mergedNext = next;
+    }
+    return &wq->merged;
+}
+
+#define WINDOW_METRICS 4 // ToolWear, Torque, RotationalSpeed, diferença de temperatura
+
+// Deque monotônica (ring de números de sequência) usada para min/max da janela
+typedef struct {
+    long long* seq; // Sequence numbers of the elements still candidates for min/max
+    int head;       // Index of the first entry in the ring
+    int count;      // Number of entries
+    int capacity;   // Same capacity as the queue
+} MonotonicDeque;
+
+// Estatísticas incrementais da janela deslizante (últimas N amostras da fila).
+// Atualizadas em O(1) amortizado a cada enqueue, sobrescrita e dequeue.
+typedef struct {
+    int n;                              // Elements currently in the window
+    double mean[WINDOW_METRICS];        // Running mean (Welford)
+    double m2[WINDOW_METRICS];          // Sum of squared deviations (Welford)
+    MonotonicDeque minDq[WINDOW_METRICS];
+    MonotonicDeque maxDq[WINDOW_METRICS];
+    FailureCube cube;                   // Counts/sensor sums per Type x failure mode
+    long long frontSeq;                 // Sequence number of data[front]
+    long long nextSeq;                  // Sequence number of the next enqueued element
+    WindowQuantiles quantiles;          // p50/p95/p99 sketches per block of the window
+    unsigned char* candidate;           // Per slot: bit m = in minDq[m], bit 4 + m = in maxDq[m]
+    bool dequesStale;                   // A removed candidate left the deques incomplete
+} WindowStats;
+
+// Índice de UDI: tabela de espalhamento encadeada pelos próprios slots. head[] guarda, por
+// balde, o primeiro slot vivo cujo UDI cai nele, e next/prev ligam os slots do mesmo balde.
+// Ligar ou desligar um slot é O(1) e achar os slots de um UDI percorre só o seu balde. A fila
+// tem capacidade fixa, então a tabela (2 baldes por slot) é alocada uma vez e nunca cresce.
+typedef struct {
+    int* head;         // Balde -> primeiro slot (-1 = vazio)
+    int* next;         // Slot -> próximo slot do mesmo balde (-1 = fim)
+    int* prev;         // Slot -> slot anterior do mesmo balde (-1 = primeiro)
+    unsigned int mask; // Número de baldes - 1 (potência de 2)
+} UDIIndex;
+
 // Estrutura da Fila Circular Otimizada
 typedef struct {
     MachineData* data; // Array to store elements
@@ -37,14 +182,245 @@ typedef struct {
     int rear;          // Index of the rear element
     int size;          // Current number of elements
     int capacity;      // Maximum capacity of the queue
+    unsigned int* dead; // Bitmap of removed slots (tombstones), one bit per slot
+    int deadCount;     // Tombstones between front and rear (counted in 'size')
+    WindowStats stats; // Sliding-window statistics over the live elements
+    ProductIndex* pidIndex; // ProductID -> slots of the live elements (NULL = index disabled)
+    BitmapIndex* bitmaps;   // Type/failures -> slots of the live elements (NULL = index disabled)
+    UDIIndex udiIndex;      // UDI -> slots vivos (sempre ligado)
 } CircularQueue;
 
-// Timer de alta precisão
-typedef struct {
-    LARGE_INTEGER start;
-    LARGE_INTEGER end;
-    LARGE_INTEGER frequency;
-} HighPrecisionTimer;
+// --- BITMAP DE TOMBSTONES ---
+
+bool isSlotDead(CircularQueue* queue, int index) {
+    return (queue->dead[index >> 5] >> (index & 31)) & 1u;
+}
+
+void setSlotDead(CircularQueue* queue, int index, bool dead) {
+    if (dead) queue->dead[index >> 5] |= (1u << (index & 31));
+    else queue->dead[index >> 5] &= ~(1u << (index & 31));
+}
+
+// --- ÍNDICE DE UDI ---
+
+void initUDIIndex(UDIIndex* ix, int capacity) {
+    int buckets = 2;
+    while (buckets < 2 * capacity) buckets <<= 1;
+    ix->head = (int*)malloc(sizeof(int) * buckets);
+    ix->next = (int*)malloc(sizeof(int) * capacity);
+    ix->prev = (int*)malloc(sizeof(int) * capacity);
+    if (ix->head == NULL || ix->next == NULL || ix->prev == NULL) {
+        perror("Erro ao alocar memória para o índice de UDI");
+        exit(EXIT_FAILURE);
+    }
+    memset(ix->head, 0xFF, sizeof(int) * buckets); // Todos -1
+    ix->mask = (unsigned int)buckets - 1;
+}
+
+void freeUDIIndex(UDIIndex* ix) {
+    free(ix->head);
+    free(ix->next);
+    free(ix->prev);
+    ix->head = ix->next = ix->prev = NULL;
+}
+
+// Multiplicativo (Knuth); UDIs vizinhos caem em baldes distantes
+unsigned int udiBucket(const UDIIndex* ix, int udi) {
+    unsigned int h = (unsigned int)udi * 2654435761u;
+    return (h ^ (h >> 16)) & ix->mask;
+}
+
+void udiIndexAdd(UDIIndex* ix, int udi, int slot) {
+    unsigned int b = udiBucket(ix, udi);
+    ix->prev[slot] = -1;
+    ix->next[slot] = ix->head[b];
+    if (ix->head[b] >= 0) ix->prev[ix->head[b]] = slot;
+    ix->head[b] = slot;
+}
+
+void udiIndexRemove(UDIIndex* ix, int udi, int slot) {
+    if (ix->prev[slot] >= 0) ix->next[ix->prev[slot]] = ix->next[slot];
+    else ix->head[udiBucket(ix, udi)] = ix->next[slot];
+    if (ix->next[slot] >= 0) ix->prev[ix->next[slot]] = ix->prev[slot];
+}
+
+// --- ESTATÍSTICAS INCREMENTAIS DA JANELA ---
+
+void initMonotonicDeque(MonotonicDeque* dq, int capacity) {
+    dq->seq = (long long*)malloc(sizeof(long long) * capacity);
+    if (dq->seq == NULL) {
+        perror("Erro ao alocar memória para as estatísticas da janela");
+        exit(EXIT_FAILURE);
+    }
+    dq->head = 0;
+    dq->count = 0;
+    dq->capacity = capacity;
+}
+
+void initWindowStats(WindowStats* ws, int capacity) {
+    memset(ws, 0, sizeof(WindowStats));
+    for (int m = 0; m < WINDOW_METRICS; m++) {
+        initMonotonicDeque(&ws->minDq[m], capacity);
+        initMonotonicDeque(&ws->maxDq[m], capacity);
+    }
+    ws->candidate = (unsigned char*)calloc(capacity > 0 ? capacity : 1, 1);
+    if (ws->candidate == NULL) {
+        perror("Erro ao alocar memória para as estatísticas da janela");
+        exit(EXIT_FAILURE);
+    }
+    initWindowQuantiles(&ws->quantiles, capacity);
+}
+
+void freeWindowStats(WindowStats* ws) {
+    for (int m = 0; m < WINDOW_METRICS; m++) {
+        free(ws->minDq[m].seq);
+        free(ws->maxDq[m].seq);
+        ws->minDq[m].seq = ws->maxDq[m].seq = NULL;
+    }
+    free(ws->candidate);
+    ws->candidate = NULL;
+    freeWindowQuantiles(&ws->quantiles);
+    ws->n = 0;
+}
+
+// Valor da métrica m de uma amostra (mesma ordem de WINDOW_METRICS)
+double windowMetric(const MachineData* d, int m) {
+    switch (m) {
+        case 0: return d->ToolWear;
+        case 1: return d->Torque;
+        case 2: return d->RotationalSpeed;
+        default: return (double)d->ProcessTemp - d->AirTemp;
+    }
+}
+
+// Slot do elemento com número de sequência seq (deve estar na fila)
+int windowSlotOf(CircularQueue* queue, long long seq) {
+    return (int)((queue->front + (seq - queue->stats.frontSeq)) % queue->capacity);
+}
+
+double windowValueAt(CircularQueue* queue, long long seq, int m) {
+    return windowMetric(&queue->data[windowSlotOf(queue, seq)], m);
+}
+
+// Insere seq no fim das deques da métrica m, descartando os candidatos dominados por x.
+// O byte candidate[] do slot acompanha a presença em cada deque.
+void windowDequePush(CircularQueue* queue, int m, long long seq, double x) {
+    unsigned char* candidate = queue->stats.candidate;
+    MonotonicDeque* mn = &queue->stats.minDq[m];
+    while (mn->count > 0) {
+        long long back = mn->seq[(mn->head + mn->count - 1) % mn->capacity];
+        if (windowValueAt(queue, back, m) < x) break;
+        candidate[windowSlotOf(queue, back)] &= (unsigned char)~(1u << m);
+        mn->count--;
+    }
+    mn->seq[(mn->head + mn->count++) % mn->capacity] = seq;
+    candidate[windowSlotOf(queue, seq)] |= (unsigned char)(1u << m);
+
+    MonotonicDeque* mx = &queue->stats.maxDq[m];
+    while (mx->count > 0) {
+        long long back = mx->seq[(mx->head + mx->count - 1) % mx->capacity];
+        if (windowValueAt(queue, back, m) > x) break;
+        candidate[windowSlotOf(queue, back)] &= (unsigned char)~(1u << (4 + m));
+        mx->count--;
+    }
+    mx->seq[(mx->head + mx->count++) % mx->capacity] = seq;
+    candidate[windowSlotOf(queue, seq)] |= (unsigned char)(1u << (4 + m));
+}
+
+// Registra o elemento recém-inserido em data[rear]. Chamado depois de front/rear/size atualizados.
+void windowStatsPush(CircularQueue* queue, const MachineData* d) {
+    WindowStats* ws = &queue->stats;
+    long long seq = ws->nextSeq++;
+    ws->n++;
+    for (int m = 0; m < WINDOW_METRICS; m++) {
+        double x = windowMetric(d, m);
+        double delta = x - ws->mean[m];
+        ws->mean[m] += delta / ws->n;
+        ws->m2[m] += delta * (x - ws->mean[m]);
+        if (!ws->dequesStale) windowDequePush(queue, m, seq, x);
+    }
+    windowQuantilesPush(&ws->quantiles, seq, d);
+    failureCubeAdd(&ws->cube, d);
+}
+
+// Remove um elemento vivo da média/variância e dos contadores (não mexe nas deques)
+void windowStatsForget(WindowStats* ws, const MachineData* d) {
+    if (ws->n == 1) {
+        for (int m = 0; m < WINDOW_METRICS; m++) {
+            ws->mean[m] = 0;
+            ws->m2[m] = 0;
+        }
+    }
+    ws->n--;
+    if (ws->n > 0) {
+        for (int m = 0; m < WINDOW_METRICS; m++) {
+            double x = windowMetric(d, m);
+            double oldMean = ws->mean[m];
+            ws->mean[m] -= (x - oldMean) / ws->n;
+            ws->m2[m] -= (x - oldMean) * (x - ws->mean[m]);
+        }
+    }
+    failureCubeRemove(&ws->cube, d);
+}
+
+// Retira da janela o elemento em data[front]. Chamado antes de front avançar.
+void windowStatsPop(CircularQueue* queue, const MachineData* d) {
+    WindowStats* ws = &queue->stats;
+    long long seq = ws->frontSeq;
+    windowStatsForget(ws, d);
+    ws->candidate[queue->front] = 0;
+    ws->frontSeq++;
+    if (ws->dequesStale) return; // Refeitas na próxima leitura de min/max
+    for (int m = 0; m < WINDOW_METRICS; m++) {
+        MonotonicDeque* mn = &ws->minDq[m];
+        if (mn->count > 0 && mn->seq[mn->head] == seq) {
+            mn->head = (mn->head + 1) % mn->capacity;
+            mn->count--;
+        }
+        MonotonicDeque* mx = &ws->maxDq[m];
+        if (mx->count > 0 && mx->seq[mx->head] == seq) {
+            mx->head = (mx->head + 1) % mx->capacity;
+            mx->count--;
+        }
+    }
+}
+
+// Reconstrói as deques de min/max a partir dos elementos vivos: O(n). Uma deque monotônica
+// descarta os elementos que um mais novo domina; se esse mais novo é removido no meio da fila,
+// os descartados voltariam a ser candidatos e não há como recuperá-los sem varrer a janela.
+// Por isso a remoção de um candidato só marca as deques como desatualizadas (dequesStale) e a
+// reconstrução acontece na próxima leitura de min/max, uma vez para todas as remoções desde a
+// leitura anterior; enquanto isso enqueue e dequeue não mexem nas deques.
+void windowRebuildDeques(CircularQueue* queue) {
+    for (int m = 0; m < WINDOW_METRICS; m++) {
+        queue->stats.minDq[m].head = queue->stats.minDq[m].count = 0;
+        queue->stats.maxDq[m].head = queue->stats.maxDq[m].count = 0;
+    }
+    memset(queue->stats.candidate, 0, queue->capacity);
+    queue->stats.dequesStale = false;
+    for (int i = 0; i < queue->size; i++) {
+        int index = (queue->front + i) % queue->capacity;
+        if (isSlotDead(queue, index)) continue;
+        for (int m = 0; m < WINDOW_METRICS; m++) {
+            windowDequePush(queue, m, queue->stats.frontSeq + i, windowMetric(&queue->data[index], m));
+        }
+    }
+}
+
+double windowMin(CircularQueue* queue, int m) {
+    if (queue->stats.dequesStale) windowRebuildDeques(queue);
+    return windowValueAt(queue, queue->stats.minDq[m].seq[queue->stats.minDq[m].head], m);
+}
+
+double windowMax(CircularQueue* queue, int m) {
+    if (queue->stats.dequesStale) windowRebuildDeques(queue);
+    return windowValueAt(queue, queue->stats.maxDq[m].seq[queue->stats.maxDq[m].head], m);
+}
+
+double windowStdDev(CircularQueue* queue, int m) {
+    double var = queue->stats.m2[m] / queue->stats.n;
+    return var > 0 ? sqrt(var) : 0; // m2 pode ficar levemente negativo por arredondamento
+}
 
 // Implementações das funções básicas da Fila Circular
 void initQueue(CircularQueue* queue, int capacity) {
@@ -57,37 +433,66 @@ void initQueue(CircularQueue* queue, int capacity) {
     queue->front = 0;
     queue->rear = -1; // Rear will point to the last added element's index
     queue->size = 0;
+    queue->dead = (unsigned int*)calloc((capacity + 31) / 32, sizeof(unsigned int));
+    if (queue->dead == NULL) {
+        perror("Erro ao alocar memória para o bitmap de remoção");
+        exit(EXIT_FAILURE);
+    }
+    queue->deadCount = 0;
+    initWindowStats(&queue->stats, capacity);
+    queue->pidIndex = useProductIndex ? createProductIndex(0) : NULL;
+    queue->bitmaps = useBitmapIndex ? createBitmapIndex() : NULL;
+    initUDIIndex(&queue->udiIndex, capacity);
 }
 
-typedef struct {
-    float minAirTemp, maxAirTemp;
-    float minProcessTemp, maxProcessTemp;
-    int minRotationalSpeed, maxRotationalSpeed;
-    float minTorque, maxTorque;
-    int minToolWear, maxToolWear;
-    bool hadTWF, hadHDF, hadPWF, hadOSF, hadRNF;
-} FailurePattern;
-
-// NOVA ESTRUTURA: Lista dinâmica para armazenar múltiplos padrões de falha
-// Usaremos uma lista dinâmica para armazenar os padrões de falha aprendidos,
-// já que a fila circular não é a estrutura ideal para buscas arbitrárias por padrões.
-typedef struct {
-    FailurePattern* patterns;
-    int count;
-    int capacity;
-} FailurePatternList;
-
 void freeQueue(CircularQueue* queue) {
     if (queue && queue->data) {
         free(queue->data);
         queue->data = NULL;
+        free(queue->dead);
+        queue->dead = NULL;
+        freeWindowStats(&queue->stats);
+        freeProductIndex(queue->pidIndex);
+        queue->pidIndex = NULL;
+        freeBitmapIndex(queue->bitmaps);
+        queue->bitmaps = NULL;
+        freeUDIIndex(&queue->udiIndex);
     }
+    queue->deadCount = 0;
     queue->front = 0;
     queue->rear = -1;
     queue->size = 0;
     queue->capacity = 0;
 }
 
+// Liga (reconstruindo a partir dos slots vivos, em ordem FIFO) ou desliga o índice de ProductID
+void setProductIndexEnabled(CircularQueue* queue, bool enabled) {
+    freeProductIndex(queue->pidIndex);
+    queue->pidIndex = NULL;
+    if (enabled) {
+        queue->pidIndex = createProductIndex(queue->size * 2);
+        for (int i = 0; i < queue->size; i++) {
+            int index = (queue->front + i) % queue->capacity;
+            if (isSlotDead(queue, index)) continue;
+            productIndexAdd(queue->pidIndex, queue->data[index].ProductID, index);
+        }
+    }
+}
+
+// Liga (reconstruindo a partir dos slots vivos) ou desliga os bitmaps de Type/falhas
+void setBitmapIndexEnabled(CircularQueue* queue, bool enabled) {
+    freeBitmapIndex(queue->bitmaps);
+    queue->bitmaps = NULL;
+    if (enabled) {
+        queue->bitmaps = createBitmapIndex();
+        for (int i = 0; i < queue->size; i++) {
+            int index = (queue->front + i) % queue->capacity;
+            if (isSlotDead(queue, index)) continue;
+            bitmapIndexAdd(queue->bitmaps, &queue->data[index], index);
+        }
+    }
+}
+
 bool isFull(CircularQueue* queue) {
     return queue->size == queue->capacity;
 }
@@ -96,18 +501,43 @@ bool isEmpty(CircularQueue* queue) {
     return queue->size == 0;
 }
 
+// Recupera os tombstones que chegaram ao início da fila, mantendo data[front] sempre vivo
+void reclaimDeadFront(CircularQueue* queue) {
+    while (queue->size > 0 && isSlotDead(queue, queue->front)) {
+        setSlotDead(queue, queue->front, false);
+        queue->front = (queue->front + 1) % queue->capacity;
+        queue->size--;
+        queue->deadCount--;
+        queue->stats.frontSeq++;
+    }
+    if (queue->size == 0) { // Reset if queue becomes empty
+        queue->front = 0;
+        queue->rear = -1;
+    }
+}
+
 // Enqueue operation for Circular Queue
 void enqueue(CircularQueue* queue, MachineData data) {
     if (isFull(queue)) {
         // Overwrite the oldest element (at 'front') if the queue is full.
         // This acts as a form of "data stream buffering" or R2 restriction.
+        windowStatsPop(queue, &queue->data[queue->front]); // Evicted from the window
+        if (queue->pidIndex) productIndexRemove(queue->pidIndex, queue->data[queue->front].ProductID, queue->front);
+        if (queue->bitmaps) bitmapIndexRemove(queue->bitmaps, &queue->data[queue->front], queue->front);
+        udiIndexRemove(&queue->udiIndex, queue->data[queue->front].UDI, queue->front);
         queue->data[queue->front] = data; // Overwrite
+        queue->rear = queue->front; // The overwritten slot is now the newest element
         queue->front = (queue->front + 1) % queue->capacity; // Move front
     } else {
         queue->rear = (queue->rear + 1) % queue->capacity;
         queue->data[queue->rear] = data;
         queue->size++;
     }
+    windowStatsPush(queue, &queue->data[queue->rear]);
+    if (queue->pidIndex) productIndexAdd(queue->pidIndex, data.ProductID, queue->rear);
+    if (queue->bitmaps) bitmapIndexAdd(queue->bitmaps, &data, queue->rear);
+    udiIndexAdd(&queue->udiIndex, data.UDI, queue->rear);
+    reclaimDeadFront(queue); // The new front may be a tombstone
 }
 
 // Dequeue operation for Circular Queue
@@ -116,12 +546,13 @@ bool dequeue(CircularQueue* queue, MachineData* data) {
         return false; // Queue is empty, cannot dequeue
     }
     *data = queue->data[queue->front];
+    windowStatsPop(queue, &queue->data[queue->front]);
+    if (queue->pidIndex) productIndexRemove(queue->pidIndex, data->ProductID, queue->front);
+    if (queue->bitmaps) bitmapIndexRemove(queue->bitmaps, data, queue->front);
+    udiIndexRemove(&queue->udiIndex, data->UDI, queue->front);
     queue->front = (queue->front + 1) % queue->capacity;
     queue->size--;
-    if (isEmpty(queue)) { // Reset if queue becomes empty
-        queue->front = 0;
-        queue->rear = -1;
-    }
+    reclaimDeadFront(queue); // Also resets the indices if the queue becomes empty
     return true;
 }
 
@@ -134,6 +565,379 @@ bool peek(CircularQueue* queue, MachineData* data) {
     return true;
 }
 
+// --- FILA CIRCULAR PERSISTENTE (ARQUIVO MAPEADO EM MEMÓRIA) ---
+// Variante da fila cujos registros e metadados (front/rear/size) ficam num arquivo mapeado.
+// O cabeçalho do arquivo só é atualizado no commit, depois que os registros novos foram
+// gravados em disco:
+//  - syncInterval > 0: commit (msync) a cada syncInterval operações; uma queda do sistema
+//    ou do processo perde no máximo as últimas syncInterval operações.
+//  - syncInterval == 0: o cabeçalho é atualizado a cada operação sem msync; sobrevive a
+//    falhas do processo (as páginas continuam no cache do SO), mas não a quedas do sistema.
+// Para que o cabeçalho confirmado continue válido entre dois commits, um slot que ele ainda
+// referencia nunca é sobrescrito: o arquivo tem PERSISTENT_RING_RESERVE slots além da
+// capacidade e, se o próximo slot ainda pertence ao último commit (fila cheia e commit
+// atrasado), o commit é antecipado antes da escrita. Como o fim da fila só avança (nem a
+// fila vazia volta ao slot 0), os slots escritos depois do commit ficam sempre fora dele.
+// Remoções no meio do log viram tombstones (um byte por slot, depois dos registros), que a
+// recuperação ignora; o slot só é liberado quando volta a ser escrito.
+
+// Cabeçalho gravado no início do arquivo, seguido de 'slots' registros MachineData e
+// 'slots' bytes de tombstone
+typedef struct {
+    unsigned int magic;
+    int version;
+    int capacity;
+    int recordSize;  // sizeof(MachineData) de quem criou o arquivo
+    int front;
+    int rear;
+    int size;        // Slots ocupados a partir de front, incluindo tombstones
+    int slots;       // capacity + PERSISTENT_RING_RESERVE
+    long long commits;
+} PersistentRingHeader;
+
+typedef struct {
+    PersistentRingHeader* header; // Início do mapeamento
+    MachineData* data;            // Registros, logo após o cabeçalho
+    unsigned char* dead;          // Tombstones, logo após os registros
+    size_t mappedBytes;
+    int front, rear, size;        // Estado de trabalho (o cabeçalho guarda o último commit)
+    int capacity;                 // Registros vivos no máximo
+    int slots;                    // Slots no arquivo
+    int syncInterval;
+    int pendingOps;               // Operações desde o último commit
+    int dirtyFrom;                // Primeiro slot gravado desde o último commit
+    int dirtyCount;               // Slots gravados desde o último commit
+    bool deadDirty;               // Tombstones alterados desde o último commit
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+} PersistentQueue;
+
+// Força a gravação de [addr, addr + len) no arquivo
+void flushMappedRange(void* addr, size_t len) {
+    if (len == 0) return;
+#ifdef _WIN32
+    FlushViewOfFile(addr, len);
+#else
+    // msync exige endereço alinhado à página
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    char* start = (char*)((size_t)addr & ~(page - 1));
+    msync(start, len + ((char*)addr - start), MS_SYNC);
+#endif
+}
+
+void publishPersistentHeader(PersistentQueue* pq) {
+    pq->header->front = pq->front;
+    pq->header->rear = pq->rear;
+    pq->header->size = pq->size;
+    pq->header->commits++;
+}
+
+// Commit: grava os registros e tombstones sujos, depois o cabeçalho que passa a referenciá-los
+void syncPersistentQueue(PersistentQueue* pq) {
+    if (pq->dirtyCount >= pq->slots) {
+        flushMappedRange(pq->data, sizeof(MachineData) * pq->slots);
+    } else if (pq->dirtyCount > 0) {
+        int first = pq->slots - pq->dirtyFrom; // Slots até o fim do array
+        if (pq->dirtyCount <= first) {
+            flushMappedRange(&pq->data[pq->dirtyFrom], sizeof(MachineData) * pq->dirtyCount);
+        } else {
+            flushMappedRange(&pq->data[pq->dirtyFrom], sizeof(MachineData) * first);
+            flushMappedRange(pq->data, sizeof(MachineData) * (pq->dirtyCount - first));
+        }
+    }
+    if (pq->deadDirty) flushMappedRange(pq->dead, pq->slots);
+    publishPersistentHeader(pq);
+    flushMappedRange(pq->header, sizeof(PersistentRingHeader));
+#ifdef _WIN32
+    FlushFileBuffers(pq->file); // FlushViewOfFile não espera o disco
+#endif
+    pq->pendingOps = 0;
+    pq->dirtyCount = 0;
+    pq->deadDirty = false;
+}
+
+// Abre (ou cria) o arquivo e recupera o último estado confirmado.
+// Retorna o número de slots recuperados (vivos ou não), ou -1 em caso de erro.
+int openPersistentQueue(PersistentQueue* pq, const char* path, int capacity, int syncInterval) {
+    int slots = capacity + PERSISTENT_RING_RESERVE;
+    size_t bytes = sizeof(PersistentRingHeader) + (sizeof(MachineData) + 1) * (size_t)slots;
+    size_t existing = 0;
+    memset(pq, 0, sizeof(PersistentQueue));
+#ifdef _WIN32
+    pq->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_ALWAYS,
+                           FILE_ATTRIBUTE_NORMAL, NULL);
+    if (pq->file == INVALID_HANDLE_VALUE) {
+        printf("Erro ao abrir %s\n", path);
+        return -1;
+    }
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(pq->file, &fileSize)) existing = (size_t)fileSize.QuadPart;
+    if (existing != bytes) { // Tamanho diferente: o arquivo é recriado
+        SetFilePointer(pq->file, 0, NULL, FILE_BEGIN);
+        SetEndOfFile(pq->file);
+    }
+    pq->mapping = CreateFileMappingA(pq->file, NULL, PAGE_READWRITE,
+                                     (DWORD)((unsigned long long)bytes >> 32), (DWORD)(bytes & 0xFFFFFFFFu), NULL);
+    void* base = pq->mapping ? MapViewOfFile(pq->mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes) : NULL;
+    if (base == NULL) {
+        printf("Erro ao mapear %s\n", path);
+        if (pq->mapping) CloseHandle(pq->mapping);
+        CloseHandle(pq->file);
+        return -1;
+    }
+#else
+    pq->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (pq->fd < 0) {
+        perror("Erro ao abrir o log persistente");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(pq->fd, &st) == 0) existing = (size_t)st.st_size;
+    if (existing != bytes && (ftruncate(pq->fd, 0) != 0 || ftruncate(pq->fd, (off_t)bytes) != 0)) {
+        perror("Erro ao dimensionar o log persistente");
+        close(pq->fd);
+        return -1;
+    }
+    void* base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, pq->fd, 0);
+    if (base == MAP_FAILED) {
+        perror("Erro ao mapear o log persistente");
+        close(pq->fd);
+        return -1;
+    }
+#endif
+    pq->header = (PersistentRingHeader*)base;
+    pq->data = (MachineData*)((char*)base + sizeof(PersistentRingHeader));
+    pq->dead = (unsigned char*)(pq->data + slots);
+    pq->mappedBytes = bytes;
+    pq->capacity = capacity;
+    pq->slots = slots;
+    pq->syncInterval = syncInterval;
+
+    PersistentRingHeader* h = pq->header;
+    bool valid = existing == bytes &&
+                 h->magic == PERSISTENT_RING_MAGIC &&
+                 h->version == PERSISTENT_RING_VERSION &&
+                 h->capacity == capacity &&
+                 h->slots == slots &&
+                 h->recordSize == (int)sizeof(MachineData) &&
+                 h->size >= 0 && h->size <= capacity &&
+                 h->front >= 0 && h->front < slots &&
+                 (h->size == 0 || h->rear == (h->front + h->size - 1) % slots);
+    if (!valid) { // Arquivo novo ou corrompido: formata
+        memset(h, 0, sizeof(PersistentRingHeader));
+        memset(pq->dead, 0, slots);
+        h->magic = PERSISTENT_RING_MAGIC;
+        h->version = PERSISTENT_RING_VERSION;
+        h->capacity = capacity;
+        h->slots = slots;
+        h->recordSize = (int)sizeof(MachineData);
+        h->rear = slots - 1;
+        flushMappedRange(pq->dead, slots);
+        flushMappedRange(h, sizeof(PersistentRingHeader));
+    }
+    pq->front = h->front;
+    pq->rear = (h->front + h->size - 1 + slots) % slots; // Com a fila vazia, o slot antes de front
+    pq->size = h->size;
+    return pq->size;
+}
+
+// Desfaz o mapeamento sem commit (o que não foi confirmado fica como numa queda do processo)
+void releasePersistentMapping(PersistentQueue* pq) {
+    if (pq->header == NULL) return;
+#ifdef _WIN32
+    UnmapViewOfFile(pq->header);
+    CloseHandle(pq->mapping);
+    CloseHandle(pq->file);
+#else
+    munmap(pq->header, pq->mappedBytes);
+    close(pq->fd);
+#endif
+    pq->header = NULL;
+    pq->data = NULL;
+    pq->dead = NULL;
+}
+
+void closePersistentQueue(PersistentQueue* pq) {
+    if (pq->header == NULL) return;
+    syncPersistentQueue(pq);
+    releasePersistentMapping(pq);
+}
+
+// Conta uma operação e faz o commit quando o intervalo de durabilidade é atingido
+void persistentOpDone(PersistentQueue* pq) {
+    if (pq->syncInterval == 0) {
+        publishPersistentHeader(pq);
+        return;
+    }
+    if (++pq->pendingOps >= pq->syncInterval) syncPersistentQueue(pq);
+}
+
+// O slot pertence ao estado confirmado no cabeçalho?
+bool persistentSlotCommitted(PersistentQueue* pq, int slot) {
+    PersistentRingHeader* h = pq->header;
+    return (slot - h->front + pq->slots) % pq->slots < h->size;
+}
+
+// Avança front sobre os tombstones (o byte só é limpo quando o slot for reescrito)
+void persistentReclaimFront(PersistentQueue* pq) {
+    while (pq->size > 0 && pq->dead[pq->front]) {
+        pq->front = (pq->front + 1) % pq->slots;
+        pq->size--;
+    }
+}
+
+// Mesma semântica de enqueue: com a fila cheia, descarta o registro mais antigo
+void persistentEnqueue(PersistentQueue* pq, MachineData data) {
+    if (pq->size == pq->capacity) {
+        pq->front = (pq->front + 1) % pq->slots;
+        pq->size--;
+        persistentReclaimFront(pq);
+    }
+    int slot = (pq->rear + 1) % pq->slots;
+    if (persistentSlotCommitted(pq, slot)) syncPersistentQueue(pq); // O commit libera o slot
+    pq->data[slot] = data;
+    if (pq->dead[slot]) {
+        pq->dead[slot] = 0;
+        pq->deadDirty = true;
+    }
+    pq->rear = slot;
+    pq->size++;
+    if (pq->dirtyCount == 0) pq->dirtyFrom = slot;
+    if (pq->dirtyCount < pq->slots) pq->dirtyCount++;
+    persistentOpDone(pq);
+}
+
+bool persistentDequeue(PersistentQueue* pq, MachineData* data) {
+    if (pq->size == 0) return false;
+    *data = pq->data[pq->front];
+    pq->front = (pq->front + 1) % pq->slots;
+    pq->size--;
+    persistentReclaimFront(pq); // data[front] continua sempre vivo
+    persistentOpDone(pq);
+    return true;
+}
+
+// Remove do log as amostras com o UDI dado (productID == NULL) ou com o ProductID dado
+// (udi ignorado), como removeByUDI/removeByProductID na fila em memória. Linear: o log não
+// tem os índices da fila em memória, e só é tocado nas remoções feitas pelo menu.
+// Retorna quantas foram removidas.
+int persistentRemove(PersistentQueue* pq, int udi, const char* productID) {
+    int removed = 0;
+    for (int i = 0; i < pq->size; i++) {
+        int slot = (pq->front + i) % pq->slots;
+        if (pq->dead[slot]) continue;
+        bool match = productID ? strcmp(pq->data[slot].ProductID, productID) == 0
+                               : pq->data[slot].UDI == udi;
+        if (!match) continue;
+        pq->dead[slot] = 1;
+        pq->deadDirty = true;
+        removed++;
+    }
+    if (removed > 0) {
+        persistentReclaimFront(pq);
+        persistentOpDone(pq);
+    }
+    return removed;
+}
+
+// Retira do log a amostra que acabou de sair do início da fila em memória (se veio do log)
+void persistentForget(PersistentQueue* pq, const MachineData* d) {
+    if (pq->size > 0 && pq->data[pq->front].UDI == d->UDI &&
+        strcmp(pq->data[pq->front].ProductID, d->ProductID) == 0) {
+        MachineData discarded;
+        persistentDequeue(pq, &discarded); // Caso comum: as duas filas são FIFO
+        return;
+    }
+    for (int i = 0; i < pq->size; i++) {
+        int slot = (pq->front + i) % pq->slots;
+        if (!pq->dead[slot] && pq->data[slot].UDI == d->UDI &&
+            strcmp(pq->data[slot].ProductID, d->ProductID) == 0) {
+            pq->dead[slot] = 1;
+            pq->deadDirty = true;
+            persistentOpDone(pq);
+            return;
+        }
+    }
+}
+
+// Reenfileira na fila em memória as amostras vivas do log
+void replayPersistentQueue(PersistentQueue* pq, CircularQueue* queue) {
+    for (int i = 0; i < pq->size; i++) {
+        int slot = (pq->front + i) % pq->slots;
+        if (!pq->dead[slot]) enqueue(queue, pq->data[slot]);
+    }
+}
+
+// Modo batch: "--check-log" testa o log num arquivo próprio: remoções e dequeues sobrevivem
+// ao reinício e uma queda entre commits, mesmo com a fila cheia dando voltas, recupera
+// exatamente o último estado confirmado. Sai com 1 se algo não confere.
+int checkPersistentQueue(void) {
+    const char* path = "MachineFailure.ring.check";
+    const int capacity = 8;
+    int failures = 0;
+    PersistentQueue pq;
+    MachineData d;
+    memset(&d, 0, sizeof(d));
+    remove(path);
+
+    // 1. Remoções por UDI, por ProductID e do início persistem após fechar e reabrir
+    if (openPersistentQueue(&pq, path, capacity, 3) < 0) return 1;
+    for (int udi = 1; udi <= 12; udi++) { // Dá a volta: ficam 5..12
+        d.UDI = udi;
+        snprintf(d.ProductID, sizeof(d.ProductID), "P%d", udi % 3);
+        persistentEnqueue(&pq, d);
+    }
+    persistentRemove(&pq, 7, NULL);   // Meio
+    persistentRemove(&pq, 0, "P0");   // 6, 9 e 12
+    persistentDequeue(&pq, &d);             // 5
+    closePersistentQueue(&pq);
+    int expected1[] = {8, 10, 11};
+    openPersistentQueue(&pq, path, capacity, 3);
+    int live = 0;
+    for (int i = 0; i < pq.size; i++) {
+        int slot = (pq.front + i) % pq.slots;
+        if (pq.dead[slot]) continue;
+        if (live >= 3 || pq.data[slot].UDI != expected1[live]) failures++;
+        live++;
+    }
+    if (live != 3) failures++;
+    printf("Log persistente: remoções após reinício ............ %s\n", failures ? "FALHOU" : "ok");
+
+    // 2. Fila cheia com o commit atrasado: a "queda" (mapeamento desfeito sem commit) deve
+    // recuperar exatamente a sequência de UDIs que terminava no último commit
+    int before = failures;
+    int lastCommitted = 0;
+    for (int udi = 100; udi < 100 + capacity + 3 * PERSISTENT_RING_RESERVE; udi++) {
+        if (udi == 100 + capacity) { // Commit com a fila cheia; depois, só os antecipados
+            syncPersistentQueue(&pq);
+            pq.syncInterval = 1000;
+        }
+        long long commits = pq.header->commits;
+        d.UDI = udi;
+        persistentEnqueue(&pq, d);
+        if (pq.header->commits != commits) lastCommitted = udi - 1; // Antecipado: antes da escrita
+        if (udi == 100 + capacity - 1) lastCommitted = udi;
+    }
+    int committedSize = pq.header->size;
+    releasePersistentMapping(&pq);
+    openPersistentQueue(&pq, path, capacity, 1000);
+    if (pq.size != committedSize || pq.size == 0 ||
+        pq.data[(pq.front + pq.size - 1) % pq.slots].UDI != lastCommitted) failures++;
+    for (int i = 1; i < pq.size; i++) {
+        MachineData* prev = &pq.data[(pq.front + i - 1) % pq.slots];
+        MachineData* cur = &pq.data[(pq.front + i) % pq.slots];
+        if (pq.dead[(pq.front + i) % pq.slots] || cur->UDI != prev->UDI + 1) failures++;
+    }
+    printf("Log persistente: queda entre commits com a fila cheia %s\n", failures > before ? "FALHOU" : "ok");
+    closePersistentQueue(&pq);
+    remove(path);
+    return failures ? 1 : 0;
+}
+
 void removerAspas(char *str) {
     char *src = str, *dst = str;
     while (*src) {
@@ -192,12 +996,13 @@ void displayAll(CircularQueue* queue) {
     int i;
     for (i = 0; i < queue->size; i++) {
         int index = (queue->front + i) % queue->capacity;
+        if (isSlotDead(queue, index)) continue;
         displayItem(queue->data[index]);
     }
 }
 
 // Função para inserir novas amostras manualmente (Versão Corrigida V2 - com validação de formato)
-void insertManualSample(CircularQueue* queue) {
+void insertManualSample(CircularQueue* queue, PersistentQueue* log) {
     MachineData newData;
     printf("\n=== INSERIR NOVA AMOSTRA MANUALMENTE ===\n");
 
@@ -206,6 +1011,7 @@ void insertManualSample(CircularQueue* queue) {
     if (!isEmpty(queue)) {
         for (int i = 0; i < queue->size; i++) {
             int index = (queue->front + i) % queue->capacity;
+            if (isSlotDead(queue, index)) continue;
             if (queue->data[index].UDI > maxUDI) {
                 maxUDI = queue->data[index].UDI;
             }
@@ -398,6 +1204,7 @@ void insertManualSample(CircularQueue* queue) {
 
             if (confirm_choice == 1) {
                 enqueue(queue, newData);
+                if (log) persistentEnqueue(log, newData);
                 printf("Amostra inserida com sucesso!\n");
                 break;
             } else if (confirm_choice == 0) {
@@ -414,9 +1221,19 @@ void insertManualSample(CircularQueue* queue) {
 }
 
 void searchByProductID(CircularQueue* queue, const char* pid) {
+    if (queue->pidIndex) {
+        ProductIndexEntry* e = productIndexFind(queue->pidIndex, pid);
+        if (e == NULL) {
+            printf("Nenhum item com ProductID %s\n", pid);
+            return;
+        }
+        for (int i = 0; i < e->count; i++) displayItem(queue->data[e->refs[i]]);
+        return;
+    }
     bool achou = false;
     for (int i = 0; i < queue->size; i++) {
         int index = (queue->front + i) % queue->capacity;
+        if (isSlotDead(queue, index)) continue;
         if (strcmp(queue->data[index].ProductID, pid) == 0) {
             displayItem(queue->data[index]);
             achou = true;
@@ -425,11 +1242,77 @@ void searchByProductID(CircularQueue* queue, const char* pid) {
     if (!achou) printf("Nenhum item com ProductID %s\n", pid);
 }
 
+// Registro de uma linha dos bitmaps (linha = slot)
+MachineData* recordAtRow(CircularQueue* queue, unsigned int row) {
+    return &queue->data[row];
+}
+
+// Linhas de um bitmap em ordem FIFO: os slots vivos vão de front até o fim do array e
+// continuam do início, então basta girar a lista crescente no primeiro slot >= front
+unsigned int* orderedRows(CircularQueue* queue, const RoaringBitmap* rows, int* count) {
+    int n = roaringCardinality(rows);
+    unsigned int* sorted = (unsigned int*)roaringAlloc(sizeof(unsigned int) * (n + 1));
+    unsigned int* out = (unsigned int*)roaringAlloc(sizeof(unsigned int) * (n + 1));
+    roaringToArray(rows, sorted);
+    int k = 0;
+    while (k < n && sorted[k] < (unsigned int)queue->front) k++;
+    memcpy(out, sorted + k, sizeof(unsigned int) * (n - k));
+    memcpy(out + (n - k), sorted, sizeof(unsigned int) * k);
+    free(sorted);
+    *count = n;
+    return out;
+}
+
+// Exibe os registros das linhas de um bitmap
+int displayRows(CircularQueue* queue, const RoaringBitmap* rows) {
+    int count;
+    unsigned int* ids = orderedRows(queue, rows, &count);
+    for (int i = 0; i < count; i++) displayItem(*recordAtRow(queue, ids[i]));
+    free(ids);
+    return count;
+}
+
+// Registros na ordem da estrutura; com candidates, só os das linhas desse bitmap
+const MachineData** collectFilterRecords(CircularQueue* queue, const RoaringBitmap* candidates, int* count) {
+    int capacity = candidates ? roaringCardinality(candidates) : queue->size;
+    const MachineData** out = (const MachineData**)malloc(sizeof(MachineData*) * (capacity + 1));
+    if (out == NULL) {
+        perror("Erro ao alocar memória para o filtro");
+        exit(EXIT_FAILURE);
+    }
+    *count = 0;
+    if (candidates == NULL) {
+        for (int i = 0; i < queue->size; i++) {
+            int index = (queue->front + i) % queue->capacity;
+            if (!isSlotDead(queue, index)) out[(*count)++] = &queue->data[index];
+        }
+        return out;
+    }
+    int n;
+    unsigned int* ids = orderedRows(queue, candidates, &n);
+    for (int i = 0; i < n; i++) {
+        MachineData* d = recordAtRow(queue, ids[i]);
+        if (d) out[(*count)++] = d;
+    }
+    free(ids);
+    return out;
+}
+
 void searchByType(CircularQueue* queue, char type) {
     bool achou = false;
     type = toupper(type);
+    if (queue->bitmaps && bitmapCoversType(type)) { // Slots do Type direto do bitmap
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapTypeWithModes(queue->bitmaps, type, 0, &rows);
+        achou = displayRows(queue, &rows) > 0;
+        roaringFree(&rows);
+        if (!achou) printf("Nenhum item do tipo %c\n", type);
+        return;
+    }
     for (int i = 0; i < queue->size; i++) {
         int index = (queue->front + i) % queue->capacity;
+        if (isSlotDead(queue, index)) continue;
         if (toupper(queue->data[index].Type) == type) {
             displayItem(queue->data[index]);
             achou = true;
@@ -440,8 +1323,18 @@ void searchByType(CircularQueue* queue, char type) {
 
 void searchByMachineFailure(CircularQueue* queue, bool f) {
     bool achou = false;
+    if (queue->bitmaps) { // FAILURE ou ALL ANDNOT FAILURE
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapFilterCandidates(queue->bitmaps, 0, f, &rows);
+        achou = displayRows(queue, &rows) > 0;
+        roaringFree(&rows);
+        if (!achou) printf("Nenhum item com falha %d\n", f);
+        return;
+    }
     for (int i = 0; i < queue->size; i++) {
         int index = (queue->front + i) % queue->capacity;
+        if (isSlotDead(queue, index)) continue;
         if (queue->data[index].MachineFailure == f) {
             displayItem(queue->data[index]);
             achou = true;
@@ -450,153 +1343,222 @@ void searchByMachineFailure(CircularQueue* queue, bool f) {
     if (!achou) printf("Nenhum item com falha %d\n", f);
 }
 
-// Removing an arbitrary element from a circular queue is not a standard, efficient operation.
-// It would involve shifting elements or using a more complex data structure.
-// For this translation, I will omit `removeByProductID` as it doesn't align with
-// the optimized circular queue paradigm, which is primarily FIFO.
-// If this functionality is crucial, a different data structure should be considered.
-void removeUnsupported(const char* feature) {
-    printf("Operação \"%s\" não suportada ou não otimizada para uma fila circular.\n", feature);
-}
-
-void displayStats(const char* title, float avg, float max, float min, float stdDev) {
-    printf("\n%s:\nMédia=%.2f | Máximo=%.2f | Mínimo=%.2f | Desvio=%.2f\n",
-           title, avg, max, min, stdDev);
-}
-
-void calculateStatistics(CircularQueue* queue) {
-    if (queue->size == 0) {
-        printf("Fila vazia. Nenhum dado para análise.\n");
-        return;
+// Busca por Type com pelo menos um dos modos de falha (ex.: H com HDF ou OSF)
+void searchByTypeAndFailureModes(CircularQueue* queue, char type, int modeMask) {
+    int found = 0;
+    if (queue->bitmaps && bitmapCoversType(type)) {
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapTypeWithModes(queue->bitmaps, type, modeMask, &rows);
+        found = displayRows(queue, &rows);
+        roaringFree(&rows);
+    } else {
+        for (int i = 0; i < queue->size; i++) {
+            int index = (queue->front + i) % queue->capacity;
+            if (isSlotDead(queue, index)) continue;
+            if (recordMatchesTypeModes(&queue->data[index], type, modeMask)) {
+                displayItem(queue->data[index]);
+                found++;
+            }
+        }
     }
+    if (!found) printf("Nenhum item do tipo %c com os modos de falha escolhidos\n", toupper(type));
+}
 
-    // Variáveis para ToolWear
-    float twSum = 0, twMax = -INFINITY, twMin = INFINITY;
-    float twSqDiffSum = 0;
-    
-    // Variáveis para Torque
-    float tqSum = 0, tqMax = -INFINITY, tqMin = INFINITY;
-    float tqSqDiffSum = 0;
-    
-    // Variáveis para RotationalSpeed
-    int rsSum = 0, rsMax = -INT_MAX, rsMin = INT_MAX;
-    float rsSqDiffSum = 0;
-    
-    // Variáveis para diferença de temperatura
-    float tempDiffSum = 0, tempDiffMax = -INFINITY, tempDiffMin = INFINITY;
-    float tempDiffSqDiffSum = 0;
-
+// Contagens de classifyFailures por varredura dos slots vivos (sem bitmaps nem janela)
+void scanClassifyCounts(CircularQueue* queue, int counts[3][6]) {
     for (int i = 0; i < queue->size; i++) {
         int index = (queue->front + i) % queue->capacity;
-        MachineData current_data = queue->data[index];
-
-        // Cálculos para ToolWear
-        twSum += current_data.ToolWear;
-        if (current_data.ToolWear > twMax) twMax = current_data.ToolWear;
-        if (current_data.ToolWear < twMin) twMin = current_data.ToolWear;
-        
-        // Cálculos para Torque
-        tqSum += current_data.Torque;
-        if (current_data.Torque > tqMax) tqMax = current_data.Torque;
-        if (current_data.Torque < tqMin) tqMin = current_data.Torque;
-        
-        // Cálculos para RotationalSpeed
-        rsSum += current_data.RotationalSpeed;
-        if (current_data.RotationalSpeed > rsMax) rsMax = current_data.RotationalSpeed;
-        if (current_data.RotationalSpeed < rsMin) rsMin = current_data.RotationalSpeed;
-        
-        // Cálculos para diferença de temperatura
-        float diff = current_data.ProcessTemp - current_data.AirTemp;
-        tempDiffSum += diff;
-        if (diff > tempDiffMax) tempDiffMax = diff;
-        if (diff < tempDiffMin) tempDiffMin = diff;
+        if (!isSlotDead(queue, index)) classifyRecord(&queue->data[index], counts);
     }
+}
 
-    // Cálculo das médias
-    float twAvg = twSum / queue->size;
-    float tqAvg = tqSum / queue->size;
-    float rsAvg = (float)rsSum / queue->size;
-    float tempDiffAvg = tempDiffSum / queue->size;
-
-    // Segunda passada para calcular desvios padrão
+int countTypeWithModes(CircularQueue* queue, char type, int modeMask) {
+    int count = 0;
     for (int i = 0; i < queue->size; i++) {
         int index = (queue->front + i) % queue->capacity;
-        MachineData current_data = queue->data[index];
-        twSqDiffSum += pow(current_data.ToolWear - twAvg, 2);
-        tqSqDiffSum += pow(current_data.Torque - tqAvg, 2);
-        rsSqDiffSum += pow(current_data.RotationalSpeed - rsAvg, 2);
-        float diff = current_data.ProcessTemp - current_data.AirTemp;
-        tempDiffSqDiffSum += pow(diff - tempDiffAvg, 2);
+        if (!isSlotDead(queue, index)) count += recordMatchesTypeModes(&queue->data[index], type, modeMask);
     }
-
-    // Cálculo dos desvios padrão
-    float twStdDev = sqrt(twSqDiffSum / queue->size);
-    float tqStdDev = sqrt(tqSqDiffSum / queue->size);
-    float rsStdDev = sqrt(rsSqDiffSum / queue->size);
-    float tempDiffStdDev = sqrt(tempDiffSqDiffSum / queue->size);
-
-    // Exibição dos resultados
-    printf("\n=== ESTATÍSTICAS DE OPERAÇÃO ===\n");
-    displayStats("Desgaste da Ferramenta (ToolWear)", twAvg, twMax, twMin, twStdDev);
-    displayStats("Torque (Nm)", tqAvg, tqMax, tqMin, tqStdDev);
-    displayStats("Velocidade Rotacional (RPM)", rsAvg, rsMax, rsMin, rsStdDev);
-    displayStats("Diferença de Temperatura (ProcessTemp - AirTemp)", tempDiffAvg, tempDiffMax, tempDiffMin, tempDiffStdDev);
+    return count;
 }
 
-void classifyFailures(CircularQueue* queue) {
-    if (queue->size == 0) {
-        printf("Fila vazia. Nenhum dado para análise.\n");
-        return;
+// --- REMOÇÃO ARBITRÁRIA COM TOMBSTONES ---
+// Remover do meio de uma fila circular exigiria deslocar elementos. Em vez disso, o slot
+// é marcado como morto no bitmap 'dead': as varreduras o ignoram, ele é recuperado quando
+// chega ao início da fila e, se a proporção de mortos passar de TOMBSTONE_COMPACT_RATIO,
+// a fila é compactada no lugar preservando a ordem FIFO. Cada compactação O(n) só ocorre
+// após Θ(n) remoções, então a remoção é O(1) amortizada. Remover um candidato a min/max só
+// marca as deques da janela como desatualizadas (ver windowRebuildDeques). Com o índice de
+// ProductID ligado, os slots do alvo vêm da tabela hash (sem ele a busca é linear); na
+// remoção por UDI, do índice de UDI.
+
+// Move os elementos vivos para frente, eliminando os tombstones. O(n).
+void compactQueue(CircularQueue* queue) {
+    memset(queue->udiIndex.head, 0xFF, sizeof(int) * (queue->udiIndex.mask + 1)); // Religado abaixo
+    int live = 0;
+    for (int i = 0; i < queue->size; i++) {
+        int src = (queue->front + i) % queue->capacity;
+        if (isSlotDead(queue, src)) {
+            setSlotDead(queue, src, false);
+            continue;
+        }
+        int dst = (queue->front + live) % queue->capacity;
+        if (dst != src) queue->data[dst] = queue->data[src];
+        udiIndexAdd(&queue->udiIndex, queue->data[dst].UDI, dst);
+        live++;
+    }
+    queue->size = live;
+    queue->deadCount = 0;
+    if (live == 0) {
+        queue->front = 0;
+        queue->rear = -1;
+    } else {
+        queue->rear = (queue->front + live - 1) % queue->capacity;
     }
+    // Os elementos vivos passam a ter números de sequência contíguos até nextSeq - 1
+    queue->stats.frontSeq = queue->stats.nextSeq - live;
+    windowRebuildDeques(queue);
+    if (queue->pidIndex) setProductIndexEnabled(queue, true); // Os slots mudaram
+    if (queue->bitmaps) setBitmapIndexEnabled(queue, true);
+}
 
-    // Estruturas para contagem de falhas por tipo de máquina
-    typedef struct {
-        int total;
-        int twf;
-        int hdf;
-        int pwf;
-        int osf;
-        int rnf;
-    } TypeStats;
+// Marca o i-ésimo slot ocupado (a partir de front) como morto. Não move elementos. O(1).
+void tombstoneSlot(CircularQueue* queue, int i) {
+    int index = (queue->front + i) % queue->capacity;
+    windowStatsForget(&queue->stats, &queue->data[index]);
+    if (queue->pidIndex) productIndexRemove(queue->pidIndex, queue->data[index].ProductID, index);
+    if (queue->bitmaps) bitmapIndexRemove(queue->bitmaps, &queue->data[index], index);
+    udiIndexRemove(&queue->udiIndex, queue->data[index].UDI, index);
+    setSlotDead(queue, index, true);
+    queue->deadCount++;
+    if (queue->stats.candidate[index]) queue->stats.dequesStale = true;
+    queue->stats.candidate[index] = 0;
+}
 
-    TypeStats stats[3] = {0}; // 0: L, 1: M, 2: H
-    int totalFailures[5] = {0}; // TWF, HDF, PWF, OSF, RNF
+// Conclui uma remoção: recupera mortos no início e compacta se necessário
+void finishRemoval(CircularQueue* queue) {
+    reclaimDeadFront(queue);
+    if (queue->deadCount > 0 && queue->deadCount > queue->size * TOMBSTONE_COMPACT_RATIO) {
+        compactQueue(queue); // Também refaz as deques e os índices
+    }
+}
 
+bool removeByProductID(CircularQueue* queue, const char* pid) {
+    bool removed = false;
+    if (queue->pidIndex) {
+        long long* refs;
+        int count = productIndexCopyRefs(queue->pidIndex, pid, &refs);
+        for (int k = 0; k < count; k++) {
+            int i = ((int)refs[k] - queue->front + queue->capacity) % queue->capacity;
+            tombstoneSlot(queue, i);
+        }
+        free(refs);
+        if (count > 0) finishRemoval(queue);
+        return count > 0;
+    }
     for (int i = 0; i < queue->size; i++) {
         int index = (queue->front + i) % queue->capacity;
-        MachineData current_data = queue->data[index];
-
-        int typeIndex = -1;
-        switch (toupper(current_data.Type)) {
-            case 'L': typeIndex = 0; break;
-            case 'M': typeIndex = 1; break;
-            case 'H': typeIndex = 2; break;
+        if (isSlotDead(queue, index)) continue;
+        if (strcmp(queue->data[index].ProductID, pid) == 0) {
+            tombstoneSlot(queue, i);
+            removed = true;
         }
+    }
+    if (removed) finishRemoval(queue);
+    return removed;
+}
 
-        if (typeIndex != -1) {
-            stats[typeIndex].total++;
-            
-            if (current_data.TWF) {
-                stats[typeIndex].twf++;
-                totalFailures[0]++;
-            }
-            if (current_data.HDF) {
-                stats[typeIndex].hdf++;
-                totalFailures[1]++;
-            }
-            if (current_data.PWF) {
-                stats[typeIndex].pwf++;
-                totalFailures[2]++;
-            }
-            if (current_data.OSF) {
-                stats[typeIndex].osf++;
-                totalFailures[3]++;
-            }
-            if (current_data.RNF) {
-                stats[typeIndex].rnf++;
-                totalFailures[4]++;
-            }
+// Existe algum registro vivo com o ProductID? (O(1) com índice, O(n) sem)
+bool containsProductID(CircularQueue* queue, const char* pid) {
+    if (queue->pidIndex) return productIndexFind(queue->pidIndex, pid) != NULL;
+    for (int i = 0; i < queue->size; i++) {
+        int index = (queue->front + i) % queue->capacity;
+        if (isSlotDead(queue, index)) continue;
+        if (strcmp(queue->data[index].ProductID, pid) == 0) return true;
+    }
+    return false;
+}
+
+// Os slots do UDI vêm do índice: O(1) em média mais a compactação amortizada
+bool removeByUDI(CircularQueue* queue, int udi) {
+    bool removed = false;
+    int slot = queue->udiIndex.head[udiBucket(&queue->udiIndex, udi)];
+    while (slot >= 0) {
+        int next = queue->udiIndex.next[slot]; // tombstoneSlot desliga o slot da cadeia
+        if (queue->data[slot].UDI == udi) {
+            tombstoneSlot(queue, (slot - queue->front + queue->capacity) % queue->capacity);
+            removed = true;
         }
+        slot = next;
+    }
+    if (removed) finishRemoval(queue);
+    return removed;
+}
+
+// Existe algum registro vivo com o UDI? (O(1) em média, pelo índice de UDI)
+bool containsUDI(CircularQueue* queue, int udi) {
+    for (int slot = queue->udiIndex.head[udiBucket(&queue->udiIndex, udi)]; slot >= 0;
+         slot = queue->udiIndex.next[slot]) {
+        if (queue->data[slot].UDI == udi) return true;
+    }
+    return false;
+}
+
+int countUDIRange(CircularQueue* queue, int lo, int hi) {
+    int count = 0;
+    for (int i = 0; i < queue->size; i++) {
+        int index = (queue->front + i) % queue->capacity;
+        if (isSlotDead(queue, index)) continue;
+        count += queue->data[index].UDI >= lo && queue->data[index].UDI <= hi;
+    }
+    return count;
+}
+
+#include "ESD-COMUM(ESTATISTICAS).h"
+
+void displayStats(const char* title, float avg, float max, float min, float stdDev) {
+    printf("\n%s:\nMédia=%.2f | Máximo=%.2f | Mínimo=%.2f | Desvio=%.2f\n",
+           title, avg, max, min, stdDev);
+}
+
+// Lê as estatísticas mantidas incrementalmente pela fila: O(1), sem percorrer a janela.
+void calculateStatistics(CircularQueue* queue) {
+    if (queue->size == 0) {
+        printf("Fila vazia. Nenhum dado para análise.\n");
+        return;
+    }
+
+    const char* titles[WINDOW_METRICS] = {
+        "Desgaste da Ferramenta (ToolWear)",
+        "Torque (Nm)",
+        "Velocidade Rotacional (RPM)",
+        "Diferença de Temperatura (ProcessTemp - AirTemp)"
+    };
+
+    // Exibição dos resultados
+    printf("\n=== ESTATÍSTICAS DE OPERAÇÃO (últimas %d amostras) ===\n", queue->stats.n);
+    for (int m = 0; m < WINDOW_METRICS; m++) {
+        displayStats(titles[m], (float)queue->stats.mean[m], (float)windowMax(queue, m),
+                     (float)windowMin(queue, m), (float)windowStdDev(queue, m));
+    }
+
+    printf("\nPercentis da janela (sketches KLL, erro de rank ~1,65%%):\n");
+    displayQuantiles(windowQuantiles(&queue->stats.quantiles, queue->stats.frontSeq, queue->stats.nextSeq), titles);
+}
+
+void classifyFailures(CircularQueue* queue) {
+    if (queue->size == 0) {
+        printf("Fila vazia. Nenhum dado para análise.\n");
+        return;
+    }
+
+    // Cubo mantido incrementalmente pela janela (enqueue/sobrescrita/dequeue/remoção): O(1)
+    const FailureCube* cube = &queue->stats.cube;
+    int counts[3][6];
+    failureCubeCounts(cube, counts);
+    int totalFailures[5] = {0}; // TWF, HDF, PWF, OSF, RNF
+    for (int t = 0; t < 3; t++) {
+        for (int m = 0; m < 5; m++) totalFailures[m] += counts[t][m + 1];
     }
 
     // Exibe resultados
@@ -606,41 +1568,20 @@ void classifyFailures(CircularQueue* queue) {
     printf("\n%-10s %-10s %-10s %-10s %-10s %-10s %-10s\n", 
            "Tipo", "Total", "TWF", "HDF", "PWF", "OSF", "RNF");
     
-    // Dados para cada tipo
+    // Dados para cada tipo: um percentual por modo de falha
     for (int i = 0; i < 3; i++) {
         char type = (i == 0) ? 'L' : (i == 1) ? 'M' : 'H';
         
-        printf("%-10c %-10d ", type, stats[i].total);
-        
-        // TWF
-        if (stats[i].total > 0)
-            printf("%-10.1f%% ", (float)stats[i].twf / stats[i].total * 100);
-        else
-            printf("%-10s ", "N/A");
-        
-        // HDF
-        if (stats[i].total > 0)
-            printf("%-10.1f%% ", (float)stats[i].hdf / stats[i].total * 100);
-        else
-            printf("%-10s ", "N/A");
-        
-        // PWF
-        if (stats[i].total > 0)
-            printf("%-10.1f%% ", (float)stats[i].pwf / stats[i].total * 100);
-        else
-            printf("%-10s ", "N/A");
+        int total = counts[i][0];
+        printf("%-10c %-10d ", type, total);
         
-        // OSF
-        if (stats[i].total > 0)
-            printf("%-10.1f%% ", (float)stats[i].osf / stats[i].total * 100);
-        else
-            printf("%-10s ", "N/A");
-        
-        // RNF
-        if (stats[i].total > 0)
-            printf("%-10.1f%%\n", (float)stats[i].rnf / stats[i].total * 100);
-        else
-            printf("%-10s\n", "N/A");
+        for (int m = 0; m < 5; m++) {
+            const char* end = (m == 4) ? "\n" : " ";
+            if (total > 0)
+                printf("%-10.1f%%%s", (float)counts[i][m + 1] / total * 100, end);
+            else
+                printf("%-10s%s", "N/A", end);
+        }
     }
 
     // Totais gerais
@@ -650,6 +1591,8 @@ void classifyFailures(CircularQueue* queue) {
     printf("PWF: %d ocorrências\n", totalFailures[2]);
     printf("OSF: %d ocorrências\n", totalFailures[3]);
     printf("RNF: %d ocorrências\n", totalFailures[4]);
+
+    displayFailureCubeAverages(cube);
 }
 
 void advancedFilter(CircularQueue* queue) {
@@ -690,60 +1633,39 @@ void advancedFilter(CircularQueue* queue) {
             criteria[5] = 1;
             hasFailureFilter = true;
             printf("Filtrar por máquinas com falha? (1-Sim, 0-Não): ");
-            scanf("%d", &failureFilter);
+            int failureValue = 0;
+            scanf("%d", &failureValue);
+            failureFilter = failureValue != 0;
         }
     } while (choice != 0);
     
     // Aplicar filtros
     printf("\nResultados do Filtro:\n");
-    int matches = 0;
-    
-    for (int i = 0; i < queue->size; i++) {
-        int index = (queue->front + i) % queue->capacity;
-        MachineData current_data = queue->data[index];
-        bool match = true;
-        
-        // Verificar cada critério
-        if (criteria[0] && (current_data.ToolWear < minVal[0] || current_data.ToolWear > maxVal[0])) {
-            match = false;
-        }
-        if (match && criteria[1] && (current_data.Torque < minVal[1] || current_data.Torque > maxVal[1])) {
-            match = false;
-        }
-        if (match && criteria[2] && (current_data.RotationalSpeed < minVal[2] || current_data.RotationalSpeed > maxVal[2])) {
-            match = false;
-        }
-        if (match && criteria[3]) {
-            float tempDiff = current_data.ProcessTemp - current_data.AirTemp;
-            if (tempDiff < minVal[3] || tempDiff > maxVal[3]) {
-                match = false;
-            }
-        }
-        if (match && criteria[4] && toupper(current_data.Type) != typeFilter) {
-            match = false;
-        }
-        if (match && criteria[5] && current_data.MachineFailure != failureFilter) {
-            match = false;
-        }
-        
-        if (match) {
-            printf("UDI: %d | ProductID: %s | Type: %c | ", 
-                   current_data.UDI, current_data.ProductID, current_data.Type);
-            
-            if (criteria[0]) printf("ToolWear: %d | ", current_data.ToolWear);
-            if (criteria[1]) printf("Torque: %.1f | ", current_data.Torque);
-            if (criteria[2]) printf("RPM: %d | ", current_data.RotationalSpeed);
-            if (criteria[3]) {
-                float tempDiff = current_data.ProcessTemp - current_data.AirTemp;
-                printf("TempDiff: %.1f | ", tempDiff);
-            }
-            if (criteria[5]) printf("Failure: %d | ", current_data.MachineFailure);
-            
-            printf("\n");
-            matches++;
-        }
+
+    FilterPlan plan = buildFilterPlan(criteria, minVal, maxVal, typeFilter, failureFilter);
+    RoaringBitmap candidates;
+    roaringInit(&candidates);
+    bool useBitmaps = queue->bitmaps && (plan.byType || plan.byFailure) && (!plan.byType || bitmapCoversType(typeFilter));
+    if (useBitmaps) {
+        // Type e falha saem dos bitmaps; o plano fica só com os intervalos numéricos
+        bitmapFilterCandidates(queue->bitmaps, plan.byType ? typeFilter : 0, plan.byFailure ? failureFilter : -1, &candidates);
+        plan.byType = false;
+        plan.byFailure = false;
     }
-    
+    int count;
+    const MachineData** rows = collectFilterRecords(queue, useBitmaps ? &candidates : NULL, &count);
+    roaringFree(&candidates);
+    int matches;
+    if (plan.rangeCount + plan.byType + plan.byFailure >= FILTER_PLAN_MIN_PREDICATES) {
+        matches = runFilterPlan(&plan, rows, count, rows);
+    } else {
+        // Poucos predicados: o kernel especializado dispensa a transposição em colunas
+        int active[6] = {criteria[0], criteria[1], criteria[2], criteria[3], plan.byType, plan.byFailure};
+        matches = selectFilterKernel(active)(rows, count, minVal, maxVal, typeFilter, failureFilter, rows);
+    }
+    writeFilterMatches(rows, matches, criteria);
+    free(rows);
+
     printf("\nTotal de máquinas que atendem aos critérios: %d\n", matches);
 }
 
@@ -762,19 +1684,69 @@ void displayMenu() {
     printf("11. Executar Restrições\n");
     printf("12. Aprender Padrões de Falha\n");        // NOVA OPÇÃO
     printf("13. Simular Fresadora e Detectar Falhas\n"); // NOVA OPÇÃO
-    printf("14. Sair\n");                               // Opção de saída atualizada
+    printf("14. Remover por ProductID\n");
+    printf("15. Remover por UDI\n");
+    printf("16. Histogramas e Correlações\n");
+    printf("17. Sair\n");
     printf("Escolha: ");
 }
 
-// Implementação das funções de benchmark com alta precisão
-void start_timer(HighPrecisionTimer* timer) {
-    QueryPerformanceFrequency(&timer->frequency);
-    QueryPerformanceCounter(&timer->start);
+// Histogramas e correlações por modo de falha numa passada (opção do menu)
+void sensorAnalytics(CircularQueue* queue) {
+    if (queue->size == 0) {
+        printf("Fila vazia. Nenhum dado para análise.\n");
+        return;
+    }
+    AnalyticsConfig cfg;
+    readAnalyticsConfig(&cfg);
+    int count;
+    const MachineData** rows = collectFilterRecords(queue, NULL, &count);
+    SensorAnalytics* a = (SensorAnalytics*)malloc(sizeof(SensorAnalytics));
+    if (a == NULL) {
+        perror("Erro ao alocar memória para a análise dos sensores");
+        free(rows);
+        return;
+    }
+    int threads = count >= STATS_PARALLEL_MIN_ROWS ? availableCores() : 1;
+    HighPrecisionTimer t;
+    start_timer(&t);
+    runSensorAnalytics(rows, count, &cfg, threads, a);
+    double ms = stop_timer(&t);
+    displaySensorAnalytics(a);
+    printf("\nPassada única sobre %d registros: %.3f ms (%d thread(s), %s)\n", count, ms, threads, ANALYTICS_SIMD_NAME);
+
+    char input[16];
+    printf("Gravar também em CSV (%s_*.csv)? (s/n): ", ANALYTICS_DEFAULT_PREFIX);
+    if (fgets(input, sizeof(input), stdin) && toupper((unsigned char)input[0]) == 'S')
+        writeSensorAnalyticsCSV(a, ANALYTICS_DEFAULT_PREFIX);
+    free(a);
+    free(rows);
 }
 
-double stop_timer(HighPrecisionTimer* timer) {
-    QueryPerformanceCounter(&timer->end);
-    return (double)(timer->end.QuadPart - timer->start.QuadPart) * 1000.0 / timer->frequency.QuadPart;
+// Modo batch: "--analytics [faixas] [prefixo]" grava os CSVs com as faixas padrão, sem menu
+int batchSensorAnalytics(CircularQueue* queue, int argc, char* argv[]) {
+    int bins = argc > 2 && atoi(argv[2]) > 0 ? atoi(argv[2]) : HIST_DEFAULT_BINS;
+    const char* prefix = argc > 3 ? argv[3] : ANALYTICS_DEFAULT_PREFIX;
+    AnalyticsConfig cfg;
+    analyticsDefaultConfig(&cfg, bins);
+    int count;
+    const MachineData** rows = collectFilterRecords(queue, NULL, &count);
+    SensorAnalytics* a = (SensorAnalytics*)malloc(sizeof(SensorAnalytics));
+    if (a == NULL) {
+        perror("Erro ao alocar memória para a análise dos sensores");
+        free(rows);
+        return 1;
+    }
+    int threads = count >= STATS_PARALLEL_MIN_ROWS ? availableCores() : 1;
+    HighPrecisionTimer t;
+    start_timer(&t);
+    runSensorAnalytics(rows, count, &cfg, threads, a);
+    double ms = stop_timer(&t);
+    printf("Análise de %d registros: %.3f ms (%d thread(s), %s)\n", count, ms, threads, ANALYTICS_SIMD_NAME);
+    int status = writeSensorAnalyticsCSV(a, prefix);
+    free(a);
+    free(rows);
+    return status;
 }
 
 void generateRandomData(CircularQueue* queue, int count) {
@@ -803,31 +1775,44 @@ void benchmark_insertion(int num_elements) {
     CircularQueue tmp;
     initQueue(&tmp, num_elements); // Capacity equal to elements to insert
     HighPrecisionTimer t;
+    HwCounters hw;
+    hwCountersStart(&hw);
     start_timer(&t);
     generateRandomData(&tmp, num_elements);
     double elapsed = stop_timer(&t);
+    hwCountersStop(&hw);
     printf("\nBenchmark Inserção (%d elementos): %.3f ms (%.1f elem/ms)\n",
            num_elements, elapsed, num_elements / elapsed);
+    benchRecord(num_elements, num_elements, elapsed, "Insercao");
+    printHwCounters(&hw, num_elements);
     freeQueue(&tmp);
 }
 
+typedef struct {
+    CircularQueue* queue;
+    long long hits;    // Encontrados (ou soma dos UDIs): evita que as buscas sejam descartadas
+} SearchBench;
+
+int benchSearchOp(void* ctx, int) {
+    SearchBench* b = (SearchBench*)ctx;
+    char id[10];
+    snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
+    if (containsProductID(b->queue, id)) b->hits++;
+    return 0;
+}
+
 void benchmark_search(CircularQueue* queue) {
     if (isEmpty(queue)) { printf("Fila vazia para busca\n"); return; }
-    HighPrecisionTimer t;
-    const int searches = 10000;
-    int found = 0;
-    start_timer(&t);
-    for (int i = 0; i < searches; i++) {
-        char id[10];
-        snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
-        for (int j = 0; j < queue->size; j++) {
-            int index = (queue->front + j) % queue->capacity;
-            if (strcmp(queue->data[index].ProductID, id) == 0) { found++; break; }
-        }
-    }
-    double elapsed = stop_timer(&t);
-    printf("\nBenchmark Busca (%d ops): encontrados=%d | tempo=%.3f ms (%.1f ops/ms)\n",
-           searches, found, elapsed, searches / elapsed);
+    SearchBench b = {queue, 0};
+    BenchScenario s = {"Busca por ProductID", 10000, &b, NULL, benchSearchOp, NULL, 1, {NULL}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("\nBenchmark Busca (%d ops x %d rodadas, %d de aquecimento): encontrados=%.1f%%\n", s.opsPerRun,
+           r.runs, BENCH_WARMUP_RUNS, 100.0 * b.hits / ((double)s.opsPerRun * (BENCH_WARMUP_RUNS + BENCH_RUNS)));
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchScenarioCounters(&s);
+    benchRecordResult(&s, &r, queue->size);
 }
 
 void benchmark_dequeue(CircularQueue* queue) { // Renamed from benchmark_removal
@@ -837,6 +1822,7 @@ void benchmark_dequeue(CircularQueue* queue) { // Renamed from benchmark_removal
     // Copy elements for testing dequeue without altering original
     for (int i = 0; i < queue->size; i++) {
         int index = (queue->front + i) % queue->capacity;
+        if (isSlotDead(queue, index)) continue;
         enqueue(&tmp, queue->data[index]);
     }
 
@@ -854,6 +1840,32 @@ void benchmark_dequeue(CircularQueue* queue) { // Renamed from benchmark_removal
     double elapsed = stop_timer(&t);
     printf("\nBenchmark Dequeue (%d ops): %.3f ms (%.1f ops/ms)\n",
            actual_dequeues, elapsed, actual_dequeues / elapsed);
+    benchRecord(queue->size, actual_dequeues, elapsed, "Dequeue");
+    freeQueue(&tmp);
+}
+
+// Remoção arbitrária por ProductID (tombstones), mesma carga dos outros backends
+void benchmark_removal(CircularQueue* queue) {
+    if (isEmpty(queue)) { printf("Fila vazia para remoção\n"); return; }
+    CircularQueue tmp;
+    initQueue(&tmp, queue->capacity);
+    for (int i = 0; i < queue->size; i++) {
+        int index = (queue->front + i) % queue->capacity;
+        if (isSlotDead(queue, index)) continue;
+        enqueue(&tmp, queue->data[index]);
+    }
+    HighPrecisionTimer t;
+    const int removals = 1000;
+    start_timer(&t);
+    for (int i = 0; i < removals; i++) {
+        char id[10];
+        snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
+        removeByProductID(&tmp, id);
+    }
+    double elapsed = stop_timer(&t);
+    printf("\nBenchmark Remoção por ProductID (%d ops): %.3f ms (%.1f ops/ms)\n",
+           removals, elapsed, removals / elapsed);
+    benchRecord(queue->size, removals, elapsed, "Remocao por ProductID");
     freeQueue(&tmp);
 }
 
@@ -870,13 +1882,25 @@ void estimate_memory_usage(CircularQueue* queue) {
     }
     
     size_t data_element_size = calculate_data_size();
-    size_t total_memory = queue->capacity * data_element_size + sizeof(CircularQueue); // data array + queue struct itself
+    size_t window_memory = (size_t)2 * WINDOW_METRICS * queue->capacity * sizeof(long long); // min/max deques
+    size_t bitmap_memory = (size_t)((queue->capacity + 31) / 32) * sizeof(unsigned int); // tombstones
+    size_t total_memory = queue->capacity * data_element_size + sizeof(CircularQueue) + window_memory + bitmap_memory; // data array + queue struct + window stats + bitmap
     
     printf("\n=== ESTIMATIVA DE USO DE MEMÓRIA ===\n");
     printf("Tamanho por elemento de dado (MachineData): %zu bytes\n", data_element_size);
     printf("Capacidade da fila: %d\n", queue->capacity);
-    printf("Número atual de elementos: %d\n", queue->size);
-    printf("Memória total estimada (array de dados + estrutura da fila): %zu bytes (%.2f KB)\n", 
+    printf("Número atual de elementos: %d (%d removidos aguardando compactação)\n",
+           queue->size - queue->deadCount, queue->deadCount);
+    printf("Deques de min/max da janela: %zu bytes | Bitmap de remoção: %zu bytes\n", window_memory, bitmap_memory);
+    if (queue->pidIndex) {
+        size_t index_memory = productIndexMemory(queue->pidIndex);
+        printf("Índice por ProductID: %zu bytes (%.2f KB)\n", index_memory, (float)index_memory / 1024);
+    }
+    if (queue->bitmaps) {
+        size_t bitmap_memory = bitmapIndexMemory(queue->bitmaps);
+        printf("Bitmaps de Type/falhas: %zu bytes (%.2f KB)\n", bitmap_memory, (float)bitmap_memory / 1024);
+    }
+    printf("Memória total estimada (array de dados + estrutura da fila + janela): %zu bytes (%.2f KB)\n", 
            total_memory, (float)total_memory / 1024);
     
     printf("\nComparação com sizeof:\n");
@@ -885,27 +1909,50 @@ void estimate_memory_usage(CircularQueue* queue) {
     printf("Obs: Pode haver padding/alignment pelo compilador\n");
 }
 
+// Memória medida: monta do zero uma estrutura com o mesmo número de registros (dados aleatórios)
+// e mede o heap e o residente antes e depois; o resultado inclui cabeçalhos e sobras do malloc
+void measure_memory_usage(CircularQueue* queue) {
+    int n = queue->size > 0 ? queue->size : 10000;
+    MemorySnapshot before;
+    memoryProbeStart(&before);
+    CircularQueue tmp;
+    initQueue(&tmp, queue->capacity);
+    generateRandomData(&tmp, n);
+    MemorySnapshot built;
+    memorySnapshot(&built);
+    printf("\n=== USO DE MEMÓRIA MEDIDO (%s) ===\n", memoryHeapSource());
+    printf("Registros montados: %d\n", tmp.size);
+    printMemoryDelta("Montagem", &before);
+    benchRecordBytes(n, memoryDeltaBytes(&before, &built), "Memoria medida (montagem)");
+    if (built.heapBytes >= 0 && tmp.size > 0)
+        printf("Heap por registro: %.1f bytes (sizeof(MachineData): %zu)\n",
+               (double)(built.heapBytes - before.heapBytes) / tmp.size, sizeof(MachineData));
+    freeQueue(&tmp);
+}
+
 // Benchmark de tempo médio de acesso (simulando acesso aleatório via iteração)
+int benchAccessOp(void* ctx, int) {
+    SearchBench* b = (SearchBench*)ctx;
+    int random_offset = rand() % b->queue->size; // Offset within current valid elements
+    int index = (b->queue->front + random_offset) % b->queue->capacity;
+    if (!isSlotDead(b->queue, index)) b->hits += b->queue->data[index].UDI;
+    return 0;
+}
+
 void benchmark_random_access(CircularQueue* queue) {
     if (isEmpty(queue)) {
         printf("Fila vazia para teste de acesso aleatório\n");
         return;
     }
-
-    const int accesses = 10000;
-    HighPrecisionTimer t;
-    int sum = 0; // Para evitar otimização
-
-    start_timer(&t);
-    for (int i = 0; i < accesses; i++) {
-        int random_offset = rand() % queue->size; // Offset within current valid elements
-        int index = (queue->front + random_offset) % queue->capacity;
-        sum += queue->data[index].UDI; // Operação qualquer para evitar otimização
-    }
-    double elapsed = stop_timer(&t);
-
-    printf("Benchmark Acesso Aleatório (%d acessos): %.3f ms (%.1f acessos/ms)\n",
-           accesses, elapsed, accesses / elapsed);
+    SearchBench b = {queue, 0};
+    BenchScenario s = {"Acesso aleatorio", 10000, &b, NULL, benchAccessOp, NULL, 1, {NULL}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("Benchmark Acesso Aleatório (%d acessos x %d rodadas):\n", s.opsPerRun, r.runs);
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchScenarioCounters(&s);
+    benchRecordResult(&s, &r, queue->size);
 }
 
 // Benchmark de escalabilidade
@@ -926,84 +1973,421 @@ void benchmark_scalability() {
         
         printf("Capacidade: %6d elementos | Tempo de enchimento: %7.3f ms | Tempo por elemento: %.5f ms\n",
                capacities[i], elapsed, elapsed / capacities[i]);
+        benchRecord(capacities[i], capacities[i], elapsed, "Escalabilidade: enchimento");
         
         freeQueue(&queue);
     }
 }
 
 // Benchmark de latência média (operações combinadas)
+// Mistura de operações sobre uma estrutura nova de 1000 registros a cada rodada
+typedef struct {
+    CircularQueue s;
+} MixBench;
+
+void benchMixSetup(void* ctx) {
+    MixBench* b = (MixBench*)ctx;
+    initQueue(&b->s, DEFAULT_QUEUE_CAPACITY); // Initial queue for combined ops
+    generateRandomData(&b->s, 1000); // Start with some elements
+}
+
+// 30% inserção; dos 70% restantes, 80% busca e 20% remoção (56% e 14% do total)
+int benchMixOp(void* ctx, int i) {
+    MixBench* b = (MixBench*)ctx;
+    // Operação de inserção (30% das vezes)
+    if (rand() % 100 < 30) {
+        MachineData d = {0};
+        d.UDI = 10000 + i;
+        snprintf(d.ProductID, sizeof(d.ProductID), "M%07d", rand() % 1000000);
+        enqueue(&b->s, d); // Enqueue will handle full queue (overwrite oldest)
+        return 0;
+    }
+    // Operação de busca (50% das vezes)
+    if (rand() % 100 < 80) { // 30% inserção + 50% busca = 80%
+        char id[10];
+        snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
+        containsProductID(&b->s, id);
+        return 1;
+    }
+    // Operação de remoção (20% das vezes)
+    MachineData dummy;
+    dequeue(&b->s, &dummy); // Dequeue from front
+    return 2;
+}
+
+void benchMixTeardown(void* ctx) {
+    freeQueue(&((MixBench*)ctx)->s);
+}
+
 void benchmark_combined_operations() {
-    const int num_operations = 1000;
-    CircularQueue queue;
-    initQueue(&queue, DEFAULT_QUEUE_CAPACITY); // Initial queue for combined ops
-    generateRandomData(&queue, 1000); // Start with some elements
+    MixBench b;
+    BenchScenario s = {"Operacoes combinadas", 1000, &b, benchMixSetup, benchMixOp, benchMixTeardown,
+                       3, {"Insercao", "Busca", "Remocao"}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("Benchmark Operações Combinadas (%d ops x %d rodadas, fila nova de 1000 registros por rodada):\n",
+           s.opsPerRun, r.runs);
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchRecordResult(&s, &r, 1000);
+}
 
-    HighPrecisionTimer t;
-    start_timer(&t);
-    
-    for (int i = 0; i < num_operations; i++) {
-        // Operação de inserção (30% das vezes)
-        if (rand() % 100 < 30) {
-            MachineData d = {0};
-            d.UDI = 10000 + i;
-            snprintf(d.ProductID, sizeof(d.ProductID), "M%07d", rand() % 1000000);
-            enqueue(&queue, d); // Enqueue will handle full queue (overwrite oldest)
-        }
-        // Operação de busca (50% das vezes)
-        else if (rand() % 100 < 80) { // 30% inserção + 50% busca = 80%
-            char id[10];
-            snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
-            for (int j = 0; j < queue.size; j++) {
-                int index = (queue.front + j) % queue.capacity;
-                if (strcmp(queue.data[index].ProductID, id) == 0) break;
-            }
+// Throughput de enqueue na fila persistente para vários intervalos de durabilidade.
+// O tempo inclui o fechamento, que faz o commit final.
+void benchmark_persistent_enqueue(int num_elements) {
+    const char* path = "benchmark_ring.tmp";
+    int intervals[] = {0, 1000, 100, 10, 1}; // 0 = sem msync (só falhas do processo)
+    int num_intervals = sizeof(intervals) / sizeof(intervals[0]);
+
+    // Gera os registros antes para medir apenas a fila
+    MachineData* samples = (MachineData*)malloc(sizeof(MachineData) * num_elements);
+    if (samples == NULL) {
+        perror("Erro ao alocar memória para o benchmark persistente");
+        return;
+    }
+    CircularQueue tmp;
+    initQueue(&tmp, num_elements);
+    generateRandomData(&tmp, num_elements);
+    for (int i = 0; i < num_elements; i++) samples[i] = tmp.data[i];
+    freeQueue(&tmp);
+
+    for (int i = 0; i < num_intervals; i++) {
+        remove(path);
+        PersistentQueue pq;
+        if (openPersistentQueue(&pq, path, DEFAULT_QUEUE_CAPACITY, intervals[i]) < 0) break;
+        HighPrecisionTimer t;
+        start_timer(&t);
+        for (int j = 0; j < num_elements; j++) {
+            persistentEnqueue(&pq, samples[j]);
         }
-        // Operação de remoção (20% das vezes)
-        else {
-            MachineData dummy;
-            dequeue(&queue, &dummy); // Dequeue from front
+        closePersistentQueue(&pq);
+        double elapsed = stop_timer(&t);
+        if (intervals[i] == 0)
+            printf("Durabilidade: sem msync         | %d enqueues: %9.3f ms (%.1f elem/ms)\n",
+                   num_elements, elapsed, num_elements / elapsed);
+        else
+            printf("Durabilidade: msync a cada %4d | %d enqueues: %9.3f ms (%.1f elem/ms)\n",
+                   intervals[i], num_elements, elapsed, num_elements / elapsed);
+        benchRecord(num_elements, num_elements, elapsed, "Durabilidade (msync a cada %d)", intervals[i]);
+    }
+    remove(path);
+    free(samples);
+}
+
+// Consultas determinísticas (metade existentes, metade ausentes) para comparar índice ligado x desligado
+char (*buildProductIDQueries(CircularQueue* queue, int num_queries))[10] {
+    char (*queries)[10] = (char (*)[10])malloc(sizeof(*queries) * num_queries);
+    char (*existing)[10] = (char (*)[10])malloc(sizeof(*existing) * num_queries);
+    if (queries == NULL || existing == NULL) {
+        perror("Erro de alocação de memória");
+        exit(EXIT_FAILURE);
+    }
+    int n = 0;
+    for (int i = 0; i < queue->size && n < num_queries; i++) {
+        int index = (queue->front + i) % queue->capacity;
+        if (isSlotDead(queue, index)) continue;
+        strcpy(existing[n++], queue->data[index].ProductID);
+    }
+    srand(31);
+    for (int i = 0; i < num_queries; i++) {
+        if (n > 0 && i % 2 == 0) {
+            strcpy(queries[i], existing[rand() % n]);
+        } else {
+            snprintf(queries[i], sizeof(queries[i]), "X%07d", rand() % 1000000);
         }
     }
-    
+    free(existing);
+    return queries;
+}
+
+double benchmark_search_product_id(CircularQueue* queue) {
+    const int searches = 10000;
+    char (*queries)[10] = buildProductIDQueries(queue, searches);
+    HighPrecisionTimer t;
+    int found = 0;
+
+    start_timer(&t);
+    for (int i = 0; i < searches; i++) {
+        if (containsProductID(queue, queries[i])) found++;
+    }
     double elapsed = stop_timer(&t);
-    printf("Benchmark Operações Combinadas (%d ops): %.3f ms | Latência média: %.3f ms/op\n",
-           num_operations, elapsed, elapsed / num_operations);
-    
-    freeQueue(&queue);
+    printf("Busca por ProductID (%d ops): encontrados=%d | tempo=%.3f ms (%.1f ops/ms)\n",
+           searches, found, elapsed, searches / elapsed);
+    benchRecord(queue->size, searches, elapsed, "Busca por ProductID (indice %s)", useProductIndex ? "ligado" : "desligado");
+    free(queries);
+    return elapsed;
+}
+
+double benchmark_removal_product_id(CircularQueue* queue) {
+    const int removals = 1000;
+    char (*queries)[10] = buildProductIDQueries(queue, removals);
+    CircularQueue tmp;
+    initQueue(&tmp, queue->capacity);
+    for (int i = 0; i < queue->size; i++) {
+        int index = (queue->front + i) % queue->capacity;
+        if (isSlotDead(queue, index)) continue;
+        enqueue(&tmp, queue->data[index]);
+    }
+
+    HighPrecisionTimer t;
+    int removed = 0;
+    start_timer(&t);
+    for (int i = 0; i < removals; i++) {
+        if (removeByProductID(&tmp, queries[i])) removed++;
+    }
+    double elapsed = stop_timer(&t);
+    printf("Remoção por ProductID (%d ops): removidos=%d | tempo=%.3f ms (%.1f ops/ms)\n",
+           removals, removed, elapsed, removals / elapsed);
+    benchRecord(queue->size, removals, elapsed, "Remocao por ProductID (indice %s)", useProductIndex ? "ligado" : "desligado");
+    freeQueue(&tmp);
+    free(queries);
+    return elapsed;
+}
+
+// Repete inserção e busca/remoção por ProductID com o índice desligado e ligado
+void benchmark_product_index(CircularQueue* queue) {
+    bool saved = useProductIndex;
+    double search_ms[2], removal_ms[2];
+    for (int on = 0; on <= 1; on++) {
+        useProductIndex = on;
+        setProductIndexEnabled(queue, on);
+        printf("\n--- Índice por ProductID %s ---", on ? "LIGADO" : "DESLIGADO");
+        benchmark_insertion(10000);
+        search_ms[on] = benchmark_search_product_id(queue);
+        removal_ms[on] = benchmark_removal_product_id(queue);
+    }
+    useProductIndex = saved;
+    setProductIndexEnabled(queue, saved);
+    printf("\nSpeedup com índice: busca %.1fx | remoção %.1fx\n",
+           search_ms[0] / search_ms[1], removal_ms[0] / removal_ms[1]);
 }
 
+// classifyFailures e a consulta "Type H com HDF ou OSF": varredura x operações nos bitmaps
+void benchmark_bitmap_index(CircularQueue* queue) {
+    if (queue->bitmaps == NULL) setBitmapIndexEnabled(queue, true);
+    const int reps = 100;
+    const int modes = parseFailureModes("HDF,OSF");
+    int scan_counts[3][6], bitmap_counts[3][6];
+    int scan_matches = 0, bitmap_matches = 0;
+    HighPrecisionTimer t;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        memset(scan_counts, 0, sizeof(scan_counts));
+        scanClassifyCounts(queue, scan_counts);
+    }
+    double scan_classify = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) bitmapClassifyCounts(queue->bitmaps, bitmap_counts);
+    double bitmap_classify = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) scan_matches = countTypeWithModes(queue, 'H', modes);
+    double scan_query = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapTypeWithModes(queue->bitmaps, 'H', modes, &rows);
+        bitmap_matches = roaringCardinality(&rows);
+        roaringFree(&rows);
+    }
+    double bitmap_query = stop_timer(&t) / reps;
+
+    int cube_counts[3][6];
+    const int cube_reps = 100000;
+    volatile int cube_sink = 0;
+    start_timer(&t);
+    for (int r = 0; r < cube_reps; r++) {
+        failureCubeCounts(&queue->stats.cube, cube_counts);
+        cube_sink += cube_counts[r % 3][0];
+    }
+    double cube_classify = stop_timer(&t) / cube_reps;
+
+    if (memcmp(scan_counts, bitmap_counts, sizeof(scan_counts)) != 0 || scan_matches != bitmap_matches)
+        printf("AVISO: bitmaps divergem da varredura!\n");
+    if (memcmp(scan_counts, cube_counts, sizeof(scan_counts)) != 0)
+        printf("AVISO: cubo de agregados diverge da varredura!\n");
+    printf("Classificação de falhas: varredura %.4f ms | popcount %.4f ms | speedup %.1fx\n",
+           scan_classify, bitmap_classify, scan_classify / bitmap_classify);
+    printf("Classificação pelo cubo incremental: %.6f ms | speedup %.0fx sobre a varredura\n",
+           cube_classify, scan_classify / cube_classify);
+    printf("Type H com HDF ou OSF (%d registros): varredura %.4f ms | bitmaps %.4f ms | speedup %.1fx\n",
+           bitmap_matches, scan_query, bitmap_query, scan_query / bitmap_query);
+    size_t bitmap_memory = bitmapIndexMemory(queue->bitmaps);
+    printf("Memória dos bitmaps: %zu bytes (%.2f KB)\n", bitmap_memory, (float)bitmap_memory / 1024);
+    benchRecord(queue->size, reps, scan_classify * reps, "Classificacao: varredura");
+    benchRecord(queue->size, reps, bitmap_classify * reps, "Classificacao: popcount");
+    benchRecord(queue->size, cube_reps, cube_classify * cube_reps, "Classificacao: cubo incremental");
+    benchRecord(queue->size, reps, scan_query * reps, "Type H com HDF ou OSF: varredura");
+    benchRecord(queue->size, reps, bitmap_query * reps, "Type H com HDF ou OSF: bitmaps");
+    benchRecordBytes(queue->size, (long long)bitmap_memory, "Memoria dos bitmaps");
+}
+
+// Filtro avançado sem a saída: laço escalar com um if por critério x plano vetorizado
+void benchmark_filter_engine(CircularQueue* queue) {
+    const int criteria[6] = {1, 1, 1, 1, 0, 1};
+    const float minVal[4] = {0, 30, 1400, 8};
+    const float maxVal[4] = {110, 45, 1550, 10.5f};
+    const int reps = 100;
+    int count;
+    const MachineData** rows = collectFilterRecords(queue, NULL, &count);
+    const MachineData** selected = (const MachineData**)malloc(sizeof(MachineData*) * (count + 1));
+    if (selected == NULL) {
+        perror("Erro ao alocar memória para o benchmark do filtro");
+        free(rows);
+        return;
+    }
+    FilterPlan plan = buildFilterPlan(criteria, minVal, maxVal, 0, false);
+    int scalar_matches = 0, engine_matches = 0;
+    HighPrecisionTimer t;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        scalar_matches = 0;
+        for (int i = 0; i < count; i++) {
+            scalar_matches += filterMatchesRecord(rows[i], criteria, minVal, maxVal, 0, false);
+        }
+    }
+    double scalar_ms = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) engine_matches = runFilterPlan(&plan, rows, count, selected);
+    double engine_ms = stop_timer(&t) / reps;
+
+    if (scalar_matches != engine_matches)
+        printf("AVISO: plano vetorizado diverge do laço escalar!\n");
+    printf("5 critérios sobre %d registros (%d aprovados)\n", count, engine_matches);
+    printf("Laço escalar: %.4f ms | Plano vetorizado: %.4f ms | speedup %.1fx\n",
+           scalar_ms, engine_ms, scalar_ms / engine_ms);
+    benchRecord(count, (long long)count * reps, scalar_ms * reps, "Filtro: laco escalar");
+    benchRecord(count, (long long)count * reps, engine_ms * reps, "Filtro: plano vetorizado");
+    free(rows);
+    free(selected);
+}
+
+// Definido junto da simulação da fresadora, depois dos padrões de falha
+void benchmark_pattern_index(CircularQueue* queue);
+void benchmark_failure_regions(CircularQueue* queue);
+void benchmark_failure_model(CircularQueue* queue);
+void benchmark_fleet_simulation(CircularQueue* queue);
+
 void run_all_benchmarks(CircularQueue* queue) {
     printf("\n=== INICIANDO BENCHMARKS COMPLETOS ===\n");
+    benchLogReset("");
+    printf("Relógio: %s (%.0f MHz) | memória: residente medida, heap por %s\n", timerSourceName(),
+           timerFrequency() / 1e6, memoryHeapSource());
+    MemorySnapshot mem;
     
     // 1. Benchmark de Inserção (onto a fresh queue for precise timing)
-    printf("\n1. Tempo de Inserção:\n");
+    benchSection("1. Tempo de Inserção");
+    memoryProbeStart(&mem);
     benchmark_insertion(1000);
     benchmark_insertion(10000);
     
-    // 2. Benchmark de Dequeue (remoção da frente)
-    printf("\n2. Tempo de Dequeue:\n");
+    // 2. Benchmark de Dequeue (remoção da frente) e de remoção arbitrária
+    benchMemoryDelta(&mem);
+    benchSection("2. Tempo de Dequeue e Remoção");
+    memoryProbeStart(&mem);
     benchmark_dequeue(queue); // Use the main queue for this test
+    benchmark_removal(queue);
     
     // 3. Benchmark de Busca
-    printf("\n3. Tempo de Busca:\n");
+    benchMemoryDelta(&mem);
+    benchSection("3. Tempo de Busca");
+    memoryProbeStart(&mem);
     benchmark_search(queue);
     
     // 4. Benchmark de Uso de Memória
-    printf("\n4. Uso de Memória:\n");
+    benchMemoryDelta(&mem);
+    benchSection("4. Uso de Memória");
+    memoryProbeStart(&mem);
     estimate_memory_usage(queue);
+    measure_memory_usage(queue);
     
     // 5. Benchmark de Tempo Médio de Acesso
-    printf("\n5. Tempo Médio de Acesso:\n");
+    benchMemoryDelta(&mem);
+    benchSection("5. Tempo Médio de Acesso");
+    memoryProbeStart(&mem);
     benchmark_random_access(queue);
     
     // 6. Benchmark de Escalabilidade
-    printf("\n6. Escalabilidade:\n");
+    benchMemoryDelta(&mem);
+    benchSection("6. Escalabilidade");
+    memoryProbeStart(&mem);
     benchmark_scalability();
     
     // 7. Benchmark de Latência Média
-    printf("\n7. Latência Média (operações combinadas):\n");
+    benchMemoryDelta(&mem);
+    benchSection("7. Latência por operação (operações combinadas)");
+    memoryProbeStart(&mem);
     benchmark_combined_operations();
+
+    // 8. Benchmark da fila persistente (arquivo mapeado)
+    benchMemoryDelta(&mem);
+    benchSection("8. Fila Persistente (enqueue x intervalo de durabilidade)");
+    memoryProbeStart(&mem);
+    benchmark_persistent_enqueue(5000);
+
+    benchMemoryDelta(&mem);
+    benchSection("9. Índice Hash por ProductID (desligado x ligado)");
+    memoryProbeStart(&mem);
+    benchmark_product_index(queue);
+
+    benchMemoryDelta(&mem);
+    benchSection("10. Bitmaps de Type/falhas (varredura x popcount)");
+    memoryProbeStart(&mem);
+    benchmark_bitmap_index(queue);
+
+    benchMemoryDelta(&mem);
+    benchSection("11. Filtro avançado (escalar x vetorizado)");
+    memoryProbeStart(&mem);
+    benchmark_filter_engine(queue);
+
+    benchMemoryDelta(&mem);
+    benchSection("12. Kernels de filtro especializados (10M linhas sintéticas)");
+    memoryProbeStart(&mem);
+    benchmark_filter_kernels();
+
+    benchMemoryDelta(&mem);
+    benchSection("13. Estatísticas em uma passada e redução paralela (50M linhas sintéticas)");
+    memoryProbeStart(&mem);
+    benchmark_parallel_stats();
+
+    benchMemoryDelta(&mem);
+    benchSection("14. Percentis: ordenação x sketches KLL");
+    memoryProbeStart(&mem);
+    benchmark_quantile_sketches();
+
+    benchMemoryDelta(&mem);
+    benchSection("15. Histogramas e correlações: linha a linha x lotes colunares");
+    memoryProbeStart(&mem);
+    benchmark_sensor_analytics();
     
+    benchMemoryDelta(&mem);
+    benchSection("16. Padrões de falha: varredura linear x R-tree (1M amostras simuladas)");
+    memoryProbeStart(&mem);
+    benchmark_pattern_index(queue);
+
+    benchMemoryDelta(&mem);
+    benchSection("17. Regiões de falha: um padrão por falha x caixas agrupadas (validação 80/20)");
+    memoryProbeStart(&mem);
+    benchmark_failure_regions(queue);
+
+    benchMemoryDelta(&mem);
+    benchSection("18. Árvores de decisão: treino, validação e inferência em blocos");
+    memoryProbeStart(&mem);
+    benchmark_failure_model(queue);
+
+    benchMemoryDelta(&mem);
+    benchSection("19. Frota em paralelo: amostras/s e latência dos alertas de 1 a 4096 máquinas");
+    memoryProbeStart(&mem);
+    benchmark_fleet_simulation(queue);
+
+    benchMemoryDelta(&mem);
+
     printf("\n=== BENCHMARKS CONCLUÍDOS ===\n");
 }
 
@@ -1014,7 +2398,7 @@ void generateAnomalousData(CircularQueue* queue, int count, int max_size) {
     
     for (int i = 0; i < count; i++) {
         if (i % 100 == 0) {
-            Sleep(1); // R10: Interrupções periódicas
+            sleepMilliseconds(1); // R10: Interrupções periódicas
         }
 
         MachineData d = {0};
@@ -1043,11 +2427,27 @@ void generateAnomalousData(CircularQueue* queue, int count, int max_size) {
         enqueue(queue, d); // enqueue automatically handles R2 (overwriting)
 
         if (i > 0 && i % 100 == 0) {
-            Sleep(50); // R13: Delay artificial por lote
+            sleepMilliseconds(50); // R13: Delay artificial por lote
         }
     }
 }
 
+// Copia os elementos vivos da fila para um array temporário (a fila não é reordenada)
+MachineData* copyQueueData(CircularQueue* queue, int* n) {
+    MachineData* temp_array = (MachineData*)malloc(sizeof(MachineData) * (queue->size > 0 ? queue->size : 1));
+    if (temp_array == NULL) {
+        perror("Erro ao alocar memória para ordenação");
+        return NULL;
+    }
+    *n = 0; // Live elements only (tombstones are skipped)
+    for (int i = 0; i < queue->size; i++) {
+        int index = (queue->front + i) % queue->capacity;
+        if (isSlotDead(queue, index)) continue;
+        temp_array[(*n)++] = queue->data[index];
+    }
+    return temp_array;
+}
+
 // R24: Ordenação por algoritmo ineficiente - adapted for a circular queue.
 // Note: Sorting a queue in place is not a standard or efficient operation.
 // This function will copy the queue elements to a temporary array, sort it, and display.
@@ -1055,22 +2455,14 @@ void generateAnomalousData(CircularQueue* queue, int count, int max_size) {
 void selectionSortQueueData(CircularQueue* queue) {
     if (isEmpty(queue) || queue->size < 2) return;
 
-    // Copy queue data to a temporary array for sorting
-    MachineData* temp_array = (MachineData*)malloc(sizeof(MachineData) * queue->size);
-    if (temp_array == NULL) {
-        perror("Erro ao alocar memória para ordenação");
-        return;
-    }
-
-    for (int i = 0; i < queue->size; i++) {
-        int index = (queue->front + i) % queue->capacity;
-        temp_array[i] = queue->data[index];
-    }
+    int n;
+    MachineData* temp_array = copyQueueData(queue, &n);
+    if (temp_array == NULL) return;
 
     // Apply selection sort to the temporary array
-    for (int i = 0; i < queue->size - 1; i++) {
+    for (int i = 0; i < n - 1; i++) {
         int min_idx = i;
-        for (int j = i + 1; j < queue->size; j++) {
+        for (int j = i + 1; j < n; j++) {
             if (temp_array[j].UDI < temp_array[min_idx].UDI) {
                 min_idx = j;
             }
@@ -1085,8 +2477,22 @@ void selectionSortQueueData(CircularQueue* queue) {
     free(temp_array);
 }
 
-void run_restricted_benchmarks() {
+#include "ESD-COMUM(ORDENACAO).h"
+
+// Mesma carga do R24, mas com radix sort O(n) sobre a cópia
+void radixSortQueueData(CircularQueue* queue) {
+    if (isEmpty(queue) || queue->size < 2) return;
+
+    int n;
+    MachineData* temp_array = copyQueueData(queue, &n);
+    if (temp_array == NULL) return;
+    radixSortByUDI(temp_array, n);
+    free(temp_array);
+}
+
+void run_restricted_benchmarks(bool r24Penalty) {
     printf("\n=== BENCHMARK COM RESTRIÇÕES ATIVADAS ===\n");
+    benchLogReset("Restricoes ativadas");
 
     CircularQueue queue;
     int restricted_capacity = 500; // R2: Limitação de tamanho (max_size)
@@ -1101,51 +2507,35 @@ void run_restricted_benchmarks() {
     double elapsed = stop_timer(&t);
 
     printf("\nTempo total de geração de dados (com 4 restrições aplicadas): %.3f ms\n", elapsed);
+    benchRecord(1000, 1000, elapsed, "Geracao com restricoes");
     printf("Elementos finais na fila (máximo %d): %d\n", restricted_capacity, queue.size);
 
-    // R24 – Ordenação por algoritmo ineficiente
-    printf("\nAplicando R24: ordenação ineficiente (selection sort)\n");
-    selectionSortQueueData(&queue); 
+    // R24 – Ordenação por algoritmo ineficiente (ou radix sort, para comparação)
+    start_timer(&t);
+    if (r24Penalty) {
+        printf("\nAplicando R24: ordenação ineficiente (selection sort)\n");
+        selectionSortQueueData(&queue);
+    } else {
+        printf("\nOrdenação por UDI com radix sort (R24 desativada)\n");
+        radixSortQueueData(&queue);
+    }
+    double sort_ms = stop_timer(&t);
+    printf("Tempo de ordenação: %.3f ms\n", sort_ms);
+    benchRecord(queue.size, queue.size, sort_ms, "Ordenacao por UDI (%s)", r24Penalty ? "selection sort" : "radix sort");
 
     // Benchmarks após restrições
     benchmark_search(&queue);
     benchmark_dequeue(&queue); // Test dequeue after restricted data generation
     benchmark_random_access(&queue);
     estimate_memory_usage(&queue);
+    measure_memory_usage(&queue);
 
     freeQueue(&queue);
 
     printf("\n=== FIM DOS TESTES COM RESTRIÇÕES ===\n");
 }
-// --- FUNÇÕES AUXILIARES PARA A LISTA DE PADRÕES DE FALHA ---
-
-// Inicializa a lista de padrões de falha
-void initFailurePatternList(FailurePatternList* list) {
-    list->patterns = NULL;
-    list->count = 0;
-    list->capacity = 0;
-}
 
-// Adiciona um padrão de falha à lista dinâmica
-void addFailurePattern(FailurePatternList* list, FailurePattern pattern) {
-    if (list->count == list->capacity) {
-        list->capacity = (list->capacity == 0) ? 1 : list->capacity * 2;
-        list->patterns = (FailurePattern*)realloc(list->patterns, list->capacity * sizeof(FailurePattern));
-        if (list->patterns == NULL) {
-            perror("Falha ao realocar memória para os padrões de falha");
-            exit(EXIT_FAILURE);
-        }
-    }
-    list->patterns[list->count++] = pattern;
-}
-
-// Libera a memória alocada para a lista de padrões de falha
-void freeFailurePatternList(FailurePatternList* list) {
-    free(list->patterns);
-    list->patterns = NULL;
-    list->count = 0;
-    list->capacity = 0;
-}
+#include "ESD-COMUM(PADROES).h"
 
 // --- FUNÇÕES DE APRENDIZAGEM E DETECÇÃO DE PADRÕES DE FALHA ---
 
@@ -1160,66 +2550,43 @@ void learnFailurePatterns(CircularQueue* queue, FailurePatternList* patterns) {
     }
 
     printf("\n=== APRENDENDO PADRÕES DE FALHA ===\n");
-    // Reinicia os padrões antes de aprender novos
-    freeFailurePatternList(patterns);
-    initFailurePatternList(patterns);
+    int count;
+    const MachineData** rows = collectFilterRecords(queue, NULL, &count);
+    HighPrecisionTimer t;
+    start_timer(&t);
+    int failures = learnFailureRegions(rows, count, patterns);
+    double ms = stop_timer(&t);
+    printf("Aprendidos %d padrões de falha (regiões) a partir de %d falhas dos dados existentes (%.2f ms).\n",
+           patterns->count, failures, ms);
+    displayPatternPrefilter(&patterns->prefilter);
 
-    int learned_count = 0;
-    for (int i = 0; i < queue->size; i++) {
-        int index = (queue->front + i) % queue->capacity;
-        if (queue->data[index].MachineFailure) { // Se houver falha na máquina
-            FailurePattern fp;
-            // Para este exemplo, armazena os valores exatos da instância de falha como um padrão.
-            fp.minAirTemp = fp.maxAirTemp = queue->data[index].AirTemp;
-            fp.minProcessTemp = fp.maxProcessTemp = queue->data[index].ProcessTemp;
-            fp.minRotationalSpeed = fp.maxRotationalSpeed = queue->data[index].RotationalSpeed;
-            fp.minTorque = fp.maxTorque = queue->data[index].Torque;
-            fp.minToolWear = fp.maxToolWear = queue->data[index].ToolWear;
-            
-            fp.hadTWF = queue->data[index].TWF;
-            fp.hadHDF = queue->data[index].HDF;
-            fp.hadPWF = queue->data[index].PWF;
-            fp.hadOSF = queue->data[index].OSF;
-            fp.hadRNF = queue->data[index].RNF;
-
-            addFailurePattern(patterns, fp);
-            learned_count++;
-        }
-    }
-    printf("Aprendidos %d padrões de falha a partir dos dados existentes.\n", learned_count);
+    start_timer(&t);
+    trainFailureModel(rows, count, &patterns->model);
+    ms = stop_timer(&t);
+    printf("Árvores de decisão treinadas (profundidade %d, %d alvos) em %.2f ms. Ajuste nos dados carregados:\n",
+           TREE_DEPTH, TREE_TARGETS, ms);
+    DetectionCounts counts[TREE_TARGETS];
+    evaluateFailureModel(&patterns->model, rows, count, counts);
+    displayFailureModelEvaluation(counts);
+    free(rows);
 }
 
-// VERIFICA SE OS DADOS ATUAIS CORRESPONDEM A UM PADRÃO DE FALHA APRENDIDO
-// Compara os dados da máquina com os padrões armazenados.
-// A correspondência atual é exata. Em um cenário real, você pode usar uma tolerância.
-bool checkForFailurePattern(MachineData data, FailurePatternList* patterns) {
-    for (int i = 0; i < patterns->count; i++) {
-        FailurePattern fp = patterns->patterns[i];
-
-        // Esta é uma correspondência exata. Considere adicionar uma tolerância (e.g., fabs(data.AirTemp - fp.minAirTemp) < epsilon)
-        bool match = true;
-        if (fabs(data.AirTemp - fp.minAirTemp) > 0.001 || // Usar fabs para float comparisons
-            fabs(data.ProcessTemp - fp.minProcessTemp) > 0.001 ||
-            data.RotationalSpeed != fp.minRotationalSpeed ||
-            fabs(data.Torque - fp.minTorque) > 0.001 ||
-            data.ToolWear != fp.minToolWear) {
-            match = false;
-        }
-
-        // Também verifica os flags de falha específicos se eles fazem parte da definição do seu padrão
-        if (match && (data.TWF != fp.hadTWF ||
-                      data.HDF != fp.hadHDF ||
-                      data.PWF != fp.hadPWF ||
-                      data.OSF != fp.hadOSF ||
-                      data.RNF != fp.hadRNF)) {
-            match = false;
-        }
+// Próximo UDI livre para amostras simuladas: maior UDI atual + 1
+int nextSimulatedUDI(CircularQueue* queue) {
+    int next_udi = 0;
 
-        if (match) {
-            return true; // Padrão detectado!
+    // Encontra o UDI máximo atual para continuar a partir dele
+    if (!isEmpty(queue)) {
+        for (int i = 0; i < queue->size; i++) {
+            int index = (queue->front + i) % queue->capacity;
+            if (isSlotDead(queue, index)) continue;
+            if (queue->data[index].UDI > next_udi) {
+                next_udi = queue->data[index].UDI;
+            }
         }
     }
-    return false; // Nenhum padrão correspondente encontrado
+    next_udi++; // Começa o UDI para novas simulações a partir do próximo número
+    return next_udi;
 }
 
 // --- FUNÇÃO DE SIMULAÇÃO DA FRESADORA ---
@@ -1228,77 +2595,40 @@ bool checkForFailurePattern(MachineData data, FailurePatternList* patterns) {
 // Gera dados de MachineData simulados.
 // Periodicamente, injeta um padrão de falha aprendido para demonstrar a detecção.
 // Opção 13 do menu.
-void simulateMillingMachine(CircularQueue* queue, FailurePatternList* patterns, int num_simulations) {
+void simulateMillingMachine(CircularQueue* queue, FailurePatternList* patterns, PersistentQueue* log, int num_simulations, unsigned int seed) {
     if (patterns->count == 0) {
         printf("Nenhum padrão de falha aprendido. Por favor, aprenda os padrões primeiro (Opção 12).\n");
         return;
     }
 
     printf("\n=== SIMULANDO FRESADORA E DETECTANDO FALHAS ===\n");
-    srand((unsigned)time(NULL)); // Inicializa o gerador de números aleatórios
+    displayPatternTolerance(patterns);
+    printf("Semente: %u\n", seed);
+    srand(seed); // Mesma semente, mesmo fluxo (ver recordSimulationStream)
     int failure_alerts = 0;
-    int next_udi = 0;
-
-    // Encontra o UDI máximo atual para continuar a partir dele
-    if (!isEmpty(queue)) {
-        for (int i = 0; i < queue->size; i++) {
-            int index = (queue->front + i) % queue->capacity;
-            if (queue->data[index].UDI > next_udi) {
-                next_udi = queue->data[index].UDI;
-            }
-        }
-    }
-    next_udi++; // Começa o UDI para novas simulações a partir do próximo número
+    int next_udi = nextSimulatedUDI(queue);
 
+    MachineData block[64];
+    unsigned long long blockAlerts = 0;
+    DetectionCounts patternHits = {0, 0, 0, 0}, modelHits = {0, 0, 0, 0};
     for (int i = 0; i < num_simulations; i++) {
-        MachineData simulatedData;
-        simulatedData.UDI = next_udi++;
-
-        // Gera ProductID e Tipo (pode ser aleatório ou seguir uma sequência)
-        snprintf(simulatedData.ProductID, sizeof(simulatedData.ProductID), "SIM%06d", rand() % 1000000);
-        simulatedData.Type = "LMH"[rand() % 3];
-
-        // Introduz variações em torno de valores típicos (menos de falha)
-        // Defina faixas razoáveis para a sua simulação de "operação normal"
-        simulatedData.AirTemp = 298.0f + (float)(rand() % 200) / 100.0f - 1.0f; // Ex: 297.0 a 299.0 K
-        simulatedData.ProcessTemp = simulatedData.AirTemp + 10.0f + (float)(rand() % 100) / 100.0f; // Ex: Processo geralmente mais alto
-        simulatedData.RotationalSpeed = 1400 + rand() % 200 - 100; // Ex: 1300 a 1500 rpm
-        simulatedData.Torque = 30.0f + (float)(rand() % 200) / 100.0f - 1.0f; // Ex: 29.0 a 31.0 Nm
-        simulatedData.ToolWear = 30 + rand() % 30 - 15; // Ex: 15 a 45 min
-
-        // Assume que não há falha inicialmente para dados simulados, a menos que um padrão seja injetado
-        simulatedData.MachineFailure = false;
-        simulatedData.TWF = false;
-        simulatedData.HDF = false;
-        simulatedData.PWF = false;
-        simulatedData.OSF = false;
-        simulatedData.RNF = false;
-
-        // Introduz um padrão de falha periodicamente ou aleatoriamente
-        // Aqui, há uma chance de 5% de injetar um padrão de falha aprendido
-        if (patterns->count > 0 && rand() % 20 == 0) { 
-            // Seleciona um padrão aprendido aleatório para injetar
-            int pattern_idx = rand() % patterns->count;
-            FailurePattern injected_pattern = patterns->patterns[pattern_idx];
-
-            // Sobrescreve os dados simulados com os valores do padrão de falha
-            simulatedData.AirTemp = injected_pattern.minAirTemp;
-            simulatedData.ProcessTemp = injected_pattern.minProcessTemp;
-            simulatedData.RotationalSpeed = injected_pattern.minRotationalSpeed;
-            simulatedData.Torque = injected_pattern.minTorque;
-            simulatedData.ToolWear = injected_pattern.minToolWear;
-            
-            // Define os flags de falha de acordo com o padrão
-            simulatedData.MachineFailure = true; // Isso é crucial para a detecção
-            simulatedData.TWF = injected_pattern.hadTWF;
-            simulatedData.HDF = injected_pattern.hadHDF;
-            simulatedData.PWF = injected_pattern.hadPWF;
-            simulatedData.OSF = injected_pattern.hadOSF;
-            simulatedData.RNF = injected_pattern.hadRNF;
+        // As amostras são geradas e comparadas com os padrões em blocos de 64 (um bit por amostra)
+        int slot = i % 64;
+        if (slot == 0) {
+            int len = num_simulations - i < 64 ? num_simulations - i : 64;
+            for (int j = 0; j < len; j++) generateSimulatedSample(&block[j], patterns, next_udi++);
+            checkForFailurePatternBatch(block, len, patterns, &blockAlerts);
         }
+        MachineData simulatedData = block[slot];
 
         // Verifica se os dados simulados correspondem a algum padrão de falha aprendido
-        if (checkForFailurePattern(simulatedData, patterns)) {
+        bool alert = (blockAlerts >> slot) & 1;
+        countDetection(&patternHits, alert, simulatedData.MachineFailure);
+        // No fluxo do simulador os caminhos se repetem e o if/else é previsto; ver benchmark_failure_model
+        if (patterns->model.trained)
+            countDetection(&modelHits, predictFailureModesScalar(&patterns->model, &simulatedData) & 1,
+                           simulatedData.MachineFailure);
+        if (alert) {
             printf("\n!!! ALERTA DE PADRÃO DE FALHA DETECTADO !!!\n");
             displayItem(simulatedData);
             failure_alerts++;
@@ -1308,17 +2638,189 @@ void simulateMillingMachine(CircularQueue* queue, FailurePatternList* patterns,
             // displayItem(simulatedData);
         }
 
-        // Adiciona os dados simulados à fila circular
+        // Adiciona os dados simulados à fila circular e ao log persistente
         enqueue(queue, simulatedData);
+        if (log) persistentEnqueue(log, simulatedData);
     }
     printf("\nSimulação concluída. Total de alertas de falha: %d\n", failure_alerts);
+    printf("Padrões: precisão %.1f%% | recall %.1f%% (falhas injetadas: %d)\n", detectionPrecision(&patternHits),
+           detectionRecall(&patternHits), patternHits.tp + patternHits.fn);
+    if (patterns->model.trained)
+        printf("Árvore de decisão: %d falhas previstas | precisão %.1f%% | recall %.1f%%\n", modelHits.tp + modelHits.fp,
+               detectionPrecision(&modelHits), detectionRecall(&modelHits));
+}
+
+// --- ADAPTAÇÃO DA FILA CIRCULAR AO CÓDIGO COMUM ---
+// As operações sobre esta estrutura de que o código comum precisa: frota, reprodução do fluxo,
+// carga de trabalho e benchmarks de padrões (ESD-COMUM(*).h).
+typedef CircularQueue WorkloadBackend;
+
+// A capacidade cobre o traço inteiro, então nenhuma inserção sobrescreve o registro mais antigo
+void workloadInit(CircularQueue* queue, int capacity) {
+    initQueue(queue, capacity);
+}
+
+void workloadFree(CircularQueue* queue) {
+    freeQueue(queue);
+}
+
+void workloadInsert(CircularQueue* queue, const MachineData* d) {
+    enqueue(queue, *d);
+}
+
+bool workloadFindUDI(CircularQueue* queue, int udi) {
+    return containsUDI(queue, udi);
+}
+
+bool workloadFindProductID(CircularQueue* queue, const char* pid) {
+    return containsProductID(queue, pid);
+}
+
+int workloadRangeCount(CircularQueue* queue, int lo, int hi) {
+    return countUDIRange(queue, lo, hi);
+}
+
+bool workloadDeleteUDI(CircularQueue* queue, int udi) {
+    return removeByUDI(queue, udi);
+}
+
+// Como calculateStatistics: lê as estatísticas incrementais da janela
+long long workloadStats(CircularQueue* queue) {
+    static volatile double sink; // Impede que o compilador descarte as leituras
+    for (int m = 0; m < WINDOW_METRICS; m++)
+        sink = sink + queue->stats.mean[m] + windowMax(queue, m) - windowMin(queue, m) + windowStdDev(queue, m);
+    return queue->stats.n;
+}
+
+#include "ESD-COMUM(FROTA).h"
+
+#include "ESD-COMUM(CARGA).h"
+
+#include "ESD-COMUM(PADROES-BENCHMARK).h"
+
+// --- BENCHMARK DA FROTA ---
+// FLEET_BENCH_SAMPLES amostras por configuração, divididas entre 1 até milhares de máquinas,
+// com uma thread e com todos os núcleos; cada rodada mescla numa estrutura vazia.
+void benchmark_fleet_simulation(CircularQueue* queue) {
+    FailurePatternList patterns;
+    initFailurePatternList(&patterns);
+    learnFailurePatterns(queue, &patterns);
+    memcpy(patterns.tolerance, patternSuggestedTolerance, sizeof(patterns.tolerance));
+    if (patterns.count == 0) {
+        printf("Nenhuma falha nos dados carregados; benchmark da frota ignorado.\n");
+        freeFailurePatternList(&patterns);
+        return;
+    }
+    int cores = availableCores();
+    printf("\n%9s %8s %11s %12s %9s %8s %8s %10s %10s %10s\n", "Maquinas", "Threads", "Tempo(ms)", "Mamostras/s",
+           "Alertas", "Recall", "Mescla", "p50(us)", "p99(us)", "max(us)");
+    static const int fleetSizes[] = {1, 16, 256, 4096};
+    for (int s = 0; s < (int)(sizeof(fleetSizes) / sizeof(fleetSizes[0])); s++) {
+        for (int pass = 0; pass < 2; pass++) {
+            int threads = pass == 0 ? 1 : cores;
+            if (pass == 1 && (cores == 1 || fleetSizes[s] == 1)) continue;
+            CircularQueue store;
+            initQueue(&store, DEFAULT_QUEUE_CAPACITY);
+            FleetReport r;
+            runFleetSimulation(&store, &patterns, fleetSizes[s], FLEET_BENCH_SAMPLES / fleetSizes[s], threads, 44, &r);
+            printf("%9d %8d %11.2f %12.2f %9d %7.1f%% %7.1f%% %10.1f %10.1f %10.1f\n", r.machines, r.threads, r.ms,
+                   r.samples / (r.ms * 1e3), r.hits.tp + r.hits.fp, detectionRecall(&r.hits),
+                   r.ms > 0 ? 100.0 * r.mergeMs / r.ms : 0.0, r.latencyP50, r.latencyP99, r.latencyMax);
+            BenchRecord* rec = benchRecord(r.samples, r.samples, r.ms, "Frota: %d maquinas x %d threads", r.machines, r.threads);
+            rec->p50 = r.latencyP50 * 1e3;
+            rec->p99 = r.latencyP99 * 1e3;
+            freeQueue(&store);
+        }
+    }
+    printf("(Mescla = fração do tempo dentro da seção crítica; recall dos alertas sobre as falhas geradas)\n");
+    freeFailurePatternList(&patterns);
 }
 
-int main() {
+// Modo batch: "--benchmarks [prefixo] [baseline.csv] [limiar%]" roda run_all_benchmarks, grava
+// <prefixo>.csv e .json e, com um baseline, sai com 1 se houver regressão
+int batchBenchmarks(CircularQueue* queue, int argc, char* argv[]) {
+    const char* prefix = argc > 2 ? argv[2] : BENCH_DEFAULT_OUTPUT;
+    run_all_benchmarks(queue);
+    if (saveBenchRecords(prefix) < 0) return 2;
+    if (argc < 4) return 0;
+    double threshold = argc > 4 && atof(argv[4]) > 0 ? atof(argv[4]) : BENCH_REGRESSION_THRESHOLD;
+    char csvPath[512];
+    snprintf(csvPath, sizeof(csvPath), "%s.csv", prefix);
+    int regressions = compareBenchFiles(csvPath, argv[3], threshold);
+    return regressions < 0 ? 2 : regressions > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    timerInit(); // Calibra o relógio antes de qualquer medição ou thread
+    if (argc > 1 && strcmp(argv[1], "--perf") == 0) { // Contadores de hardware; os outros argumentos seguem
+        enableHardwareCounters();
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+    }
     CircularQueue queue;
     initQueue(&queue, DEFAULT_QUEUE_CAPACITY); // Inicializa a fila com capacidade padrão
     parseCSV(&queue); // Carrega os dados iniciais do CSV
 
+    if (argc > 1 && strcmp(argv[1], "--analytics") == 0) {
+        int status = batchSensorAnalytics(&queue, argc, argv);
+        freeQueue(&queue);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--fleet") == 0) {
+        int status = batchFleetSimulation(&queue, argc, argv);
+        freeQueue(&queue);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--record") == 0) {
+        int status = batchRecordStream(&queue, argc, argv);
+        freeQueue(&queue);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--replay") == 0) {
+        int status = batchReplayStream(&queue, argc, argv);
+        freeQueue(&queue);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--workload") == 0) {
+        int status = batchWorkload(argc, argv);
+        freeQueue(&queue);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--benchmarks") == 0) {
+        int status = batchBenchmarks(&queue, argc, argv);
+        freeQueue(&queue);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--compare-benchmarks") == 0) {
+        int status = batchCompareBenchmarks(argc, argv);
+        freeQueue(&queue);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--check-log") == 0) {
+        int status = checkPersistentQueue();
+        freeQueue(&queue);
+        return status;
+    }
+
+    // Log persistente das amostras geradas em execução (inserção manual e simulação).
+    // Só o modo interativo usa o log: os modos em lote partem apenas do CSV, sem depender
+    // do que ficou no disco. O que foi confirmado antes de uma queda é recuperado aqui.
+    PersistentQueue sampleLog;
+    int recovered = openPersistentQueue(&sampleLog, PERSISTENT_LOG_FILE, DEFAULT_QUEUE_CAPACITY, PERSISTENT_SYNC_INTERVAL);
+    PersistentQueue* log = recovered >= 0 ? &sampleLog : NULL;
+    if (recovered > 0) {
+        replayPersistentQueue(&sampleLog, &queue);
+        printf("Recuperadas amostras do log persistente (%s).\n", PERSISTENT_LOG_FILE);
+    }
+
     // ADICIONE ESTAS DUAS LINHAS:
     FailurePatternList failurePatterns; // Declara a lista de padrões de falha
     initFailurePatternList(&failurePatterns); // Inicializa a lista
@@ -1348,7 +2850,13 @@ int main() {
             case 3: {
                 printf("Digite o Tipo para buscar (L, M, H): ");
                 if (fgets(input, sizeof(input), stdin)) {
-                    searchByType(&queue, toupper(input[0]));
+                    char type = toupper(input[0]);
+                    printf("Modos de falha (ex.: HDF,OSF; Enter para qualquer): ");
+                    int modes = fgets(input, sizeof(input), stdin) ? parseFailureModes(input) : 0;
+                    if (modes)
+                        searchByTypeAndFailureModes(&queue, type, modes);
+                    else
+                        searchByType(&queue, type);
                 }
                 break;
             }
@@ -1361,11 +2869,12 @@ int main() {
                 break;
             }
             case 5:
-    			insertManualSample(&queue);
+    			insertManualSample(&queue, log);
     			break;
             case 6: { // MODIFICADO AQUI
                 MachineData removed_data;
                 if (dequeue(&queue, &removed_data)) {
+                    if (log) persistentForget(log, &removed_data);
                     printf("Item removido do início da fila (UDI: %d, ProductID: %s).\n", 
                            removed_data.UDI, removed_data.ProductID);
                 } else {
@@ -1384,10 +2893,15 @@ int main() {
                 break;
             case 10:
                 run_all_benchmarks(&queue);
+                saveBenchRecords(BENCH_DEFAULT_OUTPUT);
+                break;
+            case 11: {
+                printf("Ordenação R24 (1-selection sort ineficiente, 0-ordenação O(n log n)): ");
+                bool r24Penalty = fgets(input, sizeof(input), stdin) && atoi(input) == 1;
+                run_restricted_benchmarks(r24Penalty);
+                saveBenchRecords(BENCH_RESTRICTED_OUTPUT);
                 break;
-            case 11:
-            	run_restricted_benchmarks();
-				break;
+            }
             // ADICIONE ESTES NOVOS CASES:
             case 12: // Nova opção: Aprender Padrões de Falha
                 learnFailurePatterns(&queue, &failurePatterns);
@@ -1397,7 +2911,8 @@ int main() {
                 int num_sims;
                 if (scanf("%d", &num_sims) == 1) {
                     while (getchar() != '\n'); // Limpa o buffer
-                    simulateMillingMachine(&queue, &failurePatterns, num_sims);
+                    if (failurePatterns.count > 0) readPatternTolerance(&failurePatterns);
+                    simulateMillingMachine(&queue, &failurePatterns, log, num_sims, (unsigned)time(NULL));
                 } else {
                     printf("Entrada inválida. Por favor, digite um número.\n");
                     while (getchar() != '\n'); // Limpa o buffer
@@ -1406,15 +2921,47 @@ int main() {
             }
             // FIM DOS NOVOS CASES
 
-            case 14: // Opção de saída atualizada (o número mudou de 12 para 14)
+            case 14: {
+                printf("Digite o ProductID para remover: ");
+                if (fgets(input, sizeof(input), stdin)) {
+                    input[strcspn(input, "\n")] = '\0';
+                    if (removeByProductID(&queue, input)) {
+                        if (log) persistentRemove(log, 0, input);
+                        printf("Item(s) removido(s) com sucesso.\n");
+                    }
+                    else
+                        printf("Nenhum item encontrado com o ProductID: %s\n", input);
+                }
+                break;
+            }
+            case 15: {
+                printf("Digite o UDI para remover: ");
+                if (fgets(input, sizeof(input), stdin)) {
+                    int udi = atoi(input);
+                    if (removeByUDI(&queue, udi)) {
+                        if (log) persistentRemove(log, udi, NULL);
+                        printf("Item removido com sucesso.\n");
+                    }
+                    else
+                        printf("Nenhum item encontrado com o UDI: %d\n", udi);
+                }
+                break;
+            }
+
+            case 16:
+                sensorAnalytics(&queue);
+                break;
+
+            case 17: // Opção de saída atualizada (o número mudou de 16 para 17)
                 printf("Saindo...\n");
                 break;
             default:
                 printf("Opção inválida. Tente novamente.\n");
         }
-    } while (choice != 14); // Condição de saída atualizada
+    } while (choice != 17); // Condição de saída atualizada
 
     freeQueue(&queue); // Libera a fila circular
+    if (log) closePersistentQueue(log); // Commit final do log persistente
     // ADICIONE ESTA LINHA:
     freeFailurePatternList(&failurePatterns); // Libera a memória da lista de padrões
     return 0;
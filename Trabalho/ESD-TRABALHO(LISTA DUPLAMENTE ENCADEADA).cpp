@@ -5,11 +5,53 @@
 #include <ctype.h>
 #include <math.h>
 #include <time.h>
+#include <limits.h>
+#include <stdarg.h>
+#ifdef _WIN32
 #include <windows.h>
-#include <profileapi.h>  // Para QueryPerformanceCounter de alta precisão
 #include <psapi.h>  // Para GetProcessMemoryInfo
+#endif
+#include <chrono> // steady_clock: relógio portátil das medições
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h> // SSE2 para o filtro vetorizado
+#define FILTER_SSE2
+#endif
+#ifndef _WIN32
+#include <pthread.h> // Redução paralela das estatísticas
+#include <unistd.h>  // sysconf
+#include <sys/resource.h> // getrusage: pico de memória do processo
+#endif
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h> // mallinfo2: bytes em uso no heap
+#define MEMORY_MALLINFO2
+#endif
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>    // __rdtsc, __cpuid
+#else
+#include <x86intrin.h> // __rdtsc
+#include <cpuid.h>     // __get_cpuid
+#endif
+#define TIMER_RDTSC
+#endif
+#if defined(_MSC_VER) && !defined(TIMER_RDTSC)
+#include <intrin.h> // _BitScanForward64 fora de x86 (ARM64)
+#endif
+#ifdef MEMORY_COUNTING
+#include <atomic>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h> // Contadores de hardware do modo --perf
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#define PERF_COUNTERS
+#endif
+
+#include "ESD-COMUM(INSTRUMENTACAO).h"
 
 #define MAX_LINHA 2048
+#define STRUCTURE_NAME "DoublyLinkedList" // Nome da estrutura nos registros dos benchmarks
+#define UNROLLED_NODE_CAPACITY 48 // Registros por nó da lista desenrolada
 
 // Estruturas de dados
 typedef struct {
@@ -29,30 +71,91 @@ typedef struct {
     bool RNF;
 } MachineData;
 
+#include "ESD-COMUM(BENCHMARK).h"
+#include "ESD-COMUM(INDICES).h"
+
 typedef struct Node {
     MachineData data;
     struct Node* prev;
     struct Node* next;
+    int row;               // Linha nos bitmaps de Type/falhas
 } Node;
 
 typedef struct {
     Node* head;
     Node* tail;
     int size;
+    ProductIndex* pidIndex; // ProductID -> endereços dos nós (NULL = índice desligado)
+    BitmapIndex* bitmaps;   // Type/falhas -> linhas (NULL = índice desligado)
+    QuantileSketches quantiles; // Percentis dos registros vivos (KLL, refeitos após remoções)
+    FailureCube cube;       // Contagens/somas por Type x modo de falha
+    Node** rows;            // Linha -> nó (NULL = removido); linhas não são reaproveitadas até renumerar
+    int rowCapacity;
+    int nextRow;
 } DoublyLinkedList;
 
-// Timer de alta precisão
+// Lista duplamente encadeada desenrolada: cada nó guarda até UNROLLED_NODE_CAPACITY
+// registros contíguos, então as varreduras percorrem arrays em vez de um ponteiro por amostra
+typedef struct UnrolledNode {
+    MachineData items[UNROLLED_NODE_CAPACITY];
+    int count;
+    struct UnrolledNode* prev;
+    struct UnrolledNode* next;
+} UnrolledNode;
+
 typedef struct {
-    LARGE_INTEGER start;
-    LARGE_INTEGER end;
-    LARGE_INTEGER frequency;
-} HighPrecisionTimer;
+    UnrolledNode* head;
+    UnrolledNode* tail;
+    int size;      // Total de registros
+    int nodeCount; // Total de nós
+} UnrolledList;
 
 // Implementações das funções básicas
 void initList(DoublyLinkedList* list) {
     list->head = NULL;
     list->tail = NULL;
     list->size = 0;
+    list->pidIndex = useProductIndex ? createProductIndex(0) : NULL;
+    list->bitmaps = useBitmapIndex ? createBitmapIndex() : NULL;
+    initQuantileSketches(&list->quantiles);
+    failureCubeInit(&list->cube);
+    list->rows = NULL;
+    list->rowCapacity = 0;
+    list->nextRow = 0;
+}
+
+// Dá ao nó a próxima linha dos bitmaps
+void bitmapAssignRow(DoublyLinkedList* list, Node* node) {
+    if (list->nextRow == list->rowCapacity) {
+        list->rowCapacity = list->rowCapacity ? list->rowCapacity * 2 : 1024;
+        list->rows = (Node**)realloc(list->rows, sizeof(Node*) * list->rowCapacity);
+        if (list->rows == NULL) {
+            perror("Erro ao alocar memória para o índice de bitmap");
+            exit(EXIT_FAILURE);
+        }
+    }
+    node->row = list->nextRow++;
+    list->rows[node->row] = node;
+    bitmapIndexAdd(list->bitmaps, &node->data, node->row);
+}
+
+void bitmapReleaseRow(DoublyLinkedList* list, Node* node) {
+    bitmapIndexRemove(list->bitmaps, &node->data, node->row);
+    list->rows[node->row] = NULL;
+}
+
+// Liga (numerando as linhas na ordem da lista) ou desliga os bitmaps de Type/falhas
+void setBitmapIndexEnabled(DoublyLinkedList* list, bool enabled) {
+    freeBitmapIndex(list->bitmaps);
+    free(list->rows);
+    list->bitmaps = NULL;
+    list->rows = NULL;
+    list->rowCapacity = 0;
+    list->nextRow = 0;
+    if (enabled) {
+        list->bitmaps = createBitmapIndex();
+        for (Node* cur = list->head; cur; cur = cur->next) bitmapAssignRow(list, cur);
+    }
 }
 
 void append(DoublyLinkedList* list, MachineData data) {
@@ -68,24 +171,17 @@ void append(DoublyLinkedList* list, MachineData data) {
         list->tail = newNode;
     }
     list->size++;
+    if (list->pidIndex) productIndexAdd(list->pidIndex, data.ProductID, (long long)(size_t)newNode);
+    if (list->bitmaps) {
+        if (list->nextRow >= 2 * list->size + 1024)
+            setBitmapIndexEnabled(list, true); // Remoções deixaram muitos buracos: renumera (já inclui newNode)
+        else
+            bitmapAssignRow(list, newNode);
+    }
+    quantileSketchesAdd(&list->quantiles, &data);
+    failureCubeAdd(&list->cube, &data);
 }
 
-typedef struct {
-    float minAirTemp, maxAirTemp;
-    float minProcessTemp, maxProcessTemp;
-    int minRotationalSpeed, maxRotationalSpeed;
-    float minTorque, maxTorque;
-    int minToolWear, maxToolWear;
-    bool hadTWF, hadHDF, hadPWF, hadOSF, hadRNF;
-} FailurePattern;
-
-// NOVA ESTRUTURA: Lista dinâmica para armazenar múltiplos padrões de falha
-typedef struct {
-    FailurePattern* patterns;
-    int count;
-    int capacity;
-} FailurePatternList;
-
 void freeList(DoublyLinkedList* list) {
     Node* curr = list->head;
     while (curr) {
@@ -95,6 +191,197 @@ void freeList(DoublyLinkedList* list) {
     }
     list->head = list->tail = NULL;
     list->size = 0;
+    failureCubeInit(&list->cube);
+    freeProductIndex(list->pidIndex);
+    list->pidIndex = NULL;
+    setBitmapIndexEnabled(list, false);
+    freeQuantileSketches(&list->quantiles);
+}
+
+// Liga (reconstruindo a partir dos nós) ou desliga o índice de ProductID
+void setProductIndexEnabled(DoublyLinkedList* list, bool enabled) {
+    freeProductIndex(list->pidIndex);
+    list->pidIndex = NULL;
+    if (enabled) {
+        list->pidIndex = createProductIndex(list->size * 2);
+        for (Node* cur = list->head; cur; cur = cur->next) {
+            productIndexAdd(list->pidIndex, cur->data.ProductID, (long long)(size_t)cur);
+        }
+    }
+}
+
+// Desencadeia e libera um nó, mantendo o índice
+void unlinkNode(DoublyLinkedList* list, Node* node) {
+    if (node->prev) node->prev->next = node->next;
+    else list->head = node->next;
+    if (node->next) node->next->prev = node->prev;
+    else list->tail = node->prev;
+    if (list->pidIndex) productIndexRemove(list->pidIndex, node->data.ProductID, (long long)(size_t)node);
+    if (list->bitmaps) bitmapReleaseRow(list, node);
+    failureCubeRemove(&list->cube, &node->data);
+    quantileSketchesInvalidate(&list->quantiles);
+    free(node);
+    list->size--;
+}
+
+// Inserção na posição pos (0..size): O(pos) para chegar ao nó. Com os bitmaps ligados, as
+// linhas são renumeradas para continuarem na ordem da lista (O(n)).
+void insertAt(DoublyLinkedList* list, int pos, MachineData data) {
+    if (pos >= list->size) {
+        append(list, data);
+        return;
+    }
+    Node* next = list->head;
+    for (int i = 0; i < pos; i++) next = next->next;
+    Node* newNode = (Node*)malloc(sizeof(Node));
+    if (newNode == NULL) {
+        perror("Erro ao alocar nó da lista");
+        exit(EXIT_FAILURE);
+    }
+    newNode->data = data;
+    newNode->next = next;
+    newNode->prev = next->prev;
+    if (next->prev) next->prev->next = newNode;
+    else list->head = newNode;
+    next->prev = newNode;
+    list->size++;
+    if (list->pidIndex) productIndexAdd(list->pidIndex, data.ProductID, (long long)(size_t)newNode);
+    if (list->bitmaps) setBitmapIndexEnabled(list, true);
+    quantileSketchesAdd(&list->quantiles, &data);
+    failureCubeAdd(&list->cube, &data);
+}
+
+// --- LISTA DESENROLADA ---
+
+void initUnrolledList(UnrolledList* list) {
+    list->head = NULL;
+    list->tail = NULL;
+    list->size = 0;
+    list->nodeCount = 0;
+}
+
+void freeUnrolledList(UnrolledList* list) {
+    UnrolledNode* curr = list->head;
+    while (curr) {
+        UnrolledNode* nxt = curr->next;
+        free(curr);
+        curr = nxt;
+    }
+    initUnrolledList(list);
+}
+
+// Cria um nó vazio e o encadeia depois de 'after' (ou no início se after == NULL)
+UnrolledNode* unrolledNewNodeAfter(UnrolledList* list, UnrolledNode* after) {
+    UnrolledNode* node = (UnrolledNode*)malloc(sizeof(UnrolledNode));
+    if (node == NULL) {
+        perror("Erro ao alocar nó da lista desenrolada");
+        exit(EXIT_FAILURE);
+    }
+    node->count = 0;
+    node->prev = after;
+    node->next = after ? after->next : list->head;
+    if (node->next) node->next->prev = node;
+    else list->tail = node;
+    if (after) after->next = node;
+    else list->head = node;
+    list->nodeCount++;
+    return node;
+}
+
+void unrolledUnlinkNode(UnrolledList* list, UnrolledNode* node) {
+    if (node->prev) node->prev->next = node->next;
+    else list->head = node->next;
+    if (node->next) node->next->prev = node->prev;
+    else list->tail = node->prev;
+    free(node);
+    list->nodeCount--;
+}
+
+// Inserção no fim: O(1), abre um nó novo só quando o último está cheio
+void unrolledAppend(UnrolledList* list, MachineData data) {
+    UnrolledNode* tail = list->tail;
+    if (tail == NULL || tail->count == UNROLLED_NODE_CAPACITY) {
+        tail = unrolledNewNodeAfter(list, list->tail);
+    }
+    tail->items[tail->count++] = data;
+    list->size++;
+}
+
+// Inserção na posição pos (0..size). Um nó cheio é dividido ao meio antes de inserir.
+void unrolledInsertAt(UnrolledList* list, int pos, MachineData data) {
+    if (pos >= list->size) {
+        unrolledAppend(list, data);
+        return;
+    }
+    UnrolledNode* node = list->head;
+    while (pos > node->count) { // pos == count insere no fim deste nó
+        pos -= node->count;
+        node = node->next;
+    }
+    if (node->count == UNROLLED_NODE_CAPACITY) {
+        UnrolledNode* right = unrolledNewNodeAfter(list, node);
+        int half = UNROLLED_NODE_CAPACITY / 2;
+        right->count = node->count - half;
+        memcpy(right->items, &node->items[half], sizeof(MachineData) * right->count);
+        node->count = half;
+        if (pos > half) {
+            pos -= half;
+            node = right;
+        }
+    }
+    memmove(&node->items[pos + 1], &node->items[pos], sizeof(MachineData) * (node->count - pos));
+    node->items[pos] = data;
+    node->count++;
+    list->size++;
+}
+
+// Mantém a ocupação mínima de metade do nó: funde com o próximo quando cabe,
+// senão pega registros emprestados dele. Nós vazios são liberados.
+void unrolledRebalance(UnrolledList* list) {
+    const int half = UNROLLED_NODE_CAPACITY / 2;
+    UnrolledNode* node = list->head;
+    while (node) {
+        UnrolledNode* next = node->next;
+        if (node->count == 0) {
+            unrolledUnlinkNode(list, node);
+            node = next;
+        } else if (node->count < half && next != NULL) {
+            if (node->count + next->count <= UNROLLED_NODE_CAPACITY) {
+                memcpy(&node->items[node->count], next->items, sizeof(MachineData) * next->count);
+                node->count += next->count;
+                unrolledUnlinkNode(list, next);
+            } else {
+                int moved = half - node->count;
+                memcpy(&node->items[node->count], next->items, sizeof(MachineData) * moved);
+                memmove(next->items, &next->items[moved], sizeof(MachineData) * (next->count - moved));
+                node->count += moved;
+                next->count -= moved;
+            }
+            // Reavalia o mesmo nó: após a fusão ele ainda pode estar abaixo da metade
+        } else {
+            node = next;
+        }
+    }
+}
+
+bool unrolledRemoveByProductID(UnrolledList* list, const char* pid) {
+    bool removed = false;
+    for (UnrolledNode* node = list->head; node; node = node->next) {
+        // Compacta o array do nó mantendo a ordem
+        int kept = 0;
+        for (int i = 0; i < node->count; i++) {
+            if (strcmp(node->items[i].ProductID, pid) == 0) continue;
+            if (kept != i) node->items[kept] = node->items[i];
+            kept++;
+        }
+        if (kept != node->count) {
+            list->size -= node->count - kept;
+            node->count = kept;
+            removed = true;
+        }
+    }
+    if (removed) unrolledRebalance(list);
+    return removed;
 }
 
 void removerAspas(char *str) {
@@ -385,6 +672,15 @@ void insertManualSample(DoublyLinkedList* list) {
 }
 
 void searchByProductID(DoublyLinkedList* list, const char* pid) {
+    if (list->pidIndex) {
+        ProductIndexEntry* e = productIndexFind(list->pidIndex, pid);
+        if (e == NULL) {
+            printf("Nenhum item com ProductID %s\n", pid);
+            return;
+        }
+        for (int i = 0; i < e->count; i++) displayItem(((Node*)(size_t)e->refs[i])->data);
+        return;
+    }
     Node* curr = list->head;
     bool achou = false;
     while (curr) {
@@ -397,10 +693,68 @@ void searchByProductID(DoublyLinkedList* list, const char* pid) {
     if (!achou) printf("Nenhum item com ProductID %s\n", pid);
 }
 
+// Registro de uma linha dos bitmaps
+MachineData* recordAtRow(DoublyLinkedList* list, unsigned int row) {
+    return list->rows[row] ? &list->rows[row]->data : NULL;
+}
+
+// Linhas de um bitmap na ordem da lista (as linhas crescem com append e são
+// renumeradas na ordem da lista após as ordenações)
+unsigned int* orderedRows(DoublyLinkedList* list, const RoaringBitmap* rows, int* count) {
+    (void)list;
+    unsigned int* out = (unsigned int*)roaringAlloc(sizeof(unsigned int) * (roaringCardinality(rows) + 1));
+    *count = roaringToArray(rows, out);
+    return out;
+}
+
+// Exibe os registros das linhas de um bitmap
+int displayRows(DoublyLinkedList* list, const RoaringBitmap* rows) {
+    int count;
+    unsigned int* ids = orderedRows(list, rows, &count);
+    for (int i = 0; i < count; i++) {
+        MachineData* d = recordAtRow(list, ids[i]);
+        if (d) displayItem(*d);
+    }
+    free(ids);
+    return count;
+}
+
+// Registros na ordem da estrutura; com candidates, só os das linhas desse bitmap
+const MachineData** collectFilterRecords(DoublyLinkedList* list, const RoaringBitmap* candidates, int* count) {
+    int capacity = candidates ? roaringCardinality(candidates) : list->size;
+    const MachineData** out = (const MachineData**)malloc(sizeof(MachineData*) * (capacity + 1));
+    if (out == NULL) {
+        perror("Erro ao alocar memória para o filtro");
+        exit(EXIT_FAILURE);
+    }
+    *count = 0;
+    if (candidates == NULL) {
+        for (Node* cur = list->head; cur; cur = cur->next) out[(*count)++] = &cur->data;
+        return out;
+    }
+    int n;
+    unsigned int* ids = orderedRows(list, candidates, &n);
+    for (int i = 0; i < n; i++) {
+        MachineData* d = recordAtRow(list, ids[i]);
+        if (d) out[(*count)++] = d;
+    }
+    free(ids);
+    return out;
+}
+
 void searchByType(DoublyLinkedList* list, char type) {
     Node* curr = list->head;
     bool achou = false;
     type = toupper(type);
+    if (list->bitmaps && bitmapCoversType(type)) { // Linhas do Type direto do bitmap
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapTypeWithModes(list->bitmaps, type, 0, &rows);
+        achou = displayRows(list, &rows) > 0;
+        roaringFree(&rows);
+        if (!achou) printf("Nenhum item do tipo %c\n", type);
+        return;
+    }
     while (curr) {
         if (toupper(curr->data.Type) == type) {
             displayItem(curr->data);
@@ -414,6 +768,15 @@ void searchByType(DoublyLinkedList* list, char type) {
 void searchByMachineFailure(DoublyLinkedList* list, bool f) {
     Node* curr = list->head;
     bool achou = false;
+    if (list->bitmaps) { // FAILURE ou ALL ANDNOT FAILURE
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapFilterCandidates(list->bitmaps, 0, f, &rows);
+        achou = displayRows(list, &rows) > 0;
+        roaringFree(&rows);
+        if (!achou) printf("Nenhum item com falha %d\n", f);
+        return;
+    }
     while (curr) {
         if (curr->data.MachineFailure == f) {
             displayItem(curr->data);
@@ -424,107 +787,160 @@ void searchByMachineFailure(DoublyLinkedList* list, bool f) {
     if (!achou) printf("Nenhum item com falha %d\n", f);
 }
 
+// Busca por Type com pelo menos um dos modos de falha (ex.: H com HDF ou OSF)
+void searchByTypeAndFailureModes(DoublyLinkedList* list, char type, int modeMask) {
+    int found = 0;
+    if (list->bitmaps && bitmapCoversType(type)) {
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapTypeWithModes(list->bitmaps, type, modeMask, &rows);
+        found = displayRows(list, &rows);
+        roaringFree(&rows);
+    } else {
+        for (Node* cur = list->head; cur; cur = cur->next) {
+            if (recordMatchesTypeModes(&cur->data, type, modeMask)) {
+                displayItem(cur->data);
+                found++;
+            }
+        }
+    }
+    if (!found) printf("Nenhum item do tipo %c com os modos de falha escolhidos\n", toupper(type));
+}
+
+// Contagens de classifyFailures por varredura (sem bitmaps)
+void scanClassifyCounts(DoublyLinkedList* list, int counts[3][6]) {
+    for (Node* cur = list->head; cur; cur = cur->next) classifyRecord(&cur->data, counts);
+}
+
+int countTypeWithModes(DoublyLinkedList* list, char type, int modeMask) {
+    int count = 0;
+    for (Node* cur = list->head; cur; cur = cur->next) count += recordMatchesTypeModes(&cur->data, type, modeMask);
+    return count;
+}
+
+// Existe algum registro com o ProductID? (O(1) com índice, O(n) sem)
+bool containsProductID(DoublyLinkedList* list, const char* pid) {
+    if (list->pidIndex) return productIndexFind(list->pidIndex, pid) != NULL;
+    for (Node* cur = list->head; cur; cur = cur->next) {
+        if (strcmp(cur->data.ProductID, pid) == 0) return true;
+    }
+    return false;
+}
+
 bool removeByProductID(DoublyLinkedList* list, const char* pid) {
+    if (list->pidIndex) {
+        long long* refs;
+        int count = productIndexCopyRefs(list->pidIndex, pid, &refs);
+        for (int i = 0; i < count; i++) {
+            unlinkNode(list, (Node*)(size_t)refs[i]);
+        }
+        free(refs);
+        return count > 0;
+    }
     Node* curr = list->head;
     bool removed = false;
     while (curr) {
+        Node* next = curr->next;
         if (strcmp(curr->data.ProductID, pid) == 0) {
-            Node* toDel = curr;
-            if (curr->prev) curr->prev->next = curr->next;
-            else list->head = curr->next;
-            if (curr->next) curr->next->prev = curr->prev;
-            else list->tail = curr->prev;
-            curr = curr->next;
-            free(toDel);
-            list->size--;
+            unlinkNode(list, curr);
             removed = true;
-        } else curr = curr->next;
+        }
+        curr = next;
     }
     return removed;
 }
 
+// A lista não é ordenada pelo UDI: busca, remoção e intervalo percorrem todos os nós (O(n))
+bool containsUDI(DoublyLinkedList* list, int udi) {
+    for (Node* cur = list->head; cur; cur = cur->next) {
+        if (cur->data.UDI == udi) return true;
+    }
+    return false;
+}
+
+bool removeByUDI(DoublyLinkedList* list, int udi) {
+    Node* curr = list->head;
+    bool removed = false;
+    while (curr) {
+        Node* next = curr->next;
+        if (curr->data.UDI == udi) {
+            unlinkNode(list, curr);
+            removed = true;
+        }
+        curr = next;
+    }
+    return removed;
+}
+
+int countUDIRange(DoublyLinkedList* list, int lo, int hi) {
+    int count = 0;
+    for (Node* cur = list->head; cur; cur = cur->next) count += cur->data.UDI >= lo && cur->data.UDI <= hi;
+    return count;
+}
+
+#include "ESD-COMUM(ESTATISTICAS).h"
+
 void displayStats(const char* title, float avg, float max, float min, float stdDev) {
     printf("\n%s:\nMédia=%.2f | Máximo=%.2f | Mínimo=%.2f | Desvio=%.2f\n",
            title, avg, max, min, stdDev);
 }
 
+// Sketches em dia com os registros vivos: depois de remoções, refeitos numa passada
+QuantileSketches* liveQuantiles(DoublyLinkedList* list) {
+    if (list->quantiles.stale) {
+        int count;
+        const MachineData** rows = collectFilterRecords(list, NULL, &count);
+        rebuildQuantileSketches(&list->quantiles, rows, count);
+        free(rows);
+    }
+    return &list->quantiles;
+}
+
 void calculateStatistics(DoublyLinkedList* list) {
     if (list->size == 0) {
         printf("Lista vazia. Nenhum dado para análise.\n");
         return;
     }
 
-    // Variáveis para ToolWear
-    float twSum = 0, twMax = -INFINITY, twMin = INFINITY;
-    float twSqDiffSum = 0;
-    
-    // Variáveis para Torque
-    float tqSum = 0, tqMax = -INFINITY, tqMin = INFINITY;
-    float tqSqDiffSum = 0;
-    
-    // Variáveis para RotationalSpeed
-    int rsSum = 0, rsMax = -INT_MAX, rsMin = INT_MAX;
-    float rsSqDiffSum = 0;
-    
-    // Variáveis para diferença de temperatura
-    float tempDiffSum = 0, tempDiffMax = -INFINITY, tempDiffMin = INFINITY;
-    float tempDiffSqDiffSum = 0;
-
-    Node* current = list->head;
-    while (current != NULL) {
-        // Cálculos para ToolWear
-        twSum += current->data.ToolWear;
-        if (current->data.ToolWear > twMax) twMax = current->data.ToolWear;
-        if (current->data.ToolWear < twMin) twMin = current->data.ToolWear;
-        
-        // Cálculos para Torque
-        tqSum += current->data.Torque;
-        if (current->data.Torque > tqMax) tqMax = current->data.Torque;
-        if (current->data.Torque < tqMin) tqMin = current->data.Torque;
-        
-        // Cálculos para RotationalSpeed
-        rsSum += current->data.RotationalSpeed;
-        if (current->data.RotationalSpeed > rsMax) rsMax = current->data.RotationalSpeed;
-        if (current->data.RotationalSpeed < rsMin) rsMin = current->data.RotationalSpeed;
-        
-        // Cálculos para diferença de temperatura
-        float diff = current->data.ProcessTemp - current->data.AirTemp;
-        tempDiffSum += diff;
-        if (diff > tempDiffMax) tempDiffMax = diff;
-        if (diff < tempDiffMin) tempDiffMin = diff;
-
-        current = current->next;
+    // Uma passada (Welford); com muitos registros, blocos acumulados em paralelo e fundidos
+    RunningStats rs;
+    if (list->size >= STATS_PARALLEL_MIN_ROWS) {
+        int count;
+        const MachineData** rows = collectFilterRecords(list, NULL, &count);
+        runningStatsParallel(rows, count, availableCores(), &rs);
+        free(rows);
+    } else {
+        runningStatsInit(&rs);
+        for (Node* current = list->head; current != NULL; current = current->next)
+            runningStatsAdd(&rs, &current->data);
     }
 
-    // Cálculo das médias
-    float twAvg = twSum / list->size;
-    float tqAvg = tqSum / list->size;
-    float rsAvg = (float)rsSum / list->size;
-    float tempDiffAvg = tempDiffSum / list->size;
-
-    // Segunda passada para calcular desvios padrão
-    current = list->head;
-    while (current != NULL) {
-        twSqDiffSum += pow(current->data.ToolWear - twAvg, 2);
-        tqSqDiffSum += pow(current->data.Torque - tqAvg, 2);
-        rsSqDiffSum += pow(current->data.RotationalSpeed - rsAvg, 2);
-        float diff = current->data.ProcessTemp - current->data.AirTemp;
-        tempDiffSqDiffSum += pow(diff - tempDiffAvg, 2);
-        current = current->next;
+    printf("\n=== ESTATÍSTICAS DE OPERAÇÃO ===\n");
+    for (int m = 0; m < STAT_METRICS; m++) {
+        displayStats(statMetricTitles[m], (float)rs.mean[m], (float)rs.max[m], (float)rs.min[m],
+                     (float)runningStatsStdDev(&rs, m));
     }
 
-    // Cálculo dos desvios padrão
-    float twStdDev = sqrt(twSqDiffSum / list->size);
-    float tqStdDev = sqrt(tqSqDiffSum / list->size);
-    float rsStdDev = sqrt(rsSqDiffSum / list->size);
-    float tempDiffStdDev = sqrt(tempDiffSqDiffSum / list->size);
+    printf("\nPercentis dos registros (sketches KLL, erro de rank ~1,65%%):\n");
+    displayQuantiles(liveQuantiles(list), statMetricTitles);
+}
 
-    // Exibição dos resultados
-    printf("\n=== ESTATÍSTICAS DE OPERAÇÃO ===\n");
-    displayStats("Desgaste da Ferramenta (ToolWear)", twAvg, twMax, twMin, twStdDev);
-    displayStats("Torque (Nm)", tqAvg, tqMax, tqMin, tqStdDev);
-    displayStats("Velocidade Rotacional (RPM)", rsAvg, rsMax, rsMin, rsStdDev);
-    displayStats("Diferença de Temperatura (ProcessTemp - AirTemp)", tempDiffAvg, tempDiffMax, tempDiffMin, tempDiffStdDev);
+// Modo batch: "--check-quantiles [ProductID]" remove o ProductID dado (sem ele, os de todos os
+// registros com ToolWear acima da mediana) e confere os percentis dos sketches com os exatos
+// dos registros restantes. Sai com 1 se algo não confere.
+int checkQuantilesAfterRemoval(DoublyLinkedList* list, int argc, char* argv[]) {
+    int count, victims;
+    const MachineData** rows = collectFilterRecords(list, NULL, &count);
+    MachineData* removed = selectQuantileCheckVictims(rows, count, argc > 2 ? argv[2] : NULL, &victims);
+    free(rows);
+    if (removed == NULL) return 1;
+    for (int i = 0; i < victims; i++) removeByProductID(list, removed[i].ProductID);
+    free(removed);
+    rows = collectFilterRecords(list, NULL, &count);
+    printf("%d ProductID(s) removido(s), %d registros restantes\n", victims, count);
+    int failures = victims == 0 ? 1 : checkQuantileSketches(liveQuantiles(list), rows, count, statMetricTitles);
+    free(rows);
+    return failures ? 1 : 0;
 }
 
 void classifyFailures(DoublyLinkedList* list) {
@@ -546,41 +962,18 @@ void classifyFailures(DoublyLinkedList* list) {
     TypeStats stats[3] = {0}; // 0: L, 1: M, 2: H
     int totalFailures[5] = {0}; // TWF, HDF, PWF, OSF, RNF
 
-    Node* current = list->head;
-    while (current != NULL) {
-        int typeIndex = -1;
-        switch (toupper(current->data.Type)) {
-            case 'L': typeIndex = 0; break;
-            case 'M': typeIndex = 1; break;
-            case 'H': typeIndex = 2; break;
-        }
-
-        if (typeIndex != -1) {
-            stats[typeIndex].total++;
-            
-            if (current->data.TWF) {
-                stats[typeIndex].twf++;
-                totalFailures[0]++;
-            }
-            if (current->data.HDF) {
-                stats[typeIndex].hdf++;
-                totalFailures[1]++;
-            }
-            if (current->data.PWF) {
-                stats[typeIndex].pwf++;
-                totalFailures[2]++;
-            }
-            if (current->data.OSF) {
-                stats[typeIndex].osf++;
-                totalFailures[3]++;
-            }
-            if (current->data.RNF) {
-                stats[typeIndex].rnf++;
-                totalFailures[4]++;
-            }
-        }
-
-        current = current->next;
+    // Contagens lidas do cubo mantido na inserção/remoção: O(1), sem percorrer a estrutura
+    int counts[3][6];
+    failureCubeCounts(&list->cube, counts);
+
+    for (int t = 0; t < 3; t++) {
+        stats[t].total = counts[t][0];
+        stats[t].twf = counts[t][1];
+        stats[t].hdf = counts[t][2];
+        stats[t].pwf = counts[t][3];
+        stats[t].osf = counts[t][4];
+        stats[t].rnf = counts[t][5];
+        for (int m = 0; m < 5; m++) totalFailures[m] += counts[t][m + 1];
     }
 
     // Exibe resultados
@@ -634,6 +1027,8 @@ void classifyFailures(DoublyLinkedList* list) {
     printf("PWF: %d ocorrências\n", totalFailures[2]);
     printf("OSF: %d ocorrências\n", totalFailures[3]);
     printf("RNF: %d ocorrências\n", totalFailures[4]);
+
+    displayFailureCubeAverages(&list->cube);
 }
 
 void advancedFilter(DoublyLinkedList* list) {
@@ -674,61 +1069,39 @@ void advancedFilter(DoublyLinkedList* list) {
             criteria[5] = 1;
             hasFailureFilter = true;
             printf("Filtrar por máquinas com falha? (1-Sim, 0-Não): ");
-            scanf("%d", &failureFilter);
+            int failureValue = 0;
+            scanf("%d", &failureValue);
+            failureFilter = failureValue != 0;
         }
     } while (choice != 0);
     
     // Aplicar filtros
     printf("\nResultados do Filtro:\n");
-    int matches = 0;
-    Node* current = list->head;
-    
-    while (current != NULL) {
-        bool match = true;
-        
-        // Verificar cada critério
-        if (criteria[0] && (current->data.ToolWear < minVal[0] || current->data.ToolWear > maxVal[0])) {
-            match = false;
-        }
-        if (match && criteria[1] && (current->data.Torque < minVal[1] || current->data.Torque > maxVal[1])) {
-            match = false;
-        }
-        if (match && criteria[2] && (current->data.RotationalSpeed < minVal[2] || current->data.RotationalSpeed > maxVal[2])) {
-            match = false;
-        }
-        if (match && criteria[3]) {
-            float tempDiff = current->data.ProcessTemp - current->data.AirTemp;
-            if (tempDiff < minVal[3] || tempDiff > maxVal[3]) {
-                match = false;
-            }
-        }
-        if (match && criteria[4] && toupper(current->data.Type) != typeFilter) {
-            match = false;
-        }
-        if (match && criteria[5] && current->data.MachineFailure != failureFilter) {
-            match = false;
-        }
-        
-        if (match) {
-            printf("UDI: %d | ProductID: %s | Type: %c | ", 
-                   current->data.UDI, current->data.ProductID, current->data.Type);
-            
-            if (criteria[0]) printf("ToolWear: %d | ", current->data.ToolWear);
-            if (criteria[1]) printf("Torque: %.1f | ", current->data.Torque);
-            if (criteria[2]) printf("RPM: %d | ", current->data.RotationalSpeed);
-            if (criteria[3]) {
-                float tempDiff = current->data.ProcessTemp - current->data.AirTemp;
-                printf("TempDiff: %.1f | ", tempDiff);
-            }
-            if (criteria[5]) printf("Failure: %d | ", current->data.MachineFailure);
-            
-            printf("\n");
-            matches++;
-        }
-        
-        current = current->next;
+
+    FilterPlan plan = buildFilterPlan(criteria, minVal, maxVal, typeFilter, failureFilter);
+    RoaringBitmap candidates;
+    roaringInit(&candidates);
+    bool useBitmaps = list->bitmaps && (plan.byType || plan.byFailure) && (!plan.byType || bitmapCoversType(typeFilter));
+    if (useBitmaps) {
+        // Type e falha saem dos bitmaps; o plano fica só com os intervalos numéricos
+        bitmapFilterCandidates(list->bitmaps, plan.byType ? typeFilter : 0, plan.byFailure ? failureFilter : -1, &candidates);
+        plan.byType = false;
+        plan.byFailure = false;
     }
-    
+    int count;
+    const MachineData** rows = collectFilterRecords(list, useBitmaps ? &candidates : NULL, &count);
+    roaringFree(&candidates);
+    int matches;
+    if (plan.rangeCount + plan.byType + plan.byFailure >= FILTER_PLAN_MIN_PREDICATES) {
+        matches = runFilterPlan(&plan, rows, count, rows);
+    } else {
+        // Poucos predicados: o kernel especializado dispensa a transposição em colunas
+        int active[6] = {criteria[0], criteria[1], criteria[2], criteria[3], plan.byType, plan.byFailure};
+        matches = selectFilterKernel(active)(rows, count, minVal, maxVal, typeFilter, failureFilter, rows);
+    }
+    writeFilterMatches(rows, matches, criteria);
+    free(rows);
+
     printf("\nTotal de máquinas que atendem aos critérios: %d\n", matches);
 }
 
@@ -747,19 +1120,67 @@ void displayMenu() {
     printf("11. Executar Benchmarks Restritos\n");
     printf("12. Aprender Padrões de Falha\n");        // NOVA OPÇÃO
     printf("13. Simular Fresadora e Detectar Falhas\n"); // NOVA OPÇÃO
-    printf("14. Sair\n");                               // Opção de saída atualizada
+    printf("14. Histogramas e Correlações\n");
+    printf("15. Sair\n");                               // Opção de saída atualizada
     printf("Escolha: ");
 }
 
-// Implementação das funções de benchmark com alta precisão
-void start_timer(HighPrecisionTimer* timer) {
-    QueryPerformanceFrequency(&timer->frequency);
-    QueryPerformanceCounter(&timer->start);
+// Histogramas e correlações por modo de falha numa passada (opção do menu)
+void sensorAnalytics(DoublyLinkedList* list) {
+    if (list->size == 0) {
+        printf("Lista vazia. Nenhum dado para análise.\n");
+        return;
+    }
+    AnalyticsConfig cfg;
+    readAnalyticsConfig(&cfg);
+    int count;
+    const MachineData** rows = collectFilterRecords(list, NULL, &count);
+    SensorAnalytics* a = (SensorAnalytics*)malloc(sizeof(SensorAnalytics));
+    if (a == NULL) {
+        perror("Erro ao alocar memória para a análise dos sensores");
+        free(rows);
+        return;
+    }
+    int threads = count >= STATS_PARALLEL_MIN_ROWS ? availableCores() : 1;
+    HighPrecisionTimer t;
+    start_timer(&t);
+    runSensorAnalytics(rows, count, &cfg, threads, a);
+    double ms = stop_timer(&t);
+    displaySensorAnalytics(a);
+    printf("\nPassada única sobre %d registros: %.3f ms (%d thread(s), %s)\n", count, ms, threads, ANALYTICS_SIMD_NAME);
+
+    char input[16];
+    printf("Gravar também em CSV (%s_*.csv)? (s/n): ", ANALYTICS_DEFAULT_PREFIX);
+    if (fgets(input, sizeof(input), stdin) && toupper((unsigned char)input[0]) == 'S')
+        writeSensorAnalyticsCSV(a, ANALYTICS_DEFAULT_PREFIX);
+    free(a);
+    free(rows);
 }
 
-double stop_timer(HighPrecisionTimer* timer) {
-    QueryPerformanceCounter(&timer->end);
-    return (double)(timer->end.QuadPart - timer->start.QuadPart) * 1000.0 / timer->frequency.QuadPart;
+// Modo batch: "--analytics [faixas] [prefixo]" grava os CSVs com as faixas padrão, sem menu
+int batchSensorAnalytics(DoublyLinkedList* list, int argc, char* argv[]) {
+    int bins = argc > 2 && atoi(argv[2]) > 0 ? atoi(argv[2]) : HIST_DEFAULT_BINS;
+    const char* prefix = argc > 3 ? argv[3] : ANALYTICS_DEFAULT_PREFIX;
+    AnalyticsConfig cfg;
+    analyticsDefaultConfig(&cfg, bins);
+    int count;
+    const MachineData** rows = collectFilterRecords(list, NULL, &count);
+    SensorAnalytics* a = (SensorAnalytics*)malloc(sizeof(SensorAnalytics));
+    if (a == NULL) {
+        perror("Erro ao alocar memória para a análise dos sensores");
+        free(rows);
+        return 1;
+    }
+    int threads = count >= STATS_PARALLEL_MIN_ROWS ? availableCores() : 1;
+    HighPrecisionTimer t;
+    start_timer(&t);
+    runSensorAnalytics(rows, count, &cfg, threads, a);
+    double ms = stop_timer(&t);
+    printf("Análise de %d registros: %.3f ms (%d thread(s), %s)\n", count, ms, threads, ANALYTICS_SIMD_NAME);
+    int status = writeSensorAnalyticsCSV(a, prefix);
+    free(a);
+    free(rows);
+    return status;
 }
 
 void generateRandomData(DoublyLinkedList* list, int count) {
@@ -786,34 +1207,46 @@ void generateRandomData(DoublyLinkedList* list, int count) {
 
 void benchmark_insertion(DoublyLinkedList* list, int num_elements) {
     HighPrecisionTimer t;
+    HwCounters hw;
+    hwCountersStart(&hw);
     start_timer(&t);
     DoublyLinkedList tmp;
     initList(&tmp);
     generateRandomData(&tmp, num_elements);
     double elapsed = stop_timer(&t);
+    hwCountersStop(&hw);
     printf("\nBenchmark Inserção (%d elementos): %.3f ms (%.1f elem/ms)\n",
            num_elements, elapsed, num_elements / elapsed);
+    benchRecord(num_elements, num_elements, elapsed, "Insercao");
+    printHwCounters(&hw, num_elements);
     freeList(&tmp);
 }
 
+typedef struct {
+    DoublyLinkedList* list;
+    long long hits;    // Encontrados (ou soma dos UDIs): evita que as buscas sejam descartadas
+} SearchBench;
+
+int benchSearchOp(void* ctx, int) {
+    SearchBench* b = (SearchBench*)ctx;
+    char id[10];
+    snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
+    if (containsProductID(b->list, id)) b->hits++;
+    return 0;
+}
+
 void benchmark_search(DoublyLinkedList* list) {
     if (list->size == 0) { printf("Lista vazia para busca\n"); return; }
-    HighPrecisionTimer t;
-    const int searches = 10000;
-    int found = 0;
-    start_timer(&t);
-    for (int i = 0; i < searches; i++) {
-        char id[10];
-        snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
-        Node* cur = list->head;
-        while (cur) {
-            if (strcmp(cur->data.ProductID, id) == 0) { found++; break; }
-            cur = cur->next;
-        }
-    }
-    double elapsed = stop_timer(&t);
-    printf("\nBenchmark Busca (%d ops): encontrados=%d | tempo=%.3f ms (%.1f ops/ms)\n",
-           searches, found, elapsed, searches / elapsed);
+    SearchBench b = {list, 0};
+    BenchScenario s = {"Busca por ProductID", 10000, &b, NULL, benchSearchOp, NULL, 1, {NULL}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("\nBenchmark Busca (%d ops x %d rodadas, %d de aquecimento): encontrados=%.1f%%\n", s.opsPerRun,
+           r.runs, BENCH_WARMUP_RUNS, 100.0 * b.hits / ((double)s.opsPerRun * (BENCH_WARMUP_RUNS + BENCH_RUNS)));
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchScenarioCounters(&s);
+    benchRecordResult(&s, &r, list->size);
 }
 
 void benchmark_removal(DoublyLinkedList* list) {
@@ -833,6 +1266,7 @@ void benchmark_removal(DoublyLinkedList* list) {
     double elapsed = stop_timer(&t);
     printf("\nBenchmark Remoção (%d ops): %.3f ms (%.1f ops/ms)\n",
            removals, elapsed, removals / elapsed);
+    benchRecord(list->size, removals, elapsed, "Remocao");
     freeList(&tmp);
 }
 // Função para medir o uso de memória
@@ -877,6 +1311,14 @@ void estimate_memory_usage(DoublyLinkedList* list) {
     printf("Número de nós: %d\n", list->size);
     printf("Memória total estimada: %zu bytes (%.2f KB)\n", 
            total_memory, (float)total_memory / 1024);
+    if (list->pidIndex) {
+        size_t index_memory = productIndexMemory(list->pidIndex);
+        printf("Índice por ProductID: %zu bytes (%.2f KB)\n", index_memory, (float)index_memory / 1024);
+    }
+    if (list->bitmaps) {
+        size_t bitmap_memory = bitmapIndexMemory(list->bitmaps) + sizeof(Node*) * list->rowCapacity;
+        printf("Bitmaps de Type/falhas: %zu bytes (%.2f KB)\n", bitmap_memory, (float)bitmap_memory / 1024);
+    }
     
     // Adicional: comparar com o tamanho real da estrutura
     printf("\nComparação com sizeof:\n");
@@ -885,32 +1327,53 @@ void estimate_memory_usage(DoublyLinkedList* list) {
     printf("Obs: Pode haver padding/alignment pelo compilador\n");
 }
 
+// Memória medida: monta do zero uma estrutura com o mesmo número de registros (dados aleatórios)
+// e mede o heap e o residente antes e depois; o resultado inclui cabeçalhos e sobras do malloc
+void measure_memory_usage(DoublyLinkedList* list) {
+    int n = list->size > 0 ? list->size : 10000;
+    MemorySnapshot before;
+    memoryProbeStart(&before);
+    DoublyLinkedList tmp;
+    initList(&tmp);
+    generateRandomData(&tmp, n);
+    MemorySnapshot built;
+    memorySnapshot(&built);
+    printf("\n=== USO DE MEMÓRIA MEDIDO (%s) ===\n", memoryHeapSource());
+    printf("Registros montados: %d\n", tmp.size);
+    printMemoryDelta("Montagem", &before);
+    benchRecordBytes(n, memoryDeltaBytes(&before, &built), "Memoria medida (montagem)");
+    if (built.heapBytes >= 0 && tmp.size > 0)
+        printf("Heap por registro: %.1f bytes (sizeof(MachineData): %zu)\n",
+               (double)(built.heapBytes - before.heapBytes) / tmp.size, sizeof(MachineData));
+    freeList(&tmp);
+}
+
 // Benchmark de tempo médio de acesso
+int benchAccessOp(void* ctx, int) {
+    SearchBench* b = (SearchBench*)ctx;
+    int random_pos = rand() % b->list->size;
+    Node* current = b->list->head;
+    for (int j = 0; j < random_pos && current != NULL; j++) {
+        current = current->next;
+    }
+    if (current != NULL) b->hits += current->data.UDI;
+    return 0;
+}
+
 void benchmark_random_access(DoublyLinkedList* list) {
     if (list->size == 0) {
         printf("Lista vazia para teste de acesso aleatório\n");
         return;
     }
-
-    const int accesses = 10000;
-    HighPrecisionTimer t;
-    int sum = 0; // Para evitar otimização
-
-    start_timer(&t);
-    for (int i = 0; i < accesses; i++) {
-        int random_pos = rand() % list->size;
-        Node* current = list->head;
-        for (int j = 0; j < random_pos && current != NULL; j++) {
-            current = current->next;
-        }
-        if (current != NULL) {
-            sum += current->data.UDI; // Operação qualquer para evitar otimização
-        }
-    }
-    double elapsed = stop_timer(&t);
-
-    printf("Benchmark Acesso Aleatório (%d acessos): %.3f ms (%.1f acessos/ms)\n",
-           accesses, elapsed, accesses / elapsed);
+    SearchBench b = {list, 0};
+    BenchScenario s = {"Acesso aleatorio", 10000, &b, NULL, benchAccessOp, NULL, 1, {NULL}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("Benchmark Acesso Aleatório (%d acessos x %d rodadas):\n", s.opsPerRun, r.runs);
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchScenarioCounters(&s);
+    benchRecordResult(&s, &r, list->size);
 }
 
 // Benchmark de escalabilidade
@@ -930,87 +1393,490 @@ void benchmark_scalability() {
         
         printf("Tamanho: %6d elementos | Tempo de inserção: %7.3f ms | Tempo por elemento: %.5f ms\n",
                sizes[i], elapsed, elapsed / sizes[i]);
+        benchRecord(sizes[i], sizes[i], elapsed, "Escalabilidade: insercao");
         
         freeList(&list);
     }
 }
 
 // Benchmark de latência média (operações combinadas)
+// Mistura de operações sobre uma estrutura nova de 1000 registros a cada rodada
+typedef struct {
+    DoublyLinkedList s;
+} MixBench;
+
+void benchMixSetup(void* ctx) {
+    MixBench* b = (MixBench*)ctx;
+    initList(&b->s);
+    generateRandomData(&b->s, 1000); // Lista inicial com 1000 elementos
+}
+
+// 30% inserção; dos 70% restantes, 80% busca e 20% remoção (56% e 14% do total)
+int benchMixOp(void* ctx, int i) {
+    MixBench* b = (MixBench*)ctx;
+    // Operação de inserção (30% das vezes)
+    if (rand() % 100 < 30) {
+        MachineData d = {0};
+        d.UDI = 10000 + i;
+        snprintf(d.ProductID, sizeof(d.ProductID), "M%07d", rand() % 1000000);
+        append(&b->s, d);
+        return 0;
+    }
+    char id[10];
+    // Operação de busca (50% das vezes)
+    if (rand() % 100 < 80) { // 30% inserção + 50% busca = 80%
+        snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
+        containsProductID(&b->s, id);
+        return 1;
+    }
+    // Operação de remoção (20% das vezes)
+    snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
+    removeByProductID(&b->s, id);
+    return 2;
+}
+
+void benchMixTeardown(void* ctx) {
+    freeList(&((MixBench*)ctx)->s);
+}
+
 void benchmark_combined_operations() {
-    const int num_operations = 1000;
+    MixBench b;
+    BenchScenario s = {"Operacoes combinadas", 1000, &b, benchMixSetup, benchMixOp, benchMixTeardown,
+                       3, {"Insercao", "Busca", "Remocao"}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("Benchmark Operações Combinadas (%d ops x %d rodadas, lista nova de 1000 registros por rodada):\n",
+           s.opsPerRun, r.runs);
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchRecordResult(&s, &r, 1000);
+}
+
+// Varreduras usadas na comparação: o mesmo trabalho por registro de searchByType (percurso sem
+// bitmap), calculateStatistics (runningStatsAdd) e advancedFilter (filterMatchesRecord), sem
+// printf, para medir só o percurso da estrutura
+typedef struct {
+    int typeMatches;    // searchByType('H')
+    RunningStats stats; // calculateStatistics
+    int filterMatches;  // advancedFilter: ToolWear 100-200, Torque 35-45, Tipo M
+} ScanResult;
+
+static const int scanCriteria[6] = {1, 1, 0, 0, 1, 0};
+static const float scanMin[4] = {100, 35, 0, 0}, scanMax[4] = {200, 45, 0, 0};
+
+void scanRecord(const MachineData* d, ScanResult* r) {
+    if (toupper(d->Type) == 'H') r->typeMatches++;
+    runningStatsAdd(&r->stats, d);
+    if (filterMatchesRecord(d, scanCriteria, scanMin, scanMax, 'M', false)) r->filterMatches++;
+}
+
+ScanResult scanLinkedList(DoublyLinkedList* list) {
+    ScanResult r = {0};
+    runningStatsInit(&r.stats);
+    for (Node* cur = list->head; cur; cur = cur->next) scanRecord(&cur->data, &r);
+    return r;
+}
+
+ScanResult scanUnrolledList(UnrolledList* list) {
+    ScanResult r = {0};
+    runningStatsInit(&r.stats);
+    for (UnrolledNode* node = list->head; node; node = node->next) {
+        for (int i = 0; i < node->count; i++) scanRecord(&node->items[i], &r);
+    }
+    return r;
+}
+
+// Compara lado a lado a lista de um registro por nó com a lista desenrolada
+void benchmark_unrolled_comparison(int num_elements) {
     DoublyLinkedList list;
+    UnrolledList unrolled;
     initList(&list);
-    generateRandomData(&list, 1000); // Lista inicial com 1000 elementos
+    initUnrolledList(&unrolled);
+    setProductIndexEnabled(&list, false); // Compara só o layout dos nós (os índices são medidos à parte)
+    setBitmapIndexEnabled(&list, false);
+
+    // Mesmos dados nas duas estruturas
+    DoublyLinkedList source;
+    initList(&source);
+    generateRandomData(&source, num_elements);
 
     HighPrecisionTimer t;
     start_timer(&t);
-    
-    for (int i = 0; i < num_operations; i++) {
-        // Operação de inserção (30% das vezes)
-        if (rand() % 100 < 30) {
-            MachineData d = {0};
-            d.UDI = 10000 + i;
-            snprintf(d.ProductID, sizeof(d.ProductID), "M%07d", rand() % 1000000);
-            append(&list, d);
-        }
-        // Operação de busca (50% das vezes)
-        else if (rand() % 100 < 80) { // 30% inserção + 50% busca = 80%
-            char id[10];
-            snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
-            Node* cur = list.head;
-            while (cur) {
-                if (strcmp(cur->data.ProductID, id) == 0) break;
-                cur = cur->next;
-            }
-        }
-        // Operação de remoção (20% das vezes)
-        else {
-            char id[10];
-            snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
-            removeByProductID(&list, id);
+    for (Node* cur = source.head; cur; cur = cur->next) append(&list, cur->data);
+    double listAppend = stop_timer(&t);
+    start_timer(&t);
+    for (Node* cur = source.head; cur; cur = cur->next) unrolledAppend(&unrolled, cur->data);
+    double unrolledAppendTime = stop_timer(&t);
+    freeList(&source);
+
+    const int scans = 20;
+    ScanResult a = {0}, b = {0};
+    start_timer(&t);
+    for (int i = 0; i < scans; i++) a = scanLinkedList(&list);
+    double listScan = stop_timer(&t) / scans;
+    start_timer(&t);
+    for (int i = 0; i < scans; i++) b = scanUnrolledList(&unrolled);
+    double unrolledScan = stop_timer(&t) / scans;
+    if (a.typeMatches != b.typeMatches || a.filterMatches != b.filterMatches || a.stats.n != b.stats.n) {
+        printf("Aviso: resultados divergentes entre as listas!\n");
+    }
+
+    // Inserções em posições aleatórias: na desenrolada, os nós cheios são divididos ao meio
+    const int inserts = 200;
+    unsigned insertSeed = (unsigned)time(NULL);
+    MachineData extra = list.head->data;
+    srand(insertSeed);
+    start_timer(&t);
+    for (int i = 0; i < inserts; i++) insertAt(&list, rand() % (list.size + 1), extra);
+    double listInsert = stop_timer(&t);
+    srand(insertSeed); // Mesmas posições para as duas estruturas
+    start_timer(&t);
+    for (int i = 0; i < inserts; i++) unrolledInsertAt(&unrolled, rand() % (unrolled.size + 1), extra);
+    double unrolledInsert = stop_timer(&t);
+    if (list.size != unrolled.size) printf("Aviso: tamanhos divergentes entre as listas!\n");
+
+    const int removals = 200;
+    unsigned seed = (unsigned)time(NULL);
+    srand(seed);
+    start_timer(&t);
+    for (int i = 0; i < removals; i++) {
+        char id[10];
+        snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
+        removeByProductID(&list, id);
+    }
+    double listRemove = stop_timer(&t);
+    srand(seed); // Mesmos ProductIDs para as duas estruturas
+    start_timer(&t);
+    for (int i = 0; i < removals; i++) {
+        char id[10];
+        snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
+        unrolledRemoveByProductID(&unrolled, id);
+    }
+    double unrolledRemove = stop_timer(&t);
+
+    printf("\nLista encadeada x desenrolada (%d elementos, %d registros/nó):\n", num_elements, UNROLLED_NODE_CAPACITY);
+    printf("%-32s %14s %14s %9s\n", "Operação", "Encadeada", "Desenrolada", "Ganho");
+    printf("%-32s %11.3f ms %11.3f ms %8.2fx\n", "Inserção no fim (append)", listAppend, unrolledAppendTime, listAppend / unrolledAppendTime);
+    printf("%-32s %11.3f ms %11.3f ms %8.2fx\n", "Varredura (tipo+estat.+filtro)", listScan, unrolledScan, listScan / unrolledScan);
+    printf("%-32s %11.3f ms %11.3f ms %8.2fx\n", "Inserção no meio (200)", listInsert, unrolledInsert, listInsert / unrolledInsert);
+    printf("%-32s %11.3f ms %11.3f ms %8.2fx\n", "Remoção por ProductID (200)", listRemove, unrolledRemove, listRemove / unrolledRemove);
+    printf("Memória: %zu bytes (encadeada) x %zu bytes (desenrolada, %d nós)\n",
+           (size_t)list.size * sizeof(Node), (size_t)unrolled.nodeCount * sizeof(UnrolledNode), unrolled.nodeCount);
+
+    freeList(&list);
+    freeUnrolledList(&unrolled);
+}
+
+// Consultas determinísticas (metade existentes, metade ausentes) para comparar índice ligado x desligado
+char (*buildProductIDQueries(DoublyLinkedList* list, int num_queries))[10] {
+    char (*queries)[10] = (char (*)[10])malloc(sizeof(*queries) * num_queries);
+    char (*existing)[10] = (char (*)[10])malloc(sizeof(*existing) * num_queries);
+    if (queries == NULL || existing == NULL) {
+        perror("Erro de alocação de memória");
+        exit(EXIT_FAILURE);
+    }
+    int n = 0;
+    for (Node* cur = list->head; cur && n < num_queries; cur = cur->next) {
+        strcpy(existing[n++], cur->data.ProductID);
+    }
+    srand(31);
+    for (int i = 0; i < num_queries; i++) {
+        if (n > 0 && i % 2 == 0) {
+            strcpy(queries[i], existing[rand() % n]);
+        } else {
+            snprintf(queries[i], sizeof(queries[i]), "X%07d", rand() % 1000000);
         }
     }
-    
+    free(existing);
+    return queries;
+}
+
+double benchmark_search_product_id(DoublyLinkedList* list) {
+    const int searches = 10000;
+    char (*queries)[10] = buildProductIDQueries(list, searches);
+    HighPrecisionTimer t;
+    int found = 0;
+
+    start_timer(&t);
+    for (int i = 0; i < searches; i++) {
+        if (containsProductID(list, queries[i])) found++;
+    }
     double elapsed = stop_timer(&t);
-    printf("Benchmark Operações Combinadas (%d ops): %.3f ms | Latência média: %.3f ms/op\n",
-           num_operations, elapsed, elapsed / num_operations);
-    
-    freeList(&list);
+    printf("Busca por ProductID (%d ops): encontrados=%d | tempo=%.3f ms (%.1f ops/ms)\n",
+           searches, found, elapsed, searches / elapsed);
+    benchRecord(list->size, searches, elapsed, "Busca por ProductID (indice %s)", useProductIndex ? "ligado" : "desligado");
+    free(queries);
+    return elapsed;
+}
+
+double benchmark_removal_product_id(DoublyLinkedList* list) {
+    const int removals = 1000;
+    char (*queries)[10] = buildProductIDQueries(list, removals);
+    DoublyLinkedList tmp;
+    initList(&tmp);
+    for (Node* cur = list->head; cur; cur = cur->next) append(&tmp, cur->data);
+
+    HighPrecisionTimer t;
+    int removed = 0;
+    start_timer(&t);
+    for (int i = 0; i < removals; i++) {
+        if (removeByProductID(&tmp, queries[i])) removed++;
+    }
+    double elapsed = stop_timer(&t);
+    printf("Remoção por ProductID (%d ops): removidos=%d | tempo=%.3f ms (%.1f ops/ms)\n",
+           removals, removed, elapsed, removals / elapsed);
+    benchRecord(list->size, removals, elapsed, "Remocao por ProductID (indice %s)", useProductIndex ? "ligado" : "desligado");
+    freeList(&tmp);
+    free(queries);
+    return elapsed;
+}
+
+// Repete inserção e busca/remoção por ProductID com o índice desligado e ligado
+void benchmark_product_index(DoublyLinkedList* list) {
+    bool saved = useProductIndex;
+    double search_ms[2], removal_ms[2];
+    for (int on = 0; on <= 1; on++) {
+        useProductIndex = on;
+        setProductIndexEnabled(list, on);
+        printf("\n--- Índice por ProductID %s ---", on ? "LIGADO" : "DESLIGADO");
+        benchmark_insertion(list, 10000);
+        search_ms[on] = benchmark_search_product_id(list);
+        removal_ms[on] = benchmark_removal_product_id(list);
+    }
+    useProductIndex = saved;
+    setProductIndexEnabled(list, saved);
+    printf("\nSpeedup com índice: busca %.1fx | remoção %.1fx\n",
+           search_ms[0] / search_ms[1], removal_ms[0] / removal_ms[1]);
 }
 
 // Substitua a função run_all_benchmarks existente por esta versão atualizada
+// classifyFailures e a consulta "Type H com HDF ou OSF": varredura x operações nos bitmaps
+void benchmark_bitmap_index(DoublyLinkedList* list) {
+    if (list->bitmaps == NULL) setBitmapIndexEnabled(list, true);
+    const int reps = 100;
+    const int modes = parseFailureModes("HDF,OSF");
+    int scan_counts[3][6], bitmap_counts[3][6];
+    int scan_matches = 0, bitmap_matches = 0;
+    HighPrecisionTimer t;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        memset(scan_counts, 0, sizeof(scan_counts));
+        scanClassifyCounts(list, scan_counts);
+    }
+    double scan_classify = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) bitmapClassifyCounts(list->bitmaps, bitmap_counts);
+    double bitmap_classify = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) scan_matches = countTypeWithModes(list, 'H', modes);
+    double scan_query = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapTypeWithModes(list->bitmaps, 'H', modes, &rows);
+        bitmap_matches = roaringCardinality(&rows);
+        roaringFree(&rows);
+    }
+    double bitmap_query = stop_timer(&t) / reps;
+
+    int cube_counts[3][6];
+    const int cube_reps = 100000;
+    volatile int cube_sink = 0;
+    start_timer(&t);
+    for (int r = 0; r < cube_reps; r++) {
+        failureCubeCounts(&list->cube, cube_counts);
+        cube_sink += cube_counts[r % 3][0];
+    }
+    double cube_classify = stop_timer(&t) / cube_reps;
+
+    if (memcmp(scan_counts, bitmap_counts, sizeof(scan_counts)) != 0 || scan_matches != bitmap_matches)
+        printf("AVISO: bitmaps divergem da varredura!\n");
+    if (memcmp(scan_counts, cube_counts, sizeof(scan_counts)) != 0)
+        printf("AVISO: cubo de agregados diverge da varredura!\n");
+    printf("Classificação de falhas: varredura %.4f ms | popcount %.4f ms | speedup %.1fx\n",
+           scan_classify, bitmap_classify, scan_classify / bitmap_classify);
+    printf("Classificação pelo cubo incremental: %.6f ms | speedup %.0fx sobre a varredura\n",
+           cube_classify, scan_classify / cube_classify);
+    printf("Type H com HDF ou OSF (%d registros): varredura %.4f ms | bitmaps %.4f ms | speedup %.1fx\n",
+           bitmap_matches, scan_query, bitmap_query, scan_query / bitmap_query);
+    size_t bitmap_memory = bitmapIndexMemory(list->bitmaps);
+    printf("Memória dos bitmaps: %zu bytes (%.2f KB)\n", bitmap_memory, (float)bitmap_memory / 1024);
+    benchRecord(list->size, reps, scan_classify * reps, "Classificacao: varredura");
+    benchRecord(list->size, reps, bitmap_classify * reps, "Classificacao: popcount");
+    benchRecord(list->size, cube_reps, cube_classify * cube_reps, "Classificacao: cubo incremental");
+    benchRecord(list->size, reps, scan_query * reps, "Type H com HDF ou OSF: varredura");
+    benchRecord(list->size, reps, bitmap_query * reps, "Type H com HDF ou OSF: bitmaps");
+    benchRecordBytes(list->size, (long long)bitmap_memory, "Memoria dos bitmaps");
+}
+
+// Filtro avançado sem a saída: laço escalar com um if por critério x plano vetorizado
+void benchmark_filter_engine(DoublyLinkedList* list) {
+    const int criteria[6] = {1, 1, 1, 1, 0, 1};
+    const float minVal[4] = {0, 30, 1400, 8};
+    const float maxVal[4] = {110, 45, 1550, 10.5f};
+    const int reps = 100;
+    int count;
+    const MachineData** rows = collectFilterRecords(list, NULL, &count);
+    const MachineData** selected = (const MachineData**)malloc(sizeof(MachineData*) * (count + 1));
+    if (selected == NULL) {
+        perror("Erro ao alocar memória para o benchmark do filtro");
+        free(rows);
+        return;
+    }
+    FilterPlan plan = buildFilterPlan(criteria, minVal, maxVal, 0, false);
+    int scalar_matches = 0, engine_matches = 0;
+    HighPrecisionTimer t;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        scalar_matches = 0;
+        for (int i = 0; i < count; i++) {
+            scalar_matches += filterMatchesRecord(rows[i], criteria, minVal, maxVal, 0, false);
+        }
+    }
+    double scalar_ms = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) engine_matches = runFilterPlan(&plan, rows, count, selected);
+    double engine_ms = stop_timer(&t) / reps;
+
+    if (scalar_matches != engine_matches)
+        printf("AVISO: plano vetorizado diverge do laço escalar!\n");
+    printf("5 critérios sobre %d registros (%d aprovados)\n", count, engine_matches);
+    printf("Laço escalar: %.4f ms | Plano vetorizado: %.4f ms | speedup %.1fx\n",
+           scalar_ms, engine_ms, scalar_ms / engine_ms);
+    benchRecord(count, (long long)count * reps, scalar_ms * reps, "Filtro: laco escalar");
+    benchRecord(count, (long long)count * reps, engine_ms * reps, "Filtro: plano vetorizado");
+    free(rows);
+    free(selected);
+}
+
+// Definido junto da simulação da fresadora, depois dos padrões de falha
+void benchmark_pattern_index(DoublyLinkedList* list);
+void benchmark_failure_regions(DoublyLinkedList* list);
+void benchmark_failure_model(DoublyLinkedList* list);
+void benchmark_fleet_simulation(DoublyLinkedList* list);
+
 void run_all_benchmarks(DoublyLinkedList* list) {
     printf("\n=== INICIANDO BENCHMARKS COMPLETOS ===\n");
+    benchLogReset("");
+    printf("Relógio: %s (%.0f MHz) | memória: residente medida, heap por %s\n", timerSourceName(),
+           timerFrequency() / 1e6, memoryHeapSource());
+    MemorySnapshot mem;
     
     // 1. Benchmark de Inserção
-    printf("\n1. Tempo de Inserção:\n");
+    benchSection("1. Tempo de Inserção");
+    memoryProbeStart(&mem);
     benchmark_insertion(list, 1000);
     benchmark_insertion(list, 10000);
     
     // 2. Benchmark de Remoção
-    printf("\n2. Tempo de Remoção:\n");
+    benchMemoryDelta(&mem);
+    benchSection("2. Tempo de Remoção");
+    memoryProbeStart(&mem);
     benchmark_removal(list);
     
     // 3. Benchmark de Busca
-    printf("\n3. Tempo de Busca:\n");
+    benchMemoryDelta(&mem);
+    benchSection("3. Tempo de Busca");
+    memoryProbeStart(&mem);
     benchmark_search(list);
     
     // 4. Benchmark de Uso de Memória
-    printf("\n4. Uso de Memória:\n");
+    benchMemoryDelta(&mem);
+    benchSection("4. Uso de Memória");
+    memoryProbeStart(&mem);
     estimate_memory_usage(list);
+    measure_memory_usage(list);
     
     // 5. Benchmark de Tempo Médio de Acesso
-    printf("\n5. Tempo Médio de Acesso:\n");
+    benchMemoryDelta(&mem);
+    benchSection("5. Tempo Médio de Acesso");
+    memoryProbeStart(&mem);
     benchmark_random_access(list);
     
     // 6. Benchmark de Escalabilidade
-    printf("\n6. Escalabilidade:\n");
+    benchMemoryDelta(&mem);
+    benchSection("6. Escalabilidade");
+    memoryProbeStart(&mem);
     benchmark_scalability();
     
     // 7. Benchmark de Latência Média
-    printf("\n7. Latência Média (operações combinadas):\n");
+    benchMemoryDelta(&mem);
+    benchSection("7. Latência por operação (operações combinadas)");
+    memoryProbeStart(&mem);
     benchmark_combined_operations();
+
+    // 8. Lista desenrolada (vários registros por nó)
+    benchMemoryDelta(&mem);
+    benchSection("8. Lista Encadeada x Lista Desenrolada");
+    memoryProbeStart(&mem);
+    benchmark_unrolled_comparison(10000);
+    benchmark_unrolled_comparison(200000);
+
+    // 9. Índice hash por ProductID
+    benchMemoryDelta(&mem);
+    benchSection("9. Índice Hash por ProductID (desligado x ligado)");
+    memoryProbeStart(&mem);
+    benchmark_product_index(list);
+
+    benchMemoryDelta(&mem);
+    benchSection("10. Bitmaps de Type/falhas (varredura x popcount)");
+    memoryProbeStart(&mem);
+    benchmark_bitmap_index(list);
+
+    benchMemoryDelta(&mem);
+    benchSection("11. Filtro avançado (escalar x vetorizado)");
+    memoryProbeStart(&mem);
+    benchmark_filter_engine(list);
+
+    benchMemoryDelta(&mem);
+    benchSection("12. Kernels de filtro especializados (10M linhas sintéticas)");
+    memoryProbeStart(&mem);
+    benchmark_filter_kernels();
+
+    benchMemoryDelta(&mem);
+    benchSection("13. Estatísticas em uma passada e redução paralela (50M linhas sintéticas)");
+    memoryProbeStart(&mem);
+    benchmark_parallel_stats();
+
+    benchMemoryDelta(&mem);
+    benchSection("14. Percentis: ordenação x sketches KLL");
+    memoryProbeStart(&mem);
+    benchmark_quantile_sketches();
+
+    benchMemoryDelta(&mem);
+    benchSection("15. Histogramas e correlações: linha a linha x lotes colunares");
+    memoryProbeStart(&mem);
+    benchmark_sensor_analytics();
     
+    benchMemoryDelta(&mem);
+    benchSection("16. Padrões de falha: varredura linear x R-tree (1M amostras simuladas)");
+    memoryProbeStart(&mem);
+    benchmark_pattern_index(list);
+
+    benchMemoryDelta(&mem);
+    benchSection("17. Regiões de falha: um padrão por falha x caixas agrupadas (validação 80/20)");
+    memoryProbeStart(&mem);
+    benchmark_failure_regions(list);
+
+    benchMemoryDelta(&mem);
+    benchSection("18. Árvores de decisão: treino, validação e inferência em blocos");
+    memoryProbeStart(&mem);
+    benchmark_failure_model(list);
+
+    benchMemoryDelta(&mem);
+    benchSection("19. Frota em paralelo: amostras/s e latência dos alertas de 1 a 4096 máquinas");
+    memoryProbeStart(&mem);
+    benchmark_fleet_simulation(list);
+
+    benchMemoryDelta(&mem);
+
     printf("\n=== BENCHMARKS CONCLUÍDOS ===\n");
 }
 
@@ -1026,6 +1892,10 @@ void removeFirst(DoublyLinkedList* list) {
         list->tail = NULL;
     }
 
+    if (list->pidIndex) productIndexRemove(list->pidIndex, temp->data.ProductID, (long long)(size_t)temp);
+    if (list->bitmaps) bitmapReleaseRow(list, temp);
+    failureCubeRemove(&list->cube, &temp->data);
+    quantileSketchesInvalidate(&list->quantiles);
     free(temp);
     list->size--;
 }
@@ -1037,7 +1907,7 @@ void generateAnomalousData(DoublyLinkedList* list, int count, int max_size) {
         }
 
         if (i % 100 == 0) {
-            Sleep(1); // R10: Interrupções periódicas
+            sleepMilliseconds(1); // R10: Interrupções periódicas
         }
 
         MachineData d = {0};
@@ -1066,7 +1936,7 @@ void generateAnomalousData(DoublyLinkedList* list, int count, int max_size) {
         append(list, d);
 
         if (i > 0 && i % 100 == 0) {
-            Sleep(50); // R13: Delay artificial por lote
+            sleepMilliseconds(50); // R13: Delay artificial por lote
         }
     }
 }
@@ -1087,10 +1957,73 @@ void selectionSortList(DoublyLinkedList* list) {
             min->data = temp;
         }
     }
+    if (list->pidIndex) setProductIndexEnabled(list, true); // Os registros trocaram de nó
+    if (list->bitmaps) setBitmapIndexEnabled(list, true);
 }
 
-void run_restricted_benchmarks() {
+// Separa os primeiros 'count' nós a partir de head e retorna o início do restante
+Node* splitRun(Node* head, int count) {
+    for (int i = 1; head != NULL && i < count; i++) head = head->next;
+    if (head == NULL) return NULL;
+    Node* rest = head->next;
+    head->next = NULL;
+    return rest;
+}
+
+// Intercala duas sequências ordenadas após 'tail' e retorna o último nó intercalado.
+// Estável: em empate, o nó de 'a' vem primeiro.
+Node* mergeRuns(Node* a, Node* b, Node* tail) {
+    while (a && b) {
+        if (b->data.UDI < a->data.UDI) {
+            tail->next = b;
+            b = b->next;
+        } else {
+            tail->next = a;
+            a = a->next;
+        }
+        tail = tail->next;
+    }
+    tail->next = a ? a : b;
+    while (tail->next) tail = tail->next;
+    return tail;
+}
+
+// Merge sort bottom-up por UDI: O(n log n), sem recursão e sem memória extra.
+// Só os ponteiros são religados; os MachineData nunca são copiados.
+void mergeSortList(DoublyLinkedList* list) {
+    if (list == NULL || list->size < 2) return;
+
+    Node* dummy = (Node*)malloc(sizeof(Node)); // Sentinela (evita um Node inteiro na pilha)
+    if (dummy == NULL) {
+        perror("Erro ao alocar memória para ordenação");
+        return;
+    }
+    for (int width = 1; width < list->size; width *= 2) {
+        Node* rest = list->head;
+        Node* tail = dummy;
+        while (rest) {
+            Node* left = rest;
+            Node* right = splitRun(left, width);
+            rest = splitRun(right, width);
+            tail = mergeRuns(left, right, tail);
+        }
+        list->head = dummy->next;
+    }
+    free(dummy);
+
+    // As passadas usam apenas 'next'; reconstrói 'prev' e a cauda
+    Node* prev = NULL;
+    for (Node* cur = list->head; cur; cur = cur->next) {
+        cur->prev = prev;
+        prev = cur;
+    }
+    list->tail = prev;
+    if (list->bitmaps) setBitmapIndexEnabled(list, true); // Linhas na nova ordem da lista
+}
+
+void run_restricted_benchmarks(bool r24Penalty) {
     printf("\n=== BENCHMARK COM RESTRIÇÕES ATIVADAS ===\n");
+    benchLogReset("Restricoes ativadas");
 
     DoublyLinkedList list;
     initList(&list);
@@ -1104,50 +2037,35 @@ void run_restricted_benchmarks() {
     double elapsed = stop_timer(&t);
 
     printf("\nTempo total (com 4 restrições aplicadas): %.3f ms\n", elapsed);
+    benchRecord(1000, 1000, elapsed, "Geracao com restricoes");
     printf("Elementos finais na lista (máximo 500): %d\n", list.size);
 
-    // R24 – Ordenação por algoritmo ineficiente
-    printf("\nAplicando R24: ordenação ineficiente (selection sort)...\n");
-    selectionSortList(&list); 
+    // R24 – Ordenação por algoritmo ineficiente (ou merge sort, para comparação)
+    start_timer(&t);
+    if (r24Penalty) {
+        printf("\nAplicando R24: ordenação ineficiente (selection sort)...\n");
+        selectionSortList(&list);
+    } else {
+        printf("\nOrdenação por UDI com merge sort (R24 desativada)...\n");
+        mergeSortList(&list);
+    }
+    double sort_ms = stop_timer(&t);
+    printf("Tempo de ordenação: %.3f ms\n", sort_ms);
+    benchRecord(list.size, list.size, sort_ms, "Ordenacao por UDI (%s)", r24Penalty ? "selection sort" : "merge sort");
 
     // Benchmarks após restrições
     benchmark_search(&list);
     benchmark_removal(&list);
     benchmark_random_access(&list);
     estimate_memory_usage(&list);
+    measure_memory_usage(&list);
 
     freeList(&list);
 
     printf("\n=== FIM DOS TESTES COM RESTRIÇÕES ===\n");
 }
 
-// Inicializa a lista de padrões de falha
-void initFailurePatternList(FailurePatternList* list) {
-    list->patterns = NULL;
-    list->count = 0;
-    list->capacity = 0;
-}
-
-// Adiciona um padrão de falha à lista dinâmica
-void addFailurePattern(FailurePatternList* list, FailurePattern pattern) {
-    if (list->count == list->capacity) {
-        list->capacity = (list->capacity == 0) ? 1 : list->capacity * 2;
-        list->patterns = (FailurePattern*)realloc(list->patterns, list->capacity * sizeof(FailurePattern));
-        if (list->patterns == NULL) {
-            perror("Falha ao realocar memória para os padrões de falha");
-            exit(EXIT_FAILURE);
-        }
-    }
-    list->patterns[list->count++] = pattern;
-}
-
-// Libera a memória alocada para a lista de padrões de falha
-void freeFailurePatternList(FailurePatternList* list) {
-    free(list->patterns);
-    list->patterns = NULL;
-    list->count = 0;
-    list->capacity = 0;
-}
+#include "ESD-COMUM(PADROES).h"
 
 // APRENDE OS PADRÕES DE FALHA A PARTIR DOS DADOS EXISTENTES
 // Percorre a lista de dados e extrai informações de entradas onde MachineFailure é true.
@@ -1159,144 +2077,80 @@ void learnFailurePatterns(DoublyLinkedList* list, FailurePatternList* patterns)
     }
 
     printf("\n=== APRENDENDO PADRÕES DE FALHA ===\n");
-    Node* current = list->head;
-    int learned_count = 0;
-
-    // Reinicia os padrões antes de aprender novos
-    freeFailurePatternList(patterns);
-    initFailurePatternList(patterns);
+    int count;
+    const MachineData** rows = collectFilterRecords(list, NULL, &count);
+    HighPrecisionTimer t;
+    start_timer(&t);
+    int failures = learnFailureRegions(rows, count, patterns);
+    double ms = stop_timer(&t);
+    printf("Aprendidos %d padrões de falha (regiões) a partir de %d falhas dos dados existentes (%.2f ms).\n",
+           patterns->count, failures, ms);
+    displayPatternPrefilter(&patterns->prefilter);
 
-    while (current != NULL) {
-        if (current->data.MachineFailure) {
-            FailurePattern fp;
-            // Armazena os valores exatos da instância de falha como um padrão.
-            // Para um sistema mais complexo, você poderia calcular faixas, médias, etc.
-            fp.minAirTemp = fp.maxAirTemp = current->data.AirTemp;
-            fp.minProcessTemp = fp.maxProcessTemp = current->data.ProcessTemp;
-            fp.minRotationalSpeed = fp.maxRotationalSpeed = current->data.RotationalSpeed;
-            fp.minTorque = fp.maxTorque = current->data.Torque;
-            fp.minToolWear = fp.maxToolWear = current->data.ToolWear;
-            
-            fp.hadTWF = current->data.TWF;
-            fp.hadHDF = current->data.HDF;
-            fp.hadPWF = current->data.PWF;
-            fp.hadOSF = current->data.OSF;
-            fp.hadRNF = current->data.RNF;
-
-            addFailurePattern(patterns, fp);
-            learned_count++;
-        }
-        current = current->next;
-    }
-    printf("Aprendidos %d padrões de falha a partir dos dados existentes.\n", learned_count);
+    start_timer(&t);
+    trainFailureModel(rows, count, &patterns->model);
+    ms = stop_timer(&t);
+    printf("Árvores de decisão treinadas (profundidade %d, %d alvos) em %.2f ms. Ajuste nos dados carregados:\n",
+           TREE_DEPTH, TREE_TARGETS, ms);
+    DetectionCounts counts[TREE_TARGETS];
+    evaluateFailureModel(&patterns->model, rows, count, counts);
+    displayFailureModelEvaluation(counts);
+    free(rows);
 }
 
-// VERIFICA SE OS DADOS ATUAIS CORRESPONDEM A UM PADRÃO DE FALHA APRENDIDO
-// Compara os dados da máquina com os padrões armazenados.
-// A correspondência atual é exata. Em um cenário real, você pode usar uma tolerância.
-bool checkForFailurePattern(MachineData data, FailurePatternList* patterns) {
-    for (int i = 0; i < patterns->count; i++) {
-        FailurePattern fp = patterns->patterns[i];
-
-        // Esta é uma correspondência exata. Considere adicionar uma tolerância (e.g., fabs(data.AirTemp - fp.minAirTemp) < epsilon)
-        bool match = true;
-        if (data.AirTemp != fp.minAirTemp ||
-            data.ProcessTemp != fp.minProcessTemp ||
-            data.RotationalSpeed != fp.minRotationalSpeed ||
-            data.Torque != fp.minTorque ||
-            data.ToolWear != fp.minToolWear) {
-            match = false;
-        }
-
-        // Também verifica os flags de falha específicos se eles fazem parte da definição do seu padrão
-        if (match && (data.TWF != fp.hadTWF ||
-                      data.HDF != fp.hadHDF ||
-                      data.PWF != fp.hadPWF ||
-                      data.OSF != fp.hadOSF ||
-                      data.RNF != fp.hadRNF)) {
-            match = false;
-        }
+// Próximo UDI livre para amostras simuladas: maior UDI atual + 1
+int nextSimulatedUDI(DoublyLinkedList* list) {
+    int next_udi = 0;
 
-        if (match) {
-            return true; // Padrão detectado!
+    // Encontra o UDI máximo atual para continuar a partir dele
+    Node* current_node_udi = list->head;
+    while(current_node_udi != NULL) {
+        if (current_node_udi->data.UDI > next_udi) {
+            next_udi = current_node_udi->data.UDI;
         }
+        current_node_udi = current_node_udi->next;
     }
-    return false; // Nenhum padrão correspondente encontrado
+    next_udi++; // Começa o UDI para novas simulações
+    return next_udi;
 }
 
 // SIMULA A FRESADORA E DETECTA PADRÕES DE FALHA
 // Gera dados de MachineData simulados.
 // Periodicamente, injeta um padrão de falha aprendido para demonstrar a detecção.
-void simulateMillingMachine(DoublyLinkedList* list, FailurePatternList* patterns, int num_simulations) {
+void simulateMillingMachine(DoublyLinkedList* list, FailurePatternList* patterns, int num_simulations, unsigned int seed) {
     if (patterns->count == 0) {
         printf("Nenhum padrão de falha aprendido. Por favor, aprenda os padrões primeiro (Opção 12).\n");
         return;
     }
 
     printf("\n=== SIMULANDO FRESADORA E DETECTANDO FALHAS ===\n");
-    srand((unsigned)time(NULL)); // Inicializa o gerador de números aleatórios
+    displayPatternTolerance(patterns);
+    printf("Semente: %u\n", seed);
+    srand(seed); // Mesma semente, mesmo fluxo (ver recordSimulationStream)
     int failure_alerts = 0;
-    int next_udi = 0;
-
-    // Encontra o UDI máximo atual para continuar a partir dele
-    Node* current_node_udi = list->head;
-    while(current_node_udi != NULL) {
-        if (current_node_udi->data.UDI > next_udi) {
-            next_udi = current_node_udi->data.UDI;
-        }
-        current_node_udi = current_node_udi->next;
-    }
-    next_udi++; // Começa o UDI para novas simulações
+    int next_udi = nextSimulatedUDI(list);
 
+    MachineData block[64];
+    unsigned long long blockAlerts = 0;
+    DetectionCounts patternHits = {0, 0, 0, 0}, modelHits = {0, 0, 0, 0};
     for (int i = 0; i < num_simulations; i++) {
-        MachineData simulatedData;
-        simulatedData.UDI = next_udi++;
-
-        // Gera ProductID e Tipo (pode ser aleatório ou seguir uma sequência)
-        snprintf(simulatedData.ProductID, sizeof(simulatedData.ProductID), "SIM%06d", rand() % 1000000);
-        simulatedData.Type = "LMH"[rand() % 3];
-
-        // Introduz variações em torno de valores típicos (menos de falha)
-        // Defina faixas razoáveis para a sua simulação de "operação normal"
-        simulatedData.AirTemp = 298.0f + (float)(rand() % 200) / 100.0f - 1.0f; // Ex: 297.0 a 299.0 K
-        simulatedData.ProcessTemp = simulatedData.AirTemp + 10.0f + (float)(rand() % 100) / 100.0f; // Ex: Processo geralmente mais alto
-        simulatedData.RotationalSpeed = 1400 + rand() % 200 - 100; // Ex: 1300 a 1500 rpm
-        simulatedData.Torque = 30.0f + (float)(rand() % 200) / 100.0f - 1.0f; // Ex: 29.0 a 31.0 Nm
-        simulatedData.ToolWear = 30 + rand() % 30 - 15; // Ex: 15 a 45 min
-
-        // Assume que não há falha inicialmente para dados simulados, a menos que um padrão seja injetado
-        simulatedData.MachineFailure = false;
-        simulatedData.TWF = false;
-        simulatedData.HDF = false;
-        simulatedData.PWF = false;
-        simulatedData.OSF = false;
-        simulatedData.RNF = false;
-
-        // Introduz um padrão de falha periodicamente ou aleatoriamente
-        // Aqui, há uma chance de 5% de injetar um padrão de falha aprendido
-        if (patterns->count > 0 && rand() % 20 == 0) { 
-            // Seleciona um padrão aprendido aleatório para injetar
-            int pattern_idx = rand() % patterns->count;
-            FailurePattern injected_pattern = patterns->patterns[pattern_idx];
-
-            // Sobrescreve os dados simulados com os valores do padrão de falha
-            simulatedData.AirTemp = injected_pattern.minAirTemp;
-            simulatedData.ProcessTemp = injected_pattern.minProcessTemp;
-            simulatedData.RotationalSpeed = injected_pattern.minRotationalSpeed;
-            simulatedData.Torque = injected_pattern.minTorque;
-            simulatedData.ToolWear = injected_pattern.minToolWear;
-            
-            // Define os flags de falha de acordo com o padrão
-            simulatedData.MachineFailure = true; // Isso é crucial para a detecção
-            simulatedData.TWF = injected_pattern.hadTWF;
-            simulatedData.HDF = injected_pattern.hadHDF;
-            simulatedData.PWF = injected_pattern.hadPWF;
-            simulatedData.OSF = injected_pattern.hadOSF;
-            simulatedData.RNF = injected_pattern.hadRNF;
+        // As amostras são geradas e comparadas com os padrões em blocos de 64 (um bit por amostra)
+        int slot = i % 64;
+        if (slot == 0) {
+            int len = num_simulations - i < 64 ? num_simulations - i : 64;
+            for (int j = 0; j < len; j++) generateSimulatedSample(&block[j], patterns, next_udi++);
+            checkForFailurePatternBatch(block, len, patterns, &blockAlerts);
         }
+        MachineData simulatedData = block[slot];
 
         // Verifica se os dados simulados correspondem a algum padrão de falha aprendido
-        if (checkForFailurePattern(simulatedData, patterns)) {
+        bool alert = (blockAlerts >> slot) & 1;
+        countDetection(&patternHits, alert, simulatedData.MachineFailure);
+        // No fluxo do simulador os caminhos se repetem e o if/else é previsto; ver benchmark_failure_model
+        if (patterns->model.trained)
+            countDetection(&modelHits, predictFailureModesScalar(&patterns->model, &simulatedData) & 1,
+                           simulatedData.MachineFailure);
+        if (alert) {
             printf("\n!!! ALERTA DE PADRÃO DE FALHA DETECTADO !!!\n");
             displayItem(simulatedData);
             failure_alerts++;
@@ -1310,13 +2164,172 @@ void simulateMillingMachine(DoublyLinkedList* list, FailurePatternList* patterns
         append(list, simulatedData);
     }
     printf("\nSimulação concluída. Total de alertas de falha: %d\n", failure_alerts);
+    printf("Padrões: precisão %.1f%% | recall %.1f%% (falhas injetadas: %d)\n", detectionPrecision(&patternHits),
+           detectionRecall(&patternHits), patternHits.tp + patternHits.fn);
+    if (patterns->model.trained)
+        printf("Árvore de decisão: %d falhas previstas | precisão %.1f%% | recall %.1f%%\n", modelHits.tp + modelHits.fp,
+               detectionPrecision(&modelHits), detectionRecall(&modelHits));
+}
+
+// --- ADAPTAÇÃO DA LISTA DUPLAMENTE ENCADEADA AO CÓDIGO COMUM ---
+// As operações sobre esta estrutura de que o código comum precisa: frota, reprodução do fluxo,
+// carga de trabalho e benchmarks de padrões (ESD-COMUM(*).h).
+typedef DoublyLinkedList WorkloadBackend;
+
+void workloadInit(DoublyLinkedList* list, int) { // Capacidade ignorada: a lista cresce sob demanda
+    initList(list);
+}
+
+void workloadFree(DoublyLinkedList* list) {
+    freeList(list);
+}
+
+void workloadInsert(DoublyLinkedList* list, const MachineData* d) {
+    append(list, *d);
+}
+
+bool workloadFindUDI(DoublyLinkedList* list, int udi) {
+    return containsUDI(list, udi);
+}
+
+bool workloadFindProductID(DoublyLinkedList* list, const char* pid) {
+    return containsProductID(list, pid);
+}
+
+int workloadRangeCount(DoublyLinkedList* list, int lo, int hi) {
+    return countUDIRange(list, lo, hi);
+}
+
+bool workloadDeleteUDI(DoublyLinkedList* list, int udi) {
+    return removeByUDI(list, udi);
+}
+
+// O mesmo caminho de calculateStatistics abaixo do limiar paralelo
+long long workloadStats(DoublyLinkedList* list) {
+    RunningStats rs;
+    runningStatsInit(&rs);
+    for (Node* cur = list->head; cur; cur = cur->next) runningStatsAdd(&rs, &cur->data);
+    return rs.n;
 }
 
-int main() {
+#include "ESD-COMUM(FROTA).h"
+
+#include "ESD-COMUM(CARGA).h"
+
+#include "ESD-COMUM(PADROES-BENCHMARK).h"
+
+// --- BENCHMARK DA FROTA ---
+// FLEET_BENCH_SAMPLES amostras por configuração, divididas entre 1 até milhares de máquinas,
+// com uma thread e com todos os núcleos; cada rodada mescla numa estrutura vazia.
+void benchmark_fleet_simulation(DoublyLinkedList* list) {
+    FailurePatternList patterns;
+    initFailurePatternList(&patterns);
+    learnFailurePatterns(list, &patterns);
+    memcpy(patterns.tolerance, patternSuggestedTolerance, sizeof(patterns.tolerance));
+    if (patterns.count == 0) {
+        printf("Nenhuma falha nos dados carregados; benchmark da frota ignorado.\n");
+        freeFailurePatternList(&patterns);
+        return;
+    }
+    int cores = availableCores();
+    printf("\n%9s %8s %11s %12s %9s %8s %8s %10s %10s %10s\n", "Maquinas", "Threads", "Tempo(ms)", "Mamostras/s",
+           "Alertas", "Recall", "Mescla", "p50(us)", "p99(us)", "max(us)");
+    static const int fleetSizes[] = {1, 16, 256, 4096};
+    for (int s = 0; s < (int)(sizeof(fleetSizes) / sizeof(fleetSizes[0])); s++) {
+        for (int pass = 0; pass < 2; pass++) {
+            int threads = pass == 0 ? 1 : cores;
+            if (pass == 1 && (cores == 1 || fleetSizes[s] == 1)) continue;
+            DoublyLinkedList store;
+            initList(&store);
+            FleetReport r;
+            runFleetSimulation(&store, &patterns, fleetSizes[s], FLEET_BENCH_SAMPLES / fleetSizes[s], threads, 44, &r);
+            printf("%9d %8d %11.2f %12.2f %9d %7.1f%% %7.1f%% %10.1f %10.1f %10.1f\n", r.machines, r.threads, r.ms,
+                   r.samples / (r.ms * 1e3), r.hits.tp + r.hits.fp, detectionRecall(&r.hits),
+                   r.ms > 0 ? 100.0 * r.mergeMs / r.ms : 0.0, r.latencyP50, r.latencyP99, r.latencyMax);
+            BenchRecord* rec = benchRecord(r.samples, r.samples, r.ms, "Frota: %d maquinas x %d threads", r.machines, r.threads);
+            rec->p50 = r.latencyP50 * 1e3;
+            rec->p99 = r.latencyP99 * 1e3;
+            freeList(&store);
+        }
+    }
+    printf("(Mescla = fração do tempo dentro da seção crítica; recall dos alertas sobre as falhas geradas)\n");
+    freeFailurePatternList(&patterns);
+}
+
+// Modo batch: "--benchmarks [prefixo] [baseline.csv] [limiar%]" roda run_all_benchmarks, grava
+// <prefixo>.csv e .json e, com um baseline, sai com 1 se houver regressão
+int batchBenchmarks(DoublyLinkedList* list, int argc, char* argv[]) {
+    const char* prefix = argc > 2 ? argv[2] : BENCH_DEFAULT_OUTPUT;
+    run_all_benchmarks(list);
+    if (saveBenchRecords(prefix) < 0) return 2;
+    if (argc < 4) return 0;
+    double threshold = argc > 4 && atof(argv[4]) > 0 ? atof(argv[4]) : BENCH_REGRESSION_THRESHOLD;
+    char csvPath[512];
+    snprintf(csvPath, sizeof(csvPath), "%s.csv", prefix);
+    int regressions = compareBenchFiles(csvPath, argv[3], threshold);
+    return regressions < 0 ? 2 : regressions > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    timerInit(); // Calibra o relógio antes de qualquer medição ou thread
+    if (argc > 1 && strcmp(argv[1], "--perf") == 0) { // Contadores de hardware; os outros argumentos seguem
+        enableHardwareCounters();
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+    }
     DoublyLinkedList list;
     initList(&list);
     parseCSV(&list); // Carrega os dados iniciais do CSV
 
+    if (argc > 1 && strcmp(argv[1], "--analytics") == 0) {
+        int status = batchSensorAnalytics(&list, argc, argv);
+        freeList(&list);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--fleet") == 0) {
+        int status = batchFleetSimulation(&list, argc, argv);
+        freeList(&list);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--record") == 0) {
+        int status = batchRecordStream(&list, argc, argv);
+        freeList(&list);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--replay") == 0) {
+        int status = batchReplayStream(&list, argc, argv);
+        freeList(&list);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--workload") == 0) {
+        int status = batchWorkload(argc, argv);
+        freeList(&list);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--benchmarks") == 0) {
+        int status = batchBenchmarks(&list, argc, argv);
+        freeList(&list);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--compare-benchmarks") == 0) {
+        int status = batchCompareBenchmarks(argc, argv);
+        freeList(&list);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--check-quantiles") == 0) {
+        int status = checkQuantilesAfterRemoval(&list, argc, argv);
+        freeList(&list);
+        return status;
+    }
+
     // ADICIONE ESTAS DUAS LINHAS:
     FailurePatternList failurePatterns; // Declara a lista de padrões de falha
     initFailurePatternList(&failurePatterns); // Inicializa a lista
@@ -1346,7 +2359,13 @@ int main() {
             case 3: {
                 printf("Digite o Tipo para buscar (L, M, H): ");
                 if (fgets(input, sizeof(input), stdin)) {
-                    searchByType(&list, toupper(input[0]));
+                    char type = toupper(input[0]);
+                    printf("Modos de falha (ex.: HDF,OSF; Enter para qualquer): ");
+                    int modes = fgets(input, sizeof(input), stdin) ? parseFailureModes(input) : 0;
+                    if (modes)
+                        searchByTypeAndFailureModes(&list, type, modes);
+                    else
+                        searchByType(&list, type);
                 }
                 break;
             }
@@ -1384,10 +2403,15 @@ int main() {
                 break;
             case 10:
                 run_all_benchmarks(&list);
+                saveBenchRecords(BENCH_DEFAULT_OUTPUT);
+                break;
+            case 11: {
+                printf("Ordenação R24 (1-selection sort ineficiente, 0-ordenação O(n log n)): ");
+                bool r24Penalty = fgets(input, sizeof(input), stdin) && atoi(input) == 1;
+                run_restricted_benchmarks(r24Penalty);
+                saveBenchRecords(BENCH_RESTRICTED_OUTPUT);
                 break;
-            case 11:
-            	run_restricted_benchmarks();
-				break;
+            }
             // ADICIONE ESTES NOVOS CASES:
             case 12: // Nova opção: Aprender Padrões de Falha
                 learnFailurePatterns(&list, &failurePatterns);
@@ -1397,7 +2421,8 @@ int main() {
                 int num_sims;
                 if (scanf("%d", &num_sims) == 1) {
                     while (getchar() != '\n'); // Limpa o buffer
-                    simulateMillingMachine(&list, &failurePatterns, num_sims);
+                    if (failurePatterns.count > 0) readPatternTolerance(&failurePatterns);
+                    simulateMillingMachine(&list, &failurePatterns, num_sims, (unsigned)time(NULL));
                 } else {
                     printf("Entrada inválida. Por favor, digite um número.\n");
                     while (getchar() != '\n'); // Limpa o buffer
@@ -1406,13 +2431,17 @@ int main() {
             }
             // FIM DOS NOVOS CASES
 
-            case 14: // Opção de saída atualizada (o número mudou de 12 para 14)
+            case 14:
+                sensorAnalytics(&list);
+                break;
+
+            case 15: // Opção de saída atualizada
                 printf("Saindo...\n");
                 break;
             default:
                 printf("Opção inválida. Tente novamente.\n");
         }
-    } while (choice != 14); // Condição de saída atualizada
+    } while (choice != 15); // Condição de saída atualizada
 
     freeList(&list);
     // ADICIONE ESTA LINHA:
@@ -5,11 +5,52 @@
 #include <ctype.h>
 #include <math.h>
 #include <time.h>
+#include <limits.h>
+#include <stdarg.h>
+#ifdef _WIN32
 #include <windows.h>
-#include <profileapi.h>
 #include <psapi.h>
+#endif
+#include <chrono> // steady_clock: relógio portátil das medições
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h> // SSE2 para o filtro vetorizado
+#define FILTER_SSE2
+#endif
+#ifndef _WIN32
+#include <pthread.h> // Redução paralela das estatísticas
+#include <unistd.h>  // sysconf
+#include <sys/resource.h> // getrusage: pico de memória do processo
+#endif
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h> // mallinfo2: bytes em uso no heap
+#define MEMORY_MALLINFO2
+#endif
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>    // __rdtsc, __cpuid
+#else
+#include <x86intrin.h> // __rdtsc
+#include <cpuid.h>     // __get_cpuid
+#endif
+#define TIMER_RDTSC
+#endif
+#if defined(_MSC_VER) && !defined(TIMER_RDTSC)
+#include <intrin.h> // _BitScanForward64 fora de x86 (ARM64)
+#endif
+#ifdef MEMORY_COUNTING
+#include <atomic>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h> // Contadores de hardware do modo --perf
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#define PERF_COUNTERS
+#endif
+
+#include "ESD-COMUM(INSTRUMENTACAO).h"
 
 #define MAX_LINHA 2048
+#define STRUCTURE_NAME "SegmentTree" // Nome da estrutura nos registros dos benchmarks
 #define MAX_PRODUCTS 100000  // Capacidade inicial aumentada
 
 typedef struct {
@@ -29,6 +70,9 @@ typedef struct {
     bool RNF;
 } MachineData;
 
+#include "ESD-COMUM(BENCHMARK).h"
+#include "ESD-COMUM(INDICES).h"
+
 typedef struct {
     MachineData* data;
     int size;
@@ -50,6 +94,11 @@ typedef struct {
     float* maxTempDiff;
     float* minTempDiff;
     float* sumTempDiff;
+
+    ProductIndex* pidIndex; // ProductID -> posições das folhas (NULL = índice desligado)
+    BitmapIndex* bitmaps;   // Type/falhas -> posições das folhas (NULL = índice desligado)
+    QuantileSketches quantiles; // Percentis dos registros vivos (KLL, refeitos após remoções)
+    FailureCube cube;       // Contagens/somas por Type x modo de falha
 } SegmentTree;
 
 // Funções auxiliares para a Segment Tree
@@ -92,9 +141,122 @@ void initSegmentTree(SegmentTree* st, int capacity) {
         perror("Falha ao alocar memória para Segment Tree");
         exit(EXIT_FAILURE);
     }
+    st->pidIndex = useProductIndex ? createProductIndex(0) : NULL;
+    st->bitmaps = useBitmapIndex ? createBitmapIndex() : NULL;
+    initQuantileSketches(&st->quantiles);
+    failureCubeInit(&st->cube);
+}
+
+void freeSegmentTree(SegmentTree* st) {
+    free(st->data);
+    free(st->maxToolWear);
+    free(st->minToolWear);
+    free(st->sumToolWear);
+    free(st->maxTorque);
+    free(st->minTorque);
+    free(st->sumTorque);
+    free(st->maxRPM);
+    free(st->minRPM);
+    free(st->sumRPM);
+    free(st->maxTempDiff);
+    free(st->minTempDiff);
+    free(st->sumTempDiff);
+    freeProductIndex(st->pidIndex);
+    freeBitmapIndex(st->bitmaps);
+    freeQuantileSketches(&st->quantiles);
+    
+    st->data = NULL;
+    st->pidIndex = NULL;
+    st->bitmaps = NULL;
+    st->size = 0;
+    st->capacity = 0;
+    failureCubeInit(&st->cube);
+}
+
+// Liga (reconstruindo a partir das folhas) ou desliga o índice de ProductID
+void setProductIndexEnabled(SegmentTree* st, bool enabled) {
+    freeProductIndex(st->pidIndex);
+    st->pidIndex = NULL;
+    if (enabled) {
+        st->pidIndex = createProductIndex(st->size * 2);
+        for (int i = 0; i < st->size; i++) {
+            productIndexAdd(st->pidIndex, st->data[st->capacity + i].ProductID, i);
+        }
+    }
+}
+
+// Liga (reconstruindo a partir das folhas) ou desliga os bitmaps de Type/falhas
+void setBitmapIndexEnabled(SegmentTree* st, bool enabled) {
+    freeBitmapIndex(st->bitmaps);
+    st->bitmaps = NULL;
+    if (enabled) {
+        st->bitmaps = createBitmapIndex();
+        for (int i = 0; i < st->size; i++) {
+            bitmapIndexAdd(st->bitmaps, &st->data[st->capacity + i], i);
+        }
+    }
+}
+
+void updateNode(SegmentTree* st, int pos) {
+    // Atualiza as estatísticas para o nó na posição pos
+    int left = 2 * pos;
+    int right = 2 * pos + 1;
+    
+    // ToolWear
+    st->maxToolWear[pos] = fmax(st->maxToolWear[left], st->maxToolWear[right]);
+    st->minToolWear[pos] = fmin(st->minToolWear[left], st->minToolWear[right]);
+    st->sumToolWear[pos] = st->sumToolWear[left] + st->sumToolWear[right];
+    
+    // Torque
+    st->maxTorque[pos] = fmax(st->maxTorque[left], st->maxTorque[right]);
+    st->minTorque[pos] = fmin(st->minTorque[left], st->minTorque[right]);
+    st->sumTorque[pos] = st->sumTorque[left] + st->sumTorque[right];
+    
+    // RPM
+    st->maxRPM[pos] = (st->maxRPM[left] > st->maxRPM[right]) ? st->maxRPM[left] : st->maxRPM[right];
+    st->minRPM[pos] = (st->minRPM[left] < st->minRPM[right]) ? st->minRPM[left] : st->minRPM[right];
+    st->sumRPM[pos] = st->sumRPM[left] + st->sumRPM[right];
+    
+    // TempDiff
+    float tempDiffLeft = st->data[left].ProcessTemp - st->data[left].AirTemp;
+    float tempDiffRight = st->data[right].ProcessTemp - st->data[right].AirTemp;
+    st->maxTempDiff[pos] = fmax(tempDiffLeft, tempDiffRight);
+    st->minTempDiff[pos] = fmin(tempDiffLeft, tempDiffRight);
+    st->sumTempDiff[pos] = tempDiffLeft + tempDiffRight;
+}
+
+// Recalcula folhas e nós internos a partir de data[] (após reordenar ou compactar as folhas)
+void rebuildSegmentTree(SegmentTree* st) {
+    for (int i = st->capacity; i < st->capacity + st->size; i++) {
+        // Atualizar estatísticas nas folhas
+        st->maxToolWear[i] = st->data[i].ToolWear;
+        st->minToolWear[i] = st->data[i].ToolWear;
+        st->sumToolWear[i] = st->data[i].ToolWear;
+        
+        st->maxTorque[i] = st->data[i].Torque;
+        st->minTorque[i] = st->data[i].Torque;
+        st->sumTorque[i] = st->data[i].Torque;
+        
+        st->maxRPM[i] = st->data[i].RotationalSpeed;
+        st->minRPM[i] = st->data[i].RotationalSpeed;
+        st->sumRPM[i] = st->data[i].RotationalSpeed;
+        
+        float tempDiff = st->data[i].ProcessTemp - st->data[i].AirTemp;
+        st->maxTempDiff[i] = tempDiff;
+        st->minTempDiff[i] = tempDiff;
+        st->sumTempDiff[i] = tempDiff;
+    }
+    
+    // Atualizar nós internos
+    for (int i = st->capacity - 1; i >= 1; i--) {
+        updateNode(st, i);
+    }
 }
 
+// Dobra a capacidade. As folhas ficam em data[capacity + i], então precisam ser movidas
+// para o novo deslocamento antes de reconstruir os nós internos.
 void resizeSegmentTree(SegmentTree* st) {
+    int old_capacity = st->capacity;
     int new_capacity = st->capacity * 2;
     
     // Realocar dados
@@ -125,35 +287,9 @@ void resizeSegmentTree(SegmentTree* st) {
         exit(EXIT_FAILURE);
     }
     
+    memmove(&st->data[new_capacity], &st->data[old_capacity], st->size * sizeof(MachineData));
     st->capacity = new_capacity;
-}
-
-void updateNode(SegmentTree* st, int pos) {
-    // Atualiza as estatísticas para o nó na posição pos
-    int left = 2 * pos;
-    int right = 2 * pos + 1;
-    
-    // ToolWear
-    st->maxToolWear[pos] = fmax(st->maxToolWear[left], st->maxToolWear[right]);
-    st->minToolWear[pos] = fmin(st->minToolWear[left], st->minToolWear[right]);
-    st->sumToolWear[pos] = st->sumToolWear[left] + st->sumToolWear[right];
-    
-    // Torque
-    st->maxTorque[pos] = fmax(st->maxTorque[left], st->maxTorque[right]);
-    st->minTorque[pos] = fmin(st->minTorque[left], st->minTorque[right]);
-    st->sumTorque[pos] = st->sumTorque[left] + st->sumTorque[right];
-    
-    // RPM
-    st->maxRPM[pos] = (st->maxRPM[left] > st->maxRPM[right]) ? st->maxRPM[left] : st->maxRPM[right];
-    st->minRPM[pos] = (st->minRPM[left] < st->minRPM[right]) ? st->minRPM[left] : st->minRPM[right];
-    st->sumRPM[pos] = st->sumRPM[left] + st->sumRPM[right];
-    
-    // TempDiff
-    float tempDiffLeft = st->data[left].ProcessTemp - st->data[left].AirTemp;
-    float tempDiffRight = st->data[right].ProcessTemp - st->data[right].AirTemp;
-    st->maxTempDiff[pos] = fmax(tempDiffLeft, tempDiffRight);
-    st->minTempDiff[pos] = fmin(tempDiffLeft, tempDiffRight);
-    st->sumTempDiff[pos] = tempDiffLeft + tempDiffRight;
+    rebuildSegmentTree(st);
 }
 
 void append(SegmentTree* st, MachineData data) {
@@ -183,6 +319,10 @@ void append(SegmentTree* st, MachineData data) {
     st->sumTempDiff[pos] = tempDiff;
     
     st->size++;
+    if (st->pidIndex) productIndexAdd(st->pidIndex, data.ProductID, st->size - 1);
+    if (st->bitmaps) bitmapIndexAdd(st->bitmaps, &data, st->size - 1);
+    quantileSketchesAdd(&st->quantiles, &data);
+    failureCubeAdd(&st->cube, &data);
     
     // Atualizar a árvore
     for (pos >>= 1; pos >= 1; pos >>= 1) {
@@ -469,6 +609,15 @@ void insertManualSample(SegmentTree* st) {
 }
 
 void searchByProductID(SegmentTree* st, const char* pid) {
+    if (st->pidIndex) {
+        ProductIndexEntry* e = productIndexFind(st->pidIndex, pid);
+        if (e == NULL) {
+            printf("Nenhum item com ProductID %s\n", pid);
+            return;
+        }
+        for (int i = 0; i < e->count; i++) displayItem(st->data[st->capacity + e->refs[i]]);
+        return;
+    }
     bool achou = false;
     for (int i = 0; i < st->size; i++) {
         if (strcmp(st->data[st->capacity + i].ProductID, pid) == 0) {
@@ -479,9 +628,63 @@ void searchByProductID(SegmentTree* st, const char* pid) {
     if (!achou) printf("Nenhum item com ProductID %s\n", pid);
 }
 
+// Registro de uma linha dos bitmaps (linha = posição da folha)
+MachineData* recordAtRow(SegmentTree* st, unsigned int row) {
+    return &st->data[st->capacity + row];
+}
+
+// Linhas de um bitmap na ordem das folhas
+unsigned int* orderedRows(SegmentTree* st, const RoaringBitmap* rows, int* count) {
+    (void)st;
+    unsigned int* out = (unsigned int*)roaringAlloc(sizeof(unsigned int) * (roaringCardinality(rows) + 1));
+    *count = roaringToArray(rows, out);
+    return out;
+}
+
+// Exibe os registros das linhas de um bitmap
+int displayRows(SegmentTree* st, const RoaringBitmap* rows) {
+    int count;
+    unsigned int* ids = orderedRows(st, rows, &count);
+    for (int i = 0; i < count; i++) displayItem(*recordAtRow(st, ids[i]));
+    free(ids);
+    return count;
+}
+
+// Registros na ordem da estrutura; com candidates, só os das linhas desse bitmap
+const MachineData** collectFilterRecords(SegmentTree* st, const RoaringBitmap* candidates, int* count) {
+    int capacity = candidates ? roaringCardinality(candidates) : st->size;
+    const MachineData** out = (const MachineData**)malloc(sizeof(MachineData*) * (capacity + 1));
+    if (out == NULL) {
+        perror("Erro ao alocar memória para o filtro");
+        exit(EXIT_FAILURE);
+    }
+    *count = 0;
+    if (candidates == NULL) {
+        for (int i = 0; i < st->size; i++) out[(*count)++] = &st->data[st->capacity + i];
+        return out;
+    }
+    int n;
+    unsigned int* ids = orderedRows(st, candidates, &n);
+    for (int i = 0; i < n; i++) {
+        MachineData* d = recordAtRow(st, ids[i]);
+        if (d) out[(*count)++] = d;
+    }
+    free(ids);
+    return out;
+}
+
 void searchByType(SegmentTree* st, char type) {
     bool achou = false;
     type = toupper(type);
+    if (st->bitmaps && bitmapCoversType(type)) { // Folhas do Type direto do bitmap
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapTypeWithModes(st->bitmaps, type, 0, &rows);
+        achou = displayRows(st, &rows) > 0;
+        roaringFree(&rows);
+        if (!achou) printf("Nenhum item do tipo %c\n", type);
+        return;
+    }
     for (int i = 0; i < st->size; i++) {
         if (toupper(st->data[st->capacity + i].Type) == type) {
             displayItem(st->data[st->capacity + i]);
@@ -493,6 +696,15 @@ void searchByType(SegmentTree* st, char type) {
 
 void searchByMachineFailure(SegmentTree* st, bool f) {
     bool achou = false;
+    if (st->bitmaps) { // FAILURE ou ALL ANDNOT FAILURE
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapFilterCandidates(st->bitmaps, 0, f, &rows);
+        achou = displayRows(st, &rows) > 0;
+        roaringFree(&rows);
+        if (!achou) printf("Nenhum item com falha %d\n", f);
+        return;
+    }
     for (int i = 0; i < st->size; i++) {
         if (st->data[st->capacity + i].MachineFailure == f) {
             displayItem(st->data[st->capacity + i]);
@@ -502,7 +714,102 @@ void searchByMachineFailure(SegmentTree* st, bool f) {
     if (!achou) printf("Nenhum item com falha %d\n", f);
 }
 
+// Busca por Type com pelo menos um dos modos de falha (ex.: H com HDF ou OSF)
+void searchByTypeAndFailureModes(SegmentTree* st, char type, int modeMask) {
+    int found = 0;
+    if (st->bitmaps && bitmapCoversType(type)) {
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapTypeWithModes(st->bitmaps, type, modeMask, &rows);
+        found = displayRows(st, &rows);
+        roaringFree(&rows);
+    } else {
+        for (int i = 0; i < st->size; i++) {
+            if (recordMatchesTypeModes(&st->data[st->capacity + i], type, modeMask)) {
+                displayItem(st->data[st->capacity + i]);
+                found++;
+            }
+        }
+    }
+    if (!found) printf("Nenhum item do tipo %c com os modos de falha escolhidos\n", toupper(type));
+}
+
+// Contagens de classifyFailures por varredura das folhas (sem bitmaps)
+void scanClassifyCounts(SegmentTree* st, int counts[3][6]) {
+    for (int i = 0; i < st->size; i++) classifyRecord(&st->data[st->capacity + i], counts);
+}
+
+int countTypeWithModes(SegmentTree* st, char type, int modeMask) {
+    int count = 0;
+    for (int i = 0; i < st->size; i++) count += recordMatchesTypeModes(&st->data[st->capacity + i], type, modeMask);
+    return count;
+}
+
+// Existe algum registro com o ProductID? (O(1) com índice, O(n) sem)
+bool containsProductID(SegmentTree* st, const char* pid) {
+    if (st->pidIndex) return productIndexFind(st->pidIndex, pid) != NULL;
+    for (int i = 0; i < st->size; i++) {
+        if (strcmp(st->data[st->capacity + i].ProductID, pid) == 0) return true;
+    }
+    return false;
+}
+
+int compareLongLong(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+// Ajusta o índice depois da compactação: cada posição desce o número de posições removidas
+// antes dela. Uma passada pela tabela, sem recalcular hashes nem realocar.
+void shiftProductIndexRefs(ProductIndex* idx, const long long* removed, int k) {
+    for (int slot = 0; slot < idx->capacity; slot++) {
+        ProductIndexEntry* e = &idx->slots[slot];
+        for (int r = 0; r < e->count; r++) {
+            int lo = 0, hi = k; // Quantidade de removidos < e->refs[r]
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (removed[mid] < e->refs[r]) lo = mid + 1;
+                else hi = mid;
+            }
+            e->refs[r] -= lo;
+        }
+    }
+}
+
+// Remove compactando as folhas e reconstruindo a árvore (O(n)). Com o índice, um ProductID
+// ausente é descartado em O(1) e a compactação começa na primeira posição removida.
 bool removeByProductID(SegmentTree* st, const char* pid) {
+    if (st->pidIndex) {
+        ProductIndexEntry* e = productIndexFind(st->pidIndex, pid);
+        if (e == NULL) return false;
+        int k = e->count;
+        long long* removed = (long long*)malloc(sizeof(long long) * k);
+        if (removed == NULL) {
+            perror("Erro de alocação de memória");
+            return false;
+        }
+        memcpy(removed, e->refs, sizeof(long long) * k);
+        e->count = 0;
+        qsort(removed, k, sizeof(long long), compareLongLong);
+
+        int newSize = (int)removed[0];
+        for (int i = (int)removed[0], next = 0; i < st->size; i++) {
+            if (next < k && removed[next] == i) {
+                failureCubeRemove(&st->cube, &st->data[st->capacity + i]);
+                quantileSketchesInvalidate(&st->quantiles);
+                next++;
+                continue;
+            }
+            st->data[st->capacity + newSize++] = st->data[st->capacity + i];
+        }
+        st->size = newSize;
+        shiftProductIndexRefs(st->pidIndex, removed, k);
+        free(removed);
+        rebuildSegmentTree(st);
+        if (st->bitmaps) setBitmapIndexEnabled(st, true); // As posições das folhas mudaram
+        return true;
+    }
+
     bool removed = false;
     int newSize = 0;
     
@@ -511,95 +818,132 @@ bool removeByProductID(SegmentTree* st, const char* pid) {
             st->data[st->capacity + newSize] = st->data[st->capacity + i];
             newSize++;
         } else {
+            failureCubeRemove(&st->cube, &st->data[st->capacity + i]);
+            quantileSketchesInvalidate(&st->quantiles);
             removed = true;
         }
     }
     
     st->size = newSize;
-    
-    // Reconstruir a árvore
-    for (int i = st->capacity; i < st->capacity + st->size; i++) {
-        // Atualizar estatísticas nas folhas
-        st->maxToolWear[i] = st->data[i].ToolWear;
-        st->minToolWear[i] = st->data[i].ToolWear;
-        st->sumToolWear[i] = st->data[i].ToolWear;
-        
-        st->maxTorque[i] = st->data[i].Torque;
-        st->minTorque[i] = st->data[i].Torque;
-        st->sumTorque[i] = st->data[i].Torque;
-        
-        st->maxRPM[i] = st->data[i].RotationalSpeed;
-        st->minRPM[i] = st->data[i].RotationalSpeed;
-        st->sumRPM[i] = st->data[i].RotationalSpeed;
-        
-        float tempDiff = st->data[i].ProcessTemp - st->data[i].AirTemp;
-        st->maxTempDiff[i] = tempDiff;
-        st->minTempDiff[i] = tempDiff;
-        st->sumTempDiff[i] = tempDiff;
-    }
-    
-    // Atualizar nós internos
-    for (int i = st->capacity - 1; i >= 1; i--) {
-        updateNode(st, i);
+    if (removed) {
+        rebuildSegmentTree(st);
+        if (st->bitmaps) setBitmapIndexEnabled(st, true);
     }
     
     return removed;
 }
 
+// As folhas ficam na ordem de inserção: busca e intervalo por UDI percorrem as folhas (O(n))
+bool containsUDI(SegmentTree* st, int udi) {
+    for (int i = 0; i < st->size; i++) {
+        if (st->data[st->capacity + i].UDI == udi) return true;
+    }
+    return false;
+}
+
+int countUDIRange(SegmentTree* st, int lo, int hi) {
+    int count = 0;
+    for (int i = 0; i < st->size; i++) {
+        int udi = st->data[st->capacity + i].UDI;
+        count += udi >= lo && udi <= hi;
+    }
+    return count;
+}
+
+// Remove compactando as folhas a partir da primeira ocorrência, como removeByProductID; as
+// posições no índice de ProductID descem com shiftProductIndexRefs em vez de reconstruí-lo.
+bool removeByUDI(SegmentTree* st, int udi) {
+    int first = 0;
+    while (first < st->size && st->data[st->capacity + first].UDI != udi) first++;
+    if (first == st->size) return false;
+
+    long long* removed = (long long*)malloc(sizeof(long long) * (st->size - first));
+    if (removed == NULL) {
+        perror("Erro de alocação de memória");
+        return false;
+    }
+    int k = 0, newSize = first;
+    for (int i = first; i < st->size; i++) {
+        MachineData* d = &st->data[st->capacity + i];
+        if (d->UDI == udi) {
+            if (st->pidIndex) productIndexRemove(st->pidIndex, d->ProductID, i);
+            failureCubeRemove(&st->cube, d);
+            quantileSketchesInvalidate(&st->quantiles);
+            removed[k++] = i;
+            continue;
+        }
+        st->data[st->capacity + newSize++] = *d;
+    }
+    st->size = newSize;
+    if (st->pidIndex) shiftProductIndexRefs(st->pidIndex, removed, k);
+    free(removed);
+    rebuildSegmentTree(st);
+    if (st->bitmaps) setBitmapIndexEnabled(st, true); // As posições das folhas mudaram
+    return true;
+}
+
+#include "ESD-COMUM(ESTATISTICAS).h"
+
 void displayStats(const char* title, float avg, float max, float min, float stdDev) {
     printf("\n%s:\nMédia=%.2f | Máximo=%.2f | Mínimo=%.2f | Desvio=%.2f\n",
            title, avg, max, min, stdDev);
 }
 
+// Sketches em dia com os registros vivos: depois de remoções, refeitos numa passada
+QuantileSketches* liveQuantiles(SegmentTree* st) {
+    if (st->quantiles.stale) {
+        int count;
+        const MachineData** rows = collectFilterRecords(st, NULL, &count);
+        rebuildQuantileSketches(&st->quantiles, rows, count);
+        free(rows);
+    }
+    return &st->quantiles;
+}
+
 void calculateStatistics(SegmentTree* st) {
     if (st->size == 0) {
         printf("Lista vazia. Nenhum dado para análise.\n");
         return;
     }
 
-    // Usando a Segment Tree para obter estatísticas rapidamente
-    float twAvg = st->sumToolWear[1] / st->size;
-    float twMax = st->maxToolWear[1];
-    float twMin = st->minToolWear[1];
-    
-    float tqAvg = st->sumTorque[1] / st->size;
-    float tqMax = st->maxTorque[1];
-    float tqMin = st->minTorque[1];
-    
-    float rsAvg = (float)st->sumRPM[1] / st->size;
-    int rsMax = st->maxRPM[1];
-    int rsMin = st->minRPM[1];
-    
-    float tempDiffAvg = st->sumTempDiff[1] / st->size;
-    float tempDiffMax = st->maxTempDiff[1];
-    float tempDiffMin = st->minTempDiff[1];
-
-    // Segunda passada para calcular desvios padrão (ainda necessário)
-    float twSqDiffSum = 0;
-    float tqSqDiffSum = 0;
-    float rsSqDiffSum = 0;
-    float tempDiffSqDiffSum = 0;
-    
-    for (int i = 0; i < st->size; i++) {
-        twSqDiffSum += pow(st->data[st->capacity + i].ToolWear - twAvg, 2);
-        tqSqDiffSum += pow(st->data[st->capacity + i].Torque - tqAvg, 2);
-        rsSqDiffSum += pow(st->data[st->capacity + i].RotationalSpeed - rsAvg, 2);
-        float diff = st->data[st->capacity + i].ProcessTemp - st->data[st->capacity + i].AirTemp;
-        tempDiffSqDiffSum += pow(diff - tempDiffAvg, 2);
+    // Uma passada (Welford); com muitos registros, blocos acumulados em paralelo e fundidos
+    RunningStats rs;
+    if (st->size >= STATS_PARALLEL_MIN_ROWS) {
+        int count;
+        const MachineData** rows = collectFilterRecords(st, NULL, &count);
+        runningStatsParallel(rows, count, availableCores(), &rs);
+        free(rows);
+    } else {
+        runningStatsInit(&rs);
+        for (int i = 0; i < st->size; i++) runningStatsAdd(&rs, &st->data[st->capacity + i]);
     }
 
-    // Cálculo dos desvios padrão
-    float twStdDev = sqrt(twSqDiffSum / st->size);
-    float tqStdDev = sqrt(tqSqDiffSum / st->size);
-    float rsStdDev = sqrt(rsSqDiffSum / st->size);
-    float tempDiffStdDev = sqrt(tempDiffSqDiffSum / st->size);
-
-    // Exibição dos resultados
     printf("\n=== ESTATÍSTICAS DE OPERAÇÃO ===\n");
-    displayStats("Desgaste da Ferramenta (ToolWear)", twAvg, twMax, twMin, twStdDev);
-    displayStats("Torque (Nm)", tqAvg, tqMax, tqMin, tqStdDev);
-    displayStats("Velocidade Rotacional (RPM)", rsAvg, rsMax, rsMin, rsStdDev);
-    displayStats("Diferença de Temperatura (ProcessTemp - AirTemp)", tempDiffAvg, tempDiffMax, tempDiffMin, tempDiffStdDev);
+    for (int m = 0; m < STAT_METRICS; m++) {
+        displayStats(statMetricTitles[m], (float)rs.mean[m], (float)rs.max[m], (float)rs.min[m],
+                     (float)runningStatsStdDev(&rs, m));
+    }
+
+    printf("\nPercentis dos registros (sketches KLL, erro de rank ~1,65%%):\n");
+    displayQuantiles(liveQuantiles(st), statMetricTitles);
+}
+
+// Modo batch: "--check-quantiles [ProductID]" remove o ProductID dado (sem ele, os de todos os
+// registros com ToolWear acima da mediana) e confere os percentis dos sketches com os exatos
+// dos registros restantes. Sai com 1 se algo não confere.
+int checkQuantilesAfterRemoval(SegmentTree* st, int argc, char* argv[]) {
+    int count, victims;
+    const MachineData** rows = collectFilterRecords(st, NULL, &count);
+    MachineData* removed = selectQuantileCheckVictims(rows, count, argc > 2 ? argv[2] : NULL, &victims);
+    free(rows);
+    if (removed == NULL) return 1;
+    for (int i = 0; i < victims; i++) removeByProductID(st, removed[i].ProductID);
+    free(removed);
+    rows = collectFilterRecords(st, NULL, &count);
+    printf("%d ProductID(s) removido(s), %d registros restantes\n", victims, count);
+    int failures = victims == 0 ? 1 : checkQuantileSketches(liveQuantiles(st), rows, count, statMetricTitles);
+    free(rows);
+    return failures ? 1 : 0;
 }
 
 void classifyFailures(SegmentTree* st) {
@@ -621,38 +965,18 @@ void classifyFailures(SegmentTree* st) {
     TypeStats stats[3] = {0}; // 0: L, 1: M, 2: H
     int totalFailures[5] = {0}; // TWF, HDF, PWF, OSF, RNF
 
-    for (int i = 0; i < st->size; i++) {
-        int typeIndex = -1;
-        switch (toupper(st->data[st->capacity + i].Type)) {
-            case 'L': typeIndex = 0; break;
-            case 'M': typeIndex = 1; break;
-            case 'H': typeIndex = 2; break;
-        }
-
-        if (typeIndex != -1) {
-            stats[typeIndex].total++;
-            
-            if (st->data[st->capacity + i].TWF) {
-                stats[typeIndex].twf++;
-                totalFailures[0]++;
-            }
-            if (st->data[st->capacity + i].HDF) {
-                stats[typeIndex].hdf++;
-                totalFailures[1]++;
-            }
-            if (st->data[st->capacity + i].PWF) {
-                stats[typeIndex].pwf++;
-                totalFailures[2]++;
-            }
-            if (st->data[st->capacity + i].OSF) {
-                stats[typeIndex].osf++;
-                totalFailures[3]++;
-            }
-            if (st->data[st->capacity + i].RNF) {
-                stats[typeIndex].rnf++;
-                totalFailures[4]++;
-            }
-        }
+    // Contagens lidas do cubo mantido na inserção/remoção: O(1), sem percorrer a estrutura
+    int counts[3][6];
+    failureCubeCounts(&st->cube, counts);
+
+    for (int t = 0; t < 3; t++) {
+        stats[t].total = counts[t][0];
+        stats[t].twf = counts[t][1];
+        stats[t].hdf = counts[t][2];
+        stats[t].pwf = counts[t][3];
+        stats[t].osf = counts[t][4];
+        stats[t].rnf = counts[t][5];
+        for (int m = 0; m < 5; m++) totalFailures[m] += counts[t][m + 1];
     }
 
     // Exibe resultados
@@ -706,6 +1030,8 @@ void classifyFailures(SegmentTree* st) {
     printf("PWF: %d ocorrências\n", totalFailures[2]);
     printf("OSF: %d ocorrências\n", totalFailures[3]);
     printf("RNF: %d ocorrências\n", totalFailures[4]);
+
+    displayFailureCubeAverages(&st->cube);
 }
 
 void advancedFilter(SegmentTree* st) {
@@ -746,77 +1072,98 @@ void advancedFilter(SegmentTree* st) {
             criteria[5] = 1;
             hasFailureFilter = true;
             printf("Filtrar por máquinas com falha? (1-Sim, 0-Não): ");
-            scanf("%d", &failureFilter);
+            int failureValue = 0;
+            scanf("%d", &failureValue);
+            failureFilter = failureValue != 0;
         }
     } while (choice != 0);
     
     // Aplicar filtros
     printf("\nResultados do Filtro:\n");
-    int matches = 0;
-    
-    for (int i = 0; i < st->size; i++) {
-        MachineData data = st->data[st->capacity + i];
-        bool match = true;
-        
-        // Verificar cada critério
-        if (criteria[0] && (data.ToolWear < minVal[0] || data.ToolWear > maxVal[0])) {
-            match = false;
-        }
-        if (match && criteria[1] && (data.Torque < minVal[1] || data.Torque > maxVal[1])) {
-            match = false;
-        }
-        if (match && criteria[2] && (data.RotationalSpeed < minVal[2] || data.RotationalSpeed > maxVal[2])) {
-            match = false;
-        }
-        if (match && criteria[3]) {
-            float tempDiff = data.ProcessTemp - data.AirTemp;
-            if (tempDiff < minVal[3] || tempDiff > maxVal[3]) {
-                match = false;
-            }
-        }
-        if (match && criteria[4] && toupper(data.Type) != typeFilter) {
-            match = false;
-        }
-        if (match && criteria[5] && data.MachineFailure != failureFilter) {
-            match = false;
-        }
-        
-        if (match) {
-            printf("UDI: %d | ProductID: %s | Type: %c | ", 
-                   data.UDI, data.ProductID, data.Type);
-            
-            if (criteria[0]) printf("ToolWear: %d | ", data.ToolWear);
-            if (criteria[1]) printf("Torque: %.1f | ", data.Torque);
-            if (criteria[2]) printf("RPM: %d | ", data.RotationalSpeed);
-            if (criteria[3]) {
-                float tempDiff = data.ProcessTemp - data.AirTemp;
-                printf("TempDiff: %.1f | ", tempDiff);
-            }
-            if (criteria[5]) printf("Failure: %d | ", data.MachineFailure);
-            
-            printf("\n");
-            matches++;
-        }
+
+    FilterPlan plan = buildFilterPlan(criteria, minVal, maxVal, typeFilter, failureFilter);
+    RoaringBitmap candidates;
+    roaringInit(&candidates);
+    bool useBitmaps = st->bitmaps && (plan.byType || plan.byFailure) && (!plan.byType || bitmapCoversType(typeFilter));
+    if (useBitmaps) {
+        // Type e falha saem dos bitmaps; o plano fica só com os intervalos numéricos
+        bitmapFilterCandidates(st->bitmaps, plan.byType ? typeFilter : 0, plan.byFailure ? failureFilter : -1, &candidates);
+        plan.byType = false;
+        plan.byFailure = false;
     }
-    
+    int count;
+    const MachineData** rows = collectFilterRecords(st, useBitmaps ? &candidates : NULL, &count);
+    roaringFree(&candidates);
+    int matches;
+    if (plan.rangeCount + plan.byType + plan.byFailure >= FILTER_PLAN_MIN_PREDICATES) {
+        matches = runFilterPlan(&plan, rows, count, rows);
+    } else {
+        // Poucos predicados: o kernel especializado dispensa a transposição em colunas
+        int active[6] = {criteria[0], criteria[1], criteria[2], criteria[3], plan.byType, plan.byFailure};
+        matches = selectFilterKernel(active)(rows, count, minVal, maxVal, typeFilter, failureFilter, rows);
+    }
+    writeFilterMatches(rows, matches, criteria);
+    free(rows);
+
     printf("\nTotal de máquinas que atendem aos critérios: %d\n", matches);
 }
 
-// Timer de alta precisão
-typedef struct {
-    LARGE_INTEGER start;
-    LARGE_INTEGER end;
-    LARGE_INTEGER frequency;
-} HighPrecisionTimer;
-
-void start_timer(HighPrecisionTimer* timer) {
-    QueryPerformanceFrequency(&timer->frequency);
-    QueryPerformanceCounter(&timer->start);
+// Histogramas e correlações por modo de falha numa passada (opção do menu)
+void sensorAnalytics(SegmentTree* st) {
+    if (st->size == 0) {
+        printf("Lista vazia. Nenhum dado para análise.\n");
+        return;
+    }
+    AnalyticsConfig cfg;
+    readAnalyticsConfig(&cfg);
+    int count;
+    const MachineData** rows = collectFilterRecords(st, NULL, &count);
+    SensorAnalytics* a = (SensorAnalytics*)malloc(sizeof(SensorAnalytics));
+    if (a == NULL) {
+        perror("Erro ao alocar memória para a análise dos sensores");
+        free(rows);
+        return;
+    }
+    int threads = count >= STATS_PARALLEL_MIN_ROWS ? availableCores() : 1;
+    HighPrecisionTimer t;
+    start_timer(&t);
+    runSensorAnalytics(rows, count, &cfg, threads, a);
+    double ms = stop_timer(&t);
+    displaySensorAnalytics(a);
+    printf("\nPassada única sobre %d registros: %.3f ms (%d thread(s), %s)\n", count, ms, threads, ANALYTICS_SIMD_NAME);
+
+    char input[16];
+    printf("Gravar também em CSV (%s_*.csv)? (s/n): ", ANALYTICS_DEFAULT_PREFIX);
+    if (fgets(input, sizeof(input), stdin) && toupper((unsigned char)input[0]) == 'S')
+        writeSensorAnalyticsCSV(a, ANALYTICS_DEFAULT_PREFIX);
+    free(a);
+    free(rows);
 }
 
-double stop_timer(HighPrecisionTimer* timer) {
-    QueryPerformanceCounter(&timer->end);
-    return (double)(timer->end.QuadPart - timer->start.QuadPart) * 1000.0 / timer->frequency.QuadPart;
+// Modo batch: "--analytics [faixas] [prefixo]" grava os CSVs com as faixas padrão, sem menu
+int batchSensorAnalytics(SegmentTree* st, int argc, char* argv[]) {
+    int bins = argc > 2 && atoi(argv[2]) > 0 ? atoi(argv[2]) : HIST_DEFAULT_BINS;
+    const char* prefix = argc > 3 ? argv[3] : ANALYTICS_DEFAULT_PREFIX;
+    AnalyticsConfig cfg;
+    analyticsDefaultConfig(&cfg, bins);
+    int count;
+    const MachineData** rows = collectFilterRecords(st, NULL, &count);
+    SensorAnalytics* a = (SensorAnalytics*)malloc(sizeof(SensorAnalytics));
+    if (a == NULL) {
+        perror("Erro ao alocar memória para a análise dos sensores");
+        free(rows);
+        return 1;
+    }
+    int threads = count >= STATS_PARALLEL_MIN_ROWS ? availableCores() : 1;
+    HighPrecisionTimer t;
+    start_timer(&t);
+    runSensorAnalytics(rows, count, &cfg, threads, a);
+    double ms = stop_timer(&t);
+    printf("Análise de %d registros: %.3f ms (%d thread(s), %s)\n", count, ms, threads, ANALYTICS_SIMD_NAME);
+    int status = writeSensorAnalyticsCSV(a, prefix);
+    free(a);
+    free(rows);
+    return status;
 }
 
 void generateRandomData(SegmentTree* st, int count) {
@@ -843,49 +1190,48 @@ void generateRandomData(SegmentTree* st, int count) {
 
 void benchmark_insertion(SegmentTree* st, int num_elements) {
     HighPrecisionTimer t;
+    HwCounters hw;
+    hwCountersStart(&hw);
     start_timer(&t);
     SegmentTree tmp;
     initSegmentTree(&tmp, num_elements);
     generateRandomData(&tmp, num_elements);
     double elapsed = stop_timer(&t);
+    hwCountersStop(&hw);
     printf("\nBenchmark Inserção (%d elementos): %.3f ms (%.1f elem/ms)\n",
            num_elements, elapsed, num_elements / elapsed);
+    benchRecord(num_elements, num_elements, elapsed, "Insercao");
+    printHwCounters(&hw, num_elements);
     
     // Liberar memória
-    free(tmp.data);
-    free(tmp.maxToolWear);
-    free(tmp.minToolWear);
-    free(tmp.sumToolWear);
-    free(tmp.maxTorque);
-    free(tmp.minTorque);
-    free(tmp.sumTorque);
-    free(tmp.maxRPM);
-    free(tmp.minRPM);
-    free(tmp.sumRPM);
-    free(tmp.maxTempDiff);
-    free(tmp.minTempDiff);
-    free(tmp.sumTempDiff);
+    freeSegmentTree(&tmp);
+}
+
+typedef struct {
+    SegmentTree* st;
+    long long hits;    // Encontrados (ou soma dos UDIs): evita que as buscas sejam descartadas
+} SearchBench;
+
+int benchSearchOp(void* ctx, int) {
+    SearchBench* b = (SearchBench*)ctx;
+    char id[10];
+    snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
+    if (containsProductID(b->st, id)) b->hits++;
+    return 0;
 }
 
 void benchmark_search(SegmentTree* st) {
     if (st->size == 0) { printf("Lista vazia para busca\n"); return; }
-    HighPrecisionTimer t;
-    const int searches = 10000;
-    int found = 0;
-    start_timer(&t);
-    for (int i = 0; i < searches; i++) {
-        char id[10];
-        snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
-        for (int j = 0; j < st->size; j++) {
-            if (strcmp(st->data[st->capacity + j].ProductID, id) == 0) { 
-                found++; 
-                break; 
-            }
-        }
-    }
-    double elapsed = stop_timer(&t);
-    printf("\nBenchmark Busca (%d ops): encontrados=%d | tempo=%.3f ms (%.1f ops/ms)\n",
-           searches, found, elapsed, searches / elapsed);
+    SearchBench b = {st, 0};
+    BenchScenario s = {"Busca por ProductID", 10000, &b, NULL, benchSearchOp, NULL, 1, {NULL}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("\nBenchmark Busca (%d ops x %d rodadas, %d de aquecimento): encontrados=%.1f%%\n", s.opsPerRun,
+           r.runs, BENCH_WARMUP_RUNS, 100.0 * b.hits / ((double)s.opsPerRun * (BENCH_WARMUP_RUNS + BENCH_RUNS)));
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchScenarioCounters(&s);
+    benchRecordResult(&s, &r, st->size);
 }
 
 void benchmark_removal(SegmentTree* st) {
@@ -907,21 +1253,10 @@ void benchmark_removal(SegmentTree* st) {
     double elapsed = stop_timer(&t);
     printf("\nBenchmark Remoção (%d ops): %.3f ms (%.1f ops/ms)\n",
            removals, elapsed, removals / elapsed);
+    benchRecord(st->size, removals, elapsed, "Remocao");
     
     // Liberar memória
-    free(tmp.data);
-    free(tmp.maxToolWear);
-    free(tmp.minToolWear);
-    free(tmp.sumToolWear);
-    free(tmp.maxTorque);
-    free(tmp.minTorque);
-    free(tmp.sumTorque);
-    free(tmp.maxRPM);
-    free(tmp.minRPM);
-    free(tmp.sumRPM);
-    free(tmp.maxTempDiff);
-    free(tmp.minTempDiff);
-    free(tmp.sumTempDiff);
+    freeSegmentTree(&tmp);
 }
 
 void estimate_memory_usage(SegmentTree* st) {
@@ -945,31 +1280,64 @@ void estimate_memory_usage(SegmentTree* st) {
            2 * analysis_capacity, analysis_capacity);
     printf("Memória total estimada para análise: %zu bytes (%.2f KB)\n",
            total_memory, (float)total_memory / 1024);
+    if (st->pidIndex) {
+        size_t index_memory = productIndexMemory(st->pidIndex);
+        printf("Índice por ProductID (%d elementos atuais): %zu bytes (%.2f KB)\n",
+               st->size, index_memory, (float)index_memory / 1024);
+    }
+    if (st->bitmaps) {
+        size_t bitmap_memory = bitmapIndexMemory(st->bitmaps);
+        printf("Bitmaps de Type/falhas (%d elementos atuais): %zu bytes (%.2f KB)\n",
+               st->size, bitmap_memory, (float)bitmap_memory / 1024);
+    }
 
     printf("\nComparação com sizeof:\n");
     printf("sizeof(MachineData): %zu bytes\n", sizeof(MachineData));
     printf("Obs: Pode haver padding/alignment pelo compilador\n");
 }
 
+// Memória medida: monta do zero uma estrutura com o mesmo número de registros (dados aleatórios)
+// e mede o heap e o residente antes e depois; o resultado inclui cabeçalhos e sobras do malloc
+void measure_memory_usage(SegmentTree* st) {
+    int n = st->size > 0 ? st->size : 10000;
+    MemorySnapshot before;
+    memoryProbeStart(&before);
+    SegmentTree tmp;
+    initSegmentTree(&tmp, n);
+    generateRandomData(&tmp, n);
+    MemorySnapshot built;
+    memorySnapshot(&built);
+    printf("\n=== USO DE MEMÓRIA MEDIDO (%s) ===\n", memoryHeapSource());
+    printf("Registros montados: %d\n", tmp.size);
+    printMemoryDelta("Montagem", &before);
+    benchRecordBytes(n, memoryDeltaBytes(&before, &built), "Memoria medida (montagem)");
+    if (built.heapBytes >= 0 && tmp.size > 0)
+        printf("Heap por registro: %.1f bytes (sizeof(MachineData): %zu)\n",
+               (double)(built.heapBytes - before.heapBytes) / tmp.size, sizeof(MachineData));
+    freeSegmentTree(&tmp);
+}
+
+int benchAccessOp(void* ctx, int) {
+    SearchBench* b = (SearchBench*)ctx;
+    int random_pos = rand() % b->st->size;
+    b->hits += b->st->data[b->st->capacity + random_pos].UDI;
+    return 0;
+}
+
 void benchmark_random_access(SegmentTree* st) {
     if (st->size == 0) {
         printf("Lista vazia para teste de acesso aleatório\n");
         return;
     }
-
-    const int accesses = 10000;
-    HighPrecisionTimer t;
-    int sum = 0;
-
-    start_timer(&t);
-    for (int i = 0; i < accesses; i++) {
-        int random_pos = rand() % st->size;
-        sum += st->data[st->capacity + random_pos].UDI;
-    }
-    double elapsed = stop_timer(&t);
-
-    printf("Benchmark Acesso Aleatório (%d acessos): %.3f ms (%.1f acessos/ms)\n",
-           accesses, elapsed, accesses / elapsed);
+    SearchBench b = {st, 0};
+    BenchScenario s = {"Acesso aleatorio", 10000, &b, NULL, benchAccessOp, NULL, 1, {NULL}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("Benchmark Acesso Aleatório (%d acessos x %d rodadas):\n", s.opsPerRun, r.runs);
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchScenarioCounters(&s);
+    benchRecordResult(&s, &r, st->size);
 }
 
 void benchmark_scalability() {
@@ -988,109 +1356,369 @@ void benchmark_scalability() {
         
         printf("Tamanho: %6d elementos | Tempo de inserção: %7.3f ms | Tempo por elemento: %.5f ms\n",
                sizes[i], elapsed, elapsed / sizes[i]);
+        benchRecord(sizes[i], sizes[i], elapsed, "Escalabilidade: insercao");
         
         // Liberar memória
-        free(st.data);
-        free(st.maxToolWear);
-        free(st.minToolWear);
-        free(st.sumToolWear);
-        free(st.maxTorque);
-        free(st.minTorque);
-        free(st.sumTorque);
-        free(st.maxRPM);
-        free(st.minRPM);
-        free(st.sumRPM);
-        free(st.maxTempDiff);
-        free(st.minTempDiff);
-        free(st.sumTempDiff);
+        freeSegmentTree(&st);
     }
 }
 
+// Mistura de operações sobre uma estrutura nova de 1000 registros a cada rodada
+typedef struct {
+    SegmentTree s;
+} MixBench;
+
+void benchMixSetup(void* ctx) {
+    MixBench* b = (MixBench*)ctx;
+    initSegmentTree(&b->s, 1000);
+    generateRandomData(&b->s, 1000);
+}
+
+// 30% inserção; dos 70% restantes, 80% busca e 20% remoção (56% e 14% do total)
+int benchMixOp(void* ctx, int i) {
+    MixBench* b = (MixBench*)ctx;
+    // Operação de inserção (30% das vezes)
+    if (rand() % 100 < 30) {
+        MachineData d = {0};
+        d.UDI = 10000 + i;
+        snprintf(d.ProductID, sizeof(d.ProductID), "M%07d", rand() % 1000000);
+        append(&b->s, d);
+        return 0;
+    }
+    char id[10];
+    // Operação de busca (50% das vezes)
+    if (rand() % 100 < 80) {
+        snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
+        containsProductID(&b->s, id);
+        return 1;
+    }
+    // Operação de remoção (20% das vezes)
+    snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
+    removeByProductID(&b->s, id);
+    return 2;
+}
+
+void benchMixTeardown(void* ctx) {
+    freeSegmentTree(&((MixBench*)ctx)->s);
+}
+
 void benchmark_combined_operations() {
-    const int num_operations = 1000;
-    SegmentTree st;
-    initSegmentTree(&st, 1000);
-    generateRandomData(&st, 1000);
+    MixBench b;
+    BenchScenario s = {"Operacoes combinadas", 1000, &b, benchMixSetup, benchMixOp, benchMixTeardown,
+                       3, {"Insercao", "Busca", "Remocao"}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("Benchmark Operações Combinadas (%d ops x %d rodadas, árvore nova de 1000 registros por rodada):\n",
+           s.opsPerRun, r.runs);
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchRecordResult(&s, &r, 1000);
+}
+
+// Consultas determinísticas (metade existentes, metade ausentes) para comparar índice ligado x desligado
+char (*buildProductIDQueries(SegmentTree* st, int num_queries))[10] {
+    char (*queries)[10] = (char (*)[10])malloc(sizeof(*queries) * num_queries);
+    char (*existing)[10] = (char (*)[10])malloc(sizeof(*existing) * num_queries);
+    if (queries == NULL || existing == NULL) {
+        perror("Erro de alocação de memória");
+        exit(EXIT_FAILURE);
+    }
+    int n = 0;
+    for (int i = 0; i < st->size && n < num_queries; i++) {
+        strcpy(existing[n++], st->data[st->capacity + i].ProductID);
+    }
+    srand(31);
+    for (int i = 0; i < num_queries; i++) {
+        if (n > 0 && i % 2 == 0) {
+            strcpy(queries[i], existing[rand() % n]);
+        } else {
+            snprintf(queries[i], sizeof(queries[i]), "X%07d", rand() % 1000000);
+        }
+    }
+    free(existing);
+    return queries;
+}
 
+double benchmark_search_product_id(SegmentTree* st) {
+    const int searches = 10000;
+    char (*queries)[10] = buildProductIDQueries(st, searches);
     HighPrecisionTimer t;
+    int found = 0;
+
     start_timer(&t);
-    
-    for (int i = 0; i < num_operations; i++) {
-        // Operação de inserção (30% das vezes)
-        if (rand() % 100 < 30) {
-            MachineData d = {0};
-            d.UDI = 10000 + i;
-            snprintf(d.ProductID, sizeof(d.ProductID), "M%07d", rand() % 1000000);
-            append(&st, d);
-        }
-        // Operação de busca (50% das vezes)
-        else if (rand() % 100 < 80) {
-            char id[10];
-            snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
-            for (int j = 0; j < st.size; j++) {
-                if (strcmp(st.data[st.capacity + j].ProductID, id) == 0) break;
-            }
-        }
-        // Operação de remoção (20% das vezes)
-        else {
-            char id[10];
-            snprintf(id, sizeof(id), "M%07d", rand() % 1000000);
-            removeByProductID(&st, id);
-        }
+    for (int i = 0; i < searches; i++) {
+        if (containsProductID(st, queries[i])) found++;
     }
-    
     double elapsed = stop_timer(&t);
-    printf("Benchmark Operações Combinadas (%d ops): %.3f ms | Latência média: %.3f ms/op\n",
-           num_operations, elapsed, elapsed / num_operations);
-    
-    // Liberar memória
-    free(st.data);
-    free(st.maxToolWear);
-    free(st.minToolWear);
-    free(st.sumToolWear);
-    free(st.maxTorque);
-    free(st.minTorque);
-    free(st.sumTorque);
-    free(st.maxRPM);
-    free(st.minRPM);
-    free(st.sumRPM);
-    free(st.maxTempDiff);
-    free(st.minTempDiff);
-    free(st.sumTempDiff);
+    printf("Busca por ProductID (%d ops): encontrados=%d | tempo=%.3f ms (%.1f ops/ms)\n",
+           searches, found, elapsed, searches / elapsed);
+    benchRecord(st->size, searches, elapsed, "Busca por ProductID (indice %s)", useProductIndex ? "ligado" : "desligado");
+    free(queries);
+    return elapsed;
+}
+
+double benchmark_removal_product_id(SegmentTree* st) {
+    const int removals = 1000;
+    char (*queries)[10] = buildProductIDQueries(st, removals);
+    SegmentTree tmp;
+    initSegmentTree(&tmp, st->size);
+    for (int i = 0; i < st->size; i++) {
+        append(&tmp, st->data[st->capacity + i]);
+    }
+
+    HighPrecisionTimer t;
+    int removed = 0;
+    start_timer(&t);
+    for (int i = 0; i < removals; i++) {
+        if (removeByProductID(&tmp, queries[i])) removed++;
+    }
+    double elapsed = stop_timer(&t);
+    printf("Remoção por ProductID (%d ops): removidos=%d | tempo=%.3f ms (%.1f ops/ms)\n",
+           removals, removed, elapsed, removals / elapsed);
+    benchRecord(st->size, removals, elapsed, "Remocao por ProductID (indice %s)", useProductIndex ? "ligado" : "desligado");
+    freeSegmentTree(&tmp);
+    free(queries);
+    return elapsed;
+}
+
+// Repete inserção e busca/remoção por ProductID com o índice desligado e ligado
+void benchmark_product_index(SegmentTree* st) {
+    bool saved = useProductIndex;
+    double search_ms[2], removal_ms[2];
+    for (int on = 0; on <= 1; on++) {
+        useProductIndex = on;
+        setProductIndexEnabled(st, on);
+        printf("\n--- Índice por ProductID %s ---", on ? "LIGADO" : "DESLIGADO");
+        benchmark_insertion(st, 10000);
+        search_ms[on] = benchmark_search_product_id(st);
+        removal_ms[on] = benchmark_removal_product_id(st);
+    }
+    useProductIndex = saved;
+    setProductIndexEnabled(st, saved);
+    printf("\nSpeedup com índice: busca %.1fx | remoção %.1fx\n",
+           search_ms[0] / search_ms[1], removal_ms[0] / removal_ms[1]);
+}
+
+// classifyFailures e a consulta "Type H com HDF ou OSF": varredura x operações nos bitmaps
+void benchmark_bitmap_index(SegmentTree* st) {
+    if (st->bitmaps == NULL) setBitmapIndexEnabled(st, true);
+    const int reps = 100;
+    const int modes = parseFailureModes("HDF,OSF");
+    int scan_counts[3][6], bitmap_counts[3][6];
+    int scan_matches = 0, bitmap_matches = 0;
+    HighPrecisionTimer t;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        memset(scan_counts, 0, sizeof(scan_counts));
+        scanClassifyCounts(st, scan_counts);
+    }
+    double scan_classify = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) bitmapClassifyCounts(st->bitmaps, bitmap_counts);
+    double bitmap_classify = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) scan_matches = countTypeWithModes(st, 'H', modes);
+    double scan_query = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapTypeWithModes(st->bitmaps, 'H', modes, &rows);
+        bitmap_matches = roaringCardinality(&rows);
+        roaringFree(&rows);
+    }
+    double bitmap_query = stop_timer(&t) / reps;
+
+    int cube_counts[3][6];
+    const int cube_reps = 100000;
+    volatile int cube_sink = 0;
+    start_timer(&t);
+    for (int r = 0; r < cube_reps; r++) {
+        failureCubeCounts(&st->cube, cube_counts);
+        cube_sink += cube_counts[r % 3][0];
+    }
+    double cube_classify = stop_timer(&t) / cube_reps;
+
+    if (memcmp(scan_counts, bitmap_counts, sizeof(scan_counts)) != 0 || scan_matches != bitmap_matches)
+        printf("AVISO: bitmaps divergem da varredura!\n");
+    if (memcmp(scan_counts, cube_counts, sizeof(scan_counts)) != 0)
+        printf("AVISO: cubo de agregados diverge da varredura!\n");
+    printf("Classificação de falhas: varredura %.4f ms | popcount %.4f ms | speedup %.1fx\n",
+           scan_classify, bitmap_classify, scan_classify / bitmap_classify);
+    printf("Classificação pelo cubo incremental: %.6f ms | speedup %.0fx sobre a varredura\n",
+           cube_classify, scan_classify / cube_classify);
+    printf("Type H com HDF ou OSF (%d registros): varredura %.4f ms | bitmaps %.4f ms | speedup %.1fx\n",
+           bitmap_matches, scan_query, bitmap_query, scan_query / bitmap_query);
+    size_t bitmap_memory = bitmapIndexMemory(st->bitmaps);
+    printf("Memória dos bitmaps: %zu bytes (%.2f KB)\n", bitmap_memory, (float)bitmap_memory / 1024);
+    benchRecord(st->size, reps, scan_classify * reps, "Classificacao: varredura");
+    benchRecord(st->size, reps, bitmap_classify * reps, "Classificacao: popcount");
+    benchRecord(st->size, cube_reps, cube_classify * cube_reps, "Classificacao: cubo incremental");
+    benchRecord(st->size, reps, scan_query * reps, "Type H com HDF ou OSF: varredura");
+    benchRecord(st->size, reps, bitmap_query * reps, "Type H com HDF ou OSF: bitmaps");
+    benchRecordBytes(st->size, (long long)bitmap_memory, "Memoria dos bitmaps");
+}
+
+// Filtro avançado sem a saída: laço escalar com um if por critério x plano vetorizado
+void benchmark_filter_engine(SegmentTree* st) {
+    const int criteria[6] = {1, 1, 1, 1, 0, 1};
+    const float minVal[4] = {0, 30, 1400, 8};
+    const float maxVal[4] = {110, 45, 1550, 10.5f};
+    const int reps = 100;
+    int count;
+    const MachineData** rows = collectFilterRecords(st, NULL, &count);
+    const MachineData** selected = (const MachineData**)malloc(sizeof(MachineData*) * (count + 1));
+    if (selected == NULL) {
+        perror("Erro ao alocar memória para o benchmark do filtro");
+        free(rows);
+        return;
+    }
+    FilterPlan plan = buildFilterPlan(criteria, minVal, maxVal, 0, false);
+    int scalar_matches = 0, engine_matches = 0;
+    HighPrecisionTimer t;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        scalar_matches = 0;
+        for (int i = 0; i < count; i++) {
+            scalar_matches += filterMatchesRecord(rows[i], criteria, minVal, maxVal, 0, false);
+        }
+    }
+    double scalar_ms = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) engine_matches = runFilterPlan(&plan, rows, count, selected);
+    double engine_ms = stop_timer(&t) / reps;
+
+    if (scalar_matches != engine_matches)
+        printf("AVISO: plano vetorizado diverge do laço escalar!\n");
+    printf("5 critérios sobre %d registros (%d aprovados)\n", count, engine_matches);
+    printf("Laço escalar: %.4f ms | Plano vetorizado: %.4f ms | speedup %.1fx\n",
+           scalar_ms, engine_ms, scalar_ms / engine_ms);
+    benchRecord(count, (long long)count * reps, scalar_ms * reps, "Filtro: laco escalar");
+    benchRecord(count, (long long)count * reps, engine_ms * reps, "Filtro: plano vetorizado");
+    free(rows);
+    free(selected);
 }
 
+// Definido junto da simulação da fresadora, depois dos padrões de falha
+void benchmark_pattern_index(SegmentTree* st);
+void benchmark_failure_regions(SegmentTree* st);
+void benchmark_failure_model(SegmentTree* st);
+void benchmark_fleet_simulation(SegmentTree* st);
+
 void run_all_benchmarks(SegmentTree* st) {
     printf("\n=== INICIANDO BENCHMARKS COMPLETOS ===\n");
+    benchLogReset("");
+    printf("Relógio: %s (%.0f MHz) | memória: residente medida, heap por %s\n", timerSourceName(),
+           timerFrequency() / 1e6, memoryHeapSource());
+    MemorySnapshot mem;
     
     // 1. Benchmark de Inserção
-    printf("\n1. Tempo de Inserção:\n");
+    benchSection("1. Tempo de Inserção");
+    memoryProbeStart(&mem);
     benchmark_insertion(st, 1000);
     benchmark_insertion(st, 10000);
     
     // 2. Benchmark de Remoção
-    printf("\n2. Tempo de Remoção:\n");
+    benchMemoryDelta(&mem);
+    benchSection("2. Tempo de Remoção");
+    memoryProbeStart(&mem);
     benchmark_removal(st);
     
     // 3. Benchmark de Busca
-    printf("\n3. Tempo de Busca:\n");
+    benchMemoryDelta(&mem);
+    benchSection("3. Tempo de Busca");
+    memoryProbeStart(&mem);
     benchmark_search(st);
     
     // 4. Benchmark de Uso de Memória
-    printf("\n4. Uso de Memória:\n");
+    benchMemoryDelta(&mem);
+    benchSection("4. Uso de Memória");
+    memoryProbeStart(&mem);
     estimate_memory_usage(st);
+    measure_memory_usage(st);
     
     // 5. Benchmark de Tempo Médio de Acesso
-    printf("\n5. Tempo Médio de Acesso:\n");
+    benchMemoryDelta(&mem);
+    benchSection("5. Tempo Médio de Acesso");
+    memoryProbeStart(&mem);
     benchmark_random_access(st);
     
     // 6. Benchmark de Escalabilidade
-    printf("\n6. Escalabilidade:\n");
+    benchMemoryDelta(&mem);
+    benchSection("6. Escalabilidade");
+    memoryProbeStart(&mem);
     benchmark_scalability();
     
     // 7. Benchmark de Latência Média
-    printf("\n7. Latência Média (operações combinadas):\n");
+    benchMemoryDelta(&mem);
+    benchSection("7. Latência por operação (operações combinadas)");
+    memoryProbeStart(&mem);
     benchmark_combined_operations();
     
+    // 8. Índice hash por ProductID
+    benchMemoryDelta(&mem);
+    benchSection("8. Índice Hash por ProductID (desligado x ligado)");
+    memoryProbeStart(&mem);
+    benchmark_product_index(st);
+
+    benchMemoryDelta(&mem);
+    benchSection("9. Bitmaps de Type/falhas (varredura x popcount)");
+    memoryProbeStart(&mem);
+    benchmark_bitmap_index(st);
+
+    benchMemoryDelta(&mem);
+    benchSection("10. Filtro avançado (escalar x vetorizado)");
+    memoryProbeStart(&mem);
+    benchmark_filter_engine(st);
+
+    benchMemoryDelta(&mem);
+    benchSection("11. Kernels de filtro especializados (10M linhas sintéticas)");
+    memoryProbeStart(&mem);
+    benchmark_filter_kernels();
+
+    benchMemoryDelta(&mem);
+    benchSection("12. Estatísticas em uma passada e redução paralela (50M linhas sintéticas)");
+    memoryProbeStart(&mem);
+    benchmark_parallel_stats();
+
+    benchMemoryDelta(&mem);
+    benchSection("13. Percentis: ordenação x sketches KLL");
+    memoryProbeStart(&mem);
+    benchmark_quantile_sketches();
+
+    benchMemoryDelta(&mem);
+    benchSection("14. Histogramas e correlações: linha a linha x lotes colunares");
+    memoryProbeStart(&mem);
+    benchmark_sensor_analytics();
+    
+    benchMemoryDelta(&mem);
+    benchSection("15. Padrões de falha: varredura linear x R-tree (1M amostras simuladas)");
+    memoryProbeStart(&mem);
+    benchmark_pattern_index(st);
+
+    benchMemoryDelta(&mem);
+    benchSection("16. Regiões de falha: um padrão por falha x caixas agrupadas (validação 80/20)");
+    memoryProbeStart(&mem);
+    benchmark_failure_regions(st);
+
+    benchMemoryDelta(&mem);
+    benchSection("17. Árvores de decisão: treino, validação e inferência em blocos");
+    memoryProbeStart(&mem);
+    benchmark_failure_model(st);
+
+    benchMemoryDelta(&mem);
+    benchSection("18. Frota em paralelo: amostras/s e latência dos alertas de 1 a 4096 máquinas");
+    memoryProbeStart(&mem);
+    benchmark_fleet_simulation(st);
+
+    benchMemoryDelta(&mem);
+
     printf("\n=== BENCHMARKS CONCLUÍDOS ===\n");
 }
 
@@ -1102,7 +1730,7 @@ void generateAnomalousData(SegmentTree* st, int count, int max_size) {
         }
 
         if (i % 100 == 0) {
-            Sleep(1); // Interrupções periódicas
+            sleepMilliseconds(1); // Interrupções periódicas
         }
 
         MachineData d = {0};
@@ -1131,11 +1759,12 @@ void generateAnomalousData(SegmentTree* st, int count, int max_size) {
         append(st, d);
 
         if (i > 0 && i % 100 == 0) {
-            Sleep(50); // Delay artificial por lote
+            sleepMilliseconds(50); // Delay artificial por lote
         }
     }
 }
 
+
 void selectionSort(SegmentTree* st) {
     if (st == NULL || st->size < 2) return;
 
@@ -1155,34 +1784,25 @@ void selectionSort(SegmentTree* st) {
     }
     
     // Reconstruir a árvore após a ordenação
-    for (int i = st->capacity; i < st->capacity + st->size; i++) {
-        // Atualizar estatísticas nas folhas
-        st->maxToolWear[i] = st->data[i].ToolWear;
-        st->minToolWear[i] = st->data[i].ToolWear;
-        st->sumToolWear[i] = st->data[i].ToolWear;
-        
-        st->maxTorque[i] = st->data[i].Torque;
-        st->minTorque[i] = st->data[i].Torque;
-        st->sumTorque[i] = st->data[i].Torque;
-        
-        st->maxRPM[i] = st->data[i].RotationalSpeed;
-        st->minRPM[i] = st->data[i].RotationalSpeed;
-        st->sumRPM[i] = st->data[i].RotationalSpeed;
-        
-        float tempDiff = st->data[i].ProcessTemp - st->data[i].AirTemp;
-        st->maxTempDiff[i] = tempDiff;
-        st->minTempDiff[i] = tempDiff;
-        st->sumTempDiff[i] = tempDiff;
-    }
-    
-    // Atualizar nós internos
-    for (int i = st->capacity - 1; i >= 1; i--) {
-        updateNode(st, i);
-    }
+    rebuildSegmentTree(st);
+    if (st->pidIndex) setProductIndexEnabled(st, true); // As posições das folhas mudaram
+    if (st->bitmaps) setBitmapIndexEnabled(st, true);
+}
+
+#include "ESD-COMUM(ORDENACAO).h"
+
+// Ordena as folhas por UDI com radix sort e reconstrói os agregados uma única vez
+void radixSortSegmentTree(SegmentTree* st) {
+    if (st == NULL || st->size < 2) return;
+    radixSortByUDI(&st->data[st->capacity], st->size);
+    rebuildSegmentTree(st);
+    if (st->pidIndex) setProductIndexEnabled(st, true); // As posições das folhas mudaram
+    if (st->bitmaps) setBitmapIndexEnabled(st, true);
 }
 
-void run_restricted_benchmarks() {
+void run_restricted_benchmarks(bool r24Penalty) {
     printf("\n=== BENCHMARK COM RESTRIÇÕES ATIVADAS ===\n");
+    benchLogReset("Restricoes ativadas");
 
     SegmentTree st;
     initSegmentTree(&st, 1000);
@@ -1196,32 +1816,31 @@ void run_restricted_benchmarks() {
     double elapsed = stop_timer(&t);
 
     printf("\nTempo total (com 4 restrições aplicadas): %.3f ms\n", elapsed);
+    benchRecord(1000, 1000, elapsed, "Geracao com restricoes");
     printf("Elementos finais na lista (máximo 500): %d\n", st.size);
 
-    // Ordenação por algoritmo ineficiente
-    printf("\nAplicando ordenação ineficiente (selection sort)...\n");
-    selectionSort(&st);
+    // Ordenação por algoritmo ineficiente (R24) ou radix sort, para comparação
+    start_timer(&t);
+    if (r24Penalty) {
+        printf("\nAplicando ordenação ineficiente (selection sort)...\n");
+        selectionSort(&st);
+    } else {
+        printf("\nOrdenação por UDI com radix sort (R24 desativada)...\n");
+        radixSortSegmentTree(&st);
+    }
+    double sort_ms = stop_timer(&t);
+    printf("Tempo de ordenação: %.3f ms\n", sort_ms);
+    benchRecord(st.size, st.size, sort_ms, "Ordenacao por UDI (%s)", r24Penalty ? "selection sort" : "radix sort");
 
     // Benchmarks após restrições
     benchmark_search(&st);
     benchmark_removal(&st);
     benchmark_random_access(&st);
     estimate_memory_usage(&st);
+    measure_memory_usage(&st);
 
     // Liberar memória
-    free(st.data);
-    free(st.maxToolWear);
-    free(st.minToolWear);
-    free(st.sumToolWear);
-    free(st.maxTorque);
-    free(st.minTorque);
-    free(st.sumTorque);
-    free(st.maxRPM);
-    free(st.minRPM);
-    free(st.sumRPM);
-    free(st.maxTempDiff);
-    free(st.minTempDiff);
-    free(st.sumTempDiff);
+    freeSegmentTree(&st);
 
     printf("\n=== FIM DOS TESTES COM RESTRIÇÕES ===\n");
 }
@@ -1233,7 +1852,7 @@ void displayMenu() {
     printf("3. Buscar Type\n");
     printf("4. Buscar MachineFailure\n");
     printf("5. Inserir nova amostra manualmente\n");
-    printf("6. Remover por ProductID (Adapte para Segment Tree)\n"); // Adapte o texto se remover por índice for mais direto
+    printf("6. Remover por ProductID\n");
     printf("7. Estatísticas (Usando Segment Tree)\n");
     printf("8. Classificar Falhas\n");
     printf("9. Filtro Avançado\n");
@@ -1241,77 +1860,12 @@ void displayMenu() {
     printf("11. Executar Restrições\n");
     printf("12. Aprender Padrões de Falha\n");        // NOVA OPÇÃO
     printf("13. Simular Fresadora e Detectar Falhas\n"); // NOVA OPÇÃO
-    printf("14. Sair\n");                               // Opção de saída atualizada
+    printf("14. Histogramas e Correlações\n");
+    printf("15. Sair\n");                               // Opção de saída atualizada
     printf("Escolha: ");
 }
 
-void freeSegmentTree(SegmentTree* st) {
-    free(st->data);
-    free(st->maxToolWear);
-    free(st->minToolWear);
-    free(st->sumToolWear);
-    free(st->maxTorque);
-    free(st->minTorque);
-    free(st->sumTorque);
-    free(st->maxRPM);
-    free(st->minRPM);
-    free(st->sumRPM);
-    free(st->maxTempDiff);
-    free(st->minTempDiff);
-    free(st->sumTempDiff);
-    
-    st->data = NULL;
-    st->size = 0;
-    st->capacity = 0;
-}
-// NOVA ESTRUTURA: Define um padrão de falha
-// Armazena os valores exatos de uma instância de falha para fins de aprendizado/detecção.
-// Em um sistema mais robusto, isso poderia ser uma faixa de valores ou propriedades estatísticas.
-typedef struct {
-    float minAirTemp, maxAirTemp;
-    float minProcessTemp, maxProcessTemp;
-    int minRotationalSpeed, maxRotationalSpeed;
-    float minTorque, maxTorque;
-    int minToolWear, maxToolWear;
-    bool hadTWF, hadHDF, hadPWF, hadOSF, hadRNF;
-} FailurePattern;
-
-// NOVA ESTRUTURA: Lista dinâmica para armazenar múltiplos padrões de falha
-typedef struct {
-    FailurePattern* patterns;
-    int count;
-    int capacity;
-} FailurePatternList;
-
-// --- FUNÇÕES AUXILIARES PARA A LISTA DE PADRÕES DE FALHA ---
-
-// Inicializa a lista de padrões de falha
-void initFailurePatternList(FailurePatternList* list) {
-    list->patterns = NULL;
-    list->count = 0;
-    list->capacity = 0;
-}
-
-// Adiciona um padrão de falha à lista dinâmica
-void addFailurePattern(FailurePatternList* list, FailurePattern pattern) {
-    if (list->count == list->capacity) {
-        list->capacity = (list->capacity == 0) ? 1 : list->capacity * 2;
-        list->patterns = (FailurePattern*)realloc(list->patterns, list->capacity * sizeof(FailurePattern));
-        if (list->patterns == NULL) {
-            perror("Falha ao realocar memória para os padrões de falha");
-            exit(EXIT_FAILURE);
-        }
-    }
-    list->patterns[list->count++] = pattern;
-}
-
-// Libera a memória alocada para a lista de padrões de falha
-void freeFailurePatternList(FailurePatternList* list) {
-    free(list->patterns);
-    list->patterns = NULL;
-    list->count = 0;
-    list->capacity = 0;
-}
+#include "ESD-COMUM(PADROES).h"
 
 // --- FUNÇÕES DE APRENDIZAGEM E DETECÇÃO DE PADRÕES DE FALHA ---
 
@@ -1326,67 +1880,41 @@ void learnFailurePatterns(SegmentTree* st, FailurePatternList* patterns) {
     }
 
     printf("\n=== APRENDENDO PADRÕES DE FALHA ===\n");
-    // Reinicia os padrões antes de aprender novos
-    freeFailurePatternList(patterns);
-    initFailurePatternList(patterns);
+    int count;
+    const MachineData** rows = collectFilterRecords(st, NULL, &count);
+    HighPrecisionTimer t;
+    start_timer(&t);
+    int failures = learnFailureRegions(rows, count, patterns);
+    double ms = stop_timer(&t);
+    printf("Aprendidos %d padrões de falha (regiões) a partir de %d falhas dos dados existentes (%.2f ms).\n",
+           patterns->count, failures, ms);
+    displayPatternPrefilter(&patterns->prefilter);
 
-    int learned_count = 0;
-    // Percorre os dados brutos armazenados na Segment Tree (folhas)
-    for (int i = 0; i < st->size; i++) {
-        MachineData current_data = st->data[st->capacity + i];
-        if (current_data.MachineFailure) { // Se houver falha na máquina
-            FailurePattern fp;
-            // Para este exemplo, armazena os valores exatos da instância de falha como um padrão.
-            fp.minAirTemp = fp.maxAirTemp = current_data.AirTemp;
-            fp.minProcessTemp = fp.maxProcessTemp = current_data.ProcessTemp;
-            fp.minRotationalSpeed = fp.maxRotationalSpeed = current_data.RotationalSpeed;
-            fp.minTorque = fp.maxTorque = current_data.Torque;
-            fp.minToolWear = fp.maxToolWear = current_data.ToolWear;
-            
-            fp.hadTWF = current_data.TWF;
-            fp.hadHDF = current_data.HDF;
-            fp.hadPWF = current_data.PWF;
-            fp.hadOSF = current_data.OSF;
-            fp.hadRNF = current_data.RNF;
-
-            addFailurePattern(patterns, fp);
-            learned_count++;
-        }
-    }
-    printf("Aprendidos %d padrões de falha a partir dos dados existentes.\n", learned_count);
+    start_timer(&t);
+    trainFailureModel(rows, count, &patterns->model);
+    ms = stop_timer(&t);
+    printf("Árvores de decisão treinadas (profundidade %d, %d alvos) em %.2f ms. Ajuste nos dados carregados:\n",
+           TREE_DEPTH, TREE_TARGETS, ms);
+    DetectionCounts counts[TREE_TARGETS];
+    evaluateFailureModel(&patterns->model, rows, count, counts);
+    displayFailureModelEvaluation(counts);
+    free(rows);
 }
 
-// VERIFICA SE OS DADOS ATUAIS CORRESPONDEM A UM PADRÃO DE FALHA APRENDIDO
-// Compara os dados da máquina com os padrões armazenados.
-// A correspondência atual é exata. Em um cenário real, você pode usar uma tolerância.
-bool checkForFailurePattern(MachineData data, FailurePatternList* patterns) {
-    for (int i = 0; i < patterns->count; i++) {
-        FailurePattern fp = patterns->patterns[i];
-
-        // Esta é uma correspondência exata. Considere adicionar uma tolerância (e.g., fabs(data.AirTemp - fp.minAirTemp) < epsilon)
-        bool match = true;
-        if (fabs(data.AirTemp - fp.minAirTemp) > 0.001 || // Usar fabs para float comparisons
-            fabs(data.ProcessTemp - fp.minProcessTemp) > 0.001 ||
-            data.RotationalSpeed != fp.minRotationalSpeed ||
-            fabs(data.Torque - fp.minTorque) > 0.001 ||
-            data.ToolWear != fp.minToolWear) {
-            match = false;
-        }
-
-        // Também verifica os flags de falha específicos se eles fazem parte da definição do seu padrão
-        if (match && (data.TWF != fp.hadTWF ||
-                      data.HDF != fp.hadHDF ||
-                      data.PWF != fp.hadPWF ||
-                      data.OSF != fp.hadOSF ||
-                      data.RNF != fp.hadRNF)) {
-            match = false;
-        }
+// Próximo UDI livre para amostras simuladas: maior UDI atual + 1
+int nextSimulatedUDI(SegmentTree* st) {
+    int next_udi = 0;
 
-        if (match) {
-            return true; // Padrão detectado!
+    // Encontra o UDI máximo atual para continuar a partir dele
+    if (st->size > 0) {
+        for (int i = 0; i < st->size; i++) {
+            if (st->data[st->capacity + i].UDI > next_udi) {
+                next_udi = st->data[st->capacity + i].UDI;
+            }
         }
     }
-    return false; // Nenhum padrão correspondente encontrado
+    next_udi++; // Começa o UDI para novas simulações a partir do próximo número
+    return next_udi;
 }
 
 // --- FUNÇÃO DE SIMULAÇÃO DA FRESADORA ---
@@ -1395,76 +1923,40 @@ bool checkForFailurePattern(MachineData data, FailurePatternList* patterns) {
 // Gera dados de MachineData simulados.
 // Periodicamente, injeta um padrão de falha aprendido para demonstrar a detecção.
 // Opção 13 do menu.
-void simulateMillingMachine(SegmentTree* st, FailurePatternList* patterns, int num_simulations) {
+void simulateMillingMachine(SegmentTree* st, FailurePatternList* patterns, int num_simulations, unsigned int seed) {
     if (patterns->count == 0) {
         printf("Nenhum padrão de falha aprendido. Por favor, aprenda os padrões primeiro (Opção 12).\n");
         return;
     }
 
     printf("\n=== SIMULANDO FRESADORA E DETECTANDO FALHAS ===\n");
-    srand((unsigned)time(NULL)); // Inicializa o gerador de números aleatórios
+    displayPatternTolerance(patterns);
+    printf("Semente: %u\n", seed);
+    srand(seed); // Mesma semente, mesmo fluxo (ver recordSimulationStream)
     int failure_alerts = 0;
-    int next_udi = 0;
-
-    // Encontra o UDI máximo atual para continuar a partir dele
-    if (st->size > 0) {
-        for (int i = 0; i < st->size; i++) {
-            if (st->data[st->capacity + i].UDI > next_udi) {
-                next_udi = st->data[st->capacity + i].UDI;
-            }
-        }
-    }
-    next_udi++; // Começa o UDI para novas simulações a partir do próximo número
+    int next_udi = nextSimulatedUDI(st);
 
+    MachineData block[64];
+    unsigned long long blockAlerts = 0;
+    DetectionCounts patternHits = {0, 0, 0, 0}, modelHits = {0, 0, 0, 0};
     for (int i = 0; i < num_simulations; i++) {
-        MachineData simulatedData;
-        simulatedData.UDI = next_udi++;
-
-        // Gera ProductID e Tipo (pode ser aleatório ou seguir uma sequência)
-        snprintf(simulatedData.ProductID, sizeof(simulatedData.ProductID), "SIM%06d", rand() % 1000000);
-        simulatedData.Type = "LMH"[rand() % 3];
-
-        // Introduz variações em torno de valores típicos (menos de falha)
-        // Defina faixas razoáveis para a sua simulação de "operação normal"
-        simulatedData.AirTemp = 298.0f + (float)(rand() % 200) / 100.0f - 1.0f; // Ex: 297.0 a 299.0 K
-        simulatedData.ProcessTemp = simulatedData.AirTemp + 10.0f + (float)(rand() % 100) / 100.0f; // Ex: Processo geralmente mais alto
-        simulatedData.RotationalSpeed = 1400 + rand() % 200 - 100; // Ex: 1300 a 1500 rpm
-        simulatedData.Torque = 30.0f + (float)(rand() % 200) / 100.0f - 1.0f; // Ex: 29.0 a 31.0 Nm
-        simulatedData.ToolWear = 30 + rand() % 30 - 15; // Ex: 15 a 45 min
-
-        // Assume que não há falha inicialmente para dados simulados, a menos que um padrão seja injetado
-        simulatedData.MachineFailure = false;
-        simulatedData.TWF = false;
-        simulatedData.HDF = false;
-        simulatedData.PWF = false;
-        simulatedData.OSF = false;
-        simulatedData.RNF = false;
-
-        // Introduz um padrão de falha periodicamente ou aleatoriamente
-        // Aqui, há uma chance de 5% de injetar um padrão de falha aprendido
-        if (patterns->count > 0 && rand() % 20 == 0) { 
-            // Seleciona um padrão aprendido aleatório para injetar
-            int pattern_idx = rand() % patterns->count;
-            FailurePattern injected_pattern = patterns->patterns[pattern_idx];
-
-            // Sobrescreve os dados simulados com os valores do padrão de falha
-            simulatedData.AirTemp = injected_pattern.minAirTemp;
-            simulatedData.ProcessTemp = injected_pattern.minProcessTemp;
-            simulatedData.RotationalSpeed = injected_pattern.minRotationalSpeed;
-            simulatedData.Torque = injected_pattern.minTorque;
-            simulatedData.ToolWear = injected_pattern.minToolWear;
-            
-            // Define os flags de falha de acordo com o padrão
-            simulatedData.MachineFailure = true; // Isso é crucial para a detecção
-            simulatedData.TWF = injected_pattern.hadTWF;
-            simulatedData.HDF = injected_pattern.hadHDF;
-            simulatedData.PWF = injected_pattern.hadPWF;
-            simulatedData.OSF = injected_pattern.hadOSF;
-            simulatedData.RNF = injected_pattern.hadRNF;
+        // As amostras são geradas e comparadas com os padrões em blocos de 64 (um bit por amostra)
+        int slot = i % 64;
+        if (slot == 0) {
+            int len = num_simulations - i < 64 ? num_simulations - i : 64;
+            for (int j = 0; j < len; j++) generateSimulatedSample(&block[j], patterns, next_udi++);
+            checkForFailurePatternBatch(block, len, patterns, &blockAlerts);
         }
+        MachineData simulatedData = block[slot];
 
         // Verifica se os dados simulados correspondem a algum padrão de falha aprendido
-        if (checkForFailurePattern(simulatedData, patterns)) {
+        bool alert = (blockAlerts >> slot) & 1;
+        countDetection(&patternHits, alert, simulatedData.MachineFailure);
+        // No fluxo do simulador os caminhos se repetem e o if/else é previsto; ver benchmark_failure_model
+        if (patterns->model.trained)
+            countDetection(&modelHits, predictFailureModesScalar(&patterns->model, &simulatedData) & 1,
+                           simulatedData.MachineFailure);
+        if (alert) {
             printf("\n!!! ALERTA DE PADRÃO DE FALHA DETECTADO !!!\n");
             displayItem(simulatedData);
             failure_alerts++;
@@ -1478,13 +1970,172 @@ void simulateMillingMachine(SegmentTree* st, FailurePatternList* patterns, int n
         append(st, simulatedData);
     }
     printf("\nSimulação concluída. Total de alertas de falha: %d\n", failure_alerts);
+    printf("Padrões: precisão %.1f%% | recall %.1f%% (falhas injetadas: %d)\n", detectionPrecision(&patternHits),
+           detectionRecall(&patternHits), patternHits.tp + patternHits.fn);
+    if (patterns->model.trained)
+        printf("Árvore de decisão: %d falhas previstas | precisão %.1f%% | recall %.1f%%\n", modelHits.tp + modelHits.fp,
+               detectionPrecision(&modelHits), detectionRecall(&modelHits));
+}
+
+// --- ADAPTAÇÃO DA SEGMENT TREE AO CÓDIGO COMUM ---
+// As operações sobre esta estrutura de que o código comum precisa: frota, reprodução do fluxo,
+// carga de trabalho e benchmarks de padrões (ESD-COMUM(*).h).
+typedef SegmentTree WorkloadBackend;
+
+void workloadInit(SegmentTree* st, int capacity) {
+    initSegmentTree(st, capacity);
+}
+
+void workloadFree(SegmentTree* st) {
+    freeSegmentTree(st);
+}
+
+void workloadInsert(SegmentTree* st, const MachineData* d) {
+    append(st, *d);
+}
+
+bool workloadFindUDI(SegmentTree* st, int udi) {
+    return containsUDI(st, udi);
+}
+
+bool workloadFindProductID(SegmentTree* st, const char* pid) {
+    return containsProductID(st, pid);
+}
+
+int workloadRangeCount(SegmentTree* st, int lo, int hi) {
+    return countUDIRange(st, lo, hi);
+}
+
+bool workloadDeleteUDI(SegmentTree* st, int udi) {
+    return removeByUDI(st, udi);
+}
+
+// O mesmo caminho de calculateStatistics abaixo do limiar paralelo
+long long workloadStats(SegmentTree* st) {
+    RunningStats rs;
+    runningStatsInit(&rs);
+    for (int i = 0; i < st->size; i++) runningStatsAdd(&rs, &st->data[st->capacity + i]);
+    return rs.n;
 }
 
-int main() {
+#include "ESD-COMUM(FROTA).h"
+
+#include "ESD-COMUM(CARGA).h"
+
+#include "ESD-COMUM(PADROES-BENCHMARK).h"
+
+// --- BENCHMARK DA FROTA ---
+// FLEET_BENCH_SAMPLES amostras por configuração, divididas entre 1 até milhares de máquinas,
+// com uma thread e com todos os núcleos; cada rodada mescla numa estrutura vazia.
+void benchmark_fleet_simulation(SegmentTree* st) {
+    FailurePatternList patterns;
+    initFailurePatternList(&patterns);
+    learnFailurePatterns(st, &patterns);
+    memcpy(patterns.tolerance, patternSuggestedTolerance, sizeof(patterns.tolerance));
+    if (patterns.count == 0) {
+        printf("Nenhuma falha nos dados carregados; benchmark da frota ignorado.\n");
+        freeFailurePatternList(&patterns);
+        return;
+    }
+    int cores = availableCores();
+    printf("\n%9s %8s %11s %12s %9s %8s %8s %10s %10s %10s\n", "Maquinas", "Threads", "Tempo(ms)", "Mamostras/s",
+           "Alertas", "Recall", "Mescla", "p50(us)", "p99(us)", "max(us)");
+    static const int fleetSizes[] = {1, 16, 256, 4096};
+    for (int s = 0; s < (int)(sizeof(fleetSizes) / sizeof(fleetSizes[0])); s++) {
+        for (int pass = 0; pass < 2; pass++) {
+            int threads = pass == 0 ? 1 : cores;
+            if (pass == 1 && (cores == 1 || fleetSizes[s] == 1)) continue;
+            SegmentTree store;
+            initSegmentTree(&store, MAX_PRODUCTS);
+            FleetReport r;
+            runFleetSimulation(&store, &patterns, fleetSizes[s], FLEET_BENCH_SAMPLES / fleetSizes[s], threads, 44, &r);
+            printf("%9d %8d %11.2f %12.2f %9d %7.1f%% %7.1f%% %10.1f %10.1f %10.1f\n", r.machines, r.threads, r.ms,
+                   r.samples / (r.ms * 1e3), r.hits.tp + r.hits.fp, detectionRecall(&r.hits),
+                   r.ms > 0 ? 100.0 * r.mergeMs / r.ms : 0.0, r.latencyP50, r.latencyP99, r.latencyMax);
+            BenchRecord* rec = benchRecord(r.samples, r.samples, r.ms, "Frota: %d maquinas x %d threads", r.machines, r.threads);
+            rec->p50 = r.latencyP50 * 1e3;
+            rec->p99 = r.latencyP99 * 1e3;
+            freeSegmentTree(&store);
+        }
+    }
+    printf("(Mescla = fração do tempo dentro da seção crítica; recall dos alertas sobre as falhas geradas)\n");
+    freeFailurePatternList(&patterns);
+}
+
+// Modo batch: "--benchmarks [prefixo] [baseline.csv] [limiar%]" roda run_all_benchmarks, grava
+// <prefixo>.csv e .json e, com um baseline, sai com 1 se houver regressão
+int batchBenchmarks(SegmentTree* st, int argc, char* argv[]) {
+    const char* prefix = argc > 2 ? argv[2] : BENCH_DEFAULT_OUTPUT;
+    run_all_benchmarks(st);
+    if (saveBenchRecords(prefix) < 0) return 2;
+    if (argc < 4) return 0;
+    double threshold = argc > 4 && atof(argv[4]) > 0 ? atof(argv[4]) : BENCH_REGRESSION_THRESHOLD;
+    char csvPath[512];
+    snprintf(csvPath, sizeof(csvPath), "%s.csv", prefix);
+    int regressions = compareBenchFiles(csvPath, argv[3], threshold);
+    return regressions < 0 ? 2 : regressions > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    timerInit(); // Calibra o relógio antes de qualquer medição ou thread
+    if (argc > 1 && strcmp(argv[1], "--perf") == 0) { // Contadores de hardware; os outros argumentos seguem
+        enableHardwareCounters();
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+    }
     SegmentTree st;
     initSegmentTree(&st, MAX_PRODUCTS); // Inicializa a Segment Tree com capacidade padrão
     parseCSV(&st); // Carrega os dados iniciais do CSV
 
+    if (argc > 1 && strcmp(argv[1], "--analytics") == 0) {
+        int status = batchSensorAnalytics(&st, argc, argv);
+        freeSegmentTree(&st);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--fleet") == 0) {
+        int status = batchFleetSimulation(&st, argc, argv);
+        freeSegmentTree(&st);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--record") == 0) {
+        int status = batchRecordStream(&st, argc, argv);
+        freeSegmentTree(&st);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--replay") == 0) {
+        int status = batchReplayStream(&st, argc, argv);
+        freeSegmentTree(&st);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--workload") == 0) {
+        int status = batchWorkload(argc, argv);
+        freeSegmentTree(&st);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--benchmarks") == 0) {
+        int status = batchBenchmarks(&st, argc, argv);
+        freeSegmentTree(&st);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--compare-benchmarks") == 0) {
+        int status = batchCompareBenchmarks(argc, argv);
+        freeSegmentTree(&st);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--check-quantiles") == 0) {
+        int status = checkQuantilesAfterRemoval(&st, argc, argv);
+        freeSegmentTree(&st);
+        return status;
+    }
+
     // ADICIONE ESTAS DUAS LINHAS:
     FailurePatternList failurePatterns; // Declara a lista de padrões de falha
     initFailurePatternList(&failurePatterns); // Inicializa a lista
@@ -1504,32 +2155,32 @@ int main() {
                 displayAll(&st);
                 break;
             case 2: {
-                // Adapte esta busca para Segment Tree, se existir uma função
                 printf("Digite o ProductID para buscar: ");
                 if (fgets(input, sizeof(input), stdin)) {
                     input[strcspn(input, "\n")] = '\0'; // Remove o newline
-                    // searchByProductID(&st, input); // Você precisará de uma função de busca adaptada para SegmentTree
-                    printf("Função de busca por ProductID para Segment Tree não implementada ou adaptada.\n");
+                    searchByProductID(&st, input); // Usa o índice por ProductID
                 }
                 break;
             }
             case 3: {
-                // Adapte esta busca para Segment Tree
                 printf("Digite o Tipo para buscar (L, M, H): ");
                 if (fgets(input, sizeof(input), stdin)) {
-                    // searchByType(&st, toupper(input[0])); // Você precisará de uma função de busca adaptada para SegmentTree
-                    printf("Função de busca por Tipo para Segment Tree não implementada ou adaptada.\n");
+                    char type = toupper(input[0]);
+                    printf("Modos de falha (ex.: HDF,OSF; Enter para qualquer): ");
+                    int modes = fgets(input, sizeof(input), stdin) ? parseFailureModes(input) : 0;
+                    if (modes)
+                        searchByTypeAndFailureModes(&st, type, modes);
+                    else
+                        searchByType(&st, type);
                 }
                 break;
             }
             case 4: {
-                // Adapte esta busca para Segment Tree
                 printf("Digite o MachineFailure (0 ou 1): ");
                 int failure;
                 if (scanf("%d", &failure)) {
                     while (getchar() != '\n'); // Limpa o buffer
-                    // searchByMachineFailure(&st, (bool)failure); // Você precisará de uma função de busca adaptada para SegmentTree
-                    printf("Função de busca por MachineFailure para Segment Tree não implementada ou adaptada.\n");
+                    searchByMachineFailure(&st, (bool)failure);
                 }
                 break;
             }
@@ -1537,43 +2188,38 @@ int main() {
     			insertManualSample(&st);
     			break;
             case 6: {
-                // Adapte esta remoção para Segment Tree. Remover da Segment Tree é complexo e geralmente não é uma operação O(logN)
-                // Você pode precisar de uma marcação lógica de remoção em vez de remoção física
-                printf("Remoção de itens da Segment Tree é uma operação complexa. Considere uma remoção lógica ou reconstrução.\n");
-                printf("Digite o ProductID para 'remover' (simulado): ");
+                // Remoção física: compacta as folhas e reconstrói a árvore (O(n)); o índice evita a
+                // reconstrução quando o ProductID não existe
+                printf("Digite o ProductID para remover: ");
                 if (fgets(input, sizeof(input), stdin)) {
                     input[strcspn(input, "\n")] = '\0';
-                    printf("Tentando remover ProductID: %s (funcionalidade pode ser limitada para Segment Tree).\n", input);
-                    // Implemente a lógica de remoção se ela for suportada eficientemente pela sua Segment Tree
+                    if (removeByProductID(&st, input))
+                        printf("Item(s) removido(s) com sucesso.\n");
+                    else
+                        printf("Nenhum item encontrado com o ProductID: %s\n", input);
                 }
                 break;
             }
             case 7:
-                // Sua Segment Tree já deve ter funções de estatísticas rápidas
-                printf("\n--- Estatísticas (da Segment Tree) ---\n");
-                printf("Média de Desgaste da Ferramenta: %.2f\n", st.sumToolWear[1] / st.size);
-                printf("Média de Torque: %.2f\n", st.sumTorque[1] / st.size);
-                printf("Média de RPM: %.2f\n", (float)st.sumRPM[1] / st.size);
-                printf("Média da Diferença de Temperatura (Processo - Ar): %.2f\n", st.sumTempDiff[1] / st.size);
-                // Adicione mais estatísticas conforme a sua Segment Tree suportar
-                printf("--------------------\n");
+                calculateStatistics(&st);
                 break;
             case 8:
-                // Adapte para percorrer os dados da Segment Tree
-                printf("Função de Classificar Falhas para Segment Tree não implementada ou adaptada diretamente.\n");
-                // ClassifyFailures(&st);
+                classifyFailures(&st);
                 break;
             case 9:
-                // Adapte para usar a Segment Tree para consultas de intervalo, se possível
-                printf("Função de Filtro Avançado para Segment Tree não implementada ou adaptada diretamente.\n");
-                // advancedFilter(&st);
+                advancedFilter(&st);
                 break;
             case 10:
                 run_all_benchmarks(&st);
+                saveBenchRecords(BENCH_DEFAULT_OUTPUT);
                 break;
-            case 11:
-            	run_restricted_benchmarks();
-				break;
+            case 11: {
+                printf("Ordenação R24 (1-selection sort ineficiente, 0-ordenação O(n log n)): ");
+                bool r24Penalty = fgets(input, sizeof(input), stdin) && atoi(input) == 1;
+                run_restricted_benchmarks(r24Penalty);
+                saveBenchRecords(BENCH_RESTRICTED_OUTPUT);
+                break;
+            }
             // ADICIONE ESTES NOVOS CASES:
             case 12: // Nova opção: Aprender Padrões de Falha
                 learnFailurePatterns(&st, &failurePatterns);
@@ -1583,7 +2229,8 @@ int main() {
                 int num_sims;
                 if (scanf("%d", &num_sims) == 1) {
                     while (getchar() != '\n'); // Limpa o buffer
-                    simulateMillingMachine(&st, &failurePatterns, num_sims);
+                    if (failurePatterns.count > 0) readPatternTolerance(&failurePatterns);
+                    simulateMillingMachine(&st, &failurePatterns, num_sims, (unsigned)time(NULL));
                 } else {
                     printf("Entrada inválida. Por favor, digite um número.\n");
                     while (getchar() != '\n'); // Limpa o buffer
@@ -1592,28 +2239,20 @@ int main() {
             }
             // FIM DOS NOVOS CASES
 
-            case 14: // Opção de saída atualizada (o número mudou de 12 para 14)
+            case 14:
+                sensorAnalytics(&st);
+                break;
+
+            case 15: // Opção de saída atualizada
                 printf("Saindo...\n");
                 break;
             default:
                 printf("Opção inválida. Tente novamente.\n");
         }
-    } while (choice != 14); // Condição de saída atualizada
+    } while (choice != 15); // Condição de saída atualizada
 
     // Libera a memória da Segment Tree
-    free(st.data);
-    free(st.maxToolWear);
-    free(st.minToolWear);
-    free(st.sumToolWear);
-    free(st.maxTorque);
-    free(st.minTorque);
-    free(st.sumTorque);
-    free(st.maxRPM);
-    free(st.minRPM);
-    free(st.sumRPM);
-    free(st.maxTempDiff);
-    free(st.minTempDiff);
-    free(st.sumTempDiff);
+    freeSegmentTree(&st);
 
     // ADICIONE ESTA LINHA:
     freeFailurePatternList(&failurePatterns); // Libera a memória da lista de padrões
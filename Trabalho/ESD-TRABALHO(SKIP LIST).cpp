@@ -5,11 +5,52 @@
 #include <ctype.h>
 #include <math.h>
 #include <time.h>
+#include <limits.h>
+#include <stdarg.h>
+#ifdef _WIN32
 #include <windows.h>
-#include <profileapi.h> // Para QueryPerformanceCounter de alta precisão
 #include <psapi.h>     // Para GetProcessMemoryInfo
+#endif
+#include <chrono> // steady_clock: relógio portátil das medições
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h> // SSE2 para o filtro vetorizado
+#define FILTER_SSE2
+#endif
+#ifndef _WIN32
+#include <pthread.h> // Redução paralela das estatísticas
+#include <unistd.h>  // sysconf
+#include <sys/resource.h> // getrusage: pico de memória do processo
+#endif
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h> // mallinfo2: bytes em uso no heap
+#define MEMORY_MALLINFO2
+#endif
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>    // __rdtsc, __cpuid
+#else
+#include <x86intrin.h> // __rdtsc
+#include <cpuid.h>     // __get_cpuid
+#endif
+#define TIMER_RDTSC
+#endif
+#if defined(_MSC_VER) && !defined(TIMER_RDTSC)
+#include <intrin.h> // _BitScanForward64 fora de x86 (ARM64)
+#endif
+#ifdef MEMORY_COUNTING
+#include <atomic>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h> // Contadores de hardware do modo --perf
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#define PERF_COUNTERS
+#endif
+
+#include "ESD-COMUM(INSTRUMENTACAO).h"
 
 #define MAX_LINHA 2048
+#define STRUCTURE_NAME "SkipList" // Nome da estrutura nos registros dos benchmarks
 #define MAX_LEVEL 16 // Nível máximo para a Skip List
 
 // Estruturas de dados
@@ -30,6 +71,9 @@ typedef struct {
     bool RNF;
 } MachineData;
 
+#include "ESD-COMUM(BENCHMARK).h"
+#include "ESD-COMUM(INDICES).h"
+
 typedef struct SkipNode {
     MachineData data;
     struct SkipNode* forward[MAX_LEVEL]; // Ponteiros para os próximos nós em cada nível
@@ -40,15 +84,12 @@ typedef struct {
     SkipNode* header;
     int level;
     int size;
+    ProductIndex* pidIndex; // ProductID -> UDIs (NULL = índice desligado)
+    BitmapIndex* bitmaps;   // Type/falhas -> UDIs (NULL = índice desligado)
+    QuantileSketches quantiles; // Percentis dos registros vivos (KLL, refeitos após remoções)
+    FailureCube cube;       // Contagens/somas por Type x modo de falha
 } SkipList;
 
-// Timer de alta precisão
-typedef struct {
-    LARGE_INTEGER start;
-    LARGE_INTEGER end;
-    LARGE_INTEGER frequency;
-} HighPrecisionTimer;
-
 // Funções para a Skip List
 SkipNode* createNode(int key, MachineData data, int level) {
     SkipNode* sn = (SkipNode*)malloc(sizeof(SkipNode));
@@ -64,6 +105,10 @@ void initSkipList(SkipList* list) {
     list->header = createNode(-1, (MachineData){0}, MAX_LEVEL); // Nó cabeçalho sentinela
     list->level = 0;
     list->size = 0;
+    list->pidIndex = useProductIndex ? createProductIndex(0) : NULL;
+    list->bitmaps = useBitmapIndex ? createBitmapIndex() : NULL;
+    initQuantileSketches(&list->quantiles);
+    failureCubeInit(&list->cube);
     srand(time(NULL)); // Inicializa o gerador de números aleatórios para o nível
 }
 
@@ -90,6 +135,17 @@ void insertSkipList(SkipList* list, int key, MachineData data) {
 
     if (current != NULL && current->key == key) {
         // Se a chave já existe, apenas atualiza os dados (ou trata como erro/ignora)
+        if (list->pidIndex && strcmp(current->data.ProductID, data.ProductID) != 0) {
+            productIndexRemove(list->pidIndex, current->data.ProductID, key);
+            productIndexAdd(list->pidIndex, data.ProductID, key);
+        }
+        if (list->bitmaps) {
+            bitmapIndexRemove(list->bitmaps, &current->data, (unsigned int)key);
+            bitmapIndexAdd(list->bitmaps, &data, (unsigned int)key);
+        }
+        failureCubeRemove(&list->cube, &current->data);
+        failureCubeAdd(&list->cube, &data);
+        quantileSketchesInvalidate(&list->quantiles); // O valor antigo sai na reconstrução
         current->data = data;
         return;
     }
@@ -109,6 +165,10 @@ void insertSkipList(SkipList* list, int key, MachineData data) {
         update[i]->forward[i] = newNode;
     }
     list->size++;
+    if (list->pidIndex) productIndexAdd(list->pidIndex, data.ProductID, key);
+    if (list->bitmaps) bitmapIndexAdd(list->bitmaps, &data, (unsigned int)key);
+    quantileSketchesAdd(&list->quantiles, &data);
+    failureCubeAdd(&list->cube, &data);
 }
 
 SkipNode* searchSkipList(SkipList* list, int key) {
@@ -148,6 +208,10 @@ void deleteSkipList(SkipList* list, int key) {
         }
         update[i]->forward[i] = current->forward[i];
     }
+    if (list->pidIndex) productIndexRemove(list->pidIndex, current->data.ProductID, key);
+    if (list->bitmaps) bitmapIndexRemove(list->bitmaps, &current->data, (unsigned int)key);
+    failureCubeRemove(&list->cube, &current->data);
+    quantileSketchesInvalidate(&list->quantiles);
     free(current);
 
     while (list->level > 0 && list->header->forward[list->level] == NULL) {
@@ -164,9 +228,39 @@ void freeSkipList(SkipList* list) {
         current = next;
     }
     free(list->header);
+    freeProductIndex(list->pidIndex);
+    freeBitmapIndex(list->bitmaps);
+    freeQuantileSketches(&list->quantiles);
     list->header = NULL;
+    list->pidIndex = NULL;
+    list->bitmaps = NULL;
     list->size = 0;
     list->level = 0;
+    failureCubeInit(&list->cube);
+}
+
+// Liga (reconstruindo a partir do nível base) ou desliga o índice de ProductID
+void setProductIndexEnabled(SkipList* list, bool enabled) {
+    freeProductIndex(list->pidIndex);
+    list->pidIndex = NULL;
+    if (enabled) {
+        list->pidIndex = createProductIndex(list->size * 2);
+        for (SkipNode* cur = list->header->forward[0]; cur != NULL; cur = cur->forward[0]) {
+            productIndexAdd(list->pidIndex, cur->data.ProductID, cur->key);
+        }
+    }
+}
+
+// Liga (reconstruindo a partir do nível base) ou desliga os bitmaps de Type/falhas
+void setBitmapIndexEnabled(SkipList* list, bool enabled) {
+    freeBitmapIndex(list->bitmaps);
+    list->bitmaps = NULL;
+    if (enabled) {
+        list->bitmaps = createBitmapIndex();
+        for (SkipNode* cur = list->header->forward[0]; cur != NULL; cur = cur->forward[0]) {
+            bitmapIndexAdd(list->bitmaps, &cur->data, (unsigned int)cur->key);
+        }
+    }
 }
 
 // Funções auxiliares existentes (adaptadas para Skip List)
@@ -469,6 +563,18 @@ void insertManualSample(SkipList* list) {
 }
 
 void searchByProductID(SkipList* list, const char* pid) {
+    if (list->pidIndex) {
+        ProductIndexEntry* e = productIndexFind(list->pidIndex, pid);
+        if (e == NULL) {
+            printf("Nenhum item com ProductID %s\n", pid);
+            return;
+        }
+        for (int i = 0; i < e->count; i++) {
+            SkipNode* node = searchSkipList(list, (int)e->refs[i]);
+            if (node != NULL) displayItem(node->data);
+        }
+        return;
+    }
     SkipNode* current = list->header->forward[0];
     bool achou = false;
     while (current != NULL) {
@@ -482,7 +588,69 @@ void searchByProductID(SkipList* list, const char* pid) {
         printf("Nenhum item com ProductID %s\n", pid);
 }
 
+// Registro de uma linha dos bitmaps (linha = UDI)
+MachineData* recordAtRow(SkipList* list, unsigned int row) {
+    SkipNode* node = searchSkipList(list, (int)row);
+    return node ? &node->data : NULL;
+}
+
+// Linhas de um bitmap na ordem do nível base (UDI crescente)
+unsigned int* orderedRows(SkipList* list, const RoaringBitmap* rows, int* count) {
+    (void)list;
+    unsigned int* out = (unsigned int*)roaringAlloc(sizeof(unsigned int) * (roaringCardinality(rows) + 1));
+    *count = roaringToArray(rows, out);
+    return out;
+}
+
+// Exibe os registros das linhas de um bitmap
+int displayRows(SkipList* list, const RoaringBitmap* rows) {
+    int count;
+    unsigned int* ids = orderedRows(list, rows, &count);
+    for (int i = 0; i < count; i++) {
+        MachineData* d = recordAtRow(list, ids[i]);
+        if (d) displayItem(*d);
+    }
+    free(ids);
+    return count;
+}
+
+// Registros na ordem da estrutura; com candidates, só os das linhas desse bitmap
+const MachineData** collectFilterRecords(SkipList* list, const RoaringBitmap* candidates, int* count) {
+    int capacity = candidates ? roaringCardinality(candidates) : list->size;
+    const MachineData** out = (const MachineData**)malloc(sizeof(MachineData*) * (capacity + 1));
+    if (out == NULL) {
+        perror("Erro ao alocar memória para o filtro");
+        exit(EXIT_FAILURE);
+    }
+    *count = 0;
+    if (candidates == NULL) {
+        for (SkipNode* cur = list->header->forward[0]; cur != NULL; cur = cur->forward[0]) {
+            out[(*count)++] = &cur->data;
+        }
+        return out;
+    }
+    int n;
+    unsigned int* ids = orderedRows(list, candidates, &n);
+    for (int i = 0; i < n; i++) {
+        MachineData* d = recordAtRow(list, ids[i]);
+        if (d) out[(*count)++] = d;
+    }
+    free(ids);
+    return out;
+}
+
+// Com bitmaps, as linhas do Type saem direto do bitmap
 void searchByType(SkipList* list, char type) {
+    type = toupper(type);
+    if (list->bitmaps && bitmapCoversType(type)) {
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapTypeWithModes(list->bitmaps, type, 0, &rows);
+        if (displayRows(list, &rows) == 0)
+            printf("Nenhum item do tipo %c\n", type);
+        roaringFree(&rows);
+        return;
+    }
     SkipNode* current = list->header->forward[0];
     bool achou = false;
     type = toupper(type);
@@ -497,7 +665,17 @@ void searchByType(SkipList* list, char type) {
         printf("Nenhum item do tipo %c\n", type);
 }
 
+// Com bitmaps: FAILURE ou ALL ANDNOT FAILURE
 void searchByMachineFailure(SkipList* list, bool f) {
+    if (list->bitmaps) {
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapFilterCandidates(list->bitmaps, 0, f, &rows);
+        if (displayRows(list, &rows) == 0)
+            printf("Nenhum item com falha %d\n", f);
+        roaringFree(&rows);
+        return;
+    }
     SkipNode* current = list->header->forward[0];
     bool achou = false;
     while (current != NULL) {
@@ -511,13 +689,64 @@ void searchByMachineFailure(SkipList* list, bool f) {
         printf("Nenhum item com falha %d\n", f);
 }
 
+// Busca por Type com pelo menos um dos modos de falha (ex.: H com HDF ou OSF)
+void searchByTypeAndFailureModes(SkipList* list, char type, int modeMask) {
+    int found = 0;
+    if (list->bitmaps && bitmapCoversType(type)) {
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapTypeWithModes(list->bitmaps, type, modeMask, &rows);
+        found = displayRows(list, &rows);
+        roaringFree(&rows);
+    } else {
+        for (SkipNode* cur = list->header->forward[0]; cur != NULL; cur = cur->forward[0]) {
+            if (recordMatchesTypeModes(&cur->data, type, modeMask)) {
+                displayItem(cur->data);
+                found++;
+            }
+        }
+    }
+    if (!found)
+        printf("Nenhum item do tipo %c com os modos de falha escolhidos\n", toupper(type));
+}
+
+// Contagens de classifyFailures por varredura (sem bitmaps)
+void scanClassifyCounts(SkipList* list, int counts[3][6]) {
+    for (SkipNode* cur = list->header->forward[0]; cur != NULL; cur = cur->forward[0]) {
+        classifyRecord(&cur->data, counts);
+    }
+}
+
+int countTypeWithModes(SkipList* list, char type, int modeMask) {
+    int count = 0;
+    for (SkipNode* cur = list->header->forward[0]; cur != NULL; cur = cur->forward[0]) {
+        count += recordMatchesTypeModes(&cur->data, type, modeMask);
+    }
+    return count;
+}
+
+// Existe algum registro com o ProductID? (O(1) com índice, O(n) sem)
+bool containsProductID(SkipList* list, const char* pid) {
+    if (list->pidIndex) return productIndexFind(list->pidIndex, pid) != NULL;
+    for (SkipNode* cur = list->header->forward[0]; cur != NULL; cur = cur->forward[0]) {
+        if (strcmp(cur->data.ProductID, pid) == 0) return true;
+    }
+    return false;
+}
+
 bool removeByProductID(SkipList* list, const char* pid) {
     // Na SkipList, a remoção é por chave (UDI). Para remover por ProductID,
-    // precisaríamos encontrar o UDI correspondente primeiro.
-    // Esta função precisaria de uma busca linear ou um índice secundário.
-    // Para simplificar, vou manter a busca linear para encontrar e remover
-    // o primeiro item com o ProductID correspondente. Para remover todos,
-    // seria necessário iterar e deletar.
+    // os UDIs correspondentes vêm do índice secundário (quando ligado) ou de
+    // uma busca linear no nível base; depois cada um é removido pela chave.
+    if (list->pidIndex) {
+        long long* refs;
+        int count = productIndexCopyRefs(list->pidIndex, pid, &refs);
+        for (int i = 0; i < count; i++) {
+            deleteSkipList(list, (int)refs[i]);
+        }
+        free(refs);
+        return count > 0;
+    }
 
     SkipNode* current = list->header->forward[0];
     bool removed = false;
@@ -548,84 +777,82 @@ bool removeByProductID(SkipList* list, const char* pid) {
     return removed;
 }
 
+// Quantos registros têm UDI em [lo, hi]: desce até o primeiro >= lo e segue pelo nível 0
+int countUDIRange(SkipList* list, int lo, int hi) {
+    SkipNode* current = list->header;
+    for (int i = list->level; i >= 0; i--) {
+        while (current->forward[i] != NULL && current->forward[i]->key < lo) {
+            current = current->forward[i];
+        }
+    }
+    int count = 0;
+    for (current = current->forward[0]; current != NULL && current->key <= hi; current = current->forward[0]) count++;
+    return count;
+}
+
+#include "ESD-COMUM(ESTATISTICAS).h"
+
 void displayStats(const char* title, float avg, float max, float min, float stdDev) {
     printf("\n%s:\nMédia=%.2f | Máximo=%.2f | Mínimo=%.2f | Desvio=%.2f\n",
            title, avg, max, min, stdDev);
 }
 
+// Sketches em dia com os registros vivos: depois de remoções, refeitos numa passada
+QuantileSketches* liveQuantiles(SkipList* list) {
+    if (list->quantiles.stale) {
+        int count;
+        const MachineData** rows = collectFilterRecords(list, NULL, &count);
+        rebuildQuantileSketches(&list->quantiles, rows, count);
+        free(rows);
+    }
+    return &list->quantiles;
+}
+
 void calculateStatistics(SkipList* list) {
     if (list->size == 0) {
         printf("Lista vazia. Nenhum dado para análise.\n");
         return;
     }
 
-    float twSum = 0, twMax = -INFINITY, twMin = INFINITY;
-    float twSqDiffSum = 0;
-
-    float tqSum = 0, tqMax = -INFINITY, tqMin = INFINITY;
-    float tqSqDiffSum = 0;
-
-    int rsSum = 0, rsMax = -INT_MAX, rsMin = INT_MAX;
-    float rsSqDiffSum = 0;
-
-    float tempDiffSum = 0, tempDiffMax = -INFINITY, tempDiffMin = INFINITY;
-    float tempDiffSqDiffSum = 0;
-
-    SkipNode* current = list->header->forward[0];
-    while (current != NULL) {
-        twSum += current->data.ToolWear;
-        if (current->data.ToolWear > twMax)
-            twMax = current->data.ToolWear;
-        if (current->data.ToolWear < twMin)
-            twMin = current->data.ToolWear;
-
-        tqSum += current->data.Torque;
-        if (current->data.Torque > tqMax)
-            tqMax = current->data.Torque;
-        if (current->data.Torque < tqMin)
-            tqMin = current->data.Torque;
-
-        rsSum += current->data.RotationalSpeed;
-        if (current->data.RotationalSpeed > rsMax)
-            rsMax = current->data.RotationalSpeed;
-        if (current->data.RotationalSpeed < rsMin)
-            rsMin = current->data.RotationalSpeed;
-
-        float diff = current->data.ProcessTemp - current->data.AirTemp;
-        tempDiffSum += diff;
-        if (diff > tempDiffMax)
-            tempDiffMax = diff;
-        if (diff < tempDiffMin)
-            tempDiffMin = diff;
-
-        current = current->forward[0];
+    // Uma passada (Welford); com muitos registros, blocos acumulados em paralelo e fundidos
+    RunningStats rs;
+    if (list->size >= STATS_PARALLEL_MIN_ROWS) {
+        int count;
+        const MachineData** rows = collectFilterRecords(list, NULL, &count);
+        runningStatsParallel(rows, count, availableCores(), &rs);
+        free(rows);
+    } else {
+        runningStatsInit(&rs);
+        for (SkipNode* current = list->header->forward[0]; current != NULL; current = current->forward[0])
+            runningStatsAdd(&rs, &current->data);
     }
 
-    float twAvg = twSum / list->size;
-    float tqAvg = tqSum / list->size;
-    float rsAvg = (float)rsSum / list->size;
-    float tempDiffAvg = tempDiffSum / list->size;
-
-    current = list->header->forward[0];
-    while (current != NULL) {
-        twSqDiffSum += pow(current->data.ToolWear - twAvg, 2);
-        tqSqDiffSum += pow(current->data.Torque - tqAvg, 2);
-        rsSqDiffSum += pow(current->data.RotationalSpeed - rsAvg, 2);
-        float diff = current->data.ProcessTemp - current->data.AirTemp;
-        tempDiffSqDiffSum += pow(diff - tempDiffAvg, 2);
-        current = current->forward[0];
+    printf("\n=== ESTATÍSTICAS DE OPERAÇÃO ===\n");
+    for (int m = 0; m < STAT_METRICS; m++) {
+        displayStats(statMetricTitles[m], (float)rs.mean[m], (float)rs.max[m], (float)rs.min[m],
+                     (float)runningStatsStdDev(&rs, m));
     }
 
-    float twStdDev = sqrt(twSqDiffSum / list->size);
-    float tqStdDev = sqrt(tqSqDiffSum / list->size);
-    float rsStdDev = sqrt(rsSqDiffSum / list->size);
-    float tempDiffStdDev = sqrt(tempDiffSqDiffSum / list->size);
+    printf("\nPercentis dos registros (sketches KLL, erro de rank ~1,65%%):\n");
+    displayQuantiles(liveQuantiles(list), statMetricTitles);
+}
 
-    printf("\n=== ESTATÍSTICAS DE OPERAÇÃO ===\n");
-    displayStats("Desgaste da Ferramenta (ToolWear)", twAvg, twMax, twMin, twStdDev);
-    displayStats("Torque (Nm)", tqAvg, tqMax, tqMin, tqStdDev);
-    displayStats("Velocidade Rotacional (RPM)", rsAvg, rsMax, rsMin, rsStdDev);
-    displayStats("Diferença de Temperatura (ProcessTemp - AirTemp)", tempDiffAvg, tempDiffMax, tempDiffMin, tempDiffStdDev);
+// Modo batch: "--check-quantiles [ProductID]" remove o ProductID dado (sem ele, os de todos os
+// registros com ToolWear acima da mediana) e confere os percentis dos sketches com os exatos
+// dos registros restantes. Sai com 1 se algo não confere.
+int checkQuantilesAfterRemoval(SkipList* list, int argc, char* argv[]) {
+    int count, victims;
+    const MachineData** rows = collectFilterRecords(list, NULL, &count);
+    MachineData* removed = selectQuantileCheckVictims(rows, count, argc > 2 ? argv[2] : NULL, &victims);
+    free(rows);
+    if (removed == NULL) return 1;
+    for (int i = 0; i < victims; i++) removeByProductID(list, removed[i].ProductID);
+    free(removed);
+    rows = collectFilterRecords(list, NULL, &count);
+    printf("%d ProductID(s) removido(s), %d registros restantes\n", victims, count);
+    int failures = victims == 0 ? 1 : checkQuantileSketches(liveQuantiles(list), rows, count, statMetricTitles);
+    free(rows);
+    return failures ? 1 : 0;
 }
 
 void classifyFailures(SkipList* list) {
@@ -646,47 +873,18 @@ void classifyFailures(SkipList* list) {
     TypeStats stats[3] = {0}; // 0: L, 1: M, 2: H
     int totalFailures[5] = {0}; // TWF, HDF, PWF, OSF, RNF
 
-    SkipNode* current = list->header->forward[0];
-    while (current != NULL) {
-        int typeIndex = -1;
-        switch (toupper(current->data.Type)) {
-            case 'L':
-                typeIndex = 0;
-                break;
-            case 'M':
-                typeIndex = 1;
-                break;
-            case 'H':
-                typeIndex = 2;
-                break;
-        }
-
-        if (typeIndex != -1) {
-            stats[typeIndex].total++;
-
-            if (current->data.TWF) {
-                stats[typeIndex].twf++;
-                totalFailures[0]++;
-            }
-            if (current->data.HDF) {
-                stats[typeIndex].hdf++;
-                totalFailures[1]++;
-            }
-            if (current->data.PWF) {
-                stats[typeIndex].pwf++;
-                totalFailures[2]++;
-            }
-            if (current->data.OSF) {
-                stats[typeIndex].osf++;
-                totalFailures[3]++;
-            }
-            if (current->data.RNF) {
-                stats[typeIndex].rnf++;
-                totalFailures[4]++;
-            }
-        }
-
-        current = current->forward[0];
+    // Contagens lidas do cubo mantido na inserção/remoção: O(1), sem percorrer a estrutura
+    int counts[3][6];
+    failureCubeCounts(&list->cube, counts);
+
+    for (int t = 0; t < 3; t++) {
+        stats[t].total = counts[t][0];
+        stats[t].twf = counts[t][1];
+        stats[t].hdf = counts[t][2];
+        stats[t].pwf = counts[t][3];
+        stats[t].osf = counts[t][4];
+        stats[t].rnf = counts[t][5];
+        for (int m = 0; m < 5; m++) totalFailures[m] += counts[t][m + 1];
     }
 
     printf("\n=== CLASSIFICAÇÃO DE FALHAS POR TIPO DE MÁQUINA ===\n");
@@ -731,6 +929,8 @@ void classifyFailures(SkipList* list) {
     printf("PWF: %d ocorrências\n", totalFailures[2]);
     printf("OSF: %d ocorrências\n", totalFailures[3]);
     printf("RNF: %d ocorrências\n", totalFailures[4]);
+
+    displayFailureCubeAverages(&list->cube);
 }
 
 void advancedFilter(SkipList* list) {
@@ -771,62 +971,37 @@ void advancedFilter(SkipList* list) {
             criteria[5] = 1;
             hasFailureFilter = true;
             printf("Filtrar por máquinas com falha? (1-Sim, 0-Não): ");
-            scanf("%d", &failureFilter);
+            int failureValue = 0;
+            scanf("%d", &failureValue);
+            failureFilter = failureValue != 0;
         }
     } while (choice != 0);
 
     printf("\nResultados do Filtro:\n");
-    int matches = 0;
-    SkipNode* current = list->header->forward[0];
-
-    while (current != NULL) {
-        bool match = true;
-
-        if (criteria[0] && (current->data.ToolWear < minVal[0] || current->data.ToolWear > maxVal[0])) {
-            match = false;
-        }
-        if (match && criteria[1] && (current->data.Torque < minVal[1] || current->data.Torque > maxVal[1])) {
-            match = false;
-        }
-        if (match && criteria[2] && (current->data.RotationalSpeed < minVal[2] || current->data.RotationalSpeed > maxVal[2])) {
-            match = false;
-        }
-        if (match && criteria[3]) {
-            float tempDiff = current->data.ProcessTemp - current->data.AirTemp;
-            if (tempDiff < minVal[3] || tempDiff > maxVal[3]) {
-                match = false;
-            }
-        }
-        if (match && criteria[4] && toupper(current->data.Type) != typeFilter) {
-            match = false;
-        }
-        if (match && criteria[5] && current->data.MachineFailure != failureFilter) {
-            match = false;
-        }
 
-        if (match) {
-            printf("UDI: %d | ProductID: %s | Type: %c | ",
-                   current->data.UDI, current->data.ProductID, current->data.Type);
-
-            if (criteria[0])
-                printf("ToolWear: %d | ", current->data.ToolWear);
-            if (criteria[1])
-                printf("Torque: %.1f | ", current->data.Torque);
-            if (criteria[2])
-                printf("RPM: %d | ", current->data.RotationalSpeed);
-            if (criteria[3]) {
-                float tempDiff = current->data.ProcessTemp - current->data.AirTemp;
-                printf("TempDiff: %.1f | ", tempDiff);
-            }
-            if (criteria[5])
-                printf("Failure: %d | ", current->data.MachineFailure);
-
-            printf("\n");
-            matches++;
-        }
-
-        current = current->forward[0];
+    FilterPlan plan = buildFilterPlan(criteria, minVal, maxVal, typeFilter, failureFilter);
+    RoaringBitmap candidates;
+    roaringInit(&candidates);
+    bool useBitmaps = list->bitmaps && (plan.byType || plan.byFailure) && (!plan.byType || bitmapCoversType(typeFilter));
+    if (useBitmaps) {
+        // Type e falha saem dos bitmaps; o plano fica só com os intervalos numéricos
+        bitmapFilterCandidates(list->bitmaps, plan.byType ? typeFilter : 0, plan.byFailure ? failureFilter : -1, &candidates);
+        plan.byType = false;
+        plan.byFailure = false;
     }
+    int count;
+    const MachineData** rows = collectFilterRecords(list, useBitmaps ? &candidates : NULL, &count);
+    roaringFree(&candidates);
+    int matches;
+    if (plan.rangeCount + plan.byType + plan.byFailure >= FILTER_PLAN_MIN_PREDICATES) {
+        matches = runFilterPlan(&plan, rows, count, rows);
+    } else {
+        // Poucos predicados: o kernel especializado dispensa a transposição em colunas
+        int active[6] = {criteria[0], criteria[1], criteria[2], criteria[3], plan.byType, plan.byFailure};
+        matches = selectFilterKernel(active)(rows, count, minVal, maxVal, typeFilter, failureFilter, rows);
+    }
+    writeFilterMatches(rows, matches, criteria);
+    free(rows);
 
     printf("\nTotal de máquinas que atendem aos critérios: %d\n", matches);
 }
@@ -846,19 +1021,67 @@ void displayMenu() {
     printf("11. Executar Restrições\n");
     printf("12. Aprender Padrões de Falha\n");        // NOVA OPÇÃO
     printf("13. Simular Fresadora e Detectar Falhas\n"); // NOVA OPÇÃO
-    printf("14. Sair\n");                               // Opção de saída atualizada
+    printf("14. Histogramas e Correlações\n");
+    printf("15. Sair\n");                               // Opção de saída atualizada
     printf("Escolha: ");
 }
 
-// Implementação das funções de benchmark com alta precisão
-void start_timer(HighPrecisionTimer* timer) {
-    QueryPerformanceFrequency(&timer->frequency);
-    QueryPerformanceCounter(&timer->start);
+// Histogramas e correlações por modo de falha numa passada (opção do menu)
+void sensorAnalytics(SkipList* list) {
+    if (list->size == 0) {
+        printf("Lista vazia. Nenhum dado para análise.\n");
+        return;
+    }
+    AnalyticsConfig cfg;
+    readAnalyticsConfig(&cfg);
+    int count;
+    const MachineData** rows = collectFilterRecords(list, NULL, &count);
+    SensorAnalytics* a = (SensorAnalytics*)malloc(sizeof(SensorAnalytics));
+    if (a == NULL) {
+        perror("Erro ao alocar memória para a análise dos sensores");
+        free(rows);
+        return;
+    }
+    int threads = count >= STATS_PARALLEL_MIN_ROWS ? availableCores() : 1;
+    HighPrecisionTimer t;
+    start_timer(&t);
+    runSensorAnalytics(rows, count, &cfg, threads, a);
+    double ms = stop_timer(&t);
+    displaySensorAnalytics(a);
+    printf("\nPassada única sobre %d registros: %.3f ms (%d thread(s), %s)\n", count, ms, threads, ANALYTICS_SIMD_NAME);
+
+    char input[16];
+    printf("Gravar também em CSV (%s_*.csv)? (s/n): ", ANALYTICS_DEFAULT_PREFIX);
+    if (fgets(input, sizeof(input), stdin) && toupper((unsigned char)input[0]) == 'S')
+        writeSensorAnalyticsCSV(a, ANALYTICS_DEFAULT_PREFIX);
+    free(a);
+    free(rows);
 }
 
-double stop_timer(HighPrecisionTimer* timer) {
-    QueryPerformanceCounter(&timer->end);
-    return (double)(timer->end.QuadPart - timer->start.QuadPart) * 1000.0 / timer->frequency.QuadPart;
+// Modo batch: "--analytics [faixas] [prefixo]" grava os CSVs com as faixas padrão, sem menu
+int batchSensorAnalytics(SkipList* list, int argc, char* argv[]) {
+    int bins = argc > 2 && atoi(argv[2]) > 0 ? atoi(argv[2]) : HIST_DEFAULT_BINS;
+    const char* prefix = argc > 3 ? argv[3] : ANALYTICS_DEFAULT_PREFIX;
+    AnalyticsConfig cfg;
+    analyticsDefaultConfig(&cfg, bins);
+    int count;
+    const MachineData** rows = collectFilterRecords(list, NULL, &count);
+    SensorAnalytics* a = (SensorAnalytics*)malloc(sizeof(SensorAnalytics));
+    if (a == NULL) {
+        perror("Erro ao alocar memória para a análise dos sensores");
+        free(rows);
+        return 1;
+    }
+    int threads = count >= STATS_PARALLEL_MIN_ROWS ? availableCores() : 1;
+    HighPrecisionTimer t;
+    start_timer(&t);
+    runSensorAnalytics(rows, count, &cfg, threads, a);
+    double ms = stop_timer(&t);
+    printf("Análise de %d registros: %.3f ms (%d thread(s), %s)\n", count, ms, threads, ANALYTICS_SIMD_NAME);
+    int status = writeSensorAnalyticsCSV(a, prefix);
+    free(a);
+    free(rows);
+    return status;
 }
 
 void generateRandomData(SkipList* list, int count) {
@@ -885,34 +1108,48 @@ void generateRandomData(SkipList* list, int count) {
 
 void benchmark_insertion(SkipList* list, int num_elements) {
     HighPrecisionTimer t;
+    HwCounters hw;
+    hwCountersStart(&hw);
     start_timer(&t);
     SkipList tmp;
     initSkipList(&tmp);
     generateRandomData(&tmp, num_elements);
     double elapsed = stop_timer(&t);
+    hwCountersStop(&hw);
     printf("\nBenchmark Inserção (%d elementos): %.3f ms (%.1f elem/ms)\n",
            num_elements, elapsed, num_elements / elapsed);
+    benchRecord(num_elements, num_elements, elapsed, "Insercao");
+    printHwCounters(&hw, num_elements);
     freeSkipList(&tmp);
 }
 
+typedef struct {
+    SkipList* list;
+    long long hits;    // Encontrados (ou soma dos UDIs): evita que as buscas sejam descartadas
+} SearchBench;
+
+int benchSearchOp(void* ctx, int) {
+    SearchBench* b = (SearchBench*)ctx;
+    int search_udi = b->list->header->forward[0]->data.UDI + (rand() % b->list->size); // Busca UDI's existentes
+    if (searchSkipList(b->list, search_udi) != NULL) b->hits++;
+    return 0;
+}
+
 void benchmark_search(SkipList* list) {
     if (list->size == 0) {
         printf("Lista vazia para busca\n");
         return;
     }
-    HighPrecisionTimer t;
-    const int searches = 10000;
-    int found = 0;
-    start_timer(&t);
-    for (int i = 0; i < searches; i++) {
-        int search_udi = list->header->forward[0]->data.UDI + (rand() % list->size); // Busca UDI's existentes
-        if (searchSkipList(list, search_udi) != NULL) {
-            found++;
-        }
-    }
-    double elapsed = stop_timer(&t);
-    printf("\nBenchmark Busca (%d ops): encontrados=%d | tempo=%.3f ms (%.1f ops/ms)\n",
-           searches, found, elapsed, searches / elapsed);
+    SearchBench b = {list, 0};
+    BenchScenario s = {"Busca por UDI", 10000, &b, NULL, benchSearchOp, NULL, 1, {NULL}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("\nBenchmark Busca (%d ops x %d rodadas, %d de aquecimento): encontrados=%.1f%%\n", s.opsPerRun,
+           r.runs, BENCH_WARMUP_RUNS, 100.0 * b.hits / ((double)s.opsPerRun * (BENCH_WARMUP_RUNS + BENCH_RUNS)));
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchScenarioCounters(&s);
+    benchRecordResult(&s, &r, list->size);
 }
 
 void benchmark_removal(SkipList* list) {
@@ -945,6 +1182,7 @@ void benchmark_removal(SkipList* list) {
     double elapsed = stop_timer(&t);
     printf("\nBenchmark Remoção (%d ops): %.3f ms (%.1f ops/ms)\n",
            removals, elapsed, removals / elapsed);
+    benchRecord(list->size, removals, elapsed, "Remocao");
     freeSkipList(&tmp);
 }
 
@@ -986,6 +1224,14 @@ void estimate_memory_usage(SkipList* list) {
     printf("Número de nós: %d\n", list->size);
     printf("Memória total estimada: %zu bytes (%.2f KB)\n",
            total_memory, (float)total_memory / 1024);
+    if (list->pidIndex) {
+        size_t index_memory = productIndexMemory(list->pidIndex);
+        printf("Índice por ProductID: %zu bytes (%.2f KB)\n", index_memory, (float)index_memory / 1024);
+    }
+    if (list->bitmaps) {
+        size_t bitmap_memory = bitmapIndexMemory(list->bitmaps);
+        printf("Bitmaps de Type/falhas: %zu bytes (%.2f KB)\n", bitmap_memory, (float)bitmap_memory / 1024);
+    }
 
     printf("\nComparação com sizeof:\n");
     printf("sizeof(MachineData): %zu bytes\n", sizeof(MachineData));
@@ -993,31 +1239,52 @@ void estimate_memory_usage(SkipList* list) {
     printf("Obs: Pode haver padding/alignment pelo compilador\n");
 }
 
+// Memória medida: monta do zero uma estrutura com o mesmo número de registros (dados aleatórios)
+// e mede o heap e o residente antes e depois; o resultado inclui cabeçalhos e sobras do malloc
+void measure_memory_usage(SkipList* list) {
+    int n = list->size > 0 ? list->size : 10000;
+    MemorySnapshot before;
+    memoryProbeStart(&before);
+    SkipList tmp;
+    initSkipList(&tmp);
+    generateRandomData(&tmp, n);
+    MemorySnapshot built;
+    memorySnapshot(&built);
+    printf("\n=== USO DE MEMÓRIA MEDIDO (%s) ===\n", memoryHeapSource());
+    printf("Registros montados: %d\n", tmp.size);
+    printMemoryDelta("Montagem", &before);
+    benchRecordBytes(n, memoryDeltaBytes(&before, &built), "Memoria medida (montagem)");
+    if (built.heapBytes >= 0 && tmp.size > 0)
+        printf("Heap por registro: %.1f bytes (sizeof(MachineData): %zu)\n",
+               (double)(built.heapBytes - before.heapBytes) / tmp.size, sizeof(MachineData));
+    freeSkipList(&tmp);
+}
+
+int benchAccessOp(void* ctx, int) {
+    SearchBench* b = (SearchBench*)ctx;
+    int random_udi_offset = rand() % b->list->size;
+    SkipNode* current = b->list->header->forward[0];
+    for (int j = 0; j < random_udi_offset && current != NULL; j++) {
+        current = current->forward[0];
+    }
+    if (current != NULL) b->hits += current->data.UDI;
+    return 0;
+}
+
 void benchmark_random_access(SkipList* list) {
     if (list->size == 0) {
         printf("Lista vazia para teste de acesso aleatório\n");
         return;
     }
-
-    const int accesses = 10000;
-    HighPrecisionTimer t;
-    int sum = 0;
-
-    start_timer(&t);
-    for (int i = 0; i < accesses; i++) {
-        int random_udi_offset = rand() % list->size;
-        SkipNode* current = list->header->forward[0];
-        for(int j = 0; j < random_udi_offset && current != NULL; j++){
-            current = current->forward[0];
-        }
-        if (current != NULL) {
-            sum += current->data.UDI;
-        }
-    }
-    double elapsed = stop_timer(&t);
-
-    printf("Benchmark Acesso Aleatório (%d acessos): %.3f ms (%.1f acessos/ms)\n",
-           accesses, elapsed, accesses / elapsed);
+    SearchBench b = {list, 0};
+    BenchScenario s = {"Acesso aleatorio", 10000, &b, NULL, benchAccessOp, NULL, 1, {NULL}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("Benchmark Acesso Aleatório (%d acessos x %d rodadas):\n", s.opsPerRun, r.runs);
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchScenarioCounters(&s);
+    benchRecordResult(&s, &r, list->size);
 }
 
 void benchmark_scalability() {
@@ -1036,73 +1303,362 @@ void benchmark_scalability() {
 
         printf("Tamanho: %6d elementos | Tempo de inserção: %7.3f ms | Tempo por elemento: %.5f ms\n",
                sizes[i], elapsed, elapsed / sizes[i]);
+        benchRecord(sizes[i], sizes[i], elapsed, "Escalabilidade: insercao");
 
         freeSkipList(&list);
     }
 }
 
+// Mistura de operações sobre uma estrutura nova de 1000 registros a cada rodada
+typedef struct {
+    SkipList s;
+} MixBench;
+
+void benchMixSetup(void* ctx) {
+    MixBench* b = (MixBench*)ctx;
+    initSkipList(&b->s);
+    generateRandomData(&b->s, 1000);
+}
+
+// 30% inserção; dos 70% restantes, 80% busca e 20% remoção (56% e 14% do total)
+int benchMixOp(void* ctx, int) {
+    MixBench* b = (MixBench*)ctx;
+    SkipList* list = &b->s;
+    if (rand() % 100 < 30) {
+        MachineData d = {0};
+        d.UDI = 10000 + list->size + rand() % 1000; // Garantir UDI único
+        snprintf(d.ProductID, sizeof(d.ProductID), "M%07d", rand() % 1000000);
+        insertSkipList(list, d.UDI, d);
+        return 0;
+    } else if (rand() % 100 < 80) {
+        if (list->size > 0) {
+            int search_udi = list->header->forward[0]->data.UDI + (rand() % list->size);
+            searchSkipList(list, search_udi);
+        }
+        return 1;
+    }
+    if (list->size > 0) {
+        // Para remoção aleatória eficiente, precisaríamos de uma forma de obter um UDI aleatório existente
+        // Mais simples para o benchmark é tentar remover um UDI que pode ou não existir
+        int remove_udi = list->header->forward[0]->data.UDI + (rand() % list->size);
+        deleteSkipList(list, remove_udi);
+    }
+    return 2;
+}
+
+void benchMixTeardown(void* ctx) {
+    freeSkipList(&((MixBench*)ctx)->s);
+}
+
 void benchmark_combined_operations() {
-    const int num_operations = 1000;
-    SkipList list;
-    initSkipList(&list);
-    generateRandomData(&list, 1000);
+    MixBench b;
+    BenchScenario s = {"Operacoes combinadas", 1000, &b, benchMixSetup, benchMixOp, benchMixTeardown,
+                       3, {"Insercao", "Busca", "Remocao"}};
+    BenchResult r;
+    runBenchScenario(&s, &r);
+    printf("Benchmark Operações Combinadas (%d ops x %d rodadas, lista nova de 1000 registros por rodada):\n",
+           s.opsPerRun, r.runs);
+    printBenchHeader();
+    printBenchResult(&s, &r);
+    benchRecordResult(&s, &r, 1000);
+}
+
+// Consultas determinísticas (metade existentes, metade ausentes) para comparar índice ligado x desligado
+char (*buildProductIDQueries(SkipList* list, int num_queries))[10] {
+    char (*queries)[10] = (char (*)[10])malloc(sizeof(*queries) * num_queries);
+    char (*existing)[10] = (char (*)[10])malloc(sizeof(*existing) * num_queries);
+    if (queries == NULL || existing == NULL) {
+        perror("Erro de alocação de memória");
+        exit(EXIT_FAILURE);
+    }
+    int n = 0;
+    for (SkipNode* cur = list->header->forward[0]; cur != NULL && n < num_queries; cur = cur->forward[0]) {
+        strcpy(existing[n++], cur->data.ProductID);
+    }
+    srand(31);
+    for (int i = 0; i < num_queries; i++) {
+        if (n > 0 && i % 2 == 0) {
+            strcpy(queries[i], existing[rand() % n]);
+        } else {
+            snprintf(queries[i], sizeof(queries[i]), "X%07d", rand() % 1000000);
+        }
+    }
+    free(existing);
+    return queries;
+}
 
+double benchmark_search_product_id(SkipList* list) {
+    const int searches = 10000;
+    char (*queries)[10] = buildProductIDQueries(list, searches);
     HighPrecisionTimer t;
+    int found = 0;
+
     start_timer(&t);
+    for (int i = 0; i < searches; i++) {
+        if (containsProductID(list, queries[i])) found++;
+    }
+    double elapsed = stop_timer(&t);
+    printf("Busca por ProductID (%d ops): encontrados=%d | tempo=%.3f ms (%.1f ops/ms)\n",
+           searches, found, elapsed, searches / elapsed);
+    benchRecord(list->size, searches, elapsed, "Busca por ProductID (indice %s)", useProductIndex ? "ligado" : "desligado");
+    free(queries);
+    return elapsed;
+}
 
-    for (int i = 0; i < num_operations; i++) {
-        if (rand() % 100 < 30) {
-            MachineData d = {0};
-            d.UDI = 10000 + list.size + rand() % 1000; // Garantir UDI único
-            snprintf(d.ProductID, sizeof(d.ProductID), "M%07d", rand() % 1000000);
-            insertSkipList(&list, d.UDI, d);
-        } else if (rand() % 100 < 80) {
-            if (list.size > 0) {
-                int search_udi = list.header->forward[0]->data.UDI + (rand() % list.size);
-                searchSkipList(&list, search_udi);
-            }
-        } else {
-            if (list.size > 0) {
-                // Para remoção aleatória eficiente, precisaríamos de uma forma de obter um UDI aleatório existente
-                // Mais simples para o benchmark é tentar remover um UDI que pode ou não existir
-                int remove_udi = list.header->forward[0]->data.UDI + (rand() % list.size); 
-                deleteSkipList(&list, remove_udi);
-            }
-        }
+double benchmark_removal_product_id(SkipList* list) {
+    const int removals = 1000;
+    char (*queries)[10] = buildProductIDQueries(list, removals);
+    SkipList tmp;
+    initSkipList(&tmp);
+    for (SkipNode* cur = list->header->forward[0]; cur != NULL; cur = cur->forward[0]) {
+        insertSkipList(&tmp, cur->key, cur->data);
     }
 
+    HighPrecisionTimer t;
+    int removed = 0;
+    start_timer(&t);
+    for (int i = 0; i < removals; i++) {
+        if (removeByProductID(&tmp, queries[i])) removed++;
+    }
     double elapsed = stop_timer(&t);
-    printf("Benchmark Operações Combinadas (%d ops): %.3f ms | Latência média: %.3f ms/op\n",
-           num_operations, elapsed, elapsed / num_operations);
+    printf("Remoção por ProductID (%d ops): removidos=%d | tempo=%.3f ms (%.1f ops/ms)\n",
+           removals, removed, elapsed, removals / elapsed);
+    benchRecord(list->size, removals, elapsed, "Remocao por ProductID (indice %s)", useProductIndex ? "ligado" : "desligado");
+    freeSkipList(&tmp);
+    free(queries);
+    return elapsed;
+}
 
-    freeSkipList(&list);
+// Repete inserção e busca/remoção por ProductID com o índice desligado e ligado
+void benchmark_product_index(SkipList* list) {
+    bool saved = useProductIndex;
+    double search_ms[2], removal_ms[2];
+    for (int on = 0; on <= 1; on++) {
+        useProductIndex = on;
+        setProductIndexEnabled(list, on);
+        printf("\n--- Índice por ProductID %s ---", on ? "LIGADO" : "DESLIGADO");
+        benchmark_insertion(list, 10000);
+        search_ms[on] = benchmark_search_product_id(list);
+        removal_ms[on] = benchmark_removal_product_id(list);
+    }
+    useProductIndex = saved;
+    setProductIndexEnabled(list, saved);
+    printf("\nSpeedup com índice: busca %.1fx | remoção %.1fx\n",
+           search_ms[0] / search_ms[1], removal_ms[0] / removal_ms[1]);
 }
 
+// classifyFailures e a consulta "Type H com HDF ou OSF": varredura x operações nos bitmaps
+void benchmark_bitmap_index(SkipList* list) {
+    if (list->bitmaps == NULL) setBitmapIndexEnabled(list, true);
+    const int reps = 100;
+    const int modes = parseFailureModes("HDF,OSF");
+    int scan_counts[3][6], bitmap_counts[3][6];
+    int scan_matches = 0, bitmap_matches = 0;
+    HighPrecisionTimer t;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        memset(scan_counts, 0, sizeof(scan_counts));
+        scanClassifyCounts(list, scan_counts);
+    }
+    double scan_classify = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) bitmapClassifyCounts(list->bitmaps, bitmap_counts);
+    double bitmap_classify = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) scan_matches = countTypeWithModes(list, 'H', modes);
+    double scan_query = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        RoaringBitmap rows;
+        roaringInit(&rows);
+        bitmapTypeWithModes(list->bitmaps, 'H', modes, &rows);
+        bitmap_matches = roaringCardinality(&rows);
+        roaringFree(&rows);
+    }
+    double bitmap_query = stop_timer(&t) / reps;
+
+    int cube_counts[3][6];
+    const int cube_reps = 100000;
+    volatile int cube_sink = 0;
+    start_timer(&t);
+    for (int r = 0; r < cube_reps; r++) {
+        failureCubeCounts(&list->cube, cube_counts);
+        cube_sink += cube_counts[r % 3][0];
+    }
+    double cube_classify = stop_timer(&t) / cube_reps;
+
+    if (memcmp(scan_counts, bitmap_counts, sizeof(scan_counts)) != 0 || scan_matches != bitmap_matches)
+        printf("AVISO: bitmaps divergem da varredura!\n");
+    if (memcmp(scan_counts, cube_counts, sizeof(scan_counts)) != 0)
+        printf("AVISO: cubo de agregados diverge da varredura!\n");
+    printf("Classificação de falhas: varredura %.4f ms | popcount %.4f ms | speedup %.1fx\n",
+           scan_classify, bitmap_classify, scan_classify / bitmap_classify);
+    printf("Classificação pelo cubo incremental: %.6f ms | speedup %.0fx sobre a varredura\n",
+           cube_classify, scan_classify / cube_classify);
+    printf("Type H com HDF ou OSF (%d registros): varredura %.4f ms | bitmaps %.4f ms | speedup %.1fx\n",
+           bitmap_matches, scan_query, bitmap_query, scan_query / bitmap_query);
+    size_t bitmap_memory = bitmapIndexMemory(list->bitmaps);
+    printf("Memória dos bitmaps: %zu bytes (%.2f KB)\n", bitmap_memory, (float)bitmap_memory / 1024);
+    benchRecord(list->size, reps, scan_classify * reps, "Classificacao: varredura");
+    benchRecord(list->size, reps, bitmap_classify * reps, "Classificacao: popcount");
+    benchRecord(list->size, cube_reps, cube_classify * cube_reps, "Classificacao: cubo incremental");
+    benchRecord(list->size, reps, scan_query * reps, "Type H com HDF ou OSF: varredura");
+    benchRecord(list->size, reps, bitmap_query * reps, "Type H com HDF ou OSF: bitmaps");
+    benchRecordBytes(list->size, (long long)bitmap_memory, "Memoria dos bitmaps");
+}
+
+// Filtro avançado sem a saída: laço escalar com um if por critério x plano vetorizado
+void benchmark_filter_engine(SkipList* list) {
+    const int criteria[6] = {1, 1, 1, 1, 0, 1};
+    const float minVal[4] = {0, 30, 1400, 8};
+    const float maxVal[4] = {110, 45, 1550, 10.5f};
+    const int reps = 100;
+    int count;
+    const MachineData** rows = collectFilterRecords(list, NULL, &count);
+    const MachineData** selected = (const MachineData**)malloc(sizeof(MachineData*) * (count + 1));
+    if (selected == NULL) {
+        perror("Erro ao alocar memória para o benchmark do filtro");
+        free(rows);
+        return;
+    }
+    FilterPlan plan = buildFilterPlan(criteria, minVal, maxVal, 0, false);
+    int scalar_matches = 0, engine_matches = 0;
+    HighPrecisionTimer t;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) {
+        scalar_matches = 0;
+        for (int i = 0; i < count; i++) {
+            scalar_matches += filterMatchesRecord(rows[i], criteria, minVal, maxVal, 0, false);
+        }
+    }
+    double scalar_ms = stop_timer(&t) / reps;
+
+    start_timer(&t);
+    for (int r = 0; r < reps; r++) engine_matches = runFilterPlan(&plan, rows, count, selected);
+    double engine_ms = stop_timer(&t) / reps;
+
+    if (scalar_matches != engine_matches)
+        printf("AVISO: plano vetorizado diverge do laço escalar!\n");
+    printf("5 critérios sobre %d registros (%d aprovados)\n", count, engine_matches);
+    printf("Laço escalar: %.4f ms | Plano vetorizado: %.4f ms | speedup %.1fx\n",
+           scalar_ms, engine_ms, scalar_ms / engine_ms);
+    benchRecord(count, (long long)count * reps, scalar_ms * reps, "Filtro: laco escalar");
+    benchRecord(count, (long long)count * reps, engine_ms * reps, "Filtro: plano vetorizado");
+    free(rows);
+    free(selected);
+}
+
+// Definido junto da simulação da fresadora, depois dos padrões de falha
+void benchmark_pattern_index(SkipList* list);
+void benchmark_failure_regions(SkipList* list);
+void benchmark_failure_model(SkipList* list);
+void benchmark_fleet_simulation(SkipList* list);
+
 void run_all_benchmarks(SkipList* list) {
     printf("\n=== INICIANDO BENCHMARKS COMPLETOS ===\n");
+    benchLogReset("");
+    printf("Relógio: %s (%.0f MHz) | memória: residente medida, heap por %s\n", timerSourceName(),
+           timerFrequency() / 1e6, memoryHeapSource());
+    MemorySnapshot mem;
 
-    printf("\n1. Tempo de Inserção:\n");
+    benchSection("1. Tempo de Inserção");
+    memoryProbeStart(&mem);
     benchmark_insertion(list, 1000);
     benchmark_insertion(list, 10000);
 
-    printf("\n2. Tempo de Remoção:\n");
+    benchMemoryDelta(&mem);
+    benchSection("2. Tempo de Remoção");
+    memoryProbeStart(&mem);
     benchmark_removal(list);
 
-    printf("\n3. Tempo de Busca:\n");
+    benchMemoryDelta(&mem);
+    benchSection("3. Tempo de Busca");
+    memoryProbeStart(&mem);
     benchmark_search(list);
 
-    printf("\n4. Uso de Memória:\n");
+    benchMemoryDelta(&mem);
+    benchSection("4. Uso de Memória");
+    memoryProbeStart(&mem);
     estimate_memory_usage(list);
+    measure_memory_usage(list);
 
-    printf("\n5. Tempo Médio de Acesso:\n");
+    benchMemoryDelta(&mem);
+    benchSection("5. Tempo Médio de Acesso");
+    memoryProbeStart(&mem);
     benchmark_random_access(list);
 
-    printf("\n6. Escalabilidade:\n");
+    benchMemoryDelta(&mem);
+    benchSection("6. Escalabilidade");
+    memoryProbeStart(&mem);
     benchmark_scalability();
 
-    printf("\n7. Latência Média (operações combinadas):\n");
+    benchMemoryDelta(&mem);
+    benchSection("7. Latência por operação (operações combinadas)");
+    memoryProbeStart(&mem);
     benchmark_combined_operations();
 
+    benchMemoryDelta(&mem);
+    benchSection("8. Índice Hash por ProductID (desligado x ligado)");
+    memoryProbeStart(&mem);
+    benchmark_product_index(list);
+
+    benchMemoryDelta(&mem);
+    benchSection("9. Bitmaps de Type/falhas (varredura x popcount)");
+    memoryProbeStart(&mem);
+    benchmark_bitmap_index(list);
+
+    benchMemoryDelta(&mem);
+    benchSection("10. Filtro avançado (escalar x vetorizado)");
+    memoryProbeStart(&mem);
+    benchmark_filter_engine(list);
+
+    benchMemoryDelta(&mem);
+    benchSection("11. Kernels de filtro especializados (10M linhas sintéticas)");
+    memoryProbeStart(&mem);
+    benchmark_filter_kernels();
+
+    benchMemoryDelta(&mem);
+    benchSection("12. Estatísticas em uma passada e redução paralela (50M linhas sintéticas)");
+    memoryProbeStart(&mem);
+    benchmark_parallel_stats();
+
+    benchMemoryDelta(&mem);
+    benchSection("13. Percentis: ordenação x sketches KLL");
+    memoryProbeStart(&mem);
+    benchmark_quantile_sketches();
+
+    benchMemoryDelta(&mem);
+    benchSection("14. Histogramas e correlações: linha a linha x lotes colunares");
+    memoryProbeStart(&mem);
+    benchmark_sensor_analytics();
+
+    benchMemoryDelta(&mem);
+    benchSection("15. Padrões de falha: varredura linear x R-tree (1M amostras simuladas)");
+    memoryProbeStart(&mem);
+    benchmark_pattern_index(list);
+
+    benchMemoryDelta(&mem);
+    benchSection("16. Regiões de falha: um padrão por falha x caixas agrupadas (validação 80/20)");
+    memoryProbeStart(&mem);
+    benchmark_failure_regions(list);
+
+    benchMemoryDelta(&mem);
+    benchSection("17. Árvores de decisão: treino, validação e inferência em blocos");
+    memoryProbeStart(&mem);
+    benchmark_failure_model(list);
+
+    benchMemoryDelta(&mem);
+    benchSection("18. Frota em paralelo: amostras/s e latência dos alertas de 1 a 4096 máquinas");
+    memoryProbeStart(&mem);
+    benchmark_fleet_simulation(list);
+
+    benchMemoryDelta(&mem);
+
     printf("\n=== BENCHMARKS CONCLUÍDOS ===\n");
 }
 
@@ -1120,7 +1676,7 @@ void generateAnomalousData(SkipList* list, int count, int max_size) {
         }
 
         if (i % 100 == 0) {
-            Sleep(1); // R10: Interrupções periódicas
+            sleepMilliseconds(1); // R10: Interrupções periódicas
         }
 
         MachineData d = {0};
@@ -1149,7 +1705,7 @@ void generateAnomalousData(SkipList* list, int count, int max_size) {
         insertSkipList(list, d.UDI, d); // Insere na Skip List
 
         if (i > 0 && i % 100 == 0) {
-            Sleep(50); // R13: Delay artificial por lote
+            sleepMilliseconds(50); // R13: Delay artificial por lote
         }
     }
 }
@@ -1162,6 +1718,7 @@ void generateAnomalousData(SkipList* list, int count, int max_size) {
 
 void run_restricted_benchmarks() {
     printf("\n=== BENCHMARK COM RESTRIÇÕES ATIVADAS ===\n");
+    benchLogReset("Restricoes ativadas");
 
     SkipList list;
     initSkipList(&list);
@@ -1175,6 +1732,7 @@ void run_restricted_benchmarks() {
     double elapsed = stop_timer(&t);
 
     printf("\nTempo total (com 4 restrições aplicadas): %.3f ms\n", elapsed);
+    benchRecord(1000, 1000, elapsed, "Geracao com restricoes");
     printf("Elementos finais na lista (máximo 500): %d\n", list.size);
 
     // R24 - Com Skip List, a ordenação já é mantida, então não há uma "ordenação ineficiente" adicional.
@@ -1185,57 +1743,14 @@ void run_restricted_benchmarks() {
     benchmark_removal(&list);
     benchmark_random_access(&list);
     estimate_memory_usage(&list);
+    measure_memory_usage(&list);
 
     freeSkipList(&list);
 
     printf("\n=== FIM DOS TESTES COM RESTRIÇÕES ===\n");
 }
 
-typedef struct {
-    float minAirTemp, maxAirTemp;
-    float minProcessTemp, maxProcessTemp;
-    int minRotationalSpeed, maxRotationalSpeed;
-    float minTorque, maxTorque;
-    int minToolWear, maxToolWear;
-    bool hadTWF, hadHDF, hadPWF, hadOSF, hadRNF;
-} FailurePattern;
-
-// NOVA ESTRUTURA: Lista dinâmica para armazenar múltiplos padrões de falha
-// Usaremos uma lista dinâmica para armazenar os padrões de falha aprendidos.
-typedef struct {
-    FailurePattern* patterns;
-    int count;
-    int capacity;
-} FailurePatternList;
-// --- FUNÇÕES AUXILIARES PARA A LISTA DE PADRÕES DE FALHA ---
-
-// Inicializa a lista de padrões de falha
-void initFailurePatternList(FailurePatternList* list) {
-    list->patterns = NULL;
-    list->count = 0;
-    list->capacity = 0;
-}
-
-// Adiciona um padrão de falha à lista dinâmica
-void addFailurePattern(FailurePatternList* list, FailurePattern pattern) {
-    if (list->count == list->capacity) {
-        list->capacity = (list->capacity == 0) ? 1 : list->capacity * 2;
-        list->patterns = (FailurePattern*)realloc(list->patterns, list->capacity * sizeof(FailurePattern));
-        if (list->patterns == NULL) {
-            perror("Falha ao realocar memória para os padrões de falha");
-            exit(EXIT_FAILURE);
-        }
-    }
-    list->patterns[list->count++] = pattern;
-}
-
-// Libera a memória alocada para a lista de padrões de falha
-void freeFailurePatternList(FailurePatternList* list) {
-    free(list->patterns);
-    list->patterns = NULL;
-    list->count = 0;
-    list->capacity = 0;
-}
+#include "ESD-COMUM(PADROES).h"
 
 // --- FUNÇÕES DE APRENDIZAGEM E DETECÇÃO DE PADRÕES DE FALHA ---
 
@@ -1250,67 +1765,41 @@ void learnFailurePatterns(SkipList* list, FailurePatternList* patterns) {
     }
 
     printf("\n=== APRENDENDO PADRÕES DE FALHA ===\n");
-    // Reinicia os padrões antes de aprender novos
-    freeFailurePatternList(patterns);
-    initFailurePatternList(patterns);
+    int count;
+    const MachineData** rows = collectFilterRecords(list, NULL, &count);
+    HighPrecisionTimer t;
+    start_timer(&t);
+    int failures = learnFailureRegions(rows, count, patterns);
+    double ms = stop_timer(&t);
+    printf("Aprendidos %d padrões de falha (regiões) a partir de %d falhas dos dados existentes (%.2f ms).\n",
+           patterns->count, failures, ms);
+    displayPatternPrefilter(&patterns->prefilter);
 
-    int learned_count = 0;
-    SkipNode* current = list->header->forward[0]; // Começa do primeiro nó real
-    while (current != NULL) {
-        if (current->data.MachineFailure) { // Se houver falha na máquina
-            FailurePattern fp;
-            // Para este exemplo, armazena os valores exatos da instância de falha como um padrão.
-            fp.minAirTemp = fp.maxAirTemp = current->data.AirTemp;
-            fp.minProcessTemp = fp.maxProcessTemp = current->data.ProcessTemp;
-            fp.minRotationalSpeed = fp.maxRotationalSpeed = current->data.RotationalSpeed;
-            fp.minTorque = fp.maxTorque = current->data.Torque;
-            fp.minToolWear = fp.maxToolWear = current->data.ToolWear;
-            
-            fp.hadTWF = current->data.TWF;
-            fp.hadHDF = current->data.HDF;
-            fp.hadPWF = current->data.PWF;
-            fp.hadOSF = current->data.OSF;
-            fp.hadRNF = current->data.RNF;
-
-            addFailurePattern(patterns, fp);
-            learned_count++;
-        }
-        current = current->forward[0]; // Avança no nível base
-    }
-    printf("Aprendidos %d padrões de falha a partir dos dados existentes.\n", learned_count);
-}
-
-// VERIFICA SE OS DADOS ATUAIS CORRESPONDEM A UM PADRÃO DE FALHA APRENDIDO
-// Compara os dados da máquina com os padrões armazenados.
-// A correspondência atual é exata. Em um cenário real, você pode usar uma tolerância.
-bool checkForFailurePattern(MachineData data, FailurePatternList* patterns) {
-    for (int i = 0; i < patterns->count; i++) {
-        FailurePattern fp = patterns->patterns[i];
-
-        // Esta é uma correspondência exata. Considere adicionar uma tolerância (e.g., fabs(data.AirTemp - fp.minAirTemp) < epsilon)
-        bool match = true;
-        if (fabs(data.AirTemp - fp.minAirTemp) > 0.001 || // Usar fabs para float comparisons
-            fabs(data.ProcessTemp - fp.minProcessTemp) > 0.001 ||
-            data.RotationalSpeed != fp.minRotationalSpeed ||
-            fabs(data.Torque - fp.minTorque) > 0.001 ||
-            data.ToolWear != fp.minToolWear) {
-            match = false;
-        }
+    start_timer(&t);
+    trainFailureModel(rows, count, &patterns->model);
+    ms = stop_timer(&t);
+    printf("Árvores de decisão treinadas (profundidade %d, %d alvos) em %.2f ms. Ajuste nos dados carregados:\n",
+           TREE_DEPTH, TREE_TARGETS, ms);
+    DetectionCounts counts[TREE_TARGETS];
+    evaluateFailureModel(&patterns->model, rows, count, counts);
+    displayFailureModelEvaluation(counts);
+    free(rows);
+}
 
-        // Também verifica os flags de falha específicos se eles fazem parte da definição do seu padrão
-        if (match && (data.TWF != fp.hadTWF ||
-                      data.HDF != fp.hadHDF ||
-                      data.PWF != fp.hadPWF ||
-                      data.OSF != fp.hadOSF ||
-                      data.RNF != fp.hadRNF)) {
-            match = false;
-        }
+// Próximo UDI livre para amostras simuladas: maior UDI atual + 1
+int nextSimulatedUDI(SkipList* list) {
+    int next_udi = 0;
 
-        if (match) {
-            return true; // Padrão detectado!
+    // Encontra o UDI máximo atual para continuar a partir dele
+    SkipNode* current_max_udi_node = list->header->forward[0];
+    while (current_max_udi_node != NULL) {
+        if (current_max_udi_node->data.UDI > next_udi) {
+            next_udi = current_max_udi_node->data.UDI;
         }
+        current_max_udi_node = current_max_udi_node->forward[0];
     }
-    return false; // Nenhum padrão correspondente encontrado
+    next_udi++; // Começa o UDI para novas simulações a partir do próximo número
+    return next_udi;
 }
 
 // --- FUNÇÃO DE SIMULAÇÃO DA FRESADORA ---
@@ -1319,76 +1808,40 @@ bool checkForFailurePattern(MachineData data, FailurePatternList* patterns) {
 // Gera dados de MachineData simulados.
 // Periodicamente, injeta um padrão de falha aprendido para demonstrar a detecção.
 // Opção 13 do menu.
-void simulateMillingMachine(SkipList* list, FailurePatternList* patterns, int num_simulations) {
+void simulateMillingMachine(SkipList* list, FailurePatternList* patterns, int num_simulations, unsigned int seed) {
     if (patterns->count == 0) {
         printf("Nenhum padrão de falha aprendido. Por favor, aprenda os padrões primeiro (Opção 12).\n");
         return;
     }
 
     printf("\n=== SIMULANDO FRESADORA E DETECTANDO FALHAS ===\n");
-    srand((unsigned)time(NULL)); // Inicializa o gerador de números aleatórios
+    displayPatternTolerance(patterns);
+    printf("Semente: %u\n", seed);
+    srand(seed); // Mesma semente, mesmo fluxo (ver recordSimulationStream)
     int failure_alerts = 0;
-    int next_udi = 0;
-
-    // Encontra o UDI máximo atual para continuar a partir dele
-    SkipNode* current_max_udi_node = list->header->forward[0];
-    while (current_max_udi_node != NULL) {
-        if (current_max_udi_node->data.UDI > next_udi) {
-            next_udi = current_max_udi_node->data.UDI;
-        }
-        current_max_udi_node = current_max_udi_node->forward[0];
-    }
-    next_udi++; // Começa o UDI para novas simulações a partir do próximo número
+    int next_udi = nextSimulatedUDI(list);
 
+    MachineData block[64];
+    unsigned long long blockAlerts = 0;
+    DetectionCounts patternHits = {0, 0, 0, 0}, modelHits = {0, 0, 0, 0};
     for (int i = 0; i < num_simulations; i++) {
-        MachineData simulatedData;
-        simulatedData.UDI = next_udi++;
-
-        // Gera ProductID e Tipo (pode ser aleatório ou seguir uma sequência)
-        snprintf(simulatedData.ProductID, sizeof(simulatedData.ProductID), "SIM%06d", rand() % 1000000);
-        simulatedData.Type = "LMH"[rand() % 3];
-
-        // Introduz variações em torno de valores típicos (menos de falha)
-        // Defina faixas razoáveis para a sua simulação de "operação normal"
-        simulatedData.AirTemp = 298.0f + (float)(rand() % 200) / 100.0f - 1.0f; // Ex: 297.0 a 299.0 K
-        simulatedData.ProcessTemp = simulatedData.AirTemp + 10.0f + (float)(rand() % 100) / 100.0f; // Ex: Processo geralmente mais alto
-        simulatedData.RotationalSpeed = 1400 + rand() % 200 - 100; // Ex: 1300 a 1500 rpm
-        simulatedData.Torque = 30.0f + (float)(rand() % 200) / 100.0f - 1.0f; // Ex: 29.0 a 31.0 Nm
-        simulatedData.ToolWear = 30 + rand() % 30 - 15; // Ex: 15 a 45 min
-
-        // Assume que não há falha inicialmente para dados simulados, a menos que um padrão seja injetado
-        simulatedData.MachineFailure = false;
-        simulatedData.TWF = false;
-        simulatedData.HDF = false;
-        simulatedData.PWF = false;
-        simulatedData.OSF = false;
-        simulatedData.RNF = false;
-
-        // Introduz um padrão de falha periodicamente ou aleatoriamente
-        // Aqui, há uma chance de 5% de injetar um padrão de falha aprendido
-        if (patterns->count > 0 && rand() % 20 == 0) { 
-            // Seleciona um padrão aprendido aleatório para injetar
-            int pattern_idx = rand() % patterns->count;
-            FailurePattern injected_pattern = patterns->patterns[pattern_idx];
-
-            // Sobrescreve os dados simulados com os valores do padrão de falha
-            simulatedData.AirTemp = injected_pattern.minAirTemp;
-            simulatedData.ProcessTemp = injected_pattern.minProcessTemp;
-            simulatedData.RotationalSpeed = injected_pattern.minRotationalSpeed;
-            simulatedData.Torque = injected_pattern.minTorque;
-            simulatedData.ToolWear = injected_pattern.minToolWear;
-            
-            // Define os flags de falha de acordo com o padrão
-            simulatedData.MachineFailure = true; // Isso é crucial para a detecção
-            simulatedData.TWF = injected_pattern.hadTWF;
-            simulatedData.HDF = injected_pattern.hadHDF;
-            simulatedData.PWF = injected_pattern.hadPWF;
-            simulatedData.OSF = injected_pattern.hadOSF;
-            simulatedData.RNF = injected_pattern.hadRNF;
+        // As amostras são geradas e comparadas com os padrões em blocos de 64 (um bit por amostra)
+        int slot = i % 64;
+        if (slot == 0) {
+            int len = num_simulations - i < 64 ? num_simulations - i : 64;
+            for (int j = 0; j < len; j++) generateSimulatedSample(&block[j], patterns, next_udi++);
+            checkForFailurePatternBatch(block, len, patterns, &blockAlerts);
         }
+        MachineData simulatedData = block[slot];
 
         // Verifica se os dados simulados correspondem a algum padrão de falha aprendido
-        if (checkForFailurePattern(simulatedData, patterns)) {
+        bool alert = (blockAlerts >> slot) & 1;
+        countDetection(&patternHits, alert, simulatedData.MachineFailure);
+        // No fluxo do simulador os caminhos se repetem e o if/else é previsto; ver benchmark_failure_model
+        if (patterns->model.trained)
+            countDetection(&modelHits, predictFailureModesScalar(&patterns->model, &simulatedData) & 1,
+                           simulatedData.MachineFailure);
+        if (alert) {
             printf("\n!!! ALERTA DE PADRÃO DE FALHA DETECTADO !!!\n");
             displayItem(simulatedData);
             failure_alerts++;
@@ -1402,13 +1855,175 @@ void simulateMillingMachine(SkipList* list, FailurePatternList* patterns, int nu
         insertSkipList(list, simulatedData.UDI, simulatedData);
     }
     printf("\nSimulação concluída. Total de alertas de falha: %d\n", failure_alerts);
+    printf("Padrões: precisão %.1f%% | recall %.1f%% (falhas injetadas: %d)\n", detectionPrecision(&patternHits),
+           detectionRecall(&patternHits), patternHits.tp + patternHits.fn);
+    if (patterns->model.trained)
+        printf("Árvore de decisão: %d falhas previstas | precisão %.1f%% | recall %.1f%%\n", modelHits.tp + modelHits.fp,
+               detectionPrecision(&modelHits), detectionRecall(&modelHits));
+}
+
+// --- ADAPTAÇÃO DA SKIP LIST AO CÓDIGO COMUM ---
+// As operações sobre esta estrutura de que o código comum precisa: frota, reprodução do fluxo,
+// carga de trabalho e benchmarks de padrões (ESD-COMUM(*).h).
+typedef SkipList WorkloadBackend;
+
+void workloadInit(SkipList* list, int) { // Capacidade ignorada: a lista cresce sob demanda
+    initSkipList(list);
+}
+
+void workloadFree(SkipList* list) {
+    freeSkipList(list);
+}
+
+void workloadInsert(SkipList* list, const MachineData* d) {
+    insertSkipList(list, d->UDI, *d);
+}
+
+bool workloadFindUDI(SkipList* list, int udi) {
+    return searchSkipList(list, udi) != NULL;
+}
+
+bool workloadFindProductID(SkipList* list, const char* pid) {
+    return containsProductID(list, pid);
+}
+
+int workloadRangeCount(SkipList* list, int lo, int hi) {
+    return countUDIRange(list, lo, hi);
+}
+
+bool workloadDeleteUDI(SkipList* list, int udi) {
+    if (searchSkipList(list, udi) == NULL) return false;
+    deleteSkipList(list, udi);
+    return true;
+}
+
+// O mesmo caminho de calculateStatistics abaixo do limiar paralelo
+long long workloadStats(SkipList* list) {
+    RunningStats rs;
+    runningStatsInit(&rs);
+    for (SkipNode* current = list->header->forward[0]; current != NULL; current = current->forward[0])
+        runningStatsAdd(&rs, &current->data);
+    return rs.n;
+}
+
+#include "ESD-COMUM(FROTA).h"
+
+#include "ESD-COMUM(CARGA).h"
+
+#include "ESD-COMUM(PADROES-BENCHMARK).h"
+
+// --- BENCHMARK DA FROTA ---
+// FLEET_BENCH_SAMPLES amostras por configuração, divididas entre 1 até milhares de máquinas,
+// com uma thread e com todos os núcleos; cada rodada mescla numa estrutura vazia.
+void benchmark_fleet_simulation(SkipList* list) {
+    FailurePatternList patterns;
+    initFailurePatternList(&patterns);
+    learnFailurePatterns(list, &patterns);
+    memcpy(patterns.tolerance, patternSuggestedTolerance, sizeof(patterns.tolerance));
+    if (patterns.count == 0) {
+        printf("Nenhuma falha nos dados carregados; benchmark da frota ignorado.\n");
+        freeFailurePatternList(&patterns);
+        return;
+    }
+    int cores = availableCores();
+    printf("\n%9s %8s %11s %12s %9s %8s %8s %10s %10s %10s\n", "Maquinas", "Threads", "Tempo(ms)", "Mamostras/s",
+           "Alertas", "Recall", "Mescla", "p50(us)", "p99(us)", "max(us)");
+    static const int fleetSizes[] = {1, 16, 256, 4096};
+    for (int s = 0; s < (int)(sizeof(fleetSizes) / sizeof(fleetSizes[0])); s++) {
+        for (int pass = 0; pass < 2; pass++) {
+            int threads = pass == 0 ? 1 : cores;
+            if (pass == 1 && (cores == 1 || fleetSizes[s] == 1)) continue;
+            SkipList store;
+            initSkipList(&store);
+            FleetReport r;
+            runFleetSimulation(&store, &patterns, fleetSizes[s], FLEET_BENCH_SAMPLES / fleetSizes[s], threads, 44, &r);
+            printf("%9d %8d %11.2f %12.2f %9d %7.1f%% %7.1f%% %10.1f %10.1f %10.1f\n", r.machines, r.threads, r.ms,
+                   r.samples / (r.ms * 1e3), r.hits.tp + r.hits.fp, detectionRecall(&r.hits),
+                   r.ms > 0 ? 100.0 * r.mergeMs / r.ms : 0.0, r.latencyP50, r.latencyP99, r.latencyMax);
+            BenchRecord* rec = benchRecord(r.samples, r.samples, r.ms, "Frota: %d maquinas x %d threads", r.machines, r.threads);
+            rec->p50 = r.latencyP50 * 1e3;
+            rec->p99 = r.latencyP99 * 1e3;
+            freeSkipList(&store);
+        }
+    }
+    printf("(Mescla = fração do tempo dentro da seção crítica; recall dos alertas sobre as falhas geradas)\n");
+    freeFailurePatternList(&patterns);
+}
+
+// Modo batch: "--benchmarks [prefixo] [baseline.csv] [limiar%]" roda run_all_benchmarks, grava
+// <prefixo>.csv e .json e, com um baseline, sai com 1 se houver regressão
+int batchBenchmarks(SkipList* list, int argc, char* argv[]) {
+    const char* prefix = argc > 2 ? argv[2] : BENCH_DEFAULT_OUTPUT;
+    run_all_benchmarks(list);
+    if (saveBenchRecords(prefix) < 0) return 2;
+    if (argc < 4) return 0;
+    double threshold = argc > 4 && atof(argv[4]) > 0 ? atof(argv[4]) : BENCH_REGRESSION_THRESHOLD;
+    char csvPath[512];
+    snprintf(csvPath, sizeof(csvPath), "%s.csv", prefix);
+    int regressions = compareBenchFiles(csvPath, argv[3], threshold);
+    return regressions < 0 ? 2 : regressions > 0 ? 1 : 0;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    timerInit(); // Calibra o relógio antes de qualquer medição ou thread
+    if (argc > 1 && strcmp(argv[1], "--perf") == 0) { // Contadores de hardware; os outros argumentos seguem
+        enableHardwareCounters();
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+    }
     SkipList list;
     initSkipList(&list);
     parseCSV(&list); // Carrega os dados iniciais do CSV
 
+    if (argc > 1 && strcmp(argv[1], "--analytics") == 0) {
+        int status = batchSensorAnalytics(&list, argc, argv);
+        freeSkipList(&list);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--fleet") == 0) {
+        int status = batchFleetSimulation(&list, argc, argv);
+        freeSkipList(&list);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--record") == 0) {
+        int status = batchRecordStream(&list, argc, argv);
+        freeSkipList(&list);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--replay") == 0) {
+        int status = batchReplayStream(&list, argc, argv);
+        freeSkipList(&list);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--workload") == 0) {
+        int status = batchWorkload(argc, argv);
+        freeSkipList(&list);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--benchmarks") == 0) {
+        int status = batchBenchmarks(&list, argc, argv);
+        freeSkipList(&list);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--compare-benchmarks") == 0) {
+        int status = batchCompareBenchmarks(argc, argv);
+        freeSkipList(&list);
+        return status;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--check-quantiles") == 0) {
+        int status = checkQuantilesAfterRemoval(&list, argc, argv);
+        freeSkipList(&list);
+        return status;
+    }
+
     // ADICIONE ESTAS DUAS LINHAS:
     FailurePatternList failurePatterns; // Declara a lista de padrões de falha
     initFailurePatternList(&failurePatterns); // Inicializa a lista
@@ -1431,10 +2046,7 @@ int main() {
                 printf("Digite o ProductID para buscar: ");
                 if (fgets(input, sizeof(input), stdin)) {
                     input[strcspn(input, "\n")] = '\0'; // Remove o newline
-                    // Adapte esta busca para Skip List se você tiver uma função eficiente para isso.
-                    // A busca por ProductID pode ser O(N) na SkipList se não for a chave.
-                    printf("Busca por ProductID em SkipList não é eficiente pela chave. Apenas o UDI é a chave de busca direta.\n");
-                    // Implemente a lógica de busca se necessário, percorrendo o nível base da SkipList.
+                    searchByProductID(&list, input); // Usa o índice secundário por ProductID
                 }
                 break;
             }
@@ -1442,20 +2054,12 @@ int main() {
                 printf("Digite o Tipo para buscar (L, M, H): ");
                 if (fgets(input, sizeof(input), stdin)) {
                     char type_char = toupper(input[0]);
-                    // Adapte esta busca para Skip List.
-                    printf("Busca por Tipo em SkipList não é eficiente pela chave. Percorrendo o nível base para buscar...\n");
-                    SkipNode* current = list.header->forward[0];
-                    bool found = false;
-                    while (current != NULL) {
-                        if (current->data.Type == type_char) {
-                            displayItem(current->data);
-                            found = true;
-                        }
-                        current = current->forward[0];
-                    }
-                    if (!found) {
-                        printf("Nenhum item encontrado com o Tipo: %c\n", type_char);
-                    }
+                    printf("Modos de falha (ex.: HDF,OSF; Enter para qualquer): ");
+                    int modes = fgets(input, sizeof(input), stdin) ? parseFailureModes(input) : 0;
+                    if (modes)
+                        searchByTypeAndFailureModes(&list, type_char, modes);
+                    else
+                        searchByType(&list, type_char);
                 }
                 break;
             }
@@ -1464,21 +2068,7 @@ int main() {
                 int failure;
                 if (scanf("%d", &failure)) {
                     while (getchar() != '\n'); // Limpa o buffer
-                    bool failure_bool = (failure == 1);
-                    // Adapte esta busca para Skip List.
-                    printf("Busca por MachineFailure em SkipList não é eficiente pela chave. Percorrendo o nível base para buscar...\n");
-                    SkipNode* current = list.header->forward[0];
-                    bool found = false;
-                    while (current != NULL) {
-                        if (current->data.MachineFailure == failure_bool) {
-                            displayItem(current->data);
-                            found = true;
-                        }
-                        current = current->forward[0];
-                    }
-                    if (!found) {
-                        printf("Nenhum item encontrado com Falha de Máquina: %s\n", failure_bool ? "Sim" : "Não");
-                    }
+                    searchByMachineFailure(&list, failure == 1);
                 }
                 break;
             }
@@ -1489,78 +2079,18 @@ int main() {
                 printf("Digite o ProductID para remover: ");
                 if (fgets(input, sizeof(input), stdin)) {
                     input[strcspn(input, "\n")] = '\0';
-                    // A remoção por ProductID na SkipList exige busca linear se ProductID não for a chave.
-                    printf("A remoção por ProductID em SkipList não é eficiente. Recomenda-se remover por UDI (chave).\n");
-                    // Você precisará implementar a lógica de remoção por ProductID percorrendo a lista base
-                    // e chamando deleteSkipList com o UDI correspondente.
-                    // Por simplicidade, vou apenas exibir uma mensagem.
-                    printf("Funcionalidade de remoção por ProductID não totalmente adaptada para SkipList com ProductID como chave secundária.\n");
+                    if (removeByProductID(&list, input)) // Usa o índice secundário por ProductID
+                        printf("Item(s) removido(s) com sucesso.\n");
+                    else
+                        printf("Nenhum item encontrado com o ProductID: %s\n", input);
                 }
                 break;
             }
             case 7:
-                // Adapte para calcular estatísticas percorrendo a Skip List
-                printf("Cálculo de Estatísticas para SkipList:\n");
-                if (list.size == 0) {
-                    printf("Lista vazia. Nenhuma estatística para calcular.\n");
-                } else {
-                    SkipNode* current = list.header->forward[0];
-                    float totalAirTemp = 0, totalProcessTemp = 0, totalTorque = 0;
-                    int totalRotationalSpeed = 0, totalToolWear = 0;
-                    int failureCount = 0;
-
-                    while (current != NULL) {
-                        totalAirTemp += current->data.AirTemp;
-                        totalProcessTemp += current->data.ProcessTemp;
-                        totalRotationalSpeed += current->data.RotationalSpeed;
-                        totalTorque += current->data.Torque;
-                        totalToolWear += current->data.ToolWear;
-                        if (current->data.MachineFailure) {
-                            failureCount++;
-                        }
-                        current = current->forward[0];
-                    }
-                    printf("Número total de amostras: %d\n", list.size);
-                    printf("Média da Temperatura do Ar: %.2f\n", totalAirTemp / list.size);
-                    printf("Média da Temperatura do Processo: %.2f\n", totalProcessTemp / list.size);
-                    printf("Média da Velocidade Rotacional: %d\n", totalRotationalSpeed / list.size);
-                    printf("Média do Torque: %.2f\n", totalTorque / list.size);
-                    printf("Média do Desgaste da Ferramenta: %d\n", totalToolWear / list.size);
-                    printf("Número de falhas de máquina: %d (%.2f%%)\n", failureCount, (float)failureCount / list.size * 100);
-                }
+                calculateStatistics(&list);
                 break;
             case 8:
-                // Adapte para classificar falhas percorrendo a Skip List
-                printf("Classificação de Falhas para SkipList:\n");
-                if (list.size == 0) {
-                    printf("Lista vazia. Nenhuma falha para classificar.\n");
-                } else {
-                    SkipNode* current = list.header->forward[0];
-                    int twf_count = 0, hdf_count = 0, pwf_count = 0, osf_count = 0, rnf_count = 0;
-                    int total_failures = 0;
-
-                    while (current != NULL) {
-                        if (current->data.MachineFailure) {
-                            total_failures++;
-                            if (current->data.TWF) twf_count++;
-                            if (current->data.HDF) hdf_count++;
-                            if (current->data.PWF) pwf_count++;
-                            if (current->data.OSF) osf_count++;
-                            if (current->data.RNF) rnf_count++;
-                        }
-                        current = current->forward[0];
-                    }
-                    printf("Total de Falhas de Máquina: %d\n", total_failures);
-                    if (total_failures > 0) {
-                        printf("Falha por Desgaste da Ferramenta (TWF): %d (%.2f%%)\n", twf_count, (float)twf_count / total_failures * 100);
-                        printf("Falha por Degradação de Calor (HDF): %d (%.2f%%)\n", hdf_count, (float)hdf_count / total_failures * 100);
-                        printf("Falha por Sobrecarga de Energia (PWF): %d (%.2f%%)\n", pwf_count, (float)pwf_count / total_failures * 100);
-                        printf("Falha por Desvio do Eixo (OSF): %d (%.2f%%)\n", osf_count, (float)osf_count / total_failures * 100);
-                        printf("Falha Não Registrada (RNF): %d (%.2f%%)\n", rnf_count, (float)rnf_count / total_failures * 100);
-                    } else {
-                        printf("Nenhuma falha de máquina registrada nos dados.\n");
-                    }
-                }
+                classifyFailures(&list); // Lê o cubo de agregados, sem percorrer a Skip List
                 break;
             case 9:
                 // Adapte para usar a Skip List para consultas de intervalo, se possível
@@ -1569,9 +2099,11 @@ int main() {
                 break;
             case 10:
                 run_all_benchmarks(&list);
+                saveBenchRecords(BENCH_DEFAULT_OUTPUT);
                 break;
             case 11:
             	run_restricted_benchmarks();
+            	saveBenchRecords(BENCH_RESTRICTED_OUTPUT);
 				break;
             // ADICIONE ESTES NOVOS CASES:
             case 12: // Nova opção: Aprender Padrões de Falha
@@ -1582,7 +2114,8 @@ int main() {
                 int num_sims;
                 if (scanf("%d", &num_sims) == 1) {
                     while (getchar() != '\n'); // Limpa o buffer
-                    simulateMillingMachine(&list, &failurePatterns, num_sims);
+                    if (failurePatterns.count > 0) readPatternTolerance(&failurePatterns);
+                    simulateMillingMachine(&list, &failurePatterns, num_sims, (unsigned)time(NULL));
                 } else {
                     printf("Entrada inválida. Por favor, digite um número.\n");
                     while (getchar() != '\n'); // Limpa o buffer
@@ -1591,13 +2124,17 @@ int main() {
             }
             // FIM DOS NOVOS CASES
 
-            case 14: // Opção de saída atualizada (o número mudou de 12 para 14)
+            case 14:
+                sensorAnalytics(&list);
+                break;
+
+            case 15: // Opção de saída atualizada
                 printf("Saindo...\n");
                 break;
             default:
                 printf("Opção inválida. Tente novamente.\n");
         }
-    } while (choice != 14); // Condição de saída atualizada
+    } while (choice != 15); // Condição de saída atualizada
 
     freeSkipList(&list);
     // ADICIONE ESTA LINHA: